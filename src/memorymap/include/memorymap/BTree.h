@@ -0,0 +1,114 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#ifndef BTREE_H_
+#define BTREE_H_
+
+#include <stddef.h>                            /// NULL, size_t
+#include <stdbool.h>
+
+#include "memorymap/MemoryArea.h"
+
+
+#define BTREE_LEAF_CAPACITY     32              /// max number of areas in leaf
+#define BTREE_INNER_CAPACITY    16              /// max number of children of inner node
+
+
+typedef enum {
+    BTREE_INVALID_OK = 0,                       /// tree is valid
+
+    BTREE_INVALID_NOT_SORTED = 1,               /// areas overlap or are not sorted
+    BTREE_INVALID_NODE_COUNT = 2,               /// node is overfilled or underfilled
+    BTREE_INVALID_LEAF_DEPTH = 3,               /// leaves are not on the same level
+    BTREE_INVALID_SUMMARY = 4,                  /// data stored in parent does not match child
+    BTREE_INVALID_TREE_DATA = 5                 /// size or height does not match nodes
+} BTreeValidationError;
+
+
+struct BTreeElement;                            /// tree node
+
+
+/**
+ * B+-tree of memory areas. Leaves keep sorted arrays of areas, inner nodes
+ * keep arrays of children with summaries of their subtrees (address span,
+ * largest free gap and number of areas). Wide nodes make descent touch only
+ * few cache lines per level.
+ */
+typedef struct {
+    struct BTreeElement* root;
+    size_t size;                                /// number of areas
+    size_t height;                              /// number of levels
+} BTree;
+
+
+/// ===========================================================================
+
+
+void* btree_mmap(BTree* tree, void *vaddr, unsigned int size);
+
+void btree_munmap(BTree* tree, void *vaddr);
+
+
+/// =============================================
+
+
+/**
+ * If tree has be initialized previously, then have to be released
+ * before next initialization.
+ */
+bool btree_init(BTree* tree);
+
+size_t btree_size(const BTree* tree);
+
+/**
+ * Returns number of levels of tree.
+ */
+size_t btree_depth(const BTree* tree);
+
+size_t btree_startAddress(const BTree* tree);
+
+size_t btree_endAddress(const BTree* tree);
+
+MemoryArea btree_area(const BTree* tree);
+
+MemoryArea btree_valueByIndex(const BTree* tree, const size_t index);
+
+BTreeValidationError btree_isValid(const BTree* tree);
+
+/**
+ * Reserves area in first free space at or after given address.
+ * Returns start address of reserved area.
+ */
+size_t btree_add(BTree* tree, const size_t address, const size_t size);
+
+void btree_delete(BTree* tree, const size_t address);
+
+void btree_print(const BTree* tree);
+
+/**
+ * Tree has to be initialized before releasing.
+ */
+bool btree_release(BTree* tree);
+
+
+#endif /* BTREE_H_ */
@@ -0,0 +1,129 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#ifndef BITMAP_H_
+#define BITMAP_H_
+
+#include <stddef.h>                            /// NULL, size_t
+#include <stdbool.h>
+#include <stdint.h>                            /// uint64_t
+
+#include "memorymap/MemoryArea.h"
+
+
+#define BITMAP_DEFAULT_GRANULARITY  4096            /// bytes per page
+#define BITMAP_DEFAULT_PAGES        ((size_t)1 << 20)   /// pages of region of 'bitmap_init'
+
+/**
+ * Returned by 'bitmap_add' if area cannot be reserved (address 0 can be valid block).
+ */
+#define BITMAP_NO_ADDRESS           ((size_t)-1)
+
+
+typedef enum {
+    BITMAP_INVALID_OK = 0,                      /// map is valid
+
+    BITMAP_INVALID_START = 1,                   /// block starts on free page
+    BITMAP_INVALID_SIZE = 2,                    /// number of blocks does not match start bits
+    BITMAP_INVALID_SUMMARY = 3                  /// summary of full words does not match pages
+} BitmapValidationError;
+
+
+/**
+ * Memory map keeping one bit per page of region of address space
+ * [base, limit). Reserved pages are marked in 'used', first page of every
+ * block is marked in 'starts'. Free runs are found by scanning whole words,
+ * full words are skipped by summary bitmap 'full', so dense maps of
+ * page-aligned blocks are cheap to search. Addresses and sizes are rounded
+ * to pages. Bitmaps grow up to last reserved page, never beyond region.
+ */
+typedef struct {
+    uint64_t* used;                             /// bit set -- page reserved
+    uint64_t* starts;                           /// bit set -- page starts block
+    uint64_t* full;                             /// bit set -- word of 'used' is full
+    size_t words;                               /// number of words of 'used' and 'starts'
+    size_t granularity;                         /// bytes per page
+    size_t base;                                /// first address of region
+    size_t pages;                               /// number of pages of region
+    size_t size;                                /// number of blocks
+} BitmapMap;
+
+
+/// ===========================================================================
+
+
+void* bitmap_mmap(BitmapMap* map, void *vaddr, unsigned int size);
+
+void bitmap_munmap(BitmapMap* map, void *vaddr);
+
+
+/// =============================================
+
+
+/**
+ * Initializes map with given page size in bytes covering region of
+ * BITMAP_DEFAULT_PAGES pages starting at address 0.
+ * If map has be initialized previously, then have to be released
+ * before next initialization.
+ */
+bool bitmap_init(BitmapMap* map, const size_t granularity);
+
+/**
+ * Initializes map of region [base, base + pages * granularity). 'base' has
+ * to be aligned to page and region has to fit in address space.
+ */
+bool bitmap_initRegion(BitmapMap* map, const size_t granularity, const size_t base, const size_t pages);
+
+size_t bitmap_size(const BitmapMap* map);
+
+size_t bitmap_startAddress(const BitmapMap* map);
+
+size_t bitmap_endAddress(const BitmapMap* map);
+
+MemoryArea bitmap_area(const BitmapMap* map);
+
+BitmapValidationError bitmap_isValid(const BitmapMap* map);
+
+/**
+ * Reserves area in first free pages at or after given address
+ * (rounded up to page, address below region means start of region).
+ * Size is rounded up to whole pages.
+ * Returns start address of reserved area or BITMAP_NO_ADDRESS if there
+ * is no such space inside region or memory of map cannot be grown.
+ */
+size_t bitmap_add(BitmapMap* map, const size_t address, const size_t size);
+
+/**
+ * Releases block containing given address.
+ */
+void bitmap_delete(BitmapMap* map, const size_t address);
+
+void bitmap_print(const BitmapMap* map);
+
+/**
+ * Map has to be initialized before releasing.
+ */
+bool bitmap_release(BitmapMap* map);
+
+
+#endif /* BITMAP_H_ */
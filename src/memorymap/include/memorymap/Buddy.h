@@ -0,0 +1,141 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#ifndef BUDDY_H_
+#define BUDDY_H_
+
+#include <stddef.h>                            /// NULL, size_t
+#include <stdbool.h>
+#include <stdint.h>                            /// uint64_t
+
+#include "memorymap/MemoryArea.h"
+
+
+#define BUDDY_DEFAULT_MIN_ORDER     12              /// smallest block (4 KiB)
+#define BUDDY_DEFAULT_MAX_ORDER     28              /// whole managed region (256 MiB)
+#define BUDDY_MAX_LEVELS            24              /// max difference of orders (size of bitmaps)
+
+
+typedef enum {
+    BUDDY_INVALID_OK = 0,                       /// map is valid
+
+    BUDDY_INVALID_OVERLAP = 1,                  /// block marked free and reserved or inside other block
+    BUDDY_INVALID_UNCOVERED = 2,                /// part of region is neither free nor reserved
+    BUDDY_INVALID_NOT_MERGED = 3,               /// both buddies are free
+    BUDDY_INVALID_SIZE = 4                      /// number of blocks does not match marks
+} BuddyValidationError;
+
+
+/**
+ * Free blocks of one order. Blocks are pushed when they become free and
+ * not removed when merged or reserved, so entries are checked against
+ * 'free' bitmap when popped.
+ */
+typedef struct {
+    size_t* items;                              /// indices of blocks
+    size_t size;
+    size_t capacity;
+    size_t free;                                /// number of free blocks of order
+} BuddyFreeList;
+
+
+/**
+ * Buddy allocator of address region [base, base + 2^maxOrder). Blocks have
+ * power of two sizes from 2^minOrder to 2^maxOrder and are naturally aligned
+ * (relative to 'base'). Every order has bitmap of free blocks, bitmap of
+ * reserved blocks and free list, so split and coalesce take O(log N).
+ */
+typedef struct {
+    size_t base;                                /// start address of region
+    size_t minOrder;
+    size_t maxOrder;
+    uint64_t* freeBits;                         /// bitmaps of free blocks of all orders
+    uint64_t* usedBits;                         /// bitmaps of reserved blocks of all orders
+    BuddyFreeList* lists;                       /// free list of every order (from 'minOrder')
+    size_t size;                                /// number of reserved blocks
+} BuddyMap;
+
+
+/// ===========================================================================
+
+
+void* buddy_mmap(BuddyMap* map, void *vaddr, unsigned int size);
+
+void buddy_munmap(BuddyMap* map, void *vaddr);
+
+
+/// =============================================
+
+
+/**
+ * Initializes map of default region: blocks from 2^BUDDY_DEFAULT_MIN_ORDER
+ * to 2^BUDDY_DEFAULT_MAX_ORDER bytes, region starts at 2^BUDDY_DEFAULT_MAX_ORDER.
+ * If map has be initialized previously, then have to be released
+ * before next initialization.
+ */
+bool buddy_init(BuddyMap* map);
+
+/**
+ * Initializes map of region [base, base + 2^maxOrder). 'base' has to be
+ * aligned to 2^maxOrder and greater than 0 (address 0 means failure of add).
+ * 'maxOrder - minOrder' can not exceed BUDDY_MAX_LEVELS.
+ */
+bool buddy_initRegion(BuddyMap* map, const size_t base, const size_t minOrder, const size_t maxOrder);
+
+size_t buddy_size(const BuddyMap* map);
+
+/**
+ * Returns number of free bytes in region.
+ */
+size_t buddy_freeSize(const BuddyMap* map);
+
+size_t buddy_startAddress(const BuddyMap* map);
+
+size_t buddy_endAddress(const BuddyMap* map);
+
+MemoryArea buddy_area(const BuddyMap* map);
+
+BuddyValidationError buddy_isValid(const BuddyMap* map);
+
+/**
+ * Reserves block of 'size' rounded up to power of two (at least 2^minOrder).
+ * If naturally aligned block at or right after 'address' is free, then it is
+ * reserved, otherwise block is taken from free lists.
+ * Returns start address of reserved block or 0 if there is no free block.
+ */
+size_t buddy_add(BuddyMap* map, const size_t address, const size_t size);
+
+/**
+ * Releases block containing given address and merges it with free buddies.
+ */
+void buddy_delete(BuddyMap* map, const size_t address);
+
+void buddy_print(const BuddyMap* map);
+
+/**
+ * Map has to be initialized before releasing.
+ */
+bool buddy_release(BuddyMap* map);
+
+
+#endif /* BUDDY_H_ */
@@ -77,6 +77,39 @@ static inline size_t memory_startAddress(const MemoryArea* area, const MemoryAre
     }
 }
 
+/**
+ * Moves 'area' to first address inside free space (gapStart, gapEnd) not lower than area's start.
+ * Returns false if area does not fit in the space.
+ */
+static inline bool memory_fitGap(const size_t gapStart, const size_t gapEnd, MemoryArea* area) {
+    const size_t start = (area->start > gapStart) ? area->start : gapStart;
+    if (start > gapEnd) {
+        return false;
+    }
+    const size_t areaSize = memory_size(area);
+    if (gapEnd - start < areaSize) {
+        return false;
+    }
+    *area = memory_create(start, areaSize);
+    return true;
+}
+
+/**
+ * Moves 'area' to the end of free space (gapStart, gapEnd).
+ * Returns false if area does not fit in the space.
+ */
+static inline bool memory_fitGapTop(const size_t gapStart, const size_t gapEnd, MemoryArea* area) {
+    if (gapStart >= gapEnd) {
+        return false;
+    }
+    const size_t areaSize = memory_size(area);
+    if (gapEnd - gapStart < areaSize) {
+        return false;
+    }
+    *area = memory_create(gapEnd - areaSize, areaSize);
+    return true;
+}
+
 void memory_print( const MemoryArea* area );
 
 int memory_compare( const MemoryArea* area1, const MemoryArea* area2 );
@@ -25,8 +25,10 @@
 #define RBTREE_H_
 
 #include <stddef.h>                            /// NULL, size_t
+#include <stdint.h>                            /// uintptr_t
 
 #include "memorymap/MemoryArea.h"
+#include "rbtree/NodePool.h"
 
 
 
@@ -36,17 +38,25 @@ typedef enum {
 } NodeColor;
 
 
+/**
+ * Compact node: area (key data) is placed first, color is kept in lowest bit
+ * of parent pointer (40 bytes instead of 48 on 64-bit platforms).
+ */
 typedef struct RBTreeElement {
-    struct RBTreeElement* parent;
+    MemoryArea area;
     struct RBTreeElement* left;
     struct RBTreeElement* right;
-    MemoryArea area;
-    NodeColor color;                /// black by default
+    uintptr_t parentColor;          /// parent pointer and color (black by default)
 } RBTreeNode;
 
 
 typedef struct {
     RBTreeNode* root;
+    size_t size;                    /// number of nodes
+    RBTreeNode* leftmost;           /// node with lowest address, NULL if tree is empty
+    RBTreeNode* rightmost;          /// node with highest address, NULL if tree is empty
+    size_t blackHeight;             /// number of black nodes on every path from root to leaf
+    NodePool* pool;                 /// optional node allocator, NULL means malloc
 } RBTree;
 
 
@@ -63,7 +73,10 @@ typedef enum {
     /// red-black tree properties
     RBTREE_INVALID_RED_ROOT = 6,
     RBTREE_INVALID_BLACK_CHILDREN = 7,            /// when node is red, then children have to be black
-    RBTREE_INVALID_BLACK_PATH = 8                 /// invalid number of black nodes on paths
+    RBTREE_INVALID_BLACK_PATH = 8,                /// invalid number of black nodes on paths
+
+    /// cached tree data
+    RBTREE_INVALID_TREE_DATA = 9                  /// size, bounds or black height does not match nodes
 } RBTreeValidationError;
 
 
@@ -80,14 +93,28 @@ void tree_munmap(RBTree* tree, void *vaddr);
  */
 int tree_init(RBTree* tree);
 
+/**
+ * Makes tree allocate nodes from slab pool. Have to be called on empty tree.
+ * Pool is released together with tree. Returns -3 if pool could not be created.
+ */
+int tree_usePool(RBTree* tree);
+
 
 /// =============================================
 
 
 size_t tree_size(const RBTree* tree);
 
+/**
+ * Exact depth, requires traversal of tree.
+ */
 size_t tree_depth(const RBTree* tree);
 
+/**
+ * Black height of tree, constant time.
+ */
+size_t tree_blackHeight(const RBTree* tree);
+
 size_t tree_startAddress(const RBTree* tree);
 
 size_t tree_endAddress(const RBTree* tree);
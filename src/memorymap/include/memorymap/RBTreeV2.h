@@ -30,16 +30,91 @@
 #include "memorymap/MemoryArea.h"
 
 
+typedef enum {
+    TREE2_LAYOUT_INLINE = 0,                    /// memory areas stored inside tree nodes (default)
+    TREE2_LAYOUT_EXTERNAL                       /// memory areas allocated separately from nodes
+} RBTree2Layout;
+
+
+/**
+ * Placement of reserved area, 'address' passed to add function is a hint.
+ */
+typedef enum {
+    TREE2_FIT_FIRST = 0,                        /// first free space at or after hint (default)
+    TREE2_FIT_NEXT,                             /// first free space after previously reserved area, then from hint
+    TREE2_FIT_BEST,                             /// smallest free space between areas (requires free index)
+    TREE2_FIT_TOP_DOWN                          /// highest free space below hint (top address if no hint), area placed at top of the space
+} RBTree2Policy;
+
+
+/**
+ * Default limit of top-down placement without hint -- top of address space
+ * (last page excluded).
+ */
+#define TREE2_DEFAULT_TOP_ADDRESS   (~(size_t)0xFFF)
+
+
+/**
+ * Radix index splits address into page table indices: TREE2_RADIX_LEVELS
+ * levels of TREE2_RADIX_LEVEL_BITS bits above page offset of
+ * TREE2_RADIX_PAGE_BITS bits. Addresses above covered range are not indexed.
+ */
+#define TREE2_RADIX_PAGE_BITS       12
+#define TREE2_RADIX_LEVEL_BITS      9
+#define TREE2_RADIX_LEVELS          4
+
+/**
+ * Maximum number of areas visited inside one page by radix lookup,
+ * above the limit lookup falls back to tree descent.
+ */
+#define TREE2_RADIX_MAX_WALK        8
+
+/**
+ * Protection bits of area kept by tree ('MemoryFlag' values).
+ */
+#define TREE2_FLAGS_MASK            (READ | WRITE | EXEC)
+
+
+struct RBTree2RadixTable;                       /// table of radix index
+
+
 typedef struct {
     ARBTree tree;
+    ARBTree freeTree;                           /// free extents between areas ordered by (size, address)
+    bool freeIndex;                             /// is 'freeTree' maintained
+    RBTree2Policy policy;                       /// placement used by 'tree2_add' and 'tree2_mmap'
+    size_t nextAddress;                         /// end of last reserved area, used by next fit
+    size_t topAddress;                          /// limit of top-down placement without hint (like mmap base)
+    struct RBTree2RadixTable* radix;            /// root of page table index of areas, NULL if disabled
+    size_t pieces;                              /// number of areas continuing block of preceding area
 } RBTree2;
 
 
+/**
+ * Position of in-order walk over areas (see 'ARBTreeCursor').
+ */
+typedef ARBTreeCursor RBTree2Cursor;
+
+/**
+ * Visitor of areas, returning false stops the walk.
+ */
+typedef bool (* tree2_visitArea)(const MemoryArea* area, void* context);
+
+
 /// ===========================================================================
 
 
 void* tree2_mmap(RBTree2* tree, void *vaddr, unsigned int size);
 
+void* tree2_mmapBestFit(RBTree2* tree, void *vaddr, unsigned int size);
+
+void* tree2_mmapFit(RBTree2* tree, void *vaddr, unsigned int size, const RBTree2Policy policy);
+
+/**
+ * Reserves area of given protection ('MemoryFlag' bits).
+ */
+void* tree2_mmapFlags(RBTree2* tree, void *vaddr, unsigned int size, const RBTree2Policy policy, const unsigned int flags);
+
 void tree2_munmap(RBTree2* tree, void *vaddr);
 
 
@@ -52,10 +127,82 @@ void tree2_munmap(RBTree2* tree, void *vaddr);
  */
 bool tree2_init(RBTree2* tree);
 
+/**
+ * Initializes tree with given layout. Nodes are allocated using malloc.
+ */
+bool tree2_initLayout(RBTree2* tree, const RBTree2Layout layout);
+
+/**
+ * Makes tree allocate nodes from slab pool. Have to be called on empty tree.
+ * 'tree2_init' uses pool by default.
+ */
+bool tree2_usePool(RBTree2* tree);
+
+/**
+ * Enables index of free extents (spaces between reserved areas) ordered
+ * by size, so the smallest space able to hold area is found in O(log n).
+ * Index is built from already reserved areas and then updated on every
+ * add and delete.
+ */
+bool tree2_useFreeIndex(RBTree2* tree);
+
+/**
+ * Makes tree searches start from last touched node instead of root
+ * (see 'rbtree_useFinger'), so reserving or removing areas close to
+ * previous ones is cheaper.
+ */
+bool tree2_useFinger(RBTree2* tree);
+
+/**
+ * Enables radix index mapping address to node of area in fixed number of
+ * steps (like hardware page table). Every page points to first area
+ * intersecting it and table fully covered by one area points directly to
+ * its node. Index speeds up 'tree2_delete' and 'tree2_find'. Index is
+ * built from already reserved areas and then updated on every add and delete.
+ * Tables take up to few KiB per sparse area, memory grows with spread of
+ * addresses. Reservation fails if table of new area cannot be allocated.
+ * If index cannot be extended when areas are trimmed or joined, then it is
+ * disabled (lookups fall back to tree descent). 'tree2_release' disables
+ * the index. Returns false if index could not be allocated.
+ */
+bool tree2_useRadixIndex(RBTree2* tree);
+
+/**
+ * Sets placement policy of 'tree2_add' and 'tree2_mmap'.
+ * Best fit policy enables free index.
+ */
+bool tree2_setPolicy(RBTree2* tree, const RBTree2Policy policy);
+
+/**
+ * Sets address below which top-down policy places areas reserved without
+ * hint (address 0), like mmap base of process. Default is
+ * TREE2_DEFAULT_TOP_ADDRESS. Returns false for address 0.
+ */
+bool tree2_setTopAddress(RBTree2* tree, const size_t address);
+
 size_t tree2_size(const RBTree2* tree);
 
+/**
+ * Returns number of reserved blocks. Block split by 'tree2_protect' is kept
+ * as many areas (pieces), so the value can be smaller than 'tree2_size'.
+ */
+size_t tree2_blocks(const RBTree2* tree);
+
+/**
+ * Returns number of free extents in index (0 if index is disabled).
+ */
+size_t tree2_freeExtents(const RBTree2* tree);
+
+/**
+ * Exact depth, requires traversal of tree.
+ */
 size_t tree2_depth(const RBTree2* tree);
 
+/**
+ * Black height of tree, constant time.
+ */
+size_t tree2_blackHeight(const RBTree2* tree);
+
 size_t tree2_startAddress(const RBTree2* tree);
 
 size_t tree2_endAddress(const RBTree2* tree);
@@ -64,12 +211,142 @@ MemoryArea tree2_area(const RBTree2* tree);
 
 MemoryArea tree2_valueByIndex(const RBTree2* tree, const size_t index);
 
+/**
+ * Returns area containing given address or empty area (0, 0) if there is no such.
+ */
+MemoryArea tree2_find(const RBTree2* tree, const size_t address);
+
 ARBTreeValidationError tree2_isValid(const RBTree2* tree);
 
+/**
+ * Cursor functions return true if cursor points to area. Stepping takes
+ * amortized O(1), so walk over all areas takes O(n) without allocations.
+ * Cursor is valid until tree is modified.
+ */
+bool tree2_cursorFirst(const RBTree2* tree, RBTree2Cursor* cursor);
+
+bool tree2_cursorLast(const RBTree2* tree, RBTree2Cursor* cursor);
+
+/**
+ * Moves cursor to area containing 'address' or to first area after it.
+ */
+bool tree2_cursorSeek(const RBTree2* tree, const size_t address, RBTree2Cursor* cursor);
+
+bool tree2_cursorNext(RBTree2Cursor* cursor);
+
+bool tree2_cursorPrev(RBTree2Cursor* cursor);
+
+/**
+ * Returns area pointed by cursor or empty area (0, 0).
+ */
+MemoryArea tree2_cursorGet(const RBTree2Cursor* cursor);
+
+/**
+ * Calls 'visitor' for every area intersecting range (start, end) in address
+ * order. Walk starts from first area ending after 'start' and stops on first
+ * area starting at or after 'end', so it takes O(log n + k) for k areas.
+ * Returns number of visited areas.
+ */
+size_t tree2_forEachInRange(const RBTree2* tree, const size_t start, const size_t end, tree2_visitArea visitor, void* context);
+
+/**
+ * Calls 'visitor' for every free gap between areas of size at least 'minSize'
+ * in address order. Subtrees without such gap are skipped (largest gap is
+ * kept in every node), so walk takes O(log n + k log n) for k gaps.
+ * Space before first area and after last area is not a gap.
+ * Returns number of visited gaps.
+ */
+size_t tree2_forEachGap(const RBTree2* tree, const size_t minSize, tree2_visitArea visitor, void* context);
+
+/**
+ * Returns largest free gap between areas (lowest one in case of many)
+ * or empty area (0, 0) if there is no gap. Size of the gap is aggregated
+ * in root, so the gap is found in O(log n).
+ */
+MemoryArea tree2_largestGap(const RBTree2* tree);
+
+/**
+ * Collects protections of areas intersecting range (start, end): 'any' gets
+ * flags set for any area, 'all' flags set for every area. Every node keeps
+ * OR and AND of protections of its subtree, so query takes O(log n).
+ * Returns false (and zero flags) if no area intersects range.
+ */
+bool tree2_rangeFlags(const RBTree2* tree, const size_t start, const size_t end, unsigned int* any, unsigned int* all);
+
+/**
+ * Reserves area according to tree's policy (first fit by default).
+ * Returns start address of reserved area.
+ */
 size_t tree2_add(RBTree2* tree, const size_t address, const size_t size);
 
+/**
+ * Reserves area according to given policy. If policy cannot place area
+ * (no fitting space for best fit, no space below hint or top address for top-down),
+ * then area is reserved with first fit. Unknown policy is rejected (returns 0).
+ */
+size_t tree2_addFit(RBTree2* tree, const size_t address, const size_t size, const RBTree2Policy policy);
+
+/**
+ * Reserves area in smallest free space between reserved areas able to hold it
+ * (lowest address in case of many). If there is no such space or free index
+ * is disabled, then reserves area as 'tree2_add' does.
+ * Returns start address of reserved area.
+ */
+size_t tree2_addBestFit(RBTree2* tree, const size_t address, const size_t size);
+
+/**
+ * Reserves many areas at once. Start of every area is a hint. Requests are
+ * placed in given order exactly as by 'tree2_addFit' with first fit: every
+ * request is found by descent over largest gaps of reserved areas and of
+ * areas placed for previous requests of batch, in O(log n + log k). Placed
+ * areas are kept sorted and linked into tree at once (see 'rbtree_addSorted').
+ * Policy is not used, empty requests fail.
+ * On return 'areas' contain reserved blocks, (0, 0) for failed requests.
+ * Returns number of reserved areas (0 if memory allocation failed).
+ */
+size_t tree2_addBatch(RBTree2* tree, MemoryArea* areas, const size_t size);
+
+/**
+ * Builds perfectly balanced tree of ascending, non-overlapping 'areas'
+ * in O(n) (see 'rbtree_buildFromSorted'). Enabled indexes are filled.
+ * Tree has to be empty. Returns false if tree is not empty, areas are
+ * not sorted, overlap or are empty, or if memory allocation failed.
+ */
+bool tree2_buildFromSorted(RBTree2* tree, const MemoryArea* areas, const size_t size);
+
 void tree2_delete(RBTree2* tree, const size_t address);
 
+/**
+ * Removes address range (start, end) from reserved areas, like POSIX munmap:
+ * areas inside range are removed, areas crossing bounds of range are trimmed
+ * and area containing whole range is split in two. Areas inside range are cut
+ * out by two splits and one concatenation of tree (see 'rbtree_split'), so
+ * whole operation takes O(log n + k) for k removed areas.
+ * Returns number of removed areas (trimmed areas are not counted).
+ */
+size_t tree2_deleteRange(RBTree2* tree, const size_t start, const size_t end);
+
+/**
+ * Checks if every address of range (start, end) belongs to some area.
+ * Free space is found by largest gaps aggregated in nodes, so check
+ * takes O(log n). Returns false for empty range.
+ */
+bool tree2_isReserved(const RBTree2* tree, const size_t start, const size_t end);
+
+/**
+ * Sets protection of address range (start, end), like POSIX mprotect: areas
+ * crossing bounds of range are split if their protection differs, touching
+ * pieces of the same block with the same protection are joined back.
+ * Areas of range are cut out of tree by split (see 'rbtree_split'), so
+ * flags and aggregates of k areas are updated in O(log n + k), every join
+ * of pieces takes O(log n) more.
+ * Returns number of areas of range whose protection has been set (area
+ * crossing bound of range and already having the protection is not split
+ * and may be skipped) or -1 if range is not fully reserved (like ENOMEM
+ * of mprotect) -- then nothing is changed.
+ */
+int tree2_protect(RBTree2* tree, const size_t start, const size_t end, const unsigned int flags);
+
 void tree2_print(const RBTree2* tree);
 
 /**
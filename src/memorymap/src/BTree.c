@@ -0,0 +1,714 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#include "memorymap/BTree.h"
+
+#include <stdlib.h>                     /// free
+#include <assert.h>
+#include <stdio.h>                      /// printf
+#include <string.h>                     /// memmove
+
+
+/**
+ * Common header of leaf and inner nodes.
+ */
+typedef struct BTreeElement {
+    size_t count;                       /// number of used slots
+    bool leaf;
+} BTreeNode;
+
+
+/**
+ * Data describing subtree, kept by parent for every child.
+ */
+typedef struct {
+    MemoryArea span;                    /// address range of subtree (from start of first to end of last area)
+    size_t maxGap;                      /// largest free space between areas of subtree
+    size_t size;                        /// number of areas in subtree
+} BTreeSummary;
+
+
+typedef struct {
+    BTreeNode header;
+    MemoryArea areas[BTREE_LEAF_CAPACITY];              /// sorted areas
+} BTreeLeaf;
+
+
+typedef struct {
+    BTreeNode header;
+    BTreeSummary summaries[BTREE_INNER_CAPACITY];
+    BTreeNode* children[BTREE_INNER_CAPACITY];
+} BTreeInner;
+
+
+static BTreeNode* btree_makeNode(const bool leaf) {
+    BTreeNode* node = NULL;
+    if (leaf) {
+        node = calloc( 1, sizeof(BTreeLeaf) );
+    } else {
+        node = calloc( 1, sizeof(BTreeInner) );
+    }
+    node->leaf = leaf;
+    return node;
+}
+
+static inline size_t btree_capacity(const BTreeNode* node) {
+    return (node->leaf) ? BTREE_LEAF_CAPACITY : BTREE_INNER_CAPACITY;
+}
+
+/**
+ * Minimal number of slots of non-root node.
+ */
+static inline size_t btree_minCount(const BTreeNode* node) {
+    return btree_capacity(node) / 4;
+}
+
+/**
+ * Moves 'num' slots from position 'srcPos' of 'src' to position 'dstPos' of 'dst'.
+ * Both nodes have to be of the same kind. Ranges can overlap. Counters are not changed.
+ */
+static void btree_moveSlots(BTreeNode* dst, const size_t dstPos, BTreeNode* src, const size_t srcPos, const size_t num) {
+    assert( dst->leaf == src->leaf );
+    if (num == 0) {
+        return ;
+    }
+    if (dst->leaf) {
+        BTreeLeaf* dstLeaf = (BTreeLeaf*)dst;
+        BTreeLeaf* srcLeaf = (BTreeLeaf*)src;
+        memmove( &(dstLeaf->areas[dstPos]), &(srcLeaf->areas[srcPos]), num * sizeof(MemoryArea) );
+        return ;
+    }
+    BTreeInner* dstInner = (BTreeInner*)dst;
+    BTreeInner* srcInner = (BTreeInner*)src;
+    memmove( &(dstInner->summaries[dstPos]), &(srcInner->summaries[srcPos]), num * sizeof(BTreeSummary) );
+    memmove( &(dstInner->children[dstPos]), &(srcInner->children[srcPos]), num * sizeof(BTreeNode*) );
+}
+
+/**
+ * Returns address range of non-empty subtree.
+ */
+static MemoryArea btree_span(const BTreeNode* node) {
+    assert( node->count > 0 );
+    const size_t last = node->count - 1;
+    MemoryArea span;
+    if (node->leaf) {
+        const BTreeLeaf* leaf = (const BTreeLeaf*)node;
+        span.start = leaf->areas[0].start;
+        span.end = leaf->areas[last].end;
+    } else {
+        const BTreeInner* inner = (const BTreeInner*)node;
+        span.start = inner->summaries[0].span.start;
+        span.end = inner->summaries[last].span.end;
+    }
+    return span;
+}
+
+/**
+ * Calculates summary of non-empty subtree based on node's slots.
+ */
+static BTreeSummary btree_summary(const BTreeNode* node) {
+    BTreeSummary summary;
+    summary.span = btree_span(node);
+    summary.maxGap = 0;
+    if (node->leaf) {
+        const BTreeLeaf* leaf = (const BTreeLeaf*)node;
+        summary.size = node->count;
+        for(size_t i = 1; i < node->count; ++i) {
+            const size_t gap = leaf->areas[i].start - leaf->areas[i-1].end;
+            if (gap > summary.maxGap) {
+                summary.maxGap = gap;
+            }
+        }
+        return summary;
+    }
+    const BTreeInner* inner = (const BTreeInner*)node;
+    summary.size = 0;
+    for(size_t i = 0; i < node->count; ++i) {
+        const BTreeSummary* child = &(inner->summaries[i]);
+        summary.size += child->size;
+        if (child->maxGap > summary.maxGap) {
+            summary.maxGap = child->maxGap;
+        }
+        if (i == 0) {
+            continue ;
+        }
+        const size_t gap = child->span.start - inner->summaries[i-1].span.end;
+        if (gap > summary.maxGap) {
+            summary.maxGap = gap;
+        }
+    }
+    return summary;
+}
+
+static inline void btree_refreshSlot(BTreeInner* inner, const size_t index) {
+    inner->summaries[index] = btree_summary( inner->children[index] );
+}
+
+/**
+ * Returns index of child that can contain given address
+ * (last child starting at or before address, first child otherwise).
+ */
+static size_t btree_childIndex(const BTreeInner* inner, const size_t address) {
+    size_t lo = 0;
+    size_t hi = inner->header.count;
+    while (hi - lo > 1) {
+        const size_t mid = (lo + hi) / 2;
+        if (inner->summaries[mid].span.start <= address) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Returns index of first area starting after given address.
+ */
+static size_t btree_upperBound(const BTreeLeaf* leaf, const size_t address) {
+    size_t lo = 0;
+    size_t hi = leaf->header.count;
+    while (lo < hi) {
+        const size_t mid = (lo + hi) / 2;
+        if (leaf->areas[mid].start <= address) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+
+/// ========================================================================================
+
+
+/**
+ * Finds first free space inside subtree able to hold 'area' (starting from area's address).
+ * 'prevEnd' is end address of area preceding the subtree (0 if there is no such area).
+ * Children placed before area's address or not having enough free space are skipped.
+ */
+static bool btree_findFirstFit(const BTreeNode* node, const size_t prevEnd, MemoryArea* area) {
+    size_t gapStart = prevEnd;
+    if (node->leaf) {
+        const BTreeLeaf* leaf = (const BTreeLeaf*)node;
+        for(size_t i = 0; i < node->count; ++i) {
+            if (memory_fitGap(gapStart, leaf->areas[i].start, area) == true) {
+                return true;
+            }
+            gapStart = leaf->areas[i].end;
+        }
+        return false;
+    }
+
+    const BTreeInner* inner = (const BTreeInner*)node;
+    const size_t areaSize = memory_size(area);
+    for(size_t i = 0; i < node->count; ++i) {
+        const BTreeSummary* child = &(inner->summaries[i]);
+        if (child->span.end > area->start) {
+            /// space before child
+            if (memory_fitGap(gapStart, child->span.start, area) == true) {
+                return true;
+            }
+            /// space inside child
+            if (child->maxGap >= areaSize) {
+                if (btree_findFirstFit(inner->children[i], gapStart, area) == true) {
+                    return true;
+                }
+            }
+        }
+        gapStart = child->span.end;
+    }
+    return false;
+}
+
+/**
+ * Moves 'area' to first free space at or after area's address.
+ */
+static void btree_fitFirst(const BTree* tree, MemoryArea* area) {
+    if (tree->root == NULL) {
+        return ;
+    }
+    if (btree_findFirstFit(tree->root, 0, area) == true) {
+        return ;
+    }
+    /// no free space between areas -- put after last one
+    const MemoryArea span = btree_span(tree->root);
+    memory_fitAfter(&span, area);
+}
+
+/**
+ * Inserts area into leaf. Returns new right sibling if leaf had to be split, otherwise NULL.
+ */
+static BTreeNode* btree_insertLeaf(BTreeLeaf* leaf, const MemoryArea* area) {
+    BTreeLeaf* target = leaf;
+    BTreeLeaf* right = NULL;
+    if (leaf->header.count == BTREE_LEAF_CAPACITY) {
+        /// full -- split in halves
+        const size_t half = BTREE_LEAF_CAPACITY / 2;
+        right = (BTreeLeaf*) btree_makeNode(true);
+        btree_moveSlots(&(right->header), 0, &(leaf->header), half, BTREE_LEAF_CAPACITY - half);
+        right->header.count = BTREE_LEAF_CAPACITY - half;
+        leaf->header.count = half;
+        if (area->start >= right->areas[0].start) {
+            target = right;
+        }
+    }
+
+    const size_t pos = btree_upperBound(target, area->start);
+    btree_moveSlots(&(target->header), pos + 1, &(target->header), pos, target->header.count - pos);
+    target->areas[pos] = *area;
+    ++(target->header.count);
+    return (BTreeNode*)right;
+}
+
+/**
+ * Inserts child into slot 'pos' of inner node. Returns new right sibling
+ * if node had to be split, otherwise NULL.
+ */
+static BTreeNode* btree_insertChild(BTreeInner* inner, const size_t pos, BTreeNode* child) {
+    BTreeInner* target = inner;
+    BTreeInner* right = NULL;
+    size_t targetPos = pos;
+    if (inner->header.count == BTREE_INNER_CAPACITY) {
+        /// full -- split in halves
+        const size_t half = BTREE_INNER_CAPACITY / 2;
+        right = (BTreeInner*) btree_makeNode(false);
+        btree_moveSlots(&(right->header), 0, &(inner->header), half, BTREE_INNER_CAPACITY - half);
+        right->header.count = BTREE_INNER_CAPACITY - half;
+        inner->header.count = half;
+        if (pos > half) {
+            target = right;
+            targetPos = pos - half;
+        }
+    }
+
+    btree_moveSlots(&(target->header), targetPos + 1, &(target->header), targetPos, target->header.count - targetPos);
+    target->children[targetPos] = child;
+    ++(target->header.count);
+    btree_refreshSlot(target, targetPos);
+    return (BTreeNode*)right;
+}
+
+/**
+ * Inserts area into subtree. Returns new right sibling if node had to be split, otherwise NULL.
+ */
+static BTreeNode* btree_insertNode(BTreeNode* node, const MemoryArea* area) {
+    if (node->leaf) {
+        return btree_insertLeaf((BTreeLeaf*)node, area);
+    }
+    BTreeInner* inner = (BTreeInner*)node;
+    const size_t index = btree_childIndex(inner, area->start);
+    BTreeNode* sibling = btree_insertNode(inner->children[index], area);
+    btree_refreshSlot(inner, index);
+    if (sibling == NULL) {
+        return NULL;
+    }
+    return btree_insertChild(inner, index + 1, sibling);
+}
+
+/**
+ * Reserves area in first free space at or after given address.
+ * On success 'area' contains reserved block.
+ */
+static void btree_addArea(BTree* tree, MemoryArea* area) {
+    btree_fitFirst(tree, area);
+
+    ++(tree->size);
+    if (tree->root == NULL) {
+        BTreeLeaf* leaf = (BTreeLeaf*) btree_makeNode(true);
+        leaf->areas[0] = *area;
+        leaf->header.count = 1;
+        tree->root = &(leaf->header);
+        tree->height = 1;
+        return ;
+    }
+
+    BTreeNode* sibling = btree_insertNode(tree->root, area);
+    if (sibling == NULL) {
+        return ;
+    }
+    /// root was split -- grow tree
+    BTreeInner* newRoot = (BTreeInner*) btree_makeNode(false);
+    newRoot->children[0] = tree->root;
+    newRoot->children[1] = sibling;
+    newRoot->header.count = 2;
+    btree_refreshSlot(newRoot, 0);
+    btree_refreshSlot(newRoot, 1);
+    tree->root = &(newRoot->header);
+    ++(tree->height);
+}
+
+
+/// ========================================================================================
+
+
+/**
+ * Fixes underfilled child 'index' by merging it with sibling or by moving
+ * slots from sibling.
+ */
+static void btree_rebalance(BTreeInner* inner, const size_t index) {
+    assert( inner->header.count > 1 );
+    const size_t leftIndex = (index > 0) ? index - 1 : index;
+    BTreeNode* left = inner->children[leftIndex];
+    BTreeNode* right = inner->children[leftIndex + 1];
+    const size_t total = left->count + right->count;
+
+    if (total <= btree_capacity(left)) {
+        /// merge right into left
+        btree_moveSlots(left, left->count, right, 0, right->count);
+        left->count = total;
+        free(right);
+        btree_moveSlots(&(inner->header), leftIndex + 1, &(inner->header), leftIndex + 2, inner->header.count - leftIndex - 2);
+        --(inner->header.count);
+        btree_refreshSlot(inner, leftIndex);
+        return ;
+    }
+
+    /// redistribute slots evenly
+    const size_t leftCount = total / 2;
+    if (left->count < leftCount) {
+        const size_t num = leftCount - left->count;
+        btree_moveSlots(left, left->count, right, 0, num);
+        btree_moveSlots(right, 0, right, num, right->count - num);
+    } else {
+        const size_t num = left->count - leftCount;
+        btree_moveSlots(right, num, right, 0, right->count);
+        btree_moveSlots(right, 0, left, leftCount, num);
+    }
+    left->count = leftCount;
+    right->count = total - leftCount;
+    btree_refreshSlot(inner, leftIndex);
+    btree_refreshSlot(inner, leftIndex + 1);
+}
+
+/**
+ * Removes area containing given address from subtree.
+ * Returns false if there is no such area.
+ */
+static bool btree_deleteNode(BTreeNode* node, const size_t address) {
+    if (node->leaf) {
+        BTreeLeaf* leaf = (BTreeLeaf*)node;
+        const size_t pos = btree_upperBound(leaf, address);
+        if (pos == 0) {
+            return false;
+        }
+        if (leaf->areas[pos - 1].end <= address) {
+            return false;
+        }
+        btree_moveSlots(node, pos - 1, node, pos, node->count - pos);
+        --(node->count);
+        return true;
+    }
+
+    BTreeInner* inner = (BTreeInner*)node;
+    const size_t index = btree_childIndex(inner, address);
+    BTreeNode* child = inner->children[index];
+    if (btree_deleteNode(child, address) == false) {
+        return false;
+    }
+    if (child->count < btree_minCount(child)) {
+        btree_rebalance(inner, index);
+    } else {
+        btree_refreshSlot(inner, index);
+    }
+    return true;
+}
+
+
+/// ========================================================================================
+
+
+size_t btree_size(const BTree* tree) {
+    if (tree == NULL) {
+        return 0;
+    }
+    return tree->size;
+}
+
+size_t btree_depth(const BTree* tree) {
+    if (tree == NULL) {
+        return 0;
+    }
+    return tree->height;
+}
+
+size_t btree_startAddress(const BTree* tree) {
+    if (tree==NULL)
+        return 0;
+    if (tree->root==NULL)
+        return 0;
+    return btree_span(tree->root).start;
+}
+
+size_t btree_endAddress(const BTree* tree) {
+    if (tree==NULL)
+        return 0;
+    if (tree->root==NULL)
+        return 0;
+    return btree_span(tree->root).end;
+}
+
+MemoryArea btree_area(const BTree* tree) {
+    if (tree==NULL)
+        return memory_create(0, 0);
+    if (tree->root==NULL)
+        return memory_create(0, 0);
+    return btree_span(tree->root);
+}
+
+MemoryArea btree_valueByIndex(const BTree* tree, const size_t index) {
+    if (tree == NULL) {
+        return memory_create(0, 0);
+    }
+    if (index >= tree->size) {
+        return memory_create(0, 0);
+    }
+    const BTreeNode* node = tree->root;
+    size_t currIndex = index;
+    while (node->leaf == false) {
+        const BTreeInner* inner = (const BTreeInner*)node;
+        size_t i = 0;
+        while (currIndex >= inner->summaries[i].size) {
+            currIndex -= inner->summaries[i].size;
+            ++i;
+        }
+        node = inner->children[i];
+    }
+    const BTreeLeaf* leaf = (const BTreeLeaf*)node;
+    return leaf->areas[currIndex];
+}
+
+
+/// ==================================================================================
+
+
+static BTreeValidationError btree_isValid_checkNode(const BTreeNode* node, const size_t level, const size_t height, size_t* counter) {
+    if (node->count > btree_capacity(node)) {
+        return BTREE_INVALID_NODE_COUNT;
+    }
+    if (level == 1) {
+        /// root
+        const size_t minCount = (node->leaf) ? 1 : 2;
+        if (node->count < minCount) {
+            return BTREE_INVALID_NODE_COUNT;
+        }
+    } else if (node->count < btree_minCount(node)) {
+        return BTREE_INVALID_NODE_COUNT;
+    }
+
+    if (node->leaf) {
+        if (level != height) {
+            return BTREE_INVALID_LEAF_DEPTH;
+        }
+        const BTreeLeaf* leaf = (const BTreeLeaf*)node;
+        for(size_t i = 0; i < node->count; ++i) {
+            if (leaf->areas[i].start > leaf->areas[i].end) {
+                return BTREE_INVALID_NOT_SORTED;
+            }
+            if (i > 0 && leaf->areas[i-1].end > leaf->areas[i].start) {
+                return BTREE_INVALID_NOT_SORTED;
+            }
+        }
+        *counter += node->count;
+        return BTREE_INVALID_OK;
+    }
+
+    if (level >= height) {
+        return BTREE_INVALID_LEAF_DEPTH;
+    }
+    const BTreeInner* inner = (const BTreeInner*)node;
+    for(size_t i = 0; i < node->count; ++i) {
+        const BTreeValidationError validChild = btree_isValid_checkNode(inner->children[i], level + 1, height, counter);
+        if (validChild != BTREE_INVALID_OK) {
+            return validChild;
+        }
+        const BTreeSummary expected = btree_summary(inner->children[i]);
+        const BTreeSummary* summary = &(inner->summaries[i]);
+        if (memory_isEqual(&(summary->span), &(expected.span)) == false) {
+            return BTREE_INVALID_SUMMARY;
+        }
+        if (summary->maxGap != expected.maxGap || summary->size != expected.size) {
+            return BTREE_INVALID_SUMMARY;
+        }
+        if (i > 0 && inner->summaries[i-1].span.end > summary->span.start) {
+            return BTREE_INVALID_NOT_SORTED;
+        }
+    }
+    return BTREE_INVALID_OK;
+}
+
+BTreeValidationError btree_isValid(const BTree* tree) {
+    if (tree == NULL) {
+        return BTREE_INVALID_OK;
+    }
+    if (tree->root == NULL) {
+        if (tree->size != 0 || tree->height != 0) {
+            return BTREE_INVALID_TREE_DATA;
+        }
+        return BTREE_INVALID_OK;
+    }
+    size_t counter = 0;
+    const BTreeValidationError valid = btree_isValid_checkNode(tree->root, 1, tree->height, &counter);
+    if (valid != BTREE_INVALID_OK) {
+        return valid;
+    }
+    if (counter != tree->size) {
+        return BTREE_INVALID_TREE_DATA;
+    }
+    return BTREE_INVALID_OK;
+}
+
+
+/// ==================================================================================
+
+
+size_t btree_add(BTree* tree, const size_t address, const size_t size) {
+    if (tree==NULL)
+        return 0;
+
+    MemoryArea area = memory_create(address, size);
+    btree_addArea(tree, &area);
+    return area.start;
+}
+
+void btree_delete(BTree* tree, const size_t address) {
+    if (tree == NULL) {
+        return ;
+    }
+    BTreeNode* root = tree->root;
+    if (root == NULL) {
+        return ;
+    }
+    if (btree_deleteNode(root, address) == false) {
+        /// not found
+        return ;
+    }
+    --(tree->size);
+
+    if (root->leaf) {
+        if (root->count == 0) {
+            free(root);
+            tree->root = NULL;
+            tree->height = 0;
+        }
+        return ;
+    }
+    if (root->count == 1) {
+        /// root has single child -- shrink tree
+        tree->root = ((BTreeInner*)root)->children[0];
+        free(root);
+        --(tree->height);
+    }
+}
+
+
+/// ==============================================================================================
+
+
+static void btree_printNode(const BTreeNode* node, const size_t level) {
+    for(size_t l = 0; l < level; ++l) {
+        printf("  ");
+    }
+    if (node->leaf) {
+        const BTreeLeaf* leaf = (const BTreeLeaf*)node;
+        for(size_t i = 0; i < node->count; ++i) {
+            printf("(%03lx,%02lx)", leaf->areas[i].start, leaf->areas[i].end);
+        }
+        printf("%s", "\n");
+        return ;
+    }
+    const BTreeInner* inner = (const BTreeInner*)node;
+    printf("[%03lx,%03lx]\n", inner->summaries[0].span.start, inner->summaries[node->count - 1].span.end);
+    for(size_t i = 0; i < node->count; ++i) {
+        btree_printNode(inner->children[i], level + 1);
+    }
+}
+
+void btree_print(const BTree* tree) {
+    if (tree == NULL) {
+        printf("%s", "[NULL]");
+        return ;
+    }
+    if (tree->root == NULL) {
+        printf("%s", "(NULL)");
+        return ;
+    }
+    btree_printNode(tree->root, 0);
+}
+
+
+/// ==============================================================================================
+
+
+static void btree_releaseNode(BTreeNode* node) {
+    if (node->leaf == false) {
+        const BTreeInner* inner = (const BTreeInner*)node;
+        for(size_t i = 0; i < node->count; ++i) {
+            btree_releaseNode(inner->children[i]);
+        }
+    }
+    free(node);
+}
+
+bool btree_release(BTree* tree) {
+    if (tree == NULL) {
+        return false;
+    }
+    if (tree->root != NULL) {
+        btree_releaseNode(tree->root);
+    }
+    tree->root = NULL;
+    tree->size = 0;
+    tree->height = 0;
+    return true;
+}
+
+
+/// ===================================================
+
+
+void* btree_mmap(BTree* tree, void *vaddr, unsigned int size) {
+    if (tree==NULL)
+        return NULL;
+
+    MemoryArea area = memory_create((size_t)vaddr, size);
+    btree_addArea(tree, &area);
+    return (void*)area.start;
+}
+
+void btree_munmap(BTree* tree, void *vaddr) {
+    const size_t voffset = (size_t)vaddr;
+    btree_delete(tree, voffset);
+    assert( btree_isValid(tree) == BTREE_INVALID_OK );
+}
+
+bool btree_init(BTree* tree) {
+    if (tree == NULL) {
+        return false;
+    }
+    tree->root = NULL;
+    tree->size = 0;
+    tree->height = 0;
+    return true;
+}
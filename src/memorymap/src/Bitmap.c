@@ -0,0 +1,483 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#include "memorymap/Bitmap.h"
+
+#include <stdlib.h>                     /// free
+#include <assert.h>
+#include <stdio.h>                      /// printf
+#include <string.h>                     /// memset
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+#define BITMAP_WORD_BITS        64
+#define BITMAP_FULL_WORD        (~(uint64_t)0)
+
+
+/// ========================================================================================
+
+
+static inline size_t bitmap_ctz(const uint64_t word) {
+    assert( word != 0 );
+#ifdef __GNUC__
+    return (size_t)__builtin_ctzll(word);
+#else
+    size_t ret = 0;
+    while ((word & ((uint64_t)1 << ret)) == 0) {
+        ++ret;
+    }
+    return ret;
+#endif
+}
+
+static inline size_t bitmap_clz(const uint64_t word) {
+    assert( word != 0 );
+#ifdef __GNUC__
+    return (size_t)__builtin_clzll(word);
+#else
+    size_t ret = 0;
+    while ((word & ((uint64_t)1 << (BITMAP_WORD_BITS - 1 - ret))) == 0) {
+        ++ret;
+    }
+    return ret;
+#endif
+}
+
+static inline size_t bitmap_popcount(uint64_t word) {
+#ifdef __GNUC__
+    return (size_t)__builtin_popcountll(word);
+#else
+    size_t ret = 0;
+    while (word != 0) {
+        word &= word - 1;
+        ++ret;
+    }
+    return ret;
+#endif
+}
+
+static inline bool bitmap_testBit(const uint64_t* bits, const size_t pos) {
+    return (bits[pos / BITMAP_WORD_BITS] & ((uint64_t)1 << (pos % BITMAP_WORD_BITS))) != 0;
+}
+
+/**
+ * Sets or clears bits in range [from, to), whole words at once.
+ */
+static void bitmap_setRange(uint64_t* bits, size_t from, const size_t to, const bool value) {
+    while (from < to) {
+        const size_t offset = from % BITMAP_WORD_BITS;
+        const size_t rest = BITMAP_WORD_BITS - offset;
+        const size_t count = (to - from < rest) ? to - from : rest;
+        const uint64_t mask = (count == BITMAP_WORD_BITS) ? BITMAP_FULL_WORD : ((((uint64_t)1 << count) - 1) << offset);
+        if (value == true) {
+            bits[from / BITMAP_WORD_BITS] |= mask;
+        } else {
+            bits[from / BITMAP_WORD_BITS] &= ~mask;
+        }
+        from += count;
+    }
+}
+
+static inline size_t bitmap_summaryWords(const size_t words) {
+    return (words + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+}
+
+/**
+ * Marks or unmarks pages [from, to) as reserved and updates summary of full words.
+ */
+static void bitmap_setUsed(BitmapMap* map, const size_t from, const size_t to, const bool value) {
+    bitmap_setRange(map->used, from, to, value);
+    const size_t lastWord = (to - 1) / BITMAP_WORD_BITS;
+    for(size_t i = from / BITMAP_WORD_BITS; i <= lastWord; ++i) {
+        const bool isFull = (map->used[i] == BITMAP_FULL_WORD);
+        bitmap_setRange(map->full, i, i + 1, isFull);
+    }
+}
+
+/**
+ * Finds first set bit (or cleared bit if 'invert' is full word) at or after 'pos'.
+ * Words without such bit are skipped, two at once with SSE2.
+ * Returns number of bits in map if there is no such bit, or 'pos' if it is
+ * outside of map.
+ */
+static size_t bitmap_findBit(const uint64_t* bits, const size_t words, const size_t pos, const uint64_t invert) {
+    const size_t total = words * BITMAP_WORD_BITS;
+    if (pos >= total) {
+        return pos;
+    }
+    size_t index = pos / BITMAP_WORD_BITS;
+    uint64_t word = (bits[index] ^ invert) & (BITMAP_FULL_WORD << (pos % BITMAP_WORD_BITS));
+    while (word == 0) {
+        ++index;
+#ifdef __SSE2__
+        const __m128i pattern = _mm_set1_epi8( (invert != 0) ? (char)-1 : 0 );
+        while (index + 2 <= words) {
+            const __m128i block = _mm_loadu_si128( (const __m128i*)(bits + index) );
+            if (_mm_movemask_epi8( _mm_cmpeq_epi8(block, pattern) ) != 0xFFFF) {
+                break;
+            }
+            index += 2;
+        }
+#endif
+        if (index >= words) {
+            return total;
+        }
+        word = bits[index] ^ invert;
+    }
+    return index * BITMAP_WORD_BITS + bitmap_ctz(word);
+}
+
+/**
+ * Finds first run of 'count' cleared bits starting at or after 'pos'. Every
+ * word is handled at once: run continued from previous words is extended
+ * by trailing free bits, runs inside word are found by shifting and masking,
+ * free bits at top of word start new run. Full words are skipped using
+ * summary bitmap 'full'. Bits outside of map are free.
+ */
+static size_t bitmap_findRun(const uint64_t* bits, const uint64_t* full, const size_t words, const size_t pos, const size_t count) {
+    size_t index = pos / BITMAP_WORD_BITS;
+    if (index >= words) {
+        return pos;
+    }
+    size_t run = 0;                                 /// length of free run reaching current word
+    size_t runStart = pos;
+    /// bits before 'pos' are treated as reserved
+    uint64_t word = bits[index] | ~(BITMAP_FULL_WORD << (pos % BITMAP_WORD_BITS));
+    while (true) {
+        const size_t base = index * BITMAP_WORD_BITS;
+        if (word == 0) {
+            if (run == 0) {
+                runStart = base;
+            }
+            run += BITMAP_WORD_BITS;
+            if (run >= count) {
+                return runStart;
+            }
+        } else if (word != BITMAP_FULL_WORD) {
+            const size_t low = bitmap_ctz(word);
+            if (run > 0 && run + low >= count) {
+                return runStart;
+            }
+            if (low >= count) {
+                return base;
+            }
+            if (count < BITMAP_WORD_BITS) {
+                /// bit 'i' of 'inside' is set if bits [i, i + count) are free
+                uint64_t inside = ~word;
+                size_t length = 1;
+                while (length < count && inside != 0) {
+                    const size_t shift = (count - length < length) ? count - length : length;
+                    inside &= inside >> shift;
+                    length += shift;
+                }
+                if (inside != 0) {
+                    return base + bitmap_ctz(inside);
+                }
+            }
+            const size_t high = bitmap_clz(word);
+            run = high;
+            runStart = base + BITMAP_WORD_BITS - high;
+        } else {
+            /// skip full words
+            run = 0;
+            const size_t next = bitmap_findBit(full, bitmap_summaryWords(words), index + 1, BITMAP_FULL_WORD);
+            index = ((next < words) ? next : words) - 1;
+        }
+
+        ++index;
+        if (index >= words) {
+            /// run continues outside of map
+            return (run > 0) ? runStart : index * BITMAP_WORD_BITS;
+        }
+        word = bits[index];
+    }
+}
+
+/**
+ * Finds last set bit at or before 'pos'. Bit has to exist.
+ */
+static size_t bitmap_findSetBefore(const uint64_t* bits, const size_t pos) {
+    size_t index = pos / BITMAP_WORD_BITS;
+    uint64_t word = bits[index] & (BITMAP_FULL_WORD >> (BITMAP_WORD_BITS - 1 - pos % BITMAP_WORD_BITS));
+    while (word == 0) {
+        assert( index > 0 );
+        --index;
+        word = bits[index];
+    }
+    return index * BITMAP_WORD_BITS + (BITMAP_WORD_BITS - 1 - bitmap_clz(word));
+}
+
+/**
+ * Returns page after last page of block starting at 'start'.
+ */
+static size_t bitmap_blockEnd(const BitmapMap* map, const size_t start) {
+    const size_t freePage = bitmap_findBit(map->used, map->words, start + 1, BITMAP_FULL_WORD);
+    const size_t nextStart = bitmap_findBit(map->starts, map->words, start + 1, 0);
+    return (freePage < nextStart) ? freePage : nextStart;
+}
+
+/**
+ * Makes map hold at least 'pages' pages (not more than pages of region).
+ */
+static bool bitmap_grow(BitmapMap* map, const size_t pages) {
+    if (pages <= map->words * BITMAP_WORD_BITS) {
+        return true;
+    }
+    const size_t needed = (pages + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+    const size_t limit = (map->pages + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+    size_t words = (map->words * 2 > needed) ? map->words * 2 : needed;
+    if (words > limit) {
+        words = limit;
+    }
+    uint64_t* used = realloc(map->used, words * sizeof(uint64_t));
+    if (used == NULL) {
+        return false;
+    }
+    map->used = used;
+    uint64_t* starts = realloc(map->starts, words * sizeof(uint64_t));
+    if (starts == NULL) {
+        return false;
+    }
+    map->starts = starts;
+    const size_t summary = bitmap_summaryWords(map->words);
+    const size_t newSummary = bitmap_summaryWords(words);
+    uint64_t* full = realloc(map->full, newSummary * sizeof(uint64_t));
+    if (full == NULL) {
+        return false;
+    }
+    map->full = full;
+    memset(map->used + map->words, 0, (words - map->words) * sizeof(uint64_t));
+    memset(map->starts + map->words, 0, (words - map->words) * sizeof(uint64_t));
+    memset(map->full + summary, 0, (newSummary - summary) * sizeof(uint64_t));
+    map->words = words;
+    return true;
+}
+
+
+/// ===================================================
+
+
+bool bitmap_init(BitmapMap* map, const size_t granularity) {
+    return bitmap_initRegion(map, granularity, 0, BITMAP_DEFAULT_PAGES);
+}
+
+bool bitmap_initRegion(BitmapMap* map, const size_t granularity, const size_t base, const size_t pages) {
+    if (map == NULL) {
+        return false;
+    }
+    if (granularity == 0 || pages == 0) {
+        return false;
+    }
+    if (base % granularity != 0) {
+        /// region not aligned
+        return false;
+    }
+    if (pages > (BITMAP_NO_ADDRESS - base) / granularity) {
+        /// region exceeds address space
+        return false;
+    }
+    map->used = NULL;
+    map->starts = NULL;
+    map->full = NULL;
+    map->words = 0;
+    map->granularity = granularity;
+    map->base = base;
+    map->pages = pages;
+    map->size = 0;
+    return true;
+}
+
+size_t bitmap_size(const BitmapMap* map) {
+    if (map == NULL) {
+        return 0;
+    }
+    return map->size;
+}
+
+size_t bitmap_startAddress(const BitmapMap* map) {
+    if (map == NULL) {
+        return 0;
+    }
+    const size_t page = bitmap_findBit(map->used, map->words, 0, 0);
+    if (page >= map->words * BITMAP_WORD_BITS) {
+        return 0;
+    }
+    return map->base + page * map->granularity;
+}
+
+size_t bitmap_endAddress(const BitmapMap* map) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->size == 0) {
+        return 0;
+    }
+    const size_t page = bitmap_findSetBefore(map->used, map->words * BITMAP_WORD_BITS - 1);
+    return map->base + (page + 1) * map->granularity;
+}
+
+MemoryArea bitmap_area(const BitmapMap* map) {
+    const size_t startAddress = bitmap_startAddress(map);
+    const size_t endAddress = bitmap_endAddress(map);
+    return memory_create(startAddress, endAddress - startAddress);
+}
+
+BitmapValidationError bitmap_isValid(const BitmapMap* map) {
+    if (map == NULL) {
+        return BITMAP_INVALID_OK;
+    }
+    size_t blocks = 0;
+    for(size_t i = 0; i < map->words; ++i) {
+        if ((map->starts[i] & ~(map->used[i])) != 0) {
+            return BITMAP_INVALID_START;
+        }
+        const bool isFull = (map->used[i] == BITMAP_FULL_WORD);
+        if (bitmap_testBit(map->full, i) != isFull) {
+            return BITMAP_INVALID_SUMMARY;
+        }
+        blocks += bitmap_popcount(map->starts[i]);
+    }
+    if (blocks != map->size) {
+        return BITMAP_INVALID_SIZE;
+    }
+    return BITMAP_INVALID_OK;
+}
+
+
+/// ==================================================================================
+
+
+size_t bitmap_add(BitmapMap* map, const size_t address, const size_t size) {
+    if (map == NULL) {
+        return BITMAP_NO_ADDRESS;
+    }
+    if (size == 0) {
+        return BITMAP_NO_ADDRESS;
+    }
+    const size_t pages = size / map->granularity + ((size % map->granularity != 0) ? 1 : 0);
+    const size_t offset = (address > map->base) ? address - map->base : 0;
+    const size_t first = offset / map->granularity + ((offset % map->granularity != 0) ? 1 : 0);
+    if (pages > map->pages || first > map->pages - pages) {
+        /// hint or size outside of region
+        return BITMAP_NO_ADDRESS;
+    }
+    const size_t pos = bitmap_findRun(map->used, map->full, map->words, first, pages);
+    if (pos > map->pages - pages) {
+        /// no space in region
+        return BITMAP_NO_ADDRESS;
+    }
+
+    if (bitmap_grow(map, pos + pages) == false) {
+        return BITMAP_NO_ADDRESS;
+    }
+    bitmap_setUsed(map, pos, pos + pages, true);
+    bitmap_setRange(map->starts, pos, pos + 1, true);
+    ++(map->size);
+    return map->base + pos * map->granularity;
+}
+
+void bitmap_delete(BitmapMap* map, const size_t address) {
+    if (map == NULL) {
+        return ;
+    }
+    if (address < map->base) {
+        return ;
+    }
+    const size_t page = (address - map->base) / map->granularity;
+    if (page >= map->words * BITMAP_WORD_BITS) {
+        return ;
+    }
+    if (bitmap_testBit(map->used, page) == false) {
+        return ;
+    }
+    const size_t start = bitmap_findSetBefore(map->starts, page);
+    const size_t end = bitmap_blockEnd(map, start);
+    bitmap_setUsed(map, start, end, false);
+    bitmap_setRange(map->starts, start, start + 1, false);
+    --(map->size);
+}
+
+
+/// ==============================================================================================
+
+
+void bitmap_print(const BitmapMap* map) {
+    if (map == NULL) {
+        printf("%s", "[NULL]");
+        return ;
+    }
+    if (map->size == 0) {
+        printf("%s", "(NULL)");
+        return ;
+    }
+    const size_t total = map->words * BITMAP_WORD_BITS;
+    size_t start = bitmap_findBit(map->starts, map->words, 0, 0);
+    while (start < total) {
+        const size_t end = bitmap_blockEnd(map, start);
+        printf("(%03lx,%02lx) ", (unsigned long)(map->base + start * map->granularity), (unsigned long)(map->base + end * map->granularity));
+        start = bitmap_findBit(map->starts, map->words, end, 0);
+    }
+    printf("\n");
+}
+
+
+/// ==============================================================================================
+
+
+bool bitmap_release(BitmapMap* map) {
+    if (map == NULL) {
+        return false;
+    }
+    free(map->used);
+    free(map->starts);
+    free(map->full);
+    map->used = NULL;
+    map->starts = NULL;
+    map->full = NULL;
+    map->words = 0;
+    map->size = 0;
+    return true;
+}
+
+
+/// ===================================================
+
+
+void* bitmap_mmap(BitmapMap* map, void *vaddr, unsigned int size) {
+    if (map==NULL)
+        return NULL;
+    const size_t address = bitmap_add(map, (size_t)vaddr, size);
+    if (address == BITMAP_NO_ADDRESS) {
+        return NULL;
+    }
+    return (void*)address;
+}
+
+void bitmap_munmap(BitmapMap* map, void *vaddr) {
+    const size_t voffset = (size_t)vaddr;
+    bitmap_delete(map, voffset);
+    assert( bitmap_isValid(map) == BITMAP_INVALID_OK );
+}
@@ -0,0 +1,567 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#include "memorymap/Buddy.h"
+
+#include <stdlib.h>                     /// free
+#include <assert.h>
+#include <stdio.h>                      /// printf
+
+
+#define BUDDY_WORD_BITS         64
+
+
+/// ========================================================================================
+
+
+static inline size_t buddy_levels(const BuddyMap* map) {
+    return map->maxOrder - map->minOrder;
+}
+
+/**
+ * Position of block in bitmaps. Level 0 keeps smallest blocks, bits of
+ * every level follow bits of previous level.
+ */
+static inline size_t buddy_bit(const BuddyMap* map, const size_t level, const size_t index) {
+    const size_t levels = buddy_levels(map);
+    return ((size_t)2 << levels) - ((size_t)2 << (levels - level)) + index;
+}
+
+static inline size_t buddy_blocksNum(const BuddyMap* map, const size_t level) {
+    return (size_t)1 << (buddy_levels(map) - level);
+}
+
+static inline bool buddy_testBit(const uint64_t* bits, const size_t bit) {
+    return (bits[bit / BUDDY_WORD_BITS] & ((uint64_t)1 << (bit % BUDDY_WORD_BITS))) != 0;
+}
+
+static inline void buddy_setBit(uint64_t* bits, const size_t bit, const bool value) {
+    const uint64_t mask = (uint64_t)1 << (bit % BUDDY_WORD_BITS);
+    if (value == true) {
+        bits[bit / BUDDY_WORD_BITS] |= mask;
+    } else {
+        bits[bit / BUDDY_WORD_BITS] &= ~mask;
+    }
+}
+
+static inline bool buddy_isFree(const BuddyMap* map, const size_t level, const size_t index) {
+    return buddy_testBit(map->freeBits, buddy_bit(map, level, index));
+}
+
+static inline bool buddy_isUsed(const BuddyMap* map, const size_t level, const size_t index) {
+    return buddy_testBit(map->usedBits, buddy_bit(map, level, index));
+}
+
+/**
+ * Finds first (or last if 'last' is true) set bit in range [from, to).
+ * Returns 'to' if there is no such bit.
+ */
+static size_t buddy_findSet(const uint64_t* bits, const size_t from, const size_t to, const bool last) {
+    size_t bit = from;
+    size_t ret = to;
+    while (bit < to) {
+        if (bits[bit / BUDDY_WORD_BITS] == 0) {
+            /// skip empty word
+            bit = (bit / BUDDY_WORD_BITS + 1) * BUDDY_WORD_BITS;
+            continue ;
+        }
+        if (buddy_testBit(bits, bit) == true) {
+            if (last == false) {
+                return bit;
+            }
+            ret = bit;
+        }
+        ++bit;
+    }
+    return ret;
+}
+
+static size_t buddy_popcount(const uint64_t* bits, const size_t words) {
+    size_t ret = 0;
+    for(size_t i = 0; i < words; ++i) {
+        uint64_t word = bits[i];
+        while (word != 0) {
+            word &= word - 1;
+            ++ret;
+        }
+    }
+    return ret;
+}
+
+static inline size_t buddy_bitmapWords(const BuddyMap* map) {
+    return (((size_t)2 << buddy_levels(map)) + BUDDY_WORD_BITS - 1) / BUDDY_WORD_BITS;
+}
+
+
+/// ========================================================================================
+
+
+/**
+ * Removes outdated and repeated entries of free list. Entries are
+ * deduplicated by clearing free bit of already kept block.
+ */
+static void buddy_compactList(BuddyMap* map, const size_t level) {
+    BuddyFreeList* list = &(map->lists[level]);
+    size_t kept = 0;
+    for(size_t i = 0; i < list->size; ++i) {
+        const size_t bit = buddy_bit(map, level, list->items[i]);
+        if (buddy_testBit(map->freeBits, bit) == false) {
+            continue ;
+        }
+        buddy_setBit(map->freeBits, bit, false);
+        list->items[kept] = list->items[i];
+        ++kept;
+    }
+    list->size = kept;
+    for(size_t i = 0; i < list->size; ++i) {
+        buddy_setBit(map->freeBits, buddy_bit(map, level, list->items[i]), true);
+    }
+}
+
+static void buddy_push(BuddyMap* map, const size_t level, const size_t index) {
+    BuddyFreeList* list = &(map->lists[level]);
+    if (list->size == list->capacity) {
+        if (list->size >= list->free * 2 + 16) {
+            /// mostly outdated entries
+            buddy_compactList(map, level);
+        }
+    }
+    if (list->size == list->capacity) {
+        const size_t capacity = (list->capacity > 0) ? list->capacity * 2 : 16;
+        size_t* items = realloc(list->items, capacity * sizeof(size_t));
+        assert( items != NULL );
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->size] = index;
+    ++(list->size);
+}
+
+/**
+ * Pops free block of given level. Outdated entries are dropped.
+ */
+static bool buddy_pop(BuddyMap* map, const size_t level, size_t* index) {
+    BuddyFreeList* list = &(map->lists[level]);
+    while (list->size > 0) {
+        --(list->size);
+        const size_t candidate = list->items[list->size];
+        if (buddy_isFree(map, level, candidate) == true) {
+            *index = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void buddy_markFree(BuddyMap* map, const size_t level, const size_t index) {
+    buddy_setBit(map->freeBits, buddy_bit(map, level, index), true);
+    ++(map->lists[level].free);
+    buddy_push(map, level, index);
+}
+
+static void buddy_unmarkFree(BuddyMap* map, const size_t level, const size_t index) {
+    buddy_setBit(map->freeBits, buddy_bit(map, level, index), false);
+    --(map->lists[level].free);
+}
+
+/**
+ * Splits free block (already unmarked) down to 'targetLevel' along path
+ * to 'targetIndex', buddies on the path become free. Target block is reserved.
+ */
+static void buddy_split(BuddyMap* map, size_t level, const size_t targetLevel, const size_t targetIndex) {
+    while (level > targetLevel) {
+        --level;
+        const size_t child = targetIndex >> (level - targetLevel);
+        buddy_markFree(map, level, child ^ 1);
+    }
+    buddy_setBit(map->usedBits, buddy_bit(map, targetLevel, targetIndex), true);
+    ++(map->size);
+}
+
+/**
+ * Reserves block of given level and index if the block is inside free block.
+ */
+static bool buddy_reserveAt(BuddyMap* map, const size_t level, const size_t index) {
+    const size_t levels = buddy_levels(map);
+    for(size_t j = level; j <= levels; ++j) {
+        const size_t ancestor = index >> (j - level);
+        if (buddy_isUsed(map, j, ancestor) == true) {
+            return false;
+        }
+        if (buddy_isFree(map, j, ancestor) == true) {
+            buddy_unmarkFree(map, j, ancestor);
+            buddy_split(map, j, level, index);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Reserves block of given level from free lists, splitting
+ * smallest available bigger block if needed.
+ */
+static bool buddy_reserveAny(BuddyMap* map, const size_t level, size_t* index) {
+    const size_t levels = buddy_levels(map);
+    for(size_t j = level; j <= levels; ++j) {
+        size_t found = 0;
+        if (buddy_pop(map, j, &found) == false) {
+            continue ;
+        }
+        buddy_unmarkFree(map, j, found);
+        *index = found << (j - level);
+        buddy_split(map, j, level, *index);
+        return true;
+    }
+    return false;
+}
+
+
+/// ===================================================
+
+
+bool buddy_init(BuddyMap* map) {
+    return buddy_initRegion(map, (size_t)1 << BUDDY_DEFAULT_MAX_ORDER, BUDDY_DEFAULT_MIN_ORDER, BUDDY_DEFAULT_MAX_ORDER);
+}
+
+bool buddy_initRegion(BuddyMap* map, const size_t base, const size_t minOrder, const size_t maxOrder) {
+    if (map == NULL) {
+        return false;
+    }
+    if (minOrder > maxOrder || maxOrder - minOrder > BUDDY_MAX_LEVELS) {
+        return false;
+    }
+    if (maxOrder >= sizeof(size_t) * 8 - 1) {
+        return false;
+    }
+    if (base == 0 || (base & (((size_t)1 << maxOrder) - 1)) != 0) {
+        /// region not aligned
+        return false;
+    }
+    map->base = base;
+    map->minOrder = minOrder;
+    map->maxOrder = maxOrder;
+    map->size = 0;
+
+    const size_t words = buddy_bitmapWords(map);
+    map->freeBits = calloc(words, sizeof(uint64_t));
+    map->usedBits = calloc(words, sizeof(uint64_t));
+    map->lists = calloc(buddy_levels(map) + 1, sizeof(BuddyFreeList));
+    if (map->freeBits == NULL || map->usedBits == NULL || map->lists == NULL) {
+        buddy_release(map);
+        return false;
+    }
+
+    /// whole region is one free block
+    buddy_markFree(map, buddy_levels(map), 0);
+    return true;
+}
+
+size_t buddy_size(const BuddyMap* map) {
+    if (map == NULL) {
+        return 0;
+    }
+    return map->size;
+}
+
+size_t buddy_freeSize(const BuddyMap* map) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->lists == NULL) {
+        return 0;
+    }
+    size_t ret = 0;
+    for(size_t l = 0; l <= buddy_levels(map); ++l) {
+        ret += map->lists[l].free << (map->minOrder + l);
+    }
+    return ret;
+}
+
+size_t buddy_startAddress(const BuddyMap* map) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->size == 0) {
+        return 0;
+    }
+    size_t ret = map->base + ((size_t)1 << map->maxOrder);
+    for(size_t l = 0; l <= buddy_levels(map); ++l) {
+        const size_t from = buddy_bit(map, l, 0);
+        const size_t to = from + buddy_blocksNum(map, l);
+        const size_t bit = buddy_findSet(map->usedBits, from, to, false);
+        if (bit == to) {
+            continue ;
+        }
+        const size_t address = map->base + ((bit - from) << (map->minOrder + l));
+        if (address < ret) {
+            ret = address;
+        }
+    }
+    return ret;
+}
+
+size_t buddy_endAddress(const BuddyMap* map) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->size == 0) {
+        return 0;
+    }
+    size_t ret = 0;
+    for(size_t l = 0; l <= buddy_levels(map); ++l) {
+        const size_t from = buddy_bit(map, l, 0);
+        const size_t to = from + buddy_blocksNum(map, l);
+        const size_t bit = buddy_findSet(map->usedBits, from, to, true);
+        if (bit == to) {
+            continue ;
+        }
+        const size_t address = map->base + ((bit - from + 1) << (map->minOrder + l));
+        if (address > ret) {
+            ret = address;
+        }
+    }
+    return ret;
+}
+
+MemoryArea buddy_area(const BuddyMap* map) {
+    const size_t startAddress = buddy_startAddress(map);
+    const size_t endAddress = buddy_endAddress(map);
+    return memory_create(startAddress, endAddress - startAddress);
+}
+
+
+/// ==================================================================================
+
+
+/**
+ * Checks blocks reachable from given block. 'marked' counts
+ * visited blocks that are free or reserved.
+ */
+static BuddyValidationError buddy_isValid_checkBlock(const BuddyMap* map, const size_t level, const size_t index, size_t* marked) {
+    const bool isFree = buddy_isFree(map, level, index);
+    const bool isUsed = buddy_isUsed(map, level, index);
+    if (isFree == true && isUsed == true) {
+        return BUDDY_INVALID_OVERLAP;
+    }
+    if (isFree == true || isUsed == true) {
+        ++(*marked);
+        return BUDDY_INVALID_OK;
+    }
+    if (level == 0) {
+        return BUDDY_INVALID_UNCOVERED;
+    }
+    const size_t left = index * 2;
+    if (buddy_isFree(map, level - 1, left) == true && buddy_isFree(map, level - 1, left + 1) == true) {
+        return BUDDY_INVALID_NOT_MERGED;
+    }
+    const BuddyValidationError validLeft = buddy_isValid_checkBlock(map, level - 1, left, marked);
+    if (validLeft != BUDDY_INVALID_OK) {
+        return validLeft;
+    }
+    return buddy_isValid_checkBlock(map, level - 1, left + 1, marked);
+}
+
+BuddyValidationError buddy_isValid(const BuddyMap* map) {
+    if (map == NULL) {
+        return BUDDY_INVALID_OK;
+    }
+    if (map->lists == NULL) {
+        return BUDDY_INVALID_OK;
+    }
+    size_t marked = 0;
+    const BuddyValidationError valid = buddy_isValid_checkBlock(map, buddy_levels(map), 0, &marked);
+    if (valid != BUDDY_INVALID_OK) {
+        return valid;
+    }
+    const size_t words = buddy_bitmapWords(map);
+    const size_t used = buddy_popcount(map->usedBits, words);
+    const size_t freeNum = buddy_popcount(map->freeBits, words);
+    if (marked != used + freeNum) {
+        /// marked block inside other block
+        return BUDDY_INVALID_OVERLAP;
+    }
+    if (used != map->size) {
+        return BUDDY_INVALID_SIZE;
+    }
+    size_t listsFree = 0;
+    for(size_t l = 0; l <= buddy_levels(map); ++l) {
+        listsFree += map->lists[l].free;
+    }
+    if (listsFree != freeNum) {
+        return BUDDY_INVALID_SIZE;
+    }
+    return BUDDY_INVALID_OK;
+}
+
+
+/// ==================================================================================
+
+
+/**
+ * Level of smallest block able to hold 'size'.
+ */
+static size_t buddy_levelFor(const BuddyMap* map, const size_t size) {
+    size_t order = map->minOrder;
+    while (order < map->maxOrder && ((size_t)1 << order) < size) {
+        ++order;
+    }
+    return order - map->minOrder;
+}
+
+size_t buddy_add(BuddyMap* map, const size_t address, const size_t size) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->lists == NULL) {
+        return 0;
+    }
+    if (size == 0 || size > ((size_t)1 << map->maxOrder)) {
+        return 0;
+    }
+    const size_t level = buddy_levelFor(map, size);
+    const size_t order = map->minOrder + level;
+
+    if (address >= map->base) {
+        /// naturally aligned block at or after hint
+        const size_t index = ((address - map->base) + ((size_t)1 << order) - 1) >> order;
+        if (index < buddy_blocksNum(map, level) && buddy_reserveAt(map, level, index) == true) {
+            return map->base + (index << order);
+        }
+    }
+
+    size_t index = 0;
+    if (buddy_reserveAny(map, level, &index) == false) {
+        /// no free block
+        return 0;
+    }
+    return map->base + (index << order);
+}
+
+void buddy_delete(BuddyMap* map, const size_t address) {
+    if (map == NULL) {
+        return ;
+    }
+    if (map->lists == NULL) {
+        return ;
+    }
+    if (address < map->base || address - map->base >= ((size_t)1 << map->maxOrder)) {
+        return ;
+    }
+    const size_t offset = address - map->base;
+    const size_t levels = buddy_levels(map);
+
+    /// find reserved block containing address
+    size_t level = 0;
+    size_t index = offset >> map->minOrder;
+    while (buddy_isUsed(map, level, index) == false) {
+        if (level == levels) {
+            return ;
+        }
+        ++level;
+        index >>= 1;
+    }
+    buddy_setBit(map->usedBits, buddy_bit(map, level, index), false);
+    --(map->size);
+
+    /// coalesce with free buddies
+    while (level < levels && buddy_isFree(map, level, index ^ 1) == true) {
+        buddy_unmarkFree(map, level, index ^ 1);
+        ++level;
+        index >>= 1;
+    }
+    buddy_markFree(map, level, index);
+}
+
+
+/// ==============================================================================================
+
+
+static void buddy_printBlock(const BuddyMap* map, const size_t level, const size_t index) {
+    if (buddy_isFree(map, level, index) == true) {
+        return ;
+    }
+    const size_t order = map->minOrder + level;
+    if (buddy_isUsed(map, level, index) == true) {
+        const size_t start = map->base + (index << order);
+        printf("(%03lx,%02lx) ", (unsigned long)start, (unsigned long)(start + ((size_t)1 << order)));
+        return ;
+    }
+    if (level == 0) {
+        return ;
+    }
+    buddy_printBlock(map, level - 1, index * 2);
+    buddy_printBlock(map, level - 1, index * 2 + 1);
+}
+
+void buddy_print(const BuddyMap* map) {
+    if (map == NULL) {
+        printf("%s", "[NULL]");
+        return ;
+    }
+    if (map->size == 0) {
+        printf("%s", "(NULL)");
+        return ;
+    }
+    buddy_printBlock(map, buddy_levels(map), 0);
+    printf("\n");
+}
+
+
+/// ==============================================================================================
+
+
+bool buddy_release(BuddyMap* map) {
+    if (map == NULL) {
+        return false;
+    }
+    if (map->lists != NULL) {
+        for(size_t l = 0; l <= buddy_levels(map); ++l) {
+            free(map->lists[l].items);
+        }
+    }
+    free(map->lists);
+    free(map->freeBits);
+    free(map->usedBits);
+    map->lists = NULL;
+    map->freeBits = NULL;
+    map->usedBits = NULL;
+    map->size = 0;
+    return true;
+}
+
+
+/// ===================================================
+
+
+void* buddy_mmap(BuddyMap* map, void *vaddr, unsigned int size) {
+    if (map==NULL)
+        return NULL;
+    return (void*)buddy_add(map, (size_t)vaddr, size);
+}
+
+void buddy_munmap(BuddyMap* map, void *vaddr) {
+    const size_t voffset = (size_t)vaddr;
+    buddy_delete(map, voffset);
+    assert( buddy_isValid(map) == BUDDY_INVALID_OK );
+}
@@ -29,6 +29,28 @@
 #include <string.h>
 
 
+#define RBTREE_COLOR_MASK       ((uintptr_t) 1)
+
+
+static inline RBTreeNode* tree_parent(const RBTreeNode* node) {
+    return (RBTreeNode*) (node->parentColor & ~RBTREE_COLOR_MASK);
+}
+
+static inline NodeColor tree_color(const RBTreeNode* node) {
+    return (NodeColor) (node->parentColor & RBTREE_COLOR_MASK);
+}
+
+static inline void tree_setParent(RBTreeNode* node, const RBTreeNode* parent) {
+    node->parentColor = (uintptr_t) parent | (node->parentColor & RBTREE_COLOR_MASK);
+}
+
+static inline void tree_setColor(RBTreeNode* node, const NodeColor color) {
+    node->parentColor = (node->parentColor & ~RBTREE_COLOR_MASK) | (uintptr_t) color;
+}
+
+
+/// ======================================================================================
+
 
 static const RBTreeNode* tree_getLeftmostNode(const RBTreeNode* node) {
     if (node == NULL) {
@@ -87,13 +109,13 @@ static const RBTreeNode* tree_getLeftDescendant(const RBTreeNode* node) {
  */
 static const RBTreeNode* tree_getRightAncestor(const RBTreeNode* node) {
     const RBTreeNode* child = node;
-    const RBTreeNode* curr = node->parent;
+    const RBTreeNode* curr = tree_parent(node);
     while( curr != NULL ) {
         if (curr->left == child) {
             return curr;
         }
         child = curr;
-        curr = curr->parent;
+        curr = tree_parent(curr);
     }
     /// root found
     return NULL;
@@ -110,13 +132,13 @@ static const RBTreeNode* tree_getRightAncestor(const RBTreeNode* node) {
  */
 static const RBTreeNode* tree_getLeftAncestor(const RBTreeNode* node) {
     const RBTreeNode* child = node;
-    const RBTreeNode* curr = node->parent;
+    const RBTreeNode* curr = tree_parent(node);
     while( curr != NULL ) {
         if (curr->right == child) {
             return curr;
         }
         child = curr;
-        curr = curr->parent;
+        curr = tree_parent(curr);
     }
     /// root found
     return NULL;
@@ -139,7 +161,7 @@ static size_t tree_sizeSubtree(const RBTreeNode* tree) {
 size_t tree_size(const RBTree* tree) {
     if (tree==NULL)
         return 0;
-    return tree_sizeSubtree(tree->root);
+    return tree->size;
 }
 
 static size_t tree_depthSubtree(const RBTreeNode* tree) {
@@ -161,24 +183,26 @@ size_t tree_depth(const RBTree* tree) {
     return tree_depthSubtree(tree->root);
 }
 
+size_t tree_blackHeight(const RBTree* tree) {
+    if (tree==NULL)
+        return 0;
+    return tree->blackHeight;
+}
+
 size_t tree_startAddress(const RBTree* tree) {
     if (tree==NULL)
         return 0;
-    if (tree->root==NULL)
+    if (tree->leftmost==NULL)
         return 0;
-
-    const RBTreeNode* node = tree_getLeftmostNode(tree->root);
-    return node->area.start;
+    return tree->leftmost->area.start;
 }
 
 size_t tree_endAddress(const RBTree* tree) {
     if (tree==NULL)
         return 0;
-    if (tree->root==NULL)
+    if (tree->rightmost==NULL)
         return 0;
-
-    const RBTreeNode* node = tree_getRightmostNode(tree->root);
-    return node->area.end;
+    return tree->rightmost->area.end;
 }
 
 MemoryArea tree_area(const RBTree* tree) {
@@ -245,7 +269,7 @@ static RBTreeValidationError tree_isValid_checkPointers(const RBTreeNode* node,
     if (node == NULL) {
         return RBTREE_INVALID_OK;
     }
-    if (node->parent != parent) {
+    if (tree_parent(node) != parent) {
         return RBTREE_INVALID_NODE_PARENT;
     }
     if ((node->left == node->right) && (node->right != NULL)) {
@@ -350,7 +374,7 @@ static RBTreeValidationError tree_isValid_countBlackPaths(const RBTreeNode* node
         return RBTREE_INVALID_BLACK_PATH;
     }
 
-    if (node->color == RBTREE_COLOR_BLACK) {
+    if (tree_color(node) == RBTREE_COLOR_BLACK) {
         *counter = leftCounter+1;
     } else {
         *counter = leftCounter;
@@ -385,16 +409,16 @@ static RBTreeValidationError tree_isValid_checkColor(const RBTreeNode* node) {
 		}
 	}
 
-    if (node->color != RBTREE_COLOR_RED) {
+    if (tree_color(node) != RBTREE_COLOR_RED) {
     	return RBTREE_INVALID_OK;
     }
 	if (node->left != NULL) {
-		if (node->left->color != RBTREE_COLOR_BLACK) {
+		if (tree_color(node->left) != RBTREE_COLOR_BLACK) {
 			return RBTREE_INVALID_BLACK_CHILDREN;
 		}
 	}
 	if (node->right != NULL) {
-		if (node->right->color != RBTREE_COLOR_BLACK) {
+		if (tree_color(node->right) != RBTREE_COLOR_BLACK) {
 			return RBTREE_INVALID_BLACK_CHILDREN;
 		}
 	}
@@ -402,18 +426,45 @@ static RBTreeValidationError tree_isValid_checkColor(const RBTreeNode* node) {
 	return RBTREE_INVALID_OK;
 }
 
+/**
+ * Checks data cached in tree structure: size, bounds and black height.
+ */
+static RBTreeValidationError tree_isValid_checkTreeData(const RBTree* tree) {
+    if (tree->size != tree_sizeSubtree(tree->root)) {
+        return RBTREE_INVALID_TREE_DATA;
+    }
+    if (tree->leftmost != tree_getLeftmostNode(tree->root)) {
+        return RBTREE_INVALID_TREE_DATA;
+    }
+    if (tree->rightmost != tree_getRightmostNode(tree->root)) {
+        return RBTREE_INVALID_TREE_DATA;
+    }
+    size_t height = 0;
+    const RBTreeNode* curr = tree->root;
+    while (curr != NULL) {
+        if (tree_color(curr) == RBTREE_COLOR_BLACK) {
+            ++height;
+        }
+        curr = curr->left;
+    }
+    if (tree->blackHeight != height) {
+        return RBTREE_INVALID_TREE_DATA;
+    }
+    return RBTREE_INVALID_OK;
+}
+
 RBTreeValidationError tree_isValid(const RBTree* tree) {
     if (tree==NULL)
         return RBTREE_INVALID_OK;
     if (tree->root == NULL)
-        return RBTREE_INVALID_OK;
-    if (tree->root->parent != NULL)
+        return tree_isValid_checkTreeData(tree);
+    if (tree_parent(tree->root) != NULL)
         return RBTREE_INVALID_ROOT_PARENT;
 
     const RBTreeNode* rootNode = tree->root;
 
     /// check pointers
-    const RBTreeValidationError validPointers = tree_isValid_checkPointers(rootNode, rootNode->parent);
+    const RBTreeValidationError validPointers = tree_isValid_checkPointers(rootNode, tree_parent(rootNode));
     if (validPointers != RBTREE_INVALID_OK) {
         return validPointers;
     }
@@ -433,7 +484,7 @@ RBTreeValidationError tree_isValid(const RBTree* tree) {
 
     /// checking red-black properties
     /// root is black
-    if (rootNode->color != RBTREE_COLOR_BLACK)
+    if (tree_color(rootNode) != RBTREE_COLOR_BLACK)
         return RBTREE_INVALID_RED_ROOT;
 
     /// if a node is red, then both its children are black
@@ -447,7 +498,8 @@ RBTreeValidationError tree_isValid(const RBTree* tree) {
         return validPath;
     }
 
-    return RBTREE_INVALID_OK;
+    /// black paths are valid, so black height can be counted on any path
+    return tree_isValid_checkTreeData(tree);
 }
 
 
@@ -455,37 +507,37 @@ RBTreeValidationError tree_isValid(const RBTree* tree) {
 
 
 static RBTreeNode* tree_grandparent(RBTreeNode* node) {
-	if (node->parent == NULL) {
+	if (tree_parent(node) == NULL) {
 		return NULL;
 	}
-	return node->parent->parent;
+	return tree_parent(tree_parent(node));
 }
 
 static RBTreeNode* tree_sibling(RBTreeNode* node) {
-	if (node->parent == NULL) {
+	if (tree_parent(node) == NULL) {
 		return NULL;
 	}
-	if (node->parent->left == node)
-		return node->parent->right;
+	if (tree_parent(node)->left == node)
+		return tree_parent(node)->right;
 	else
-		return node->parent->left;
+		return tree_parent(node)->left;
 }
 
 static inline RBTreeNode* tree_uncle(RBTreeNode* node) {
-	return tree_sibling(node->parent);
+	return tree_sibling(tree_parent(node));
 }
 
 static inline void tree_setLeftChild(RBTreeNode* node, RBTreeNode* child) {
     node->left = child;
     if (child != NULL) {
-        child->parent = node;
+        tree_setParent(child, node);
     }
 }
 
 static inline void tree_setRightChild(RBTreeNode* node, RBTreeNode* child) {
     node->right = child;
     if (child != NULL) {
-        child->parent = node;
+        tree_setParent(child, node);
     }
 }
 
@@ -498,13 +550,13 @@ static inline void tree_changeChild(RBTreeNode* node, RBTreeNode* from, RBTreeNo
 }
 
 static void tree_rotate_left(RBTreeNode* node) {
-    RBTreeNode* parent = node->parent;
+    RBTreeNode* parent = tree_parent(node);
     RBTreeNode* nnew = node->right;
     assert(nnew != NULL);                   /// since the leaves of a red-black tree are empty, they cannot become internal nodes
     tree_setRightChild(node, nnew->left);
     tree_setLeftChild(nnew, node);
     if (parent == NULL) {
-        nnew->parent = NULL;
+        tree_setParent(nnew, NULL);
         return;
     }
     if (parent->left == node) {
@@ -515,13 +567,13 @@ static void tree_rotate_left(RBTreeNode* node) {
 }
 
 static void tree_rotate_right(RBTreeNode* node) {
-    RBTreeNode* parent = node->parent;
+    RBTreeNode* parent = tree_parent(node);
     RBTreeNode* nnew = node->left;
     assert(nnew != NULL);                   /// since the leaves of a red-black tree are empty, they cannot become internal nodes
     tree_setLeftChild(node, nnew->right);
     tree_setRightChild(nnew, node);
     if (parent == NULL) {
-        nnew->parent = NULL;
+        tree_setParent(nnew, NULL);
         return;
     }
     if (parent->left == node) {
@@ -531,24 +583,28 @@ static void tree_rotate_right(RBTreeNode* node) {
     }
 }
 
-static void tree_repair_insert(RBTreeNode* node) {
-	RBTreeNode* nParent = node->parent;
+static void tree_repair_insert(RBTree* tree, RBTreeNode* node) {
+	RBTreeNode* nParent = tree_parent(node);
 	if ( nParent == NULL) {
-		node->color = RBTREE_COLOR_BLACK;
+	    if (tree_color(node) == RBTREE_COLOR_RED) {
+	        /// red root blackened -- every path gets one more black node
+	        ++(tree->blackHeight);
+	    }
+		tree_setColor(node, RBTREE_COLOR_BLACK);
 		return ;
 	}
-	if (nParent->color == RBTREE_COLOR_BLACK) {
+	if (tree_color(nParent) == RBTREE_COLOR_BLACK) {
 		/// do nothing
 		return ;
 	}
 	RBTreeNode* uncle = tree_uncle(node);
 	if (uncle != NULL) {
-        if (uncle->color == RBTREE_COLOR_RED) {
-            nParent->color = RBTREE_COLOR_BLACK;
-            uncle->color = RBTREE_COLOR_BLACK;
+        if (tree_color(uncle) == RBTREE_COLOR_RED) {
+            tree_setColor(nParent, RBTREE_COLOR_BLACK);
+            tree_setColor(uncle, RBTREE_COLOR_BLACK);
             RBTreeNode* grandpa = tree_grandparent(node);		/// never NULL here
-            grandpa->color = RBTREE_COLOR_RED;
-            tree_repair_insert(grandpa);
+            tree_setColor(grandpa, RBTREE_COLOR_RED);
+            tree_repair_insert(tree, grandpa);
             return ;
         }
 	}
@@ -557,48 +613,82 @@ static void tree_repair_insert(RBTreeNode* node) {
 	{
         RBTreeNode* grandpa = tree_grandparent(curr);		/// never NULL here
         if ((grandpa->left != NULL) && (curr == grandpa->left->right)) {
-            tree_rotate_left(curr->parent);
+            tree_rotate_left(tree_parent(curr));
             curr = curr->left;
         } else if ((grandpa->right != NULL) && (curr == grandpa->right->left)) {
-            tree_rotate_right(curr->parent);
+            tree_rotate_right(tree_parent(curr));
             curr = curr->right;
         }
 	}
 	{
 	    RBTreeNode* grandpa = tree_grandparent(curr);       /// never NULL here
-        if (curr == curr->parent->left)
+        if (curr == tree_parent(curr)->left)
             tree_rotate_right(grandpa);
         else
             tree_rotate_left(grandpa);
-        curr->parent->color = RBTREE_COLOR_BLACK;
-        grandpa->color = RBTREE_COLOR_RED;
+        tree_setColor(tree_parent(curr), RBTREE_COLOR_BLACK);
+        tree_setColor(grandpa, RBTREE_COLOR_RED);
 	}
 }
 
-static RBTreeNode* tree_insertLeftNode(RBTreeNode* node) {
+static RBTreeNode* tree_allocNode(RBTree* tree, const NodeColor color) {
+    if (tree->pool == NULL) {
+        return tree_makeColoredNode(color);
+    }
+    RBTreeNode* node = pool_alloc(tree->pool);
+    tree_setColor(node, color);
+    return node;
+}
+
+static void tree_freeNode(RBTree* tree, RBTreeNode* node) {
+    if (tree->pool == NULL) {
+        free(node);
+        return ;
+    }
+    pool_free(tree->pool, node);
+}
+
+/**
+ * Updates cached data of tree after insertion of 'node'.
+ */
+static void tree_updateTreeData(RBTree* tree, RBTreeNode* node) {
+    ++(tree->size);
+    if ( tree->leftmost == NULL || node->area.start < tree->leftmost->area.start ) {
+        tree->leftmost = node;
+    }
+    if ( tree->rightmost == NULL || node->area.start > tree->rightmost->area.start ) {
+        tree->rightmost = node;
+    }
+}
+
+static RBTreeNode* tree_insertLeftNode(RBTree* tree, RBTreeNode* node, const MemoryArea area) {
 	RBTreeNode* oldLeft = node->left;
-	RBTreeNode* newNode = tree_makeColoredNode(RBTREE_COLOR_RED);         /// default color of new node
+	RBTreeNode* newNode = tree_allocNode(tree, RBTREE_COLOR_RED);         /// default color of new node
+	newNode->area = area;
 	tree_setLeftChild(node, newNode);
 	tree_setLeftChild(newNode, oldLeft);
+	tree_updateTreeData(tree, newNode);
 
-	tree_repair_insert(newNode);
+	tree_repair_insert(tree, newNode);
 	return newNode;
 }
 
-static RBTreeNode* tree_insertRightNode(RBTreeNode* node) {
+static RBTreeNode* tree_insertRightNode(RBTree* tree, RBTreeNode* node, const MemoryArea area) {
 	RBTreeNode* oldLeft = node->right;
-	RBTreeNode* newNode = tree_makeColoredNode(RBTREE_COLOR_RED);         /// default color of new node
+	RBTreeNode* newNode = tree_allocNode(tree, RBTREE_COLOR_RED);         /// default color of new node
+	newNode->area = area;
 	tree_setRightChild(node, newNode);
 	newNode->right = oldLeft;
 	tree_setRightChild(newNode, oldLeft);
+	tree_updateTreeData(tree, newNode);
 
-	tree_repair_insert(node->right);
+	tree_repair_insert(tree, node->right);
 	return newNode;
 }
 
-static void* tree_addMemoryToRight(RBTreeNode* node, MemoryArea* area);
+static void* tree_addMemoryToRight(RBTree* tree, RBTreeNode* node, MemoryArea* area);
 
-static void* tree_addMemoryToLeft(RBTreeNode* node, MemoryArea* area) {
+static void* tree_addMemoryToLeft(RBTree* tree, RBTreeNode* node, MemoryArea* area) {
     if (area->end > node->area.start) {
         /// could not add on left side
     	return NULL;
@@ -609,13 +699,12 @@ static void* tree_addMemoryToLeft(RBTreeNode* node, MemoryArea* area) {
     	const RBTreeNode* leftAncestor = tree_getLeftAncestor(node);
     	if (leftAncestor == NULL) {
     		/// smallest leaf case -- add node
-    	    RBTreeNode* newNode = tree_insertLeftNode(node);
-    	    newNode->area = *area;
+    	    RBTreeNode* newNode = tree_insertLeftNode(tree, node, *area);
 			return (void*)newNode->area.start;
     	}
     	leftNode = leftAncestor;
     } else {
-        void* ret = tree_addMemoryToLeft(node->left, area);
+        void* ret = tree_addMemoryToLeft(tree, node->left, area);
         if (ret != NULL) {
             return ret;
         }
@@ -635,29 +724,26 @@ static void* tree_addMemoryToLeft(RBTreeNode* node, MemoryArea* area) {
 
     if ( node->left == NULL ) {
     	/// leaf case -- can add, no more between
-        RBTreeNode* newNode = tree_insertLeftNode(node);
-        newNode->area = memory_create( minStart, areaSize );
+        RBTreeNode* newNode = tree_insertLeftNode(tree, node, memory_create( minStart, areaSize ));
 		return (void*)newNode->area.start;
     }
 
-	return tree_addMemoryToRight(node->left, area);
+	return tree_addMemoryToRight(tree, node->left, area);
 }
 
-static void* tree_addMemoryToRight(RBTreeNode* node, MemoryArea* area) {
+static void* tree_addMemoryToRight(RBTree* tree, RBTreeNode* node, MemoryArea* area) {
     if ( node->right == NULL ) {
     	const RBTreeNode* rightAncestor = tree_getRightAncestor(node);
     	if (rightAncestor == NULL) {
     		/// greatest leaf case -- add node
     		memory_fitAfter(&(node->area), area);
-    		RBTreeNode* newNode = tree_insertRightNode(node);
-    		newNode->area = *area;
+    		RBTreeNode* newNode = tree_insertRightNode(tree, node, *area);
 			return (void*)newNode->area.start;
     	}
 		/// leaf case -- check space
 		const int doesFit = memory_fitBetween(&(node->area), &(rightAncestor->area), area);
 		if (doesFit == 0) {
-		    RBTreeNode* newNode = tree_insertRightNode(node);
-		    newNode->area = *area;
+		    RBTreeNode* newNode = tree_insertRightNode(tree, node, *area);
 			return (void*)newNode->area.start;
 		}
 		/// no space -- return
@@ -666,31 +752,35 @@ static void* tree_addMemoryToRight(RBTreeNode* node, MemoryArea* area) {
 
     const MemoryArea* rightArea = &(node->right->area);
     if (area->start > rightArea->start) {
-        return tree_addMemoryToRight(node->right, area);
+        return tree_addMemoryToRight(tree, node->right, area);
     }
 
     const size_t minStart = memory_startAddress(&(node->area), area );
     const size_t spaceBetween = rightArea->start - minStart;
 	const size_t areaSize = memory_size( area );
 	if (areaSize<=spaceBetween) {
-	    void* retAddr = tree_addMemoryToLeft(node->right, area);
+	    void* retAddr = tree_addMemoryToLeft(tree, node->right, area);
 	    if (retAddr != NULL) {
 	        return retAddr;
 	    }
 	}
     /// no space -- go to next node
-    return tree_addMemoryToRight(node->right, area);
+    return tree_addMemoryToRight(tree, node->right, area);
 }
 
 static const RBTreeNode* tree_findRootFromNode(const RBTreeNode* node) {
     /// find the new root to return
     const RBTreeNode* curr = node;
-    while (curr->parent != NULL)
-        curr = curr->parent;
+    while (tree_parent(curr) != NULL)
+        curr = tree_parent(curr);
     return curr;
 }
 
 static void tree_findRoot(RBTree* tree) {
+    if (tree->root == NULL) {
+        /// last node removed
+        return ;
+    }
     /// find the new root to return
     tree->root = (RBTreeNode*) tree_findRootFromNode(tree->root);
 }
@@ -703,19 +793,23 @@ static void* tree_addMemory(RBTree* tree, MemoryArea* area) {
     }
 
     if (tree->root == NULL) {
-        tree->root = calloc( 1, sizeof(RBTreeNode) );
+        tree->root = tree_allocNode( tree, RBTREE_COLOR_BLACK );
         ///tree->root->parent = NULL;
         ///tree->root->color = RBTREE_BLACK;
         tree->root->area = *area;
-        tree_repair_insert(tree->root);
+        tree_repair_insert(tree, tree->root);
+        tree->size = 1;
+        tree->leftmost = tree->root;
+        tree->rightmost = tree->root;
+        tree->blackHeight = 1;
         return (void*)tree->root->area.start;
     }
 
-	void* newMemoryAddress = tree_addMemoryToLeft(tree->root, area);
+	void* newMemoryAddress = tree_addMemoryToLeft(tree, tree->root, area);
 	if (newMemoryAddress==NULL) {
 	    /// ends inside or after current area
 	    /// go to right, called on root should always work
-	    newMemoryAddress = tree_addMemoryToRight(tree->root, area);
+	    newMemoryAddress = tree_addMemoryToRight(tree, tree->root, area);
 	}
     tree_findRoot(tree);
     return newMemoryAddress;
@@ -755,7 +849,7 @@ static void tree_printLevel(const RBTreeNode* node, const size_t level, int* pre
     }
 
     char color = 'X';
-    switch(node->color) {
+    switch(tree_color(node)) {
     case RBTREE_COLOR_BLACK: {
         color = 'B';
         break;
@@ -820,8 +914,16 @@ int tree_release(RBTree* tree) {
     if (tree==NULL) {
         return -1;
     }
+    if (tree->pool != NULL) {
+        /// release all nodes at once
+        const int ret = (int)tree->pool->used;
+        pool_destroy(tree->pool);
+        tree->pool = NULL;
+        tree_init(tree);
+        return ret;
+    }
     const int ret = tree_releaseNodes(tree->root);
-    tree->root = NULL;
+    tree_init(tree);
     return ret;
 }
 
@@ -874,7 +976,7 @@ static RBTreeNode* tree_repair_sibling(RBTreeNode* parent, RBTreeNode* node) {
 
 static int tree_repair_isChildrenColors(const RBTreeNode* parent, const NodeColor leftChild, const NodeColor rightChild) {
     if ( parent->left != NULL ) {
-        if ( parent->left->color != leftChild ) {
+        if ( tree_color(parent->left) != leftChild ) {
             return 1;
         }
     } else {
@@ -883,7 +985,7 @@ static int tree_repair_isChildrenColors(const RBTreeNode* parent, const NodeColo
         }
     }
     if ( parent->right != NULL ) {
-        if ( parent->right->color != rightChild ) {
+        if ( tree_color(parent->right) != rightChild ) {
             return 1;
         }
     } else {
@@ -894,27 +996,27 @@ static int tree_repair_isChildrenColors(const RBTreeNode* parent, const NodeColo
     return 0;
 }
 
-static void tree_repair_case1(RBTreeNode* parent, RBTreeNode* node);
+static void tree_repair_case1(RBTree* tree, RBTreeNode* parent, RBTreeNode* node);
 
 static void tree_repair_case6(RBTreeNode* parent, RBTreeNode* node) {
     RBTreeNode* sibling = tree_repair_sibling(parent, node);
-    sibling->color = parent->color;
-    parent->color = RBTREE_COLOR_BLACK;
+    tree_setColor(sibling, tree_color(parent));
+    tree_setColor(parent, RBTREE_COLOR_BLACK);
 
     if (parent->left == node) {
         if (sibling->right!=NULL)
-            sibling->right->color = RBTREE_COLOR_BLACK;
+            tree_setColor(sibling->right, RBTREE_COLOR_BLACK);
         tree_rotate_left( parent );
     } else {
         if (sibling->left!=NULL)
-            sibling->left->color = RBTREE_COLOR_BLACK;
+            tree_setColor(sibling->left, RBTREE_COLOR_BLACK);
         tree_rotate_right( parent );
     }
 }
 
 static void tree_repair_case5(RBTreeNode* parent, RBTreeNode* node) {
     RBTreeNode* sibling = tree_repair_sibling(parent, node);
-    if (sibling->color != RBTREE_COLOR_BLACK) {
+    if (tree_color(sibling) != RBTREE_COLOR_BLACK) {
         tree_repair_case6(parent, node);
         return ;
     }
@@ -926,9 +1028,9 @@ static void tree_repair_case5(RBTreeNode* parent, RBTreeNode* node) {
     if (parent->left == node) {
         /// is left child
         if (tree_repair_isChildrenColors(sibling, RBTREE_COLOR_RED, RBTREE_COLOR_BLACK) == 0) {
-            sibling->color = RBTREE_COLOR_RED;
+            tree_setColor(sibling, RBTREE_COLOR_RED);
             if (sibling->left != NULL)
-                sibling->left->color = RBTREE_COLOR_BLACK;
+                tree_setColor(sibling->left, RBTREE_COLOR_BLACK);
             tree_rotate_right( sibling );
             tree_repair_case6(parent, node);
             return ;
@@ -940,9 +1042,9 @@ static void tree_repair_case5(RBTreeNode* parent, RBTreeNode* node) {
     if (parent->right == node) {
         /// is right child
         if (tree_repair_isChildrenColors(sibling, RBTREE_COLOR_BLACK, RBTREE_COLOR_RED) == 0) {
-            sibling->color = RBTREE_COLOR_RED;
+            tree_setColor(sibling, RBTREE_COLOR_RED);
             if (sibling->right != NULL)
-                sibling->right->color = RBTREE_COLOR_BLACK;
+                tree_setColor(sibling->right, RBTREE_COLOR_BLACK);
             tree_rotate_left( sibling );
             tree_repair_case6(parent, node);
             return ;
@@ -953,12 +1055,12 @@ static void tree_repair_case5(RBTreeNode* parent, RBTreeNode* node) {
 }
 
 static void tree_repair_case4(RBTreeNode* parent, RBTreeNode* node) {
-    if (parent->color != RBTREE_COLOR_RED) {
+    if (tree_color(parent) != RBTREE_COLOR_RED) {
         tree_repair_case5(parent, node);
         return ;
     }
     RBTreeNode* sibling = tree_repair_sibling(parent, node);
-    if (sibling->color != RBTREE_COLOR_BLACK) {
+    if (tree_color(sibling) != RBTREE_COLOR_BLACK) {
         tree_repair_case5(parent, node);
         return ;
     }
@@ -966,17 +1068,17 @@ static void tree_repair_case4(RBTreeNode* parent, RBTreeNode* node) {
         tree_repair_case5(parent, node);
         return ;
     }
-    sibling->color = RBTREE_COLOR_RED;
-    parent->color = RBTREE_COLOR_BLACK;
+    tree_setColor(sibling, RBTREE_COLOR_RED);
+    tree_setColor(parent, RBTREE_COLOR_BLACK);
 }
 
-static void tree_repair_case3(RBTreeNode* parent, RBTreeNode* node) {
-    if (parent->color != RBTREE_COLOR_BLACK) {
+static void tree_repair_case3(RBTree* tree, RBTreeNode* parent, RBTreeNode* node) {
+    if (tree_color(parent) != RBTREE_COLOR_BLACK) {
         tree_repair_case4(parent, node);
         return ;
     }
     RBTreeNode* sibling = tree_repair_sibling(parent, node);
-    if (sibling->color != RBTREE_COLOR_BLACK) {
+    if (tree_color(sibling) != RBTREE_COLOR_BLACK) {
         tree_repair_case4(parent, node);
         return ;
     }
@@ -986,44 +1088,46 @@ static void tree_repair_case3(RBTreeNode* parent, RBTreeNode* node) {
         return ;
     }
 
-    sibling->color = RBTREE_COLOR_RED;
-    tree_repair_case1(parent->parent, parent);
+    tree_setColor(sibling, RBTREE_COLOR_RED);
+    tree_repair_case1(tree, tree_parent(parent), parent);
 }
 
-static void tree_repair_case2(RBTreeNode* parent, RBTreeNode* node) {
+static void tree_repair_case2(RBTree* tree, RBTreeNode* parent, RBTreeNode* node) {
     RBTreeNode* sibling = tree_repair_sibling(parent, node);
     if (sibling == NULL) {
         /// case of root
         return ;
     }
-    if (sibling->color == RBTREE_COLOR_RED) {
-        parent->color = RBTREE_COLOR_RED;
-        sibling->color = RBTREE_COLOR_BLACK;
+    if (tree_color(sibling) == RBTREE_COLOR_RED) {
+        tree_setColor(parent, RBTREE_COLOR_RED);
+        tree_setColor(sibling, RBTREE_COLOR_BLACK);
         if (parent->left == node)
             tree_rotate_left( parent );
         else
             tree_rotate_right( parent );
     }
-    tree_repair_case3(parent, node);
+    tree_repair_case3(tree, parent, node);
 }
 
-static void tree_repair_case1(RBTreeNode* parent, RBTreeNode* node) {
+static void tree_repair_case1(RBTree* tree, RBTreeNode* parent, RBTreeNode* node) {
     if (parent == NULL) {
+        /// missing black node reached root -- every path lost one black node
+        --(tree->blackHeight);
         return ;
     }
-    tree_repair_case2(parent, node);
+    tree_repair_case2(tree, parent, node);
 }
 
-static void tree_repair_delete(RBTreeNode* parent, RBTreeNode* node) {
+static void tree_repair_delete(RBTree* tree, RBTreeNode* parent, RBTreeNode* node) {
     if (node != NULL) {
-        if (node->color == RBTREE_COLOR_RED) {
-            node->color = RBTREE_COLOR_BLACK;
+        if (tree_color(node) == RBTREE_COLOR_RED) {
+            tree_setColor(node, RBTREE_COLOR_BLACK);
             return ;
         }
     }
 
     /// restore -- cases
-    tree_repair_case1(parent, node);
+    tree_repair_case1(tree, parent, node);
 }
 
 void tree_delete(RBTree* tree, const size_t address) {
@@ -1033,49 +1137,59 @@ void tree_delete(RBTree* tree, const size_t address) {
         return;
     }
 
+    --(tree->size);
+
+    /// node with missing child is removed -- update bounds before unlinking
+    if (node == tree->leftmost) {
+        tree->leftmost = (RBTreeNode*) tree_rightNode(node);
+    }
+    if (node == tree->rightmost) {
+        tree->rightmost = (RBTreeNode*) tree_leftNode(node);
+    }
+
     if (node->right == NULL) {
         /// simple case -- just remove
-        if ( node->parent != NULL ) {
+        if ( tree_parent(node) != NULL ) {
             /// non-root case
-            tree_changeChild(node->parent, node, node->left);
+            tree_changeChild(tree_parent(node), node, node->left);
         } else {
             /// removing root
             tree->root = node->left;
             if (node->left != NULL) {
-                node->left->parent = NULL;
+                tree_setParent(node->left, NULL);
             }
         }
 
-        if (node->color == RBTREE_COLOR_BLACK) {
-            tree_repair_delete(node->parent, node->left);
+        if (tree_color(node) == RBTREE_COLOR_BLACK) {
+            tree_repair_delete(tree, tree_parent(node), node->left);
             /// can happpen than root changes due to rotations
             tree_findRoot(tree);
         }
 
-        free(node);
+        tree_freeNode(tree, node);
         return;
     }
 
     if (node->left == NULL) {
         /// simple case -- just reconnect
-        if ( node->parent != NULL ) {
+        if ( tree_parent(node) != NULL ) {
             /// non-root case
-            tree_changeChild(node->parent, node, node->right);
+            tree_changeChild(tree_parent(node), node, node->right);
         } else {
             /// removing root
             tree->root = node->right;
             if (node->right != NULL) {
-                node->right->parent = NULL;
+                tree_setParent(node->right, NULL);
             }
         }
 
-        if (node->color == RBTREE_COLOR_BLACK) {
-            tree_repair_delete(node->parent, node->right);
+        if (tree_color(node) == RBTREE_COLOR_BLACK) {
+            tree_repair_delete(tree, tree_parent(node), node->right);
             /// can happpen than root changes due to rotations
             tree_findRoot(tree);
         }
 
-        free(node);
+        tree_freeNode(tree, node);
         return;
     }
 
@@ -1084,15 +1198,19 @@ void tree_delete(RBTree* tree, const size_t address) {
 
     RBTreeNode* nextNode = (RBTreeNode*) tree_getRightDescendant(node);      /// never NULL
     node->area = nextNode->area;
+    if (nextNode == tree->rightmost) {
+        /// greatest area moves to 'node'
+        tree->rightmost = node;
+    }
 
-    tree_changeChild(nextNode->parent, nextNode, nextNode->right);
-    if (nextNode->color == RBTREE_COLOR_BLACK) {
-        tree_repair_delete(nextNode->parent, nextNode->right);
+    tree_changeChild(tree_parent(nextNode), nextNode, nextNode->right);
+    if (tree_color(nextNode) == RBTREE_COLOR_BLACK) {
+        tree_repair_delete(tree, tree_parent(nextNode), nextNode->right);
         /// can happpen than root changes due to rotations
         tree_findRoot(tree);
     }
 
-    free(nextNode);
+    tree_freeNode(tree, nextNode);
 }
 
 
@@ -1118,6 +1236,28 @@ int tree_init(RBTree* tree) {
     }
 
     tree->root = NULL;
+    tree->size = 0;
+    tree->leftmost = NULL;
+    tree->rightmost = NULL;
+    tree->blackHeight = 0;
+    tree->pool = NULL;
+    return 0;
+}
+
+int tree_usePool(RBTree* tree) {
+    if (tree == NULL) {
+        return -1;
+    }
+    if (tree->root != NULL) {
+        return -2;
+    }
+    if (tree->pool != NULL) {
+        pool_destroy(tree->pool);
+    }
+    tree->pool = pool_create( sizeof(RBTreeNode) );
+    if (tree->pool == NULL) {
+        return -3;
+    }
     return 0;
 }
 
@@ -1131,7 +1271,7 @@ RBTreeNode* tree_makeDefaultNode() {
 
 RBTreeNode* tree_makeColoredNode(const NodeColor color) {
     RBTreeNode* node = tree_makeDefaultNode();
-    node->color = color;
+    tree_setColor(node, color);
     return node;
 }
 
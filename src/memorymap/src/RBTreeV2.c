@@ -29,11 +29,27 @@
 #include <string.h>
 
 #include "rbtree/AbstractRBTree.h"
+#include "rbtree/RBTreeGenerator.h"
 
 
 typedef ARBTreeNode RBTreeNode2;
 
 
+/**
+ * Value stored in tree nodes. Memory area have to be first field, because
+ * values are compared and returned as 'MemoryArea'.
+ */
+typedef struct {
+    MemoryArea area;
+    MemoryArea span;                    /// address range of subtree (from start of leftmost to end of rightmost area)
+    size_t maxGap;                      /// largest free space between areas of subtree
+    unsigned char flags;                /// protection of area (MemoryFlag bits)
+    unsigned char flagsOr;              /// protections of any area of subtree
+    unsigned char flagsAnd;             /// protections of every area of subtree
+    unsigned char continued;            /// area is piece of block of preceding area (split by 'tree2_protect')
+} RBTreeValue2;
+
+
 static inline bool tree2_checkOrder(const ARBTreeValue valueA, const ARBTreeValue valueB) {
     const MemoryArea* vA = (MemoryArea*)valueA;
     const MemoryArea* vB = (MemoryArea*)valueB;
@@ -51,6 +67,35 @@ static inline void tree2_freeValue(ARBTreeValue value) {
     free(value);
 }
 
+static inline void tree2_updateNode(ARBTreeNode* node) {
+    RBTreeValue2* value = (RBTreeValue2*)node->value;
+    value->span = value->area;
+    value->maxGap = 0;
+    value->flagsOr = value->flags;
+    value->flagsAnd = value->flags;
+    if (node->left != NULL) {
+        const RBTreeValue2* left = (const RBTreeValue2*)node->left->value;
+        const size_t gap = value->area.start - left->span.end;
+        value->span.start = left->span.start;
+        value->maxGap = (left->maxGap > gap) ? left->maxGap : gap;
+        value->flagsOr |= left->flagsOr;
+        value->flagsAnd &= left->flagsAnd;
+    }
+    if (node->right != NULL) {
+        const RBTreeValue2* right = (const RBTreeValue2*)node->right->value;
+        const size_t gap = right->span.start - value->area.end;
+        value->span.end = right->span.end;
+        value->flagsOr |= right->flagsOr;
+        value->flagsAnd &= right->flagsAnd;
+        if (right->maxGap > value->maxGap) {
+            value->maxGap = right->maxGap;
+        }
+        if (gap > value->maxGap) {
+            value->maxGap = gap;
+        }
+    }
+}
+
 static inline bool tree2_tryFitRight(const ARBTreeNode* node, ARBTreeValue value) {
     const ARBTreeNode* ancestor = rbtree_getRightAncestor(node);
     if (ancestor == NULL) {
@@ -76,36 +121,607 @@ static inline bool tree2_tryFitLeft(const ARBTreeNode* node, ARBTreeValue value)
     return (doesFit == 0);
 }
 
+static inline bool tree2_lessArea(const MemoryArea* areaA, const MemoryArea* areaB) {
+    return (memory_compare(areaA, areaB) < 0);
+}
+
+/// loops of base tree with inlined comparator and fitting
+RBTREE_DEFINE(tree2_typed, MemoryArea, tree2_lessArea, tree2_tryFitLeft, tree2_tryFitRight)
+
 
 /// ========================================================================================
 
 
-static const RBTreeNode2* tree2_getLeftmostNode(const RBTreeNode2* node) {
+/**
+ * Finds first free space inside subtree able to hold 'area' (starting from area's address).
+ * 'prevEnd' is end address of area preceding the subtree (0 if there is no such area).
+ * Subtrees placed before area's address or not having enough free space are skipped,
+ * so the search takes O(log n).
+ */
+static bool tree2_findFirstFit(const RBTreeNode2* node, const size_t prevEnd, MemoryArea* area) {
     if (node == NULL) {
-        return NULL;
+        return false;
+    }
+    const RBTreeValue2* value = (const RBTreeValue2*)node->value;
+    if (value->span.end <= area->start) {
+        /// whole subtree is before requested address
+        return false;
+    }
+    if (value->maxGap < memory_size(area)) {
+        /// no space inside subtree -- check space before subtree
+        return memory_fitGap(prevEnd, value->span.start, area);
+    }
+
+    if (tree2_findFirstFit(node->left, prevEnd, area) == true) {
+        return true;
+    }
+    const size_t leftEnd = (node->left != NULL) ? ((const RBTreeValue2*)node->left->value)->span.end : prevEnd;
+    if (memory_fitGap(leftEnd, value->area.start, area) == true) {
+        return true;
+    }
+    return tree2_findFirstFit(node->right, value->area.end, area);
+}
+
+/**
+ * Moves 'area' to first free space at or after area's address.
+ */
+static void tree2_fitFirst(const ARBTree* tree, MemoryArea* area) {
+    const RBTreeNode2* root = tree->root;
+    if (root == NULL) {
+        return ;
+    }
+    if (tree2_findFirstFit(root, 0, area) == true) {
+        return ;
+    }
+    /// no free space between areas -- put after last one
+    const RBTreeValue2* value = (const RBTreeValue2*)root->value;
+    memory_fitAfter(&(value->span), area);
+}
+
+/// ========================================================================================
+
+
+/**
+ * Free extents are ordered by size, then by address.
+ */
+static inline bool tree2_checkExtentOrder(const ARBTreeValue valueA, const ARBTreeValue valueB) {
+    const MemoryArea* vA = (MemoryArea*)valueA;
+    const MemoryArea* vB = (MemoryArea*)valueB;
+    const size_t sizeA = memory_size(vA);
+    const size_t sizeB = memory_size(vB);
+    if (sizeA != sizeB) {
+        return (sizeA < sizeB);
+    }
+    return (vA->start < vB->start);
+}
+
+static inline void tree2_addExtent(ARBTree* freeTree, const size_t start, const size_t end) {
+    if (start >= end) {
+        /// areas are adjacent -- no free space
+        return ;
+    }
+    MemoryArea extent = memory_create(start, end - start);
+    rbtree_add(freeTree, &extent);
+}
+
+static inline void tree2_deleteExtent(ARBTree* freeTree, const size_t start, const size_t end) {
+    if (start >= end) {
+        return ;
+    }
+    MemoryArea extent = memory_create(start, end - start);
+    rbtree_delete(freeTree, &extent);
+}
+
+/**
+ * Splits free extent between neighbours of newly reserved 'area'.
+ */
+static void tree2_reserveExtent(RBTree2* tree, const RBTreeNode2* node) {
+    const MemoryArea* area = (const MemoryArea*)node->value;
+    const RBTreeNode2* prev = rbtree_prevNode(node);
+    const RBTreeNode2* next = rbtree_nextNode(node);
+    ARBTree* freeTree = &(tree->freeTree);
+    if (prev != NULL && next != NULL) {
+        tree2_deleteExtent(freeTree, ((const MemoryArea*)prev->value)->end, ((const MemoryArea*)next->value)->start);
+    }
+    if (prev != NULL) {
+        tree2_addExtent(freeTree, ((const MemoryArea*)prev->value)->end, area->start);
+    }
+    if (next != NULL) {
+        tree2_addExtent(freeTree, area->end, ((const MemoryArea*)next->value)->start);
+    }
+}
+
+/**
+ * Splits free extents after insertion of ascending 'nodes' at once.
+ * Extent between neighbours of every run of adjacent new nodes is replaced
+ * by extents between consecutive areas of the run.
+ */
+static void tree2_reserveExtents(RBTree2* tree, RBTreeNode2* const* nodes, const size_t size) {
+    ARBTree* freeTree = &(tree->freeTree);
+    size_t first = 0;
+    while (first < size) {
+        size_t last = first;
+        const RBTreeNode2* next = rbtree_nextNode(nodes[last]);
+        while (last + 1 < size && next == nodes[last + 1]) {
+            tree2_addExtent(freeTree, ((const MemoryArea*)nodes[last]->value)->end, ((const MemoryArea*)next->value)->start);
+            ++last;
+            next = rbtree_nextNode(nodes[last]);
+        }
+        const RBTreeNode2* prev = rbtree_prevNode(nodes[first]);
+        if (prev != NULL && next != NULL) {
+            tree2_deleteExtent(freeTree, ((const MemoryArea*)prev->value)->end, ((const MemoryArea*)next->value)->start);
+        }
+        if (prev != NULL) {
+            tree2_addExtent(freeTree, ((const MemoryArea*)prev->value)->end, ((const MemoryArea*)nodes[first]->value)->start);
+        }
+        if (next != NULL) {
+            tree2_addExtent(freeTree, ((const MemoryArea*)nodes[last]->value)->end, ((const MemoryArea*)next->value)->start);
+        }
+        first = last + 1;
+    }
+}
+
+/**
+ * Moves 'area' to smallest free extent able to hold it.
+ * Returns false if there is no such extent.
+ */
+static bool tree2_fitBest(const RBTree2* tree, MemoryArea* area) {
+    const size_t areaSize = memory_size(area);
+    const MemoryArea* best = NULL;
+    const RBTreeNode2* curr = tree->freeTree.root;
+    while (curr != NULL) {
+        const MemoryArea* extent = (const MemoryArea*)curr->value;
+        if (memory_size(extent) >= areaSize) {
+            /// extent fits -- look for smaller one
+            best = extent;
+            curr = curr->left;
+        } else {
+            curr = curr->right;
+        }
+    }
+    if (best == NULL) {
+        return false;
+    }
+    *area = memory_create(best->start, areaSize);
+    return true;
+}
+
+
+/// ========================================================================================
+
+
+#define TREE2_RADIX_SLOTS           ((size_t)1 << TREE2_RADIX_LEVEL_BITS)
+#define TREE2_RADIX_LIMIT           ((size_t)1 << (TREE2_RADIX_PAGE_BITS + TREE2_RADIX_LEVEL_BITS * TREE2_RADIX_LEVELS))
+#define TREE2_RADIX_NODE_TAG        ((uintptr_t) 1)
+
+
+/**
+ * Slot keeps NULL, pointer to table of next level or pointer to node
+ * tagged with lowest bit.
+ */
+typedef struct RBTree2RadixTable {
+    void* slots[TREE2_RADIX_SLOTS];
+    size_t used;                                /// number of non-empty slots
+} RBTree2RadixTable;
+
+
+static inline bool tree2_radixIsNode(const void* slot) {
+    return ((uintptr_t)slot & TREE2_RADIX_NODE_TAG) != 0;
+}
+
+static inline const RBTreeNode2* tree2_radixNode(const void* slot) {
+    return (const RBTreeNode2*)((uintptr_t)slot & ~TREE2_RADIX_NODE_TAG);
+}
+
+static inline void* tree2_radixSlot(const RBTreeNode2* node) {
+    return (void*)((uintptr_t)node | TREE2_RADIX_NODE_TAG);
+}
+
+/**
+ * Size of address range of one slot of table on given level (0 is root).
+ */
+static inline size_t tree2_radixSpan(const size_t level) {
+    return (size_t)1 << (TREE2_RADIX_PAGE_BITS + TREE2_RADIX_LEVEL_BITS * (TREE2_RADIX_LEVELS - 1 - level));
+}
+
+static inline const MemoryArea* tree2_nodeArea(const RBTreeNode2* node) {
+    return (const MemoryArea*)node->value;
+}
+
+/**
+ * Calls 'code' for every slot of 'table' intersecting 'area'. Defines
+ * 'slot', 'slotStart' and 'slotEnd'.
+ */
+#define TREE2_RADIX_FOREACH(table, level, tableStart, area, code)                                   \
+    {                                                                                               \
+        const size_t span_ = tree2_radixSpan(level);                                                \
+        const size_t tableEnd_ = (tableStart) + span_ * TREE2_RADIX_SLOTS;                          \
+        const size_t from_ = ((area)->start > (tableStart)) ? (area)->start : (tableStart);         \
+        const size_t to_ = ((area)->end < tableEnd_) ? (area)->end : tableEnd_;                     \
+        for(size_t i_ = (from_ - (tableStart)) / span_; (tableStart) + i_ * span_ < to_; ++i_) {    \
+            void** slot = &((table)->slots[i_]);                                                    \
+            const size_t slotStart = (tableStart) + i_ * span_;                                     \
+            const size_t slotEnd = slotStart + span_;                                               \
+            (void) slotEnd;                                                                         \
+            code                                                                                    \
+        }                                                                                           \
+    }
+
+/**
+ * Adds 'node' to index. Returns false if table could not be allocated
+ * (index is then partially updated, 'tree2_radixRemoveTable' cleans it).
+ */
+static bool tree2_radixInsertTable(RBTree2RadixTable* table, const size_t level, const size_t tableStart, const RBTreeNode2* node) {
+    const MemoryArea* area = tree2_nodeArea(node);
+    TREE2_RADIX_FOREACH(table, level, tableStart, area, {
+        if (area->start <= slotStart && area->end >= slotEnd) {
+            /* slot fully covered -- no other area can be inside */
+            assert( *slot == NULL );
+            *slot = tree2_radixSlot(node);
+            ++(table->used);
+        } else if (level + 1 == TREE2_RADIX_LEVELS) {
+            /* page -- keep first area intersecting it */
+            if (*slot == NULL) {
+                *slot = tree2_radixSlot(node);
+                ++(table->used);
+            } else if (tree2_nodeArea(tree2_radixNode(*slot))->start > area->start) {
+                *slot = tree2_radixSlot(node);
+            }
+        } else {
+            assert( tree2_radixIsNode(*slot) == false );
+            if (*slot == NULL) {
+                *slot = calloc(1, sizeof(RBTree2RadixTable));
+                if (*slot == NULL) {
+                    return false;
+                }
+                ++(table->used);
+            }
+            if (tree2_radixInsertTable((RBTree2RadixTable*)*slot, level + 1, slotStart, node) == false) {
+                return false;
+            }
+        }
+    })
+    return true;
+}
+
+/**
+ * Removes 'node' from index. Pages pointing to node start pointing
+ * to 'next' node if it intersects them.
+ */
+static void tree2_radixRemoveTable(RBTree2RadixTable* table, const size_t level, const size_t tableStart, const RBTreeNode2* node, const RBTreeNode2* next) {
+    const MemoryArea* area = tree2_nodeArea(node);
+    TREE2_RADIX_FOREACH(table, level, tableStart, area, {
+        if (*slot == NULL) {
+            continue ;
+        }
+        if (tree2_radixIsNode(*slot) == true) {
+            if (tree2_radixNode(*slot) != node) {
+                continue ;
+            }
+            if (next != NULL && tree2_nodeArea(next)->start < slotEnd) {
+                *slot = tree2_radixSlot(next);
+            } else {
+                *slot = NULL;
+                --(table->used);
+            }
+            continue ;
+        }
+        RBTree2RadixTable* child = (RBTree2RadixTable*)*slot;
+        tree2_radixRemoveTable(child, level + 1, slotStart, node, next);
+        if (child->used == 0) {
+            free(child);
+            *slot = NULL;
+            --(table->used);
+        }
+    })
+}
+
+/**
+ * Makes slots pointing to 'from' node point to 'to' node (value of 'from' moved to 'to').
+ */
+static void tree2_radixReplaceTable(RBTree2RadixTable* table, const size_t level, const size_t tableStart, const MemoryArea* area,
+                                    const RBTreeNode2* from, const RBTreeNode2* to) {
+    TREE2_RADIX_FOREACH(table, level, tableStart, area, {
+        if (*slot == NULL) {
+            continue ;
+        }
+        if (tree2_radixIsNode(*slot) == true) {
+            if (tree2_radixNode(*slot) == from) {
+                *slot = tree2_radixSlot(to);
+            }
+            continue ;
+        }
+        tree2_radixReplaceTable((RBTree2RadixTable*)*slot, level + 1, slotStart, area, from, to);
+    })
+}
+
+static void tree2_radixReleaseTable(RBTree2RadixTable* table, const size_t level) {
+    if (level + 1 < TREE2_RADIX_LEVELS) {
+        for(size_t i = 0; i < TREE2_RADIX_SLOTS; ++i) {
+            if (table->slots[i] != NULL && tree2_radixIsNode(table->slots[i]) == false) {
+                tree2_radixReleaseTable((RBTree2RadixTable*)table->slots[i], level + 1);
+            }
+        }
+    }
+    free(table);
+}
+
+/**
+ * Finds node of area containing 'address' using radix index.
+ * Falls back to tree descent if address is not indexed or
+ * page contains many areas.
+ */
+static const RBTreeNode2* tree2_radixFind(const RBTree2* tree, const size_t address) {
+    MemoryArea key = memory_create(address, 1);
+    if (address >= TREE2_RADIX_LIMIT) {
+        return tree2_typed_findNode(&(tree->tree), &key);
+    }
+    const void* slot = tree->radix;
+    for(size_t level = 0; level < TREE2_RADIX_LEVELS; ++level) {
+        const RBTree2RadixTable* table = (const RBTree2RadixTable*)slot;
+        const size_t index = (address / tree2_radixSpan(level)) % TREE2_RADIX_SLOTS;
+        slot = table->slots[index];
+        if (slot == NULL) {
+            return NULL;
+        }
+        if (tree2_radixIsNode(slot) == true) {
+            break;
+        }
+    }
+    /// first area intersecting page -- walk to area containing address
+    const RBTreeNode2* node = tree2_radixNode(slot);
+    for(size_t i = 0; i < TREE2_RADIX_MAX_WALK; ++i) {
+        const MemoryArea* area = tree2_nodeArea(node);
+        if (area->start > address) {
+            return NULL;
+        }
+        if (address < area->end) {
+            return node;
+        }
+        node = rbtree_nextNode(node);
+        if (node == NULL) {
+            return NULL;
+        }
+    }
+    return tree2_typed_findNode(&(tree->tree), &key);
+}
+
+/**
+ * Returns false if index could not be extended.
+ */
+static inline bool tree2_radixInsert(RBTree2* tree, const RBTreeNode2* node) {
+    const MemoryArea* area = tree2_nodeArea(node);
+    if (area->start >= TREE2_RADIX_LIMIT || area->start >= area->end) {
+        /// not indexed
+        return true;
+    }
+    return tree2_radixInsertTable(tree->radix, 0, 0, node);
+}
+
+static inline void tree2_radixRemove(RBTree2* tree, const RBTreeNode2* node, const RBTreeNode2* next) {
+    const MemoryArea* area = tree2_nodeArea(node);
+    if (area->start >= TREE2_RADIX_LIMIT || area->start >= area->end) {
+        return ;
+    }
+    tree2_radixRemoveTable(tree->radix, 0, 0, node, next);
+}
+
+/**
+ * Updates index after value of node 'from' has been moved to node 'to'.
+ */
+static inline void tree2_radixReplace(RBTree2* tree, const RBTreeNode2* to, const RBTreeNode2* from) {
+    const MemoryArea* area = tree2_nodeArea(to);
+    if (area->start >= TREE2_RADIX_LIMIT || area->start >= area->end) {
+        return ;
+    }
+    tree2_radixReplaceTable(tree->radix, 0, 0, area, from, to);
+}
+
+static void tree2_radixRelease(RBTree2* tree) {
+    if (tree->radix == NULL) {
+        return ;
+    }
+    tree2_radixReleaseTable(tree->radix, 0);
+    tree->radix = NULL;
+}
+
+/**
+ * Adds 'node' to index in the middle of operation which cannot be reverted.
+ * If index cannot be extended, then it is disabled (lookups fall back to
+ * tree descent), so it never points to wrong areas.
+ */
+static inline void tree2_radixUpdate(RBTree2* tree, const RBTreeNode2* node) {
+    if (tree2_radixInsert(tree, node) == false) {
+        tree2_radixRelease(tree);
     }
-    const RBTreeNode2* curr = node;
-    while (curr->left != NULL) {
-        curr = curr->left;
+}
+
+/**
+ * Finds node of area containing 'address' (using radix index if enabled).
+ */
+static RBTreeNode2* tree2_findNode(const RBTree2* tree, const size_t address) {
+    if (tree->radix != NULL) {
+        return (RBTreeNode2*)tree2_radixFind(tree, address);
     }
-    return curr;
+    MemoryArea key = memory_create(address, 1);
+    return tree2_typed_findNode(&(tree->tree), &key);
 }
 
-static const RBTreeNode2* tree2_getRightmostNode(const RBTreeNode2* node) {
+
+/// ========================================================================================
+
+
+/**
+ * Inserts already placed area of given protection into tree and updates indexes.
+ */
+static bool tree2_insertArea(RBTree2* tree, const MemoryArea* area, const unsigned char flags) {
+    ARBTree* baseTree = &(tree->tree);
+    RBTreeValue2 value;
+    value.area = *area;
+    value.flags = flags;
+    value.continued = 0;
+
+    const RBTreeNode2* node = NULL;
+    if (baseTree->valueSize > 0) {
+        /// inline values -- value is copied to node
+        node = tree2_typed_addValue(baseTree, &value);
+    } else {
+        RBTreeValue2* ptr = malloc( sizeof(RBTreeValue2) );
+        if (ptr == NULL) {
+            return false;
+        }
+        *ptr = value;
+        node = tree2_typed_addValue(baseTree, ptr);
+        if (node == NULL) {
+            free(ptr);
+        }
+    }
+
     if (node == NULL) {
-        return NULL;
+        return false;
+    }
+    if (tree->radix != NULL && tree2_radixInsert(tree, node) == false) {
+        /// out of memory -- remove area again
+        const RBTreeNode2* next = rbtree_nextNode(node);
+        tree2_radixRemove(tree, node, next);
+        /// node with both children takes value of its successor
+        const RBTreeNode2* moved = (node->left != NULL && node->right != NULL) ? next : NULL;
+        rbtree_deleteNode(baseTree, (RBTreeNode2*)node);
+        if (moved != NULL) {
+            tree2_radixReplace(tree, node, moved);
+        }
+        return false;
+    }
+    if (tree->freeIndex == true) {
+        tree2_reserveExtent(tree, node);
+    }
+    return true;
+}
+
+/**
+ * Moves 'area' to first free space after previously reserved area. If there
+ * is no free space between areas, then search starts again from area's address.
+ */
+static void tree2_fitNext(const RBTree2* tree, MemoryArea* area) {
+    const RBTreeNode2* root = tree->tree.root;
+    if (root != NULL && tree->nextAddress > area->start) {
+        MemoryArea candidate = memory_create(tree->nextAddress, memory_size(area));
+        if (tree2_findFirstFit(root, 0, &candidate) == true) {
+            *area = candidate;
+            return ;
+        }
     }
-    const RBTreeNode2* curr = node;
-    while (curr->right != NULL) {
-        curr = curr->right;
+    /// wrap around
+    tree2_fitFirst(&(tree->tree), area);
+}
+
+/**
+ * Finds last free space inside subtree (or right after it) able to hold 'area'
+ * and ending not above 'limit'. 'nextStart' is start address of area following
+ * the subtree. Mirror of 'tree2_findFirstFit'.
+ */
+static bool tree2_findLastFit(const RBTreeNode2* node, const size_t nextStart, const size_t limit, MemoryArea* area) {
+    if (node == NULL) {
+        return false;
+    }
+    const RBTreeValue2* value = (const RBTreeValue2*)node->value;
+    if (value->span.start >= limit) {
+        /// whole subtree is above limit
+        return false;
+    }
+    const size_t afterEnd = (nextStart < limit) ? nextStart : limit;
+    if (value->maxGap < memory_size(area)) {
+        /// no space inside subtree -- check space after subtree
+        return memory_fitGapTop(value->span.end, afterEnd, area);
+    }
+
+    if (tree2_findLastFit(node->right, nextStart, limit, area) == true) {
+        return true;
+    }
+    const size_t rightStart = (node->right != NULL) ? ((const RBTreeValue2*)node->right->value)->span.start : nextStart;
+    const size_t gapEnd = (rightStart < limit) ? rightStart : limit;
+    if (memory_fitGapTop(value->area.end, gapEnd, area) == true) {
+        return true;
+    }
+    return tree2_findLastFit(node->left, value->area.start, limit, area);
+}
+
+/**
+ * Moves 'area' to highest free space ending not above area's address
+ * (tree's top address if area has no hint).
+ * Returns false if there is no such space.
+ */
+static bool tree2_fitTopDown(const RBTree2* tree, MemoryArea* area) {
+    const size_t limit = (area->start != 0) ? area->start : tree->topAddress;
+    const RBTreeNode2* root = tree->tree.root;
+    if (root == NULL) {
+        return memory_fitGapTop(0, limit, area);
+    }
+    if (tree2_findLastFit(root, limit, limit, area) == true) {
+        return true;
+    }
+    /// space before first area
+    const RBTreeValue2* value = (const RBTreeValue2*)root->value;
+    const size_t firstStart = (value->span.start < limit) ? value->span.start : limit;
+    return memory_fitGapTop(0, firstStart, area);
+}
+
+/**
+ * Moves 'area' to free space according to policy.
+ */
+static bool tree2_placeArea(RBTree2* tree, MemoryArea* area, const RBTree2Policy policy) {
+    switch(policy) {
+    case TREE2_FIT_FIRST: {
+        tree2_fitFirst(&(tree->tree), area);
+        return true;
+    }
+    case TREE2_FIT_NEXT: {
+        tree2_fitNext(tree, area);
+        return true;
+    }
+    case TREE2_FIT_BEST: {
+        if (tree->freeIndex == false || tree2_fitBest(tree, area) == false) {
+            tree2_fitFirst(&(tree->tree), area);
+        }
+        return true;
+    }
+    case TREE2_FIT_TOP_DOWN: {
+        if (tree2_fitTopDown(tree, area) == false) {
+            tree2_fitFirst(&(tree->tree), area);
+        }
+        return true;
+    }
+    }
+    /// unknown policy
+    return false;
+}
+
+/**
+ * Reserves area according to policy.
+ * On success 'area' contains reserved block. Fails for unknown policy.
+ */
+static bool tree2_addArea(RBTree2* tree, MemoryArea* area, const RBTree2Policy policy, const unsigned char flags) {
+    if (tree2_placeArea(tree, area, policy) == false) {
+        return false;
     }
-    return curr;
+    if (tree2_insertArea(tree, area, flags) == false) {
+        return false;
+    }
+    tree->nextAddress = area->end;
+    return true;
 }
 
 
 /// ===================================================
 
 
+size_t tree2_blocks(const RBTree2* tree) {
+    if (tree == NULL) {
+        return 0;
+    }
+    return rbtree_size(&(tree->tree)) - tree->pieces;
+}
+
 size_t tree2_size(const RBTree2* tree) {
     if (tree == NULL) {
         return 0;
@@ -114,6 +730,16 @@ size_t tree2_size(const RBTree2* tree) {
     return rbtree_size(baseTree);
 }
 
+size_t tree2_freeExtents(const RBTree2* tree) {
+    if (tree == NULL) {
+        return 0;
+    }
+    if (tree->freeIndex == false) {
+        return 0;
+    }
+    return rbtree_size(&(tree->freeTree));
+}
+
 size_t tree2_depth(const RBTree2* tree) {
     if (tree == NULL) {
         return 0;
@@ -122,15 +748,21 @@ size_t tree2_depth(const RBTree2* tree) {
     return rbtree_depth(baseTree);
 }
 
+size_t tree2_blackHeight(const RBTree2* tree) {
+    if (tree == NULL) {
+        return 0;
+    }
+    const ARBTree* baseTree = &(tree->tree);
+    return rbtree_blackHeight(baseTree);
+}
+
 size_t tree2_startAddress(const RBTree2* tree) {
     if (tree==NULL)
         return 0;
     const ARBTree* baseTree = &(tree->tree);
-    if (baseTree->root==NULL)
+    const MemoryArea* area = (const MemoryArea*)rbtree_firstValue(baseTree);
+    if (area==NULL)
         return 0;
-
-    const RBTreeNode2* node = tree2_getLeftmostNode(baseTree->root);
-    const MemoryArea* area = (const MemoryArea*)node->value;
     return area->start;
 }
 
@@ -138,11 +770,9 @@ size_t tree2_endAddress(const RBTree2* tree) {
     if (tree==NULL)
         return 0;
     const ARBTree* baseTree = &(tree->tree);
-    if (baseTree->root==NULL)
+    const MemoryArea* area = (const MemoryArea*)rbtree_lastValue(baseTree);
+    if (area==NULL)
         return 0;
-
-    const RBTreeNode2* node = tree2_getRightmostNode(baseTree->root);
-    const MemoryArea* area = (const MemoryArea*)node->value;
     return area->end;
 }
 
@@ -168,119 +798,1223 @@ MemoryArea tree2_valueByIndex(const RBTree2* tree, const size_t index) {
     return *val;
 }
 
-
-/// ==================================================================================
-
-
-ARBTreeValidationError tree2_isValid(const RBTree2* tree) {
+MemoryArea tree2_find(const RBTree2* tree, const size_t address) {
     if (tree == NULL) {
-        return ARBTREE_INVALID_OK;
+        return memory_create(0, 0);
     }
-    const ARBTree* baseTree = &(tree->tree);
-    return rbtree_isValid(baseTree);
+    const RBTreeNode2* node = tree2_findNode(tree, address);
+    if (node == NULL) {
+        return memory_create(0, 0);
+    }
+    return *tree2_nodeArea(node);
 }
 
 
-/// ==================================================================================
-
-
-size_t tree2_add(RBTree2* tree, const size_t address, const size_t size) {
-    if (tree==NULL)
-        return 0;
-    ARBTree* baseTree = &(tree->tree);
-    if (baseTree==NULL)
-        return 0;
-
-    MemoryArea* ptr = malloc( sizeof(MemoryArea) );
-    *ptr = memory_create(address, size);
-
-    if (rbtree_add(baseTree, ptr)==true) {
-        return ptr->start;
+bool tree2_cursorFirst(const RBTree2* tree, RBTree2Cursor* cursor) {
+    if (tree == NULL || cursor == NULL) {
+        return false;
     }
-
-    free(ptr);
-    return 0;
+    return rbtree_cursorFirst(&(tree->tree), cursor);
 }
 
-void tree2_delete(RBTree2* tree, const size_t address) {
-    if (tree == NULL) {
-        return ;
+bool tree2_cursorLast(const RBTree2* tree, RBTree2Cursor* cursor) {
+    if (tree == NULL || cursor == NULL) {
+        return false;
     }
-    ARBTree* baseTree = &(tree->tree);
-
-    MemoryArea area = memory_create(address, 1);
-    const ARBTreeValue v = (ARBTreeValue)&area;
-    rbtree_delete(baseTree, v);
+    return rbtree_cursorLast(&(tree->tree), cursor);
 }
 
-
-/// ==============================================================================================
-
-
-void tree2_print(const RBTree2* tree) {
-    if (tree == NULL) {
-        printf("%s", "[NULL]");
-        return ;
+bool tree2_cursorSeek(const RBTree2* tree, const size_t address, RBTree2Cursor* cursor) {
+    if (tree == NULL || cursor == NULL) {
+        return false;
     }
-    const ARBTree* baseTree = &(tree->tree);
-    rbtree_print(baseTree);
+    if (tree->radix != NULL) {
+        cursor->node = tree2_radixFind(tree, address);
+        if (cursor->node != NULL) {
+            return true;
+        }
+    }
+    /// first area ending after address
+    MemoryArea key = memory_create(address, 1);
+    return rbtree_cursorSeek(&(tree->tree), &key, cursor);
 }
 
-
-/// ==============================================================================================
-
-
-bool tree2_release(RBTree2* tree) {
-    if (tree == NULL) {
+bool tree2_cursorNext(RBTree2Cursor* cursor) {
+    if (cursor == NULL) {
         return false;
     }
-    ARBTree* baseTree = &(tree->tree);
-    return rbtree_release(baseTree);
+    return rbtree_cursorNext(cursor);
 }
 
-
-/// ===================================================
-
-
-void* tree2_mmap(RBTree2* tree, void *vaddr, unsigned int size) {
-    if (tree==NULL)
-        return NULL;
-    ARBTree* baseTree = &(tree->tree);
-    if (baseTree==NULL)
-        return NULL;
-
-    MemoryArea* ptr = malloc( sizeof(MemoryArea) );
-    *ptr = memory_create((size_t)vaddr, size);
-
-    if (rbtree_add(baseTree, ptr)==true) {
-        return (void*)ptr->start;
+bool tree2_cursorPrev(RBTree2Cursor* cursor) {
+    if (cursor == NULL) {
+        return false;
     }
+    return rbtree_cursorPrev(cursor);
+}
 
-    free(ptr);
-    return NULL;
+MemoryArea tree2_cursorGet(const RBTree2Cursor* cursor) {
+    if (cursor == NULL || cursor->node == NULL) {
+        return memory_create(0, 0);
+    }
+    return *tree2_nodeArea(cursor->node);
 }
 
-void tree2_munmap(RBTree2* tree, void *vaddr) {
+size_t tree2_forEachInRange(const RBTree2* tree, const size_t start, const size_t end, tree2_visitArea visitor, void* context) {
+    if (tree == NULL || visitor == NULL || start >= end) {
+        return 0;
+    }
+    size_t visited = 0;
+    RBTree2Cursor cursor;
+    bool valid = tree2_cursorSeek(tree, start, &cursor);
+    while (valid == true) {
+        const MemoryArea* area = tree2_nodeArea(cursor.node);
+        if (area->start >= end) {
+            break;
+        }
+        ++visited;
+        if (visitor(area, context) == false) {
+            break;
+        }
+        valid = tree2_cursorNext(&cursor);
+    }
+    return visited;
+}
+
+/**
+ * Visits gaps of subtree not smaller than 'minSize' in address order.
+ * Gap between node and its child subtree is kept by the node.
+ * Returns false if visitor stopped the walk.
+ */
+static bool tree2_visitGaps(const RBTreeNode2* node, const size_t minSize, tree2_visitArea visitor, void* context, size_t* visited) {
+    const RBTreeValue2* value = (const RBTreeValue2*)node->value;
+    if (node->left != NULL) {
+        const RBTreeValue2* left = (const RBTreeValue2*)node->left->value;
+        if (left->maxGap >= minSize && tree2_visitGaps(node->left, minSize, visitor, context, visited) == false) {
+            return false;
+        }
+        if (value->area.start - left->span.end >= minSize) {
+            const MemoryArea gap = memory_create(left->span.end, value->area.start - left->span.end);
+            ++(*visited);
+            if (visitor(&gap, context) == false) {
+                return false;
+            }
+        }
+    }
+    if (node->right != NULL) {
+        const RBTreeValue2* right = (const RBTreeValue2*)node->right->value;
+        if (right->span.start - value->area.end >= minSize) {
+            const MemoryArea gap = memory_create(value->area.end, right->span.start - value->area.end);
+            ++(*visited);
+            if (visitor(&gap, context) == false) {
+                return false;
+            }
+        }
+        if (right->maxGap >= minSize && tree2_visitGaps(node->right, minSize, visitor, context, visited) == false) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t tree2_forEachGap(const RBTree2* tree, const size_t minSize, tree2_visitArea visitor, void* context) {
+    if (tree == NULL || visitor == NULL) {
+        return 0;
+    }
+    const RBTreeNode2* root = tree->tree.root;
+    if (root == NULL) {
+        return 0;
+    }
+    /// adjacent areas have no gap
+    const size_t size = (minSize > 0) ? minSize : 1;
+    if (((const RBTreeValue2*)root->value)->maxGap < size) {
+        return 0;
+    }
+    size_t visited = 0;
+    tree2_visitGaps(root, size, visitor, context, &visited);
+    return visited;
+}
+
+MemoryArea tree2_largestGap(const RBTree2* tree) {
+    if (tree == NULL || tree->tree.root == NULL) {
+        return memory_create(0, 0);
+    }
+    const RBTreeNode2* node = tree->tree.root;
+    const size_t maxGap = ((const RBTreeValue2*)node->value)->maxGap;
+    if (maxGap == 0) {
+        return memory_create(0, 0);
+    }
+    /// descend to lowest gap of aggregated size
+    while (node != NULL) {
+        const RBTreeValue2* value = (const RBTreeValue2*)node->value;
+        if (node->left != NULL) {
+            const RBTreeValue2* left = (const RBTreeValue2*)node->left->value;
+            if (left->maxGap == maxGap) {
+                node = node->left;
+                continue ;
+            }
+            if (value->area.start - left->span.end == maxGap) {
+                return memory_create(left->span.end, maxGap);
+            }
+        }
+        if (node->right == NULL) {
+            /// aggregate does not match subtree
+            break;
+        }
+        const RBTreeValue2* right = (const RBTreeValue2*)node->right->value;
+        if (right->span.start - value->area.end == maxGap) {
+            return memory_create(value->area.end, maxGap);
+        }
+        node = node->right;
+    }
+    return memory_create(0, 0);
+}
+
+/**
+ * Accumulates protections of areas of subtree intersecting range (start, end).
+ * Subtree inside range is taken from aggregates of its root, so at most
+ * two partially covered nodes are visited on every level.
+ */
+static void tree2_collectFlags(const RBTreeNode2* node, const size_t start, const size_t end,
+                               unsigned int* any, unsigned int* all, bool* found) {
+    if (node == NULL) {
+        return ;
+    }
+    const RBTreeValue2* value = (const RBTreeValue2*)node->value;
+    if (value->span.end <= start || value->span.start >= end) {
+        /// subtree outside range
+        return ;
+    }
+    if (value->span.start >= start && value->span.end <= end) {
+        *any |= value->flagsOr;
+        *all &= value->flagsAnd;
+        *found = true;
+        return ;
+    }
+    tree2_collectFlags(node->left, start, end, any, all, found);
+    if (value->area.end > start && value->area.start < end) {
+        *any |= value->flags;
+        *all &= value->flags;
+        *found = true;
+    }
+    tree2_collectFlags(node->right, start, end, any, all, found);
+}
+
+bool tree2_rangeFlags(const RBTree2* tree, const size_t start, const size_t end, unsigned int* any, unsigned int* all) {
+    unsigned int flagsAny = 0;
+    unsigned int flagsAll = TREE2_FLAGS_MASK;
+    bool found = false;
+    if (tree != NULL && start < end) {
+        tree2_collectFlags(tree->tree.root, start, end, &flagsAny, &flagsAll, &found);
+    }
+    if (found == false) {
+        flagsAll = 0;
+    }
+    if (any != NULL) {
+        *any = flagsAny;
+    }
+    if (all != NULL) {
+        *all = flagsAll;
+    }
+    return found;
+}
+
+
+/// ==================================================================================
+
+
+static ARBTreeValidationError tree2_isValid_checkAugmented(const RBTreeNode2* node) {
+    if (node == NULL) {
+        return ARBTREE_INVALID_OK;
+    }
+    const ARBTreeValidationError validLeft = tree2_isValid_checkAugmented(node->left);
+    if (validLeft != ARBTREE_INVALID_OK) {
+        return validLeft;
+    }
+    const ARBTreeValidationError validRight = tree2_isValid_checkAugmented(node->right);
+    if (validRight != ARBTREE_INVALID_OK) {
+        return validRight;
+    }
+
+    /// recalculate data on copy of node
+    RBTreeValue2 expected = *(const RBTreeValue2*)node->value;
+    RBTreeNode2 nodeCopy = *node;
+    nodeCopy.value = &expected;
+    tree2_updateNode(&nodeCopy);
+
+    const RBTreeValue2* value = (const RBTreeValue2*)node->value;
+    if (memory_isEqual(&(value->span), &(expected.span)) == false) {
+        return ARBTREE_INVALID_AUGMENTED_DATA;
+    }
+    if (value->maxGap != expected.maxGap) {
+        return ARBTREE_INVALID_AUGMENTED_DATA;
+    }
+    if (value->flagsOr != expected.flagsOr || value->flagsAnd != expected.flagsAnd) {
+        return ARBTREE_INVALID_AUGMENTED_DATA;
+    }
+    return ARBTREE_INVALID_OK;
+}
+
+/**
+ * Checks if every free space between areas is in free index and nothing more.
+ */
+static ARBTreeValidationError tree2_isValid_checkFreeIndex(const RBTree2* tree) {
+    const ARBTreeValidationError valid = rbtree_isValid(&(tree->freeTree));
+    if (valid != ARBTREE_INVALID_OK) {
+        return valid;
+    }
+    size_t extents = 0;
+    const RBTreeNode2* curr = tree->tree.leftmost;
+    while (curr != NULL) {
+        const RBTreeNode2* next = rbtree_nextNode(curr);
+        if (next == NULL) {
+            break;
+        }
+        const size_t start = ((const MemoryArea*)curr->value)->end;
+        const size_t end = ((const MemoryArea*)next->value)->start;
+        if (start < end) {
+            MemoryArea extent = memory_create(start, end - start);
+            if (rbtree_findNode(&(tree->freeTree), &extent) == NULL) {
+                return ARBTREE_INVALID_TREE_DATA;
+            }
+            ++extents;
+        }
+        curr = next;
+    }
+    if (extents != rbtree_size(&(tree->freeTree))) {
+        return ARBTREE_INVALID_TREE_DATA;
+    }
+    return ARBTREE_INVALID_OK;
+}
+
+/**
+ * Checks if both ends of every area are found by radix index.
+ */
+static ARBTreeValidationError tree2_isValid_checkRadix(const RBTree2* tree) {
+    const RBTreeNode2* curr = tree->tree.leftmost;
+    while (curr != NULL) {
+        const MemoryArea* area = tree2_nodeArea(curr);
+        if (tree2_radixFind(tree, area->start) != curr) {
+            return ARBTREE_INVALID_TREE_DATA;
+        }
+        if (tree2_radixFind(tree, area->end - 1) != curr) {
+            return ARBTREE_INVALID_TREE_DATA;
+        }
+        curr = rbtree_nextNode(curr);
+    }
+    return ARBTREE_INVALID_OK;
+}
+
+/**
+ * Checks if every piece of block touches preceding area and number of pieces is correct.
+ */
+static ARBTreeValidationError tree2_isValid_checkPieces(const RBTree2* tree) {
+    size_t pieces = 0;
+    const RBTreeNode2* prev = NULL;
+    for(const RBTreeNode2* node = tree->tree.leftmost; node != NULL; node = rbtree_nextNode(node)) {
+        const RBTreeValue2* value = (const RBTreeValue2*)node->value;
+        if (value->continued != 0) {
+            if (prev == NULL || tree2_nodeArea(prev)->end != value->area.start) {
+                return ARBTREE_INVALID_TREE_DATA;
+            }
+            ++pieces;
+        }
+        prev = node;
+    }
+    if (pieces != tree->pieces) {
+        return ARBTREE_INVALID_TREE_DATA;
+    }
+    return ARBTREE_INVALID_OK;
+}
+
+ARBTreeValidationError tree2_isValid(const RBTree2* tree) {
+    if (tree == NULL) {
+        return ARBTREE_INVALID_OK;
+    }
+    const ARBTree* baseTree = &(tree->tree);
+    const ARBTreeValidationError valid = rbtree_isValid(baseTree);
+    if (valid != ARBTREE_INVALID_OK) {
+        return valid;
+    }
+    const ARBTreeValidationError validAugmented = tree2_isValid_checkAugmented(baseTree->root);
+    if (validAugmented != ARBTREE_INVALID_OK) {
+        return validAugmented;
+    }
+    const ARBTreeValidationError validPieces = tree2_isValid_checkPieces(tree);
+    if (validPieces != ARBTREE_INVALID_OK) {
+        return validPieces;
+    }
+    if (tree->radix != NULL) {
+        const ARBTreeValidationError validRadix = tree2_isValid_checkRadix(tree);
+        if (validRadix != ARBTREE_INVALID_OK) {
+            return validRadix;
+        }
+    }
+    if (tree->freeIndex == false) {
+        return ARBTREE_INVALID_OK;
+    }
+    return tree2_isValid_checkFreeIndex(tree);
+}
+
+/**
+ * Checks if free space of subtree intersects range (start, end). Subtree
+ * inside range is checked by its largest gap, so at most two partially
+ * covered nodes are visited on every level.
+ */
+static bool tree2_hasGap(const RBTreeNode2* node, const size_t start, const size_t end) {
+    if (node == NULL) {
+        return false;
+    }
+    const RBTreeValue2* value = (const RBTreeValue2*)node->value;
+    if (value->span.end <= start || value->span.start >= end) {
+        /// subtree outside range
+        return false;
+    }
+    if (value->span.start >= start && value->span.end <= end) {
+        return (value->maxGap > 0);
+    }
+    if (node->left != NULL) {
+        const RBTreeValue2* left = (const RBTreeValue2*)node->left->value;
+        if (left->span.end < value->area.start && left->span.end < end && value->area.start > start) {
+            return true;
+        }
+        if (tree2_hasGap(node->left, start, end) == true) {
+            return true;
+        }
+    }
+    if (node->right != NULL) {
+        const RBTreeValue2* right = (const RBTreeValue2*)node->right->value;
+        if (value->area.end < right->span.start && value->area.end < end && right->span.start > start) {
+            return true;
+        }
+        if (tree2_hasGap(node->right, start, end) == true) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool tree2_isReserved(const RBTree2* tree, const size_t start, const size_t end) {
+    if (tree == NULL || start >= end) {
+        return false;
+    }
+    const RBTreeNode2* root = tree->tree.root;
+    if (root == NULL) {
+        return false;
+    }
+    const RBTreeValue2* value = (const RBTreeValue2*)root->value;
+    if (value->span.start > start || value->span.end < end) {
+        return false;
+    }
+    return (tree2_hasGap(root, start, end) == false);
+}
+
+
+/// ==================================================================================
+
+
+size_t tree2_add(RBTree2* tree, const size_t address, const size_t size) {
+    if (tree==NULL)
+        return 0;
+    ARBTree* baseTree = &(tree->tree);
+    if (baseTree==NULL)
+        return 0;
+
+    MemoryArea area = memory_create(address, size);
+    if (tree2_addArea(tree, &area, tree->policy, 0) == true) {
+        return area.start;
+    }
+    return 0;
+}
+
+size_t tree2_addFit(RBTree2* tree, const size_t address, const size_t size, const RBTree2Policy policy) {
+    if (tree==NULL)
+        return 0;
+
+    MemoryArea area = memory_create(address, size);
+    if (tree2_addArea(tree, &area, policy, 0) == true) {
+        return area.start;
+    }
+    return 0;
+}
+
+size_t tree2_addBestFit(RBTree2* tree, const size_t address, const size_t size) {
+    return tree2_addFit(tree, address, size, TREE2_FIT_BEST);
+}
+
+/**
+ * Updates free index and radix index after insertion of ascending 'nodes'.
+ */
+static void tree2_indexNodes(RBTree2* tree, RBTreeNode2* const* nodes, const size_t size) {
+    if (tree->freeIndex == true) {
+        tree2_reserveExtents(tree, nodes, size);
+    }
+    if (tree->radix != NULL) {
+        for(size_t i = 0; i < size && tree->radix != NULL; ++i) {
+            tree2_radixUpdate(tree, nodes[i]);
+        }
+    }
+}
+
+/**
+ * Moves 'area' to first free space at or after area's address not taken
+ * by areas of 'tree' nor by areas of 'placed'. Both searches return lowest
+ * suitable address not below given one, so alternating them converges to
+ * lowest address free in both trees (every round skips some conflicting area).
+ * Returns false if address space is exceeded.
+ */
+static bool tree2_fitFirstBoth(const ARBTree* tree, const ARBTree* placed, MemoryArea* area) {
+    while (true) {
+        tree2_fitFirst(tree, area);
+        const size_t start = area->start;
+        tree2_fitFirst(placed, area);
+        if (area->end < area->start) {
+            /// address space exceeded
+            return false;
+        }
+        if (area->start == start) {
+            return true;
+        }
+    }
+}
+
+/**
+ * Places requests in given order with first fit as 'tree2_addFit' would:
+ * every request is found by descent over largest gaps of reserved areas
+ * and of areas placed for previous requests, so placement takes O(log n + log k)
+ * per request. Placed areas are collected in 'placed' (sorted by address).
+ * Returns number of placed requests, unplaced ones are set to (0, 0).
+ */
+static size_t tree2_placeBatch(const RBTree2* tree, ARBTree* placed, MemoryArea* areas, const size_t size) {
+    size_t count = 0;
+    for(size_t i = 0; i < size; ++i) {
+        MemoryArea* area = &(areas[i]);
+        if (memory_size(area) == 0 || tree2_fitFirstBoth(&(tree->tree), placed, area) == false) {
+            /// empty request or address space exceeded
+            *area = memory_create(0, 0);
+            continue ;
+        }
+        RBTreeValue2 value;
+        value.area = *area;
+        value.flags = 0;
+        value.continued = 0;
+        if (rbtree_add(placed, &value) == false) {
+            /// out of memory
+            *area = memory_create(0, 0);
+            continue ;
+        }
+        ++count;
+    }
+    return count;
+}
+
+size_t tree2_addBatch(RBTree2* tree, MemoryArea* areas, const size_t size) {
+    if (tree == NULL || areas == NULL || size == 0) {
+        return 0;
+    }
+    ARBTree* baseTree = &(tree->tree);
+    ARBTreeValue* values = malloc( size * sizeof(ARBTreeValue) );
+    RBTreeNode2** nodes = malloc( size * sizeof(RBTreeNode2*) );
+    if (values == NULL || nodes == NULL) {
+        free(values);
+        free(nodes);
+        return 0;
+    }
+
+    /// placed areas are kept in separate tree augmented like the map
+    ARBTree placed;
+    rbtree_initInline(&placed, sizeof(RBTreeValue2));
+    rbtree_usePool(&placed);
+    placed.fIsLessOrder = tree2_checkOrder;
+    placed.fUpdateNode = tree2_updateNode;
+
+    const size_t count = tree2_placeBatch(tree, &placed, areas, size);
+
+    /// values of placed areas in address order
+    size_t index = 0;
+    bool added = true;
+    for(const RBTreeNode2* node = placed.leftmost; node != NULL; node = rbtree_nextNode(node)) {
+        if (baseTree->valueSize > 0) {
+            /// inline values -- value is copied to node
+            values[index] = node->value;
+        } else {
+            RBTreeValue2* value = malloc( sizeof(RBTreeValue2) );
+            if (value == NULL) {
+                added = false;
+                break;
+            }
+            *value = *(const RBTreeValue2*)node->value;
+            values[index] = value;
+        }
+        ++index;
+    }
+    assert( added == false || index == count );
+
+    if (added == true) {
+        added = rbtree_addSorted(baseTree, values, count, nodes);
+    }
+    rbtree_release(&placed);
+    if (added == false) {
+        /// out of memory -- none of requests is reserved
+        if (baseTree->valueSize == 0) {
+            for(size_t i = 0; i < index; ++i) {
+                free(values[i]);
+            }
+        }
+        for(size_t i = 0; i < size; ++i) {
+            areas[i] = memory_create(0, 0);
+        }
+        free(values);
+        free(nodes);
+        return 0;
+    }
+    tree2_indexNodes(tree, nodes, count);
+    /// as after reserving requests one by one
+    for(size_t i = size; i > 0; --i) {
+        if (memory_size(&(areas[i - 1])) > 0) {
+            tree->nextAddress = areas[i - 1].end;
+            break;
+        }
+    }
+
+    free(values);
+    free(nodes);
+    return count;
+}
+
+bool tree2_buildFromSorted(RBTree2* tree, const MemoryArea* areas, const size_t size) {
+    if (tree == NULL) {
+        return false;
+    }
+    ARBTree* baseTree = &(tree->tree);
+    if (baseTree->root != NULL) {
+        return false;
+    }
+    if (areas == NULL || size == 0) {
+        return true;
+    }
+    for(size_t i = 0; i < size; ++i) {
+        if (areas[i].start >= areas[i].end) {
+            return false;
+        }
+        if (i > 0 && areas[i - 1].end > areas[i].start) {
+            /// not sorted or overlapping
+            return false;
+        }
+    }
+
+    ARBTreeValue* values = malloc( size * sizeof(ARBTreeValue) );
+    RBTreeNode2** nodes = malloc( size * sizeof(RBTreeNode2*) );
+    RBTreeValue2* inlineValues = (baseTree->valueSize > 0) ? malloc( size * sizeof(RBTreeValue2) ) : NULL;
+    if (values == NULL || nodes == NULL || (baseTree->valueSize > 0 && inlineValues == NULL)) {
+        free(values);
+        free(nodes);
+        free(inlineValues);
+        return false;
+    }
+    size_t index = 0;
+    for(; index < size; ++index) {
+        RBTreeValue2* value = (inlineValues != NULL) ? &(inlineValues[index]) : malloc( sizeof(RBTreeValue2) );
+        if (value == NULL) {
+            break;
+        }
+        value->area = areas[index];
+        value->flags = 0;
+        value->continued = 0;
+        values[index] = value;
+    }
+
+    if (index < size || rbtree_addSorted(baseTree, values, size, nodes) == false) {
+        /// out of memory -- tree stays empty
+        if (inlineValues == NULL) {
+            for(size_t i = 0; i < index; ++i) {
+                free(values[i]);
+            }
+        }
+        free(values);
+        free(nodes);
+        free(inlineValues);
+        return false;
+    }
+    tree2_indexNodes(tree, nodes, size);
+    tree->nextAddress = areas[size - 1].end;
+
+    free(values);
+    free(nodes);
+    free(inlineValues);
+    return true;
+}
+
+/**
+ * Checks if area of 'node' belongs to block of many pieces.
+ */
+static inline bool tree2_isPiece(const RBTreeNode2* node) {
+    if (((const RBTreeValue2*)node->value)->continued != 0) {
+        return true;
+    }
+    const RBTreeNode2* next = rbtree_nextNode(node);
+    return (next != NULL && ((const RBTreeValue2*)next->value)->continued != 0);
+}
+
+/**
+ * Returns address range of block containing area of 'node' (all its pieces).
+ */
+static MemoryArea tree2_blockArea(const RBTreeNode2* node) {
+    const RBTreeNode2* first = node;
+    while (((const RBTreeValue2*)first->value)->continued != 0) {
+        first = rbtree_prevNode(first);
+    }
+    const RBTreeNode2* last = node;
+    const RBTreeNode2* next = rbtree_nextNode(last);
+    while (next != NULL && ((const RBTreeValue2*)next->value)->continued != 0) {
+        last = next;
+        next = rbtree_nextNode(last);
+    }
+    MemoryArea block;
+    block.start = tree2_nodeArea(first)->start;
+    block.end = tree2_nodeArea(last)->end;
+    return block;
+}
+
+void tree2_delete(RBTree2* tree, const size_t address) {
+    if (tree == NULL) {
+        return ;
+    }
+    ARBTree* baseTree = &(tree->tree);
+    if (tree->pieces > 0) {
+        const RBTreeNode2* found = tree2_findNode(tree, address);
+        if (found != NULL && tree2_isPiece(found) == true) {
+            /// block split by protection -- remove all its pieces
+            const MemoryArea block = tree2_blockArea(found);
+            tree2_deleteRange(tree, block.start, block.end);
+            return ;
+        }
+    }
+
+    MemoryArea area = memory_create(address, 1);
+    const ARBTreeValue v = (ARBTreeValue)&area;
+    if (tree->freeIndex == false && tree->radix == NULL) {
+        tree2_typed_deleteValue(baseTree, v);
+        return ;
+    }
+
+    RBTreeNode2* node = (tree->radix != NULL) ? (RBTreeNode2*)tree2_radixFind(tree, address) : tree2_typed_findNode(baseTree, v);
+    if (node == NULL) {
+        return ;
+    }
+    /// neighbours' values can be moved by deletion -- copy addresses
+    const MemoryArea removed = *(const MemoryArea*)node->value;
+    const RBTreeNode2* prev = rbtree_prevNode(node);
+    const RBTreeNode2* next = rbtree_nextNode(node);
+    const size_t prevEnd = (prev != NULL) ? ((const MemoryArea*)prev->value)->end : 0;
+    const size_t nextStart = (next != NULL) ? ((const MemoryArea*)next->value)->start : 0;
+
+    if (tree->radix != NULL) {
+        tree2_radixRemove(tree, node, next);
+    }
+
+    /// node with both children takes value of its successor
+    const RBTreeNode2* moved = (node->left != NULL && node->right != NULL) ? next : NULL;
+    rbtree_deleteNode(baseTree, node);
+    if (moved != NULL && tree->radix != NULL) {
+        tree2_radixReplace(tree, node, moved);
+    }
+
+    if (tree->freeIndex == false) {
+        return ;
+    }
+
+    /// merge free spaces around removed area
+    ARBTree* freeTree = &(tree->freeTree);
+    if (prev != NULL) {
+        tree2_deleteExtent(freeTree, prevEnd, removed.start);
+    }
+    if (next != NULL) {
+        tree2_deleteExtent(freeTree, removed.end, nextStart);
+    }
+    if (prev != NULL && next != NULL) {
+        tree2_addExtent(freeTree, prevEnd, nextStart);
+    }
+}
+
+
+/**
+ * Shrinks area of 'node' to (start, end). Order of areas does not change,
+ * so node stays in place and only augmented data and indexes are updated.
+ */
+static void tree2_trimArea(RBTree2* tree, RBTreeNode2* node, const size_t start, const size_t end) {
+    MemoryArea* area = (MemoryArea*)node->value;
+    const RBTreeNode2* prev = rbtree_prevNode(node);
+    const RBTreeNode2* next = rbtree_nextNode(node);
+    const size_t prevEnd = (prev != NULL) ? tree2_nodeArea(prev)->end : 0;
+    const size_t nextStart = (next != NULL) ? tree2_nodeArea(next)->start : 0;
+    ARBTree* freeTree = &(tree->freeTree);
+
+    if (tree->radix != NULL) {
+        tree2_radixRemove(tree, node, next);
+    }
+    if (tree->freeIndex == true) {
+        if (prev != NULL) {
+            tree2_deleteExtent(freeTree, prevEnd, area->start);
+        }
+        if (next != NULL) {
+            tree2_deleteExtent(freeTree, area->end, nextStart);
+        }
+    }
+
+    *area = memory_create(start, end - start);
+    rbtree_refreshValue(&(tree->tree), node);
+
+    if (tree->radix != NULL) {
+        tree2_radixUpdate(tree, node);
+    }
+    if (tree->freeIndex == true) {
+        if (prev != NULL) {
+            tree2_addExtent(freeTree, prevEnd, area->start);
+        }
+        if (next != NULL) {
+            tree2_addExtent(freeTree, area->end, nextStart);
+        }
+    }
+}
+
+/**
+ * Removes indexes of ascending nodes of 'middle' cut out of tree between
+ * 'prev' and 'next' areas (NULL if there is no such area).
+ */
+static void tree2_unindexNodes(RBTree2* tree, const ARBTree* middle, const RBTreeNode2* prev, const RBTreeNode2* next) {
+    ARBTree* freeTree = &(tree->freeTree);
+    size_t lastEnd = (prev != NULL) ? tree2_nodeArea(prev)->end : 0;
+    bool hasLast = (prev != NULL);
+    const RBTreeNode2* node = middle->leftmost;
+    while (node != NULL) {
+        const RBTreeNode2* following = rbtree_nextNode(node);
+        const MemoryArea* area = tree2_nodeArea(node);
+        if (tree->radix != NULL) {
+            tree2_radixRemove(tree, node, (following != NULL) ? following : next);
+        }
+        if (tree->freeIndex == true && hasLast == true) {
+            tree2_deleteExtent(freeTree, lastEnd, area->start);
+        }
+        lastEnd = area->end;
+        hasLast = true;
+        node = following;
+    }
+    if (tree->freeIndex == false) {
+        return ;
+    }
+    if (next != NULL) {
+        tree2_deleteExtent(freeTree, lastEnd, tree2_nodeArea(next)->start);
+    }
+    if (prev != NULL && next != NULL) {
+        tree2_addExtent(freeTree, tree2_nodeArea(prev)->end, tree2_nodeArea(next)->start);
+    }
+}
+
+size_t tree2_deleteRange(RBTree2* tree, const size_t start, const size_t end) {
+    if (tree == NULL || start >= end) {
+        return 0;
+    }
+    ARBTree* baseTree = &(tree->tree);
+
+    /// trim areas crossing bounds of range
+    RBTreeNode2* node = tree2_findNode(tree, start);
+    if (node != NULL && tree2_nodeArea(node)->start < start) {
+        const MemoryArea area = *tree2_nodeArea(node);
+        const unsigned char flags = ((const RBTreeValue2*)node->value)->flags;
+        tree2_trimArea(tree, node, area.start, start);
+        if (area.end > end) {
+            /// range inside area -- area is split in two
+            const MemoryArea tail = memory_create(end, area.end - end);
+            tree2_insertArea(tree, &tail, flags);
+            return 0;
+        }
+    }
+    node = tree2_findNode(tree, end - 1);
+    if (node != NULL && tree2_nodeArea(node)->end > end) {
+        const MemoryArea area = *tree2_nodeArea(node);
+        tree2_trimArea(tree, node, end, area.end);
+    }
+
+    /// cut out areas inside range: split before range and after range
+    ARBTree middle;
+    ARBTree rest;
+    MemoryArea bound = memory_create(start, 0);
+    rbtree_split(baseTree, &bound, baseTree, &rest);
+    bound = memory_create(end, 0);
+    rbtree_split(&rest, &bound, &middle, &rest);
+
+    const RBTreeNode2* prev = baseTree->rightmost;
+    RBTreeNode2* next = rest.leftmost;
+    const size_t removed = rbtree_size(&middle);
+    if (removed > 0) {
+        tree2_unindexNodes(tree, &middle, prev, next);
+    }
+    if (tree->pieces > 0) {
+        for(const RBTreeNode2* curr = middle.leftmost; curr != NULL; curr = rbtree_nextNode(curr)) {
+            tree->pieces -= ((const RBTreeValue2*)curr->value)->continued;
+        }
+        RBTreeValue2* nextValue = (next != NULL) ? (RBTreeValue2*)next->value : NULL;
+        if (nextValue != NULL && nextValue->continued != 0 && (prev == NULL || tree2_nodeArea(prev)->end != nextValue->area.start)) {
+            /// preceding piece is gone -- area starts new block
+            nextValue->continued = 0;
+            --(tree->pieces);
+        }
+    }
+
+    rbtree_concat(baseTree, &rest);
+    rbtree_release(&middle);
+    return removed;
+}
+
+
+/**
+ * Splits area containing 'address' in two at 'address' if protection
+ * of the area differs from 'flags'. Both parts keep protection of area,
+ * second part becomes piece of block of the first one.
+ */
+static void tree2_splitAreaAt(RBTree2* tree, const size_t address, const unsigned char flags) {
+    RBTreeNode2* node = tree2_findNode(tree, address);
+    if (node == NULL) {
+        return ;
+    }
+    const RBTreeValue2* value = (const RBTreeValue2*)node->value;
+    if (value->area.start == address || value->flags == flags) {
+        return ;
+    }
+    const MemoryArea area = value->area;
+    const unsigned char areaFlags = value->flags;
+    tree2_trimArea(tree, node, area.start, address);
+    const MemoryArea tail = memory_create(address, area.end - address);
+    tree2_insertArea(tree, &tail, areaFlags);
+    RBTreeNode2* tailNode = tree2_findNode(tree, address);
+    assert( tailNode != NULL );
+    ((RBTreeValue2*)tailNode->value)->continued = 1;
+    ++(tree->pieces);
+}
+
+/**
+ * Merges piece following 'node' into area of 'node'.
+ * Free space does not change, so only radix index is updated.
+ */
+static void tree2_mergeNext(RBTree2* tree, ARBTree* baseTree, RBTreeNode2* node) {
+    RBTreeNode2* next = (RBTreeNode2*)rbtree_nextNode(node);
+    assert( next != NULL );
+    const RBTreeNode2* after = rbtree_nextNode(next);
+    if (tree->radix != NULL) {
+        tree2_radixRemove(tree, next, after);
+        tree2_radixRemove(tree, node, after);
+    }
+    const size_t end = tree2_nodeArea(next)->end;
+
+    /// node with both children takes value of its successor
+    const RBTreeNode2* moved = (next->left != NULL && next->right != NULL) ? after : NULL;
+    rbtree_deleteNode(baseTree, next);
+    if (moved != NULL && tree->radix != NULL) {
+        tree2_radixReplace(tree, next, moved);
+    }
+    --(tree->pieces);
+
+    MemoryArea* area = (MemoryArea*)node->value;
+    area->end = end;
+    rbtree_refreshValue(baseTree, node);
+    if (tree->radix != NULL) {
+        tree2_radixUpdate(tree, node);
+    }
+}
+
+/**
+ * Checks if area following 'node' is piece of the same block and has the same protection.
+ * Separately reserved blocks are never merged.
+ */
+static inline bool tree2_canMergeNext(const RBTreeNode2* node) {
+    const RBTreeNode2* next = rbtree_nextNode(node);
+    if (next == NULL) {
+        return false;
+    }
+    const RBTreeValue2* value = (const RBTreeValue2*)node->value;
+    const RBTreeValue2* nextValue = (const RBTreeValue2*)next->value;
+    return (nextValue->continued != 0 && value->flags == nextValue->flags);
+}
+
+int tree2_protect(RBTree2* tree, const size_t start, const size_t end, const unsigned int flags) {
+    if (tree == NULL || start >= end) {
+        return 0;
+    }
+    if (tree2_isReserved(tree, start, end) == false) {
+        /// range contains free space -- nothing is changed
+        return -1;
+    }
+    ARBTree* baseTree = &(tree->tree);
+    const unsigned char protection = (unsigned char)(flags & TREE2_FLAGS_MASK);
+
+    /// split areas crossing bounds of range
+    tree2_splitAreaAt(tree, start, protection);
+    tree2_splitAreaAt(tree, end, protection);
+
+    /// cut out areas intersecting range: split before range and after range
+    ARBTree middle;
+    ARBTree rest;
+    MemoryArea bound = memory_create(start, 0);
+    rbtree_split(baseTree, &bound, baseTree, &rest);
+    bound = memory_create(end, 0);
+    rbtree_split(&rest, &bound, &middle, &rest);
+
+    const int changed = (int)rbtree_size(&middle);
+    if (changed == 0) {
+        rbtree_concat(baseTree, &rest);
+        return 0;
+    }
+
+    /// set protection and recalculate aggregates in one pass
+    for(RBTreeNode2* node = middle.leftmost; node != NULL; node = (RBTreeNode2*)rbtree_nextNode(node)) {
+        ((RBTreeValue2*)node->value)->flags = protection;
+    }
+    rbtree_refreshTree(&middle);
+
+    /// merge touching areas inside range
+    RBTreeNode2* node = middle.leftmost;
+    while (node != NULL) {
+        if (tree2_canMergeNext(node) == true) {
+            tree2_mergeNext(tree, &middle, node);
+        } else {
+            node = (RBTreeNode2*)rbtree_nextNode(node);
+        }
+    }
+
+    /// join back and merge with touching neighbours of range
+    RBTreeNode2* first = middle.leftmost;
+    RBTreeNode2* last = middle.rightmost;
+    rbtree_concat(baseTree, &middle);
+    rbtree_concat(baseTree, &rest);
+    if (tree2_canMergeNext(last) == true) {
+        tree2_mergeNext(tree, baseTree, last);
+    }
+    RBTreeNode2* prev = (RBTreeNode2*)rbtree_prevNode(first);
+    if (prev != NULL && tree2_canMergeNext(prev) == true) {
+        tree2_mergeNext(tree, baseTree, prev);
+    }
+    return changed;
+}
+
+
+/// ==============================================================================================
+
+
+void tree2_print(const RBTree2* tree) {
+    if (tree == NULL) {
+        printf("%s", "[NULL]");
+        return ;
+    }
+    const ARBTree* baseTree = &(tree->tree);
+    rbtree_print(baseTree);
+}
+
+
+/// ==============================================================================================
+
+
+bool tree2_release(RBTree2* tree) {
+    if (tree == NULL) {
+        return false;
+    }
+    rbtree_release(&(tree->freeTree));
+    tree2_radixRelease(tree);
+    tree->nextAddress = 0;
+    tree->pieces = 0;
+    ARBTree* baseTree = &(tree->tree);
+    return rbtree_release(baseTree);
+}
+
+
+/// ===================================================
+
+
+void* tree2_mmap(RBTree2* tree, void *vaddr, unsigned int size) {
+    if (tree==NULL)
+        return NULL;
+    ARBTree* baseTree = &(tree->tree);
+    if (baseTree==NULL)
+        return NULL;
+
+    MemoryArea area = memory_create((size_t)vaddr, size);
+    if (tree2_addArea(tree, &area, tree->policy, 0) == true) {
+        return (void*)area.start;
+    }
+    return NULL;
+}
+
+void* tree2_mmapFit(RBTree2* tree, void *vaddr, unsigned int size, const RBTree2Policy policy) {
+    return tree2_mmapFlags(tree, vaddr, size, policy, 0);
+}
+
+void* tree2_mmapFlags(RBTree2* tree, void *vaddr, unsigned int size, const RBTree2Policy policy, const unsigned int flags) {
+    if (tree==NULL)
+        return NULL;
+
+    MemoryArea area = memory_create((size_t)vaddr, size);
+    if (tree2_addArea(tree, &area, policy, (unsigned char)(flags & TREE2_FLAGS_MASK)) == true) {
+        return (void*)area.start;
+    }
+    return NULL;
+}
+
+void* tree2_mmapBestFit(RBTree2* tree, void *vaddr, unsigned int size) {
+    return tree2_mmapFit(tree, vaddr, size, TREE2_FIT_BEST);
+}
+
+void tree2_munmap(RBTree2* tree, void *vaddr) {
     const size_t voffset = (size_t)vaddr;
     tree2_delete(tree, voffset);
     assert( tree2_isValid(tree) == ARBTREE_INVALID_OK );
 }
 
 bool tree2_init(RBTree2* tree) {
+    if (tree2_initLayout(tree, TREE2_LAYOUT_INLINE) == false) {
+        return false;
+    }
+    return tree2_usePool(tree);
+}
+
+bool tree2_usePool(RBTree2* tree) {
+    if (tree == NULL) {
+        return false;
+    }
+    ARBTree* baseTree = &(tree->tree);
+    if (baseTree->root != NULL) {
+        return false;
+    }
+    rbtree_usePool(baseTree);
+    return true;
+}
+
+bool tree2_useFreeIndex(RBTree2* tree) {
+    if (tree == NULL) {
+        return false;
+    }
+    if (tree->freeIndex == true) {
+        return true;
+    }
+    /// build index from reserved areas
+    const RBTreeNode2* curr = tree->tree.leftmost;
+    while (curr != NULL) {
+        const RBTreeNode2* next = rbtree_nextNode(curr);
+        if (next == NULL) {
+            break;
+        }
+        tree2_addExtent(&(tree->freeTree), ((const MemoryArea*)curr->value)->end, ((const MemoryArea*)next->value)->start);
+        curr = next;
+    }
+    tree->freeIndex = true;
+    return true;
+}
+
+bool tree2_useFinger(RBTree2* tree) {
+    if (tree == NULL) {
+        return false;
+    }
+    rbtree_useFinger(&(tree->tree));
+    return true;
+}
+
+bool tree2_useRadixIndex(RBTree2* tree) {
+    if (tree == NULL) {
+        return false;
+    }
+    if (tree->radix != NULL) {
+        return true;
+    }
+    tree->radix = calloc(1, sizeof(RBTree2RadixTable));
+    if (tree->radix == NULL) {
+        return false;
+    }
+    /// index reserved areas
+    const RBTreeNode2* curr = tree->tree.leftmost;
+    while (curr != NULL) {
+        if (tree2_radixInsert(tree, curr) == false) {
+            tree2_radixRelease(tree);
+            return false;
+        }
+        curr = rbtree_nextNode(curr);
+    }
+    return true;
+}
+
+bool tree2_setPolicy(RBTree2* tree, const RBTree2Policy policy) {
+    if (tree == NULL) {
+        return false;
+    }
+    switch(policy) {
+    case TREE2_FIT_FIRST:
+    case TREE2_FIT_NEXT:
+    case TREE2_FIT_TOP_DOWN: {
+        break;
+    }
+    case TREE2_FIT_BEST: {
+        tree2_useFreeIndex(tree);
+        break;
+    }
+    default: {
+        return false;
+    }
+    }
+    tree->policy = policy;
+    return true;
+}
+
+bool tree2_setTopAddress(RBTree2* tree, const size_t address) {
+    if (tree == NULL) {
+        return false;
+    }
+    if (address == 0) {
+        return false;
+    }
+    tree->topAddress = address;
+    return true;
+}
+
+bool tree2_initLayout(RBTree2* tree, const RBTree2Layout layout) {
     if (tree == NULL) {
         return false;
     }
 
     ARBTree* baseTree = &(tree->tree);
-    rbtree_init(baseTree);
+    switch(layout) {
+    case TREE2_LAYOUT_INLINE: {
+        rbtree_initInline(baseTree, sizeof(RBTreeValue2));
+        break;
+    }
+    case TREE2_LAYOUT_EXTERNAL: {
+        rbtree_init(baseTree);
+        break;
+    }
+    default: {
+        return false;
+    }
+    }
 
     baseTree->fIsLessOrder = tree2_checkOrder;
 
     baseTree->fTryFitRight = tree2_tryFitRight;
     baseTree->fTryFitLeft = tree2_tryFitLeft;
 
+    baseTree->fUpdateNode = tree2_updateNode;
+
     baseTree->fPrintValue = tree2_printValue;
-    baseTree->fDeleteValue = tree2_freeValue;
+    if (layout == TREE2_LAYOUT_EXTERNAL) {
+        baseTree->fDeleteValue = tree2_freeValue;
+    }
+
+    ARBTree* freeTree = &(tree->freeTree);
+    rbtree_initInline(freeTree, sizeof(MemoryArea));
+    freeTree->fIsLessOrder = tree2_checkExtentOrder;
+    freeTree->fPrintValue = tree2_printValue;
+    tree->freeIndex = false;
+    tree->policy = TREE2_FIT_FIRST;
+    tree->topAddress = TREE2_DEFAULT_TOP_ADDRESS;
+    tree->nextAddress = 0;
+    tree->radix = NULL;
+    tree->pieces = 0;
 
     return true;
 }
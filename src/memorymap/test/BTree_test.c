@@ -0,0 +1,347 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#include "memorymap/BTree.h"
+
+#include <time.h>
+#include <stdlib.h>
+#include <stdio.h>                              /// printf
+
+/// for cmocka to mock system functions
+#define UNIT_TESTING 1
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+
+
+static unsigned int current_seed = 0;
+
+static unsigned int get_next_seed() {
+    if (current_seed == 0) {
+        srand( time(NULL) );
+        current_seed = rand();
+    }
+    return (++current_seed);
+}
+
+static BTree create_default_tree(const size_t nodes) {
+    BTree tree;
+    btree_init(&tree);
+
+    for(size_t i = 0; i < nodes; ++i) {
+        btree_add(&tree, i+1, 1);
+    }
+
+    return tree;
+}
+
+
+/// ======================================================
+
+
+static void test_btree_init_NULL(void **state) {
+    (void) state; /* unused */
+
+    const bool ret = btree_init(NULL);
+    assert_int_equal( ret, false );
+}
+
+static void test_btree_init_valid(void **state) {
+    (void) state; /* unused */
+
+    BTree tree;
+    const bool ret = btree_init(&tree);
+    assert_int_equal( ret, true );
+    assert_int_equal( btree_size(&tree), 0 );
+    assert_int_equal( btree_depth(&tree), 0 );
+    assert_int_equal( btree_isValid(&tree), BTREE_INVALID_OK );
+
+    btree_release(&tree);
+}
+
+
+/// ======================================================
+
+
+static void test_btree_add_NULL(void **state) {
+    (void) state; /* unused */
+
+    const size_t ret = btree_add(NULL, 3, 1);
+    assert_int_equal( ret, 0 );
+}
+
+static void test_btree_add_0(void **state) {
+    (void) state; /* unused */
+
+    BTree tree;
+    btree_init(&tree);
+
+    const size_t retAddr = btree_add(&tree, 0, 1);
+    assert_int_equal( retAddr, 0 );
+
+    assert_int_equal( btree_size(&tree), 1 );
+    assert_int_equal( btree_depth(&tree), 1 );
+    assert_int_equal( btree_isValid(&tree), BTREE_INVALID_OK );
+
+    btree_release(&tree);
+}
+
+static void test_btree_add_overlap(void **state) {
+    (void) state; /* unused */
+
+    BTree tree;
+    btree_init(&tree);
+
+    assert_int_equal( btree_add(&tree, 10, 10), 10 );
+    assert_int_equal( btree_add(&tree, 30, 10), 30 );
+    /// too big for gap -- goes after last area
+    assert_int_equal( btree_add(&tree, 15, 11), 40 );
+    /// fits into gap
+    assert_int_equal( btree_add(&tree, 15, 10), 20 );
+    /// before first area
+    assert_int_equal( btree_add(&tree, 2, 8), 2 );
+
+    assert_int_equal( btree_size(&tree), 5 );
+    assert_int_equal( btree_startAddress(&tree), 2 );
+    assert_int_equal( btree_endAddress(&tree), 51 );
+    assert_int_equal( btree_isValid(&tree), BTREE_INVALID_OK );
+
+    btree_release(&tree);
+}
+
+static void test_btree_add_split(void **state) {
+    (void) state; /* unused */
+
+    const size_t nodes = BTREE_LEAF_CAPACITY * BTREE_INNER_CAPACITY * 2;
+    BTree tree = create_default_tree(nodes);
+
+    assert_int_equal( btree_size(&tree), nodes );
+    assert_int_equal( btree_depth(&tree), 3 );
+    assert_int_equal( btree_startAddress(&tree), 1 );
+    assert_int_equal( btree_endAddress(&tree), nodes + 1 );
+    assert_int_equal( btree_isValid(&tree), BTREE_INVALID_OK );
+
+    btree_release(&tree);
+}
+
+static void test_btree_mmap_fragmented(void **state) {
+    (void) state; /* unused */
+
+    BTree tree;
+    btree_init(&tree);
+
+    /// blocks of size 10 with gaps: 2, 4, 6, ...
+    size_t addr = 100;
+    for(size_t i = 1; i <= 200; ++i) {
+        btree_mmap(&tree, (void*)addr, 10);
+        addr += 10 + 2*i;
+    }
+    assert_int_equal( btree_depth(&tree), 2 );
+
+    /// gap of size 12 is after 6th block
+    const void* ret = btree_mmap(&tree, (void*)100, 11);
+    assert_int_equal( ret, 100 + 6*10 + 2+4+6+8+10 );
+
+    /// hint inside gap of size 20
+    const size_t gapStart = 100 + 10*10 + 2+4+6+8+10+12+14+16+18;
+    ret = btree_mmap(&tree, (void*)(gapStart + 5), 15);
+    assert_int_equal( ret, gapStart + 5 );
+
+    /// no gap big enough -- goes after last block
+    ret = btree_mmap(&tree, (void*)100, 1000);
+    assert_int_equal( ret, btree_endAddress(&tree) - 1000 );
+
+    assert_int_equal( btree_size(&tree), 203 );
+    assert_int_equal( btree_isValid(&tree), BTREE_INVALID_OK );
+
+    btree_release(&tree);
+}
+
+
+/// ======================================================
+
+
+static void test_btree_delete_badaddr(void **state) {
+    (void) state; /* unused */
+
+    BTree tree;
+    btree_init(&tree);
+    btree_delete(&tree, 10);
+
+    btree_add(&tree, 10, 10);
+    btree_delete(&tree, 5);
+    btree_delete(&tree, 20);
+    assert_int_equal( btree_size(&tree), 1 );
+
+    btree_delete(&tree, 19);
+    assert_int_equal( btree_size(&tree), 0 );
+    assert_int_equal( btree_depth(&tree), 0 );
+    assert_int_equal( btree_isValid(&tree), BTREE_INVALID_OK );
+
+    btree_release(&tree);
+}
+
+static void test_btree_delete_all(void **state) {
+    (void) state; /* unused */
+
+    const size_t nodes = BTREE_LEAF_CAPACITY * BTREE_INNER_CAPACITY * 2;
+    BTree tree = create_default_tree(nodes);
+
+    /// remove every second area, then the rest
+    for(size_t i = 1; i <= nodes; i += 2) {
+        btree_delete(&tree, i);
+        assert_int_equal( btree_isValid(&tree), BTREE_INVALID_OK );
+    }
+    assert_int_equal( btree_size(&tree), nodes / 2 );
+    for(size_t i = 2; i <= nodes; i += 2) {
+        btree_delete(&tree, i);
+        assert_int_equal( btree_isValid(&tree), BTREE_INVALID_OK );
+    }
+
+    assert_int_equal( btree_size(&tree), 0 );
+    assert_int_equal( btree_depth(&tree), 0 );
+    assert_null( tree.root );
+
+    btree_release(&tree);
+}
+
+static void test_btree_delete_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    BTree tree;
+    btree_init(&tree);
+    for(size_t i = 0; i < 2000; ++i) {
+        btree_add(&tree, rand() % 10000 + 1, rand() % 20 + 1);
+    }
+    assert_int_equal( btree_isValid(&tree), BTREE_INVALID_OK );
+
+    const MemoryArea area = btree_area(&tree);
+    while( btree_size(&tree) > 0 ) {
+        const size_t addr = rand() % memory_size(&area) + area.start;
+        btree_delete(&tree, addr);
+        if ( btree_isValid(&tree) != BTREE_INVALID_OK ) {
+            fail_msg("invalid tree for seed %u", seed);
+        }
+    }
+
+    btree_release(&tree);
+}
+
+
+/// ======================================================
+
+
+static void test_btree_area_empty(void **state) {
+    (void) state; /* unused */
+
+    const MemoryArea areaNull = btree_area(NULL);
+    assert_int_equal( memory_size(&areaNull), 0 );
+
+    BTree tree;
+    btree_init(&tree);
+
+    const MemoryArea area = btree_area(&tree);
+    assert_int_equal( area.start, 0 );
+    assert_int_equal( area.end, 0 );
+    assert_int_equal( btree_startAddress(&tree), 0 );
+    assert_int_equal( btree_endAddress(&tree), 0 );
+
+    btree_release(&tree);
+}
+
+static void test_btree_valueByIndex(void **state) {
+    (void) state; /* unused */
+
+    const size_t nodes = 1000;
+    BTree tree = create_default_tree(nodes);
+
+    for(size_t i = 0; i < nodes; ++i) {
+        const MemoryArea area = btree_valueByIndex(&tree, i);
+        assert_int_equal( area.start, i + 1 );
+        assert_int_equal( area.end, i + 2 );
+    }
+
+    const MemoryArea outside = btree_valueByIndex(&tree, nodes);
+    assert_int_equal( memory_size(&outside), 0 );
+
+    btree_release(&tree);
+}
+
+
+/// ======================================================
+
+
+static void test_btree_release_NULL(void **state) {
+    (void) state; /* unused */
+
+    const bool ret = btree_release(NULL);
+    assert_int_equal( ret, false );
+}
+
+static void test_btree_release_double(void **state) {
+    (void) state; /* unused */
+
+    BTree tree = create_default_tree(100);
+
+    assert_int_equal( btree_release(&tree), true );
+    assert_int_equal( btree_release(&tree), true );
+    assert_int_equal( btree_size(&tree), 0 );
+}
+
+
+/// ==================================================
+
+
+int main(void) {
+
+    //TODO: add selective run
+
+    const struct UnitTest tests[] = {
+        unit_test(test_btree_init_NULL),
+        unit_test(test_btree_init_valid),
+
+        unit_test(test_btree_add_NULL),
+        unit_test(test_btree_add_0),
+        unit_test(test_btree_add_overlap),
+        unit_test(test_btree_add_split),
+        unit_test(test_btree_mmap_fragmented),
+
+        unit_test(test_btree_delete_badaddr),
+        unit_test(test_btree_delete_all),
+        unit_test(test_btree_delete_random),
+
+        unit_test(test_btree_area_empty),
+        unit_test(test_btree_valueByIndex),
+
+        unit_test(test_btree_release_NULL),
+        unit_test(test_btree_release_double),
+    };
+
+    return run_group_tests(tests);
+}
@@ -0,0 +1,389 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#include "memorymap/Bitmap.h"
+
+#include <time.h>
+#include <stdlib.h>
+#include <stdio.h>                              /// printf
+
+/// for cmocka to mock system functions
+#define UNIT_TESTING 1
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+
+
+static unsigned int current_seed = 0;
+
+static unsigned int get_next_seed() {
+    if (current_seed == 0) {
+        srand( time(NULL) );
+        current_seed = rand();
+    }
+    return (++current_seed);
+}
+
+
+/// ======================================================
+
+
+static void test_bitmap_init_NULL(void **state) {
+    (void) state; /* unused */
+
+    assert_int_equal( bitmap_init(NULL, 1), false );
+
+    BitmapMap map;
+    assert_int_equal( bitmap_init(&map, 0), false );
+}
+
+static void test_bitmap_initRegion_invalid(void **state) {
+    (void) state; /* unused */
+
+    BitmapMap map;
+    assert_int_equal( bitmap_initRegion(NULL, 0x1000, 0x1000, 16), false );
+    assert_int_equal( bitmap_initRegion(&map, 0x1000, 0x1000, 0), false );
+    /// not aligned
+    assert_int_equal( bitmap_initRegion(&map, 0x1000, 0x1800, 16), false );
+    /// exceeds address space
+    assert_int_equal( bitmap_initRegion(&map, 0x1000, 0x1000, BITMAP_NO_ADDRESS / 0x1000), false );
+}
+
+static void test_bitmap_init_valid(void **state) {
+    (void) state; /* unused */
+
+    BitmapMap map;
+    const bool ret = bitmap_init(&map, BITMAP_DEFAULT_GRANULARITY);
+    assert_int_equal( ret, true );
+    assert_int_equal( bitmap_size(&map), 0 );
+    assert_int_equal( bitmap_startAddress(&map), 0 );
+    assert_int_equal( bitmap_endAddress(&map), 0 );
+    assert_int_equal( bitmap_isValid(&map), BITMAP_INVALID_OK );
+
+    bitmap_release(&map);
+}
+
+
+/// ======================================================
+
+
+static void test_bitmap_add_NULL(void **state) {
+    (void) state; /* unused */
+
+    assert_int_equal( bitmap_add(NULL, 3, 1), BITMAP_NO_ADDRESS );
+
+    BitmapMap map;
+    bitmap_init(&map, 1);
+    assert_int_equal( bitmap_add(&map, 3, 0), BITMAP_NO_ADDRESS );
+    assert_int_equal( bitmap_size(&map), 0 );
+    bitmap_release(&map);
+}
+
+static void test_bitmap_add_overlap(void **state) {
+    (void) state; /* unused */
+
+    BitmapMap map;
+    bitmap_init(&map, 1);
+
+    assert_int_equal( bitmap_add(&map, 10, 10), 10 );
+    assert_int_equal( bitmap_add(&map, 30, 10), 30 );
+    /// too big for gap -- goes after last area
+    assert_int_equal( bitmap_add(&map, 15, 11), 40 );
+    /// fits into gap
+    assert_int_equal( bitmap_add(&map, 15, 10), 20 );
+    /// before first area
+    assert_int_equal( bitmap_add(&map, 2, 8), 2 );
+
+    assert_int_equal( bitmap_size(&map), 5 );
+    assert_int_equal( bitmap_startAddress(&map), 2 );
+    assert_int_equal( bitmap_endAddress(&map), 51 );
+    assert_int_equal( bitmap_isValid(&map), BITMAP_INVALID_OK );
+
+    bitmap_release(&map);
+}
+
+static void test_bitmap_add_granularity(void **state) {
+    (void) state; /* unused */
+
+    BitmapMap map;
+    bitmap_init(&map, 0x1000);
+
+    /// address and size rounded up to pages
+    assert_int_equal( bitmap_add(&map, 0x1000, 0x1000), 0x1000 );
+    assert_int_equal( bitmap_add(&map, 0x1001, 1), 0x2000 );
+    assert_int_equal( bitmap_add(&map, 0x1000, 0x1001), 0x3000 );
+
+    assert_int_equal( bitmap_endAddress(&map), 0x5000 );
+    assert_int_equal( bitmap_size(&map), 3 );
+
+    /// any address inside block
+    bitmap_delete(&map, 0x4fff);
+    assert_int_equal( bitmap_endAddress(&map), 0x3000 );
+    assert_int_equal( bitmap_size(&map), 2 );
+
+    bitmap_release(&map);
+}
+
+/**
+ * Blocks spanning many words.
+ */
+static void test_bitmap_add_words(void **state) {
+    (void) state; /* unused */
+
+    BitmapMap map;
+    bitmap_init(&map, 1);
+
+    assert_int_equal( bitmap_add(&map, 1, 500), 1 );
+    assert_int_equal( bitmap_add(&map, 600, 1000), 600 );
+    /// gap of 99 bytes is too small
+    assert_int_equal( bitmap_add(&map, 1, 100), 1600 );
+    assert_int_equal( bitmap_add(&map, 1, 99), 501 );
+    assert_int_equal( bitmap_add(&map, 1, 1), 1700 );
+
+    assert_int_equal( bitmap_size(&map), 5 );
+    assert_int_equal( bitmap_isValid(&map), BITMAP_INVALID_OK );
+
+    /// adjacent blocks stay separate
+    bitmap_delete(&map, 1700);
+    assert_int_equal( bitmap_endAddress(&map), 1700 );
+    bitmap_delete(&map, 550);
+    assert_int_equal( bitmap_add(&map, 1, 100), 1700 );
+    assert_int_equal( bitmap_add(&map, 1, 99), 501 );
+
+    assert_int_equal( bitmap_size(&map), 5 );
+    assert_int_equal( bitmap_isValid(&map), BITMAP_INVALID_OK );
+
+    bitmap_release(&map);
+}
+
+
+/**
+ * Block at address 0 is distinguished from failure.
+ */
+static void test_bitmap_add_zero(void **state) {
+    (void) state; /* unused */
+
+    BitmapMap map;
+    bitmap_init(&map, 0x1000);
+    assert_int_equal( bitmap_add(&map, 0, 0x1000), 0 );
+    assert_int_equal( bitmap_add(&map, 0, 0x1000), 0x1000 );
+    assert_int_equal( bitmap_size(&map), 2 );
+    bitmap_release(&map);
+}
+
+static void test_bitmap_add_region(void **state) {
+    (void) state; /* unused */
+
+    BitmapMap map;
+    assert_int_equal( bitmap_initRegion(&map, 0x1000, 0x100000, 128), true );
+
+    /// hint below region -- start of region
+    assert_int_equal( bitmap_add(&map, 0, 0x1000), 0x100000 );
+    assert_int_equal( bitmap_add(&map, 0x1000, 0x2000), 0x101000 );
+    assert_int_equal( bitmap_startAddress(&map), 0x100000 );
+    assert_int_equal( bitmap_endAddress(&map), 0x103000 );
+
+    /// hint above region -- no memory is grown
+    assert_int_equal( bitmap_add(&map, 0x7f0000000000, 0x1000), BITMAP_NO_ADDRESS );
+    assert_int_equal( bitmap_add(&map, 0x180000, 0x1000), BITMAP_NO_ADDRESS );
+    assert_true( map.words <= 2 );
+
+    /// last pages of region
+    assert_int_equal( bitmap_add(&map, 0x17e000, 0x2000), 0x17e000 );
+    assert_int_equal( bitmap_add(&map, 0x17e000, 0x1000), BITMAP_NO_ADDRESS );
+    /// too big for region
+    assert_int_equal( bitmap_add(&map, 0, 0x81000), BITMAP_NO_ADDRESS );
+    assert_int_equal( bitmap_add(&map, 0, 0x7b000), 0x103000 );
+    assert_int_equal( bitmap_add(&map, 0, 0x1000), BITMAP_NO_ADDRESS );
+
+    assert_int_equal( bitmap_size(&map), 4 );
+    assert_int_equal( bitmap_isValid(&map), BITMAP_INVALID_OK );
+
+    bitmap_delete(&map, 0x1000);
+    bitmap_delete(&map, 0x17f000);
+    assert_int_equal( bitmap_size(&map), 3 );
+    assert_int_equal( bitmap_endAddress(&map), 0x17e000 );
+
+    bitmap_release(&map);
+}
+
+
+/// ======================================================
+
+
+static void test_bitmap_delete_badaddr(void **state) {
+    (void) state; /* unused */
+
+    BitmapMap map;
+    bitmap_init(&map, 1);
+    bitmap_add(&map, 10, 10);
+
+    bitmap_delete(NULL, 10);
+    bitmap_delete(&map, 5);
+    bitmap_delete(&map, 20);
+    bitmap_delete(&map, 100000);
+    assert_int_equal( bitmap_size(&map), 1 );
+
+    bitmap_release(&map);
+}
+
+static void test_bitmap_delete_all(void **state) {
+    (void) state; /* unused */
+
+    BitmapMap map;
+    bitmap_init(&map, 1);
+    for(size_t i = 0; i < 200; ++i) {
+        bitmap_add(&map, i + 1, 1);
+    }
+    assert_int_equal( bitmap_size(&map), 200 );
+
+    for(size_t i = 0; i < 200; ++i) {
+        bitmap_delete(&map, i + 1);
+        assert_int_equal( bitmap_isValid(&map), BITMAP_INVALID_OK );
+    }
+    assert_int_equal( bitmap_size(&map), 0 );
+    assert_int_equal( bitmap_startAddress(&map), 0 );
+    assert_int_equal( bitmap_endAddress(&map), 0 );
+
+    bitmap_release(&map);
+}
+
+/**
+ * Compares placement with linear scan of reserved blocks.
+ */
+static void test_bitmap_add_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    #define random_num 300
+
+    BitmapMap map;
+    bitmap_init(&map, 1);
+
+    size_t starts[random_num];
+    size_t ends[random_num];
+    size_t num = 0;
+
+    for(size_t i = 0; i < random_num * 2; ++i) {
+        if (num > 0 && rand() % 3 == 0) {
+            /// remove by address inside block
+            const size_t index = rand() % num;
+            bitmap_delete(&map, starts[index] + rand() % (ends[index] - starts[index]));
+            --num;
+            starts[index] = starts[num];
+            ends[index] = ends[num];
+            continue ;
+        }
+        if (num >= random_num) {
+            continue ;
+        }
+
+        const size_t hint = rand() % 2000 + 1;
+        const size_t msize = rand() % 150 + 1;
+
+        /// expected: lowest address at or after hint not overlapping any block
+        size_t expected = hint;
+        bool moved = true;
+        while (moved == true) {
+            moved = false;
+            for(size_t n = 0; n < num; ++n) {
+                if (expected < ends[n] && starts[n] < expected + msize) {
+                    expected = ends[n];
+                    moved = true;
+                }
+            }
+        }
+
+        const size_t ret = bitmap_add(&map, hint, msize);
+        if (ret != expected) {
+            printf("seed: %u\n", seed);
+        }
+        assert_int_equal( ret, expected );
+        starts[num] = ret;
+        ends[num] = ret + msize;
+        ++num;
+    }
+
+    assert_int_equal( bitmap_size(&map), num );
+    assert_int_equal( bitmap_isValid(&map), BITMAP_INVALID_OK );
+
+    bitmap_release(&map);
+}
+
+
+/// ======================================================
+
+
+static void test_bitmap_release_NULL(void **state) {
+    (void) state; /* unused */
+
+    assert_int_equal( bitmap_release(NULL), false );
+}
+
+static void test_bitmap_release_double(void **state) {
+    (void) state; /* unused */
+
+    BitmapMap map;
+    bitmap_init(&map, 1);
+    bitmap_add(&map, 10, 10);
+
+    assert_int_equal( bitmap_release(&map), true );
+    assert_int_equal( bitmap_release(&map), true );
+    assert_int_equal( bitmap_size(&map), 0 );
+}
+
+
+/// ======================================================
+
+
+int main(void) {
+
+    //TODO: add selective run
+
+    const struct UnitTest tests[] = {
+        unit_test(test_bitmap_init_NULL),
+        unit_test(test_bitmap_initRegion_invalid),
+        unit_test(test_bitmap_init_valid),
+
+        unit_test(test_bitmap_add_NULL),
+        unit_test(test_bitmap_add_overlap),
+        unit_test(test_bitmap_add_granularity),
+        unit_test(test_bitmap_add_words),
+        unit_test(test_bitmap_add_random),
+        unit_test(test_bitmap_add_zero),
+        unit_test(test_bitmap_add_region),
+
+        unit_test(test_bitmap_delete_badaddr),
+        unit_test(test_bitmap_delete_all),
+
+        unit_test(test_bitmap_release_NULL),
+        unit_test(test_bitmap_release_double),
+    };
+
+    return run_group_tests(tests);
+}
@@ -0,0 +1,323 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#include "memorymap/Buddy.h"
+
+#include <time.h>
+#include <stdlib.h>
+#include <stdio.h>                              /// printf
+
+/// for cmocka to mock system functions
+#define UNIT_TESTING 1
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+
+
+static unsigned int current_seed = 0;
+
+static unsigned int get_next_seed() {
+    if (current_seed == 0) {
+        srand( time(NULL) );
+        current_seed = rand();
+    }
+    return (++current_seed);
+}
+
+/**
+ * Region [1024, 2048) with blocks from 16 to 1024 bytes.
+ */
+static BuddyMap create_small_map() {
+    BuddyMap map;
+    buddy_initRegion(&map, 1024, 4, 10);
+    return map;
+}
+
+
+/// ======================================================
+
+
+static void test_buddy_init_NULL(void **state) {
+    (void) state; /* unused */
+
+    assert_int_equal( buddy_init(NULL), false );
+
+    BuddyMap map;
+    /// not aligned base
+    assert_int_equal( buddy_initRegion(&map, 1000, 4, 10), false );
+    assert_int_equal( buddy_initRegion(&map, 0, 4, 10), false );
+    /// bad orders
+    assert_int_equal( buddy_initRegion(&map, 1024, 11, 10), false );
+    assert_int_equal( buddy_initRegion(&map, 1 << 30, 0, 30), false );
+}
+
+static void test_buddy_init_valid(void **state) {
+    (void) state; /* unused */
+
+    BuddyMap map;
+    assert_int_equal( buddy_init(&map), true );
+    assert_int_equal( buddy_size(&map), 0 );
+    assert_int_equal( buddy_freeSize(&map), 1 << BUDDY_DEFAULT_MAX_ORDER );
+    assert_int_equal( buddy_startAddress(&map), 0 );
+    assert_int_equal( buddy_endAddress(&map), 0 );
+    assert_int_equal( buddy_isValid(&map), BUDDY_INVALID_OK );
+
+    buddy_release(&map);
+}
+
+
+/// ======================================================
+
+
+static void test_buddy_add_NULL(void **state) {
+    (void) state; /* unused */
+
+    assert_int_equal( buddy_add(NULL, 0, 16), 0 );
+
+    BuddyMap map = create_small_map();
+    assert_int_equal( buddy_add(&map, 0, 0), 0 );
+    /// bigger than region
+    assert_int_equal( buddy_add(&map, 0, 1025), 0 );
+    assert_int_equal( buddy_size(&map), 0 );
+    buddy_release(&map);
+}
+
+static void test_buddy_add_rounding(void **state) {
+    (void) state; /* unused */
+
+    BuddyMap map = create_small_map();
+
+    /// sizes rounded up to power of two, at least 16
+    assert_int_equal( buddy_add(&map, 1024, 1), 1024 );
+    assert_int_equal( buddy_add(&map, 1024, 17), 1024 + 32 );
+    assert_int_equal( buddy_add(&map, 1024, 16), 1024 + 16 );
+    assert_int_equal( buddy_add(&map, 1024, 100), 1024 + 128 );
+
+    assert_int_equal( buddy_size(&map), 4 );
+    assert_int_equal( buddy_freeSize(&map), 1024 - 16 - 16 - 32 - 128 );
+    assert_int_equal( buddy_startAddress(&map), 1024 );
+    assert_int_equal( buddy_endAddress(&map), 1024 + 256 );
+    assert_int_equal( buddy_isValid(&map), BUDDY_INVALID_OK );
+
+    buddy_release(&map);
+}
+
+static void test_buddy_add_aligned(void **state) {
+    (void) state; /* unused */
+
+    BuddyMap map = create_small_map();
+
+    /// hint rounded up to natural alignment of block
+    assert_int_equal( buddy_add(&map, 1024 + 1, 64), 1024 + 64 );
+    assert_int_equal( buddy_add(&map, 1024 + 600, 256), 1024 + 768 );
+
+    /// hint occupied -- block from free list
+    const size_t ret = buddy_add(&map, 1024 + 64, 64);
+    assert_int_not_equal( ret, 0 );
+    assert_int_not_equal( ret, 1024 + 64 );
+    assert_int_equal( (ret - 1024) % 64, 0 );
+
+    assert_int_equal( buddy_isValid(&map), BUDDY_INVALID_OK );
+    buddy_release(&map);
+}
+
+static void test_buddy_add_full(void **state) {
+    (void) state; /* unused */
+
+    BuddyMap map = create_small_map();
+
+    for(size_t i = 0; i < 64; ++i) {
+        const size_t ret = buddy_add(&map, 0, 16);
+        assert_int_not_equal( ret, 0 );
+        assert_int_equal( ret % 16, 0 );
+    }
+    assert_int_equal( buddy_freeSize(&map), 0 );
+    assert_int_equal( buddy_add(&map, 0, 16), 0 );
+
+    assert_int_equal( buddy_size(&map), 64 );
+    assert_int_equal( buddy_isValid(&map), BUDDY_INVALID_OK );
+    buddy_release(&map);
+}
+
+
+/// ======================================================
+
+
+static void test_buddy_delete_badaddr(void **state) {
+    (void) state; /* unused */
+
+    BuddyMap map = create_small_map();
+    buddy_add(&map, 1024, 16);
+
+    buddy_delete(NULL, 1024);
+    buddy_delete(&map, 100);
+    buddy_delete(&map, 1024 + 16);
+    buddy_delete(&map, 4096);
+    assert_int_equal( buddy_size(&map), 1 );
+
+    buddy_release(&map);
+}
+
+static void test_buddy_delete_coalesce(void **state) {
+    (void) state; /* unused */
+
+    BuddyMap map = create_small_map();
+
+    const size_t a = buddy_add(&map, 1024, 16);
+    const size_t b = buddy_add(&map, 1024 + 16, 16);
+    const size_t c = buddy_add(&map, 1024 + 512, 512);
+    assert_int_equal( a, 1024 );
+    assert_int_equal( b, 1024 + 16 );
+    assert_int_equal( c, 1024 + 512 );
+
+    /// by address inside block
+    buddy_delete(&map, c + 100);
+    buddy_delete(&map, a);
+    assert_int_equal( buddy_isValid(&map), BUDDY_INVALID_OK );
+    assert_int_equal( buddy_size(&map), 1 );
+
+    /// buddies merged back to whole region
+    buddy_delete(&map, b);
+    assert_int_equal( buddy_size(&map), 0 );
+    assert_int_equal( buddy_freeSize(&map), 1024 );
+    assert_int_equal( buddy_isValid(&map), BUDDY_INVALID_OK );
+    assert_int_equal( buddy_add(&map, 0, 1024), 1024 );
+
+    buddy_release(&map);
+}
+
+static void test_buddy_mmap_munmap(void **state) {
+    (void) state; /* unused */
+
+    BuddyMap map = create_small_map();
+
+    void* ptr = buddy_mmap(&map, (void*)1024, 48);
+    assert_int_equal( ptr, 1024 );
+    assert_int_equal( buddy_mmap(NULL, ptr, 48), NULL );
+    buddy_munmap(&map, ptr);
+    assert_int_equal( buddy_size(&map), 0 );
+
+    buddy_release(&map);
+}
+
+static void test_buddy_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    BuddyMap map;
+    buddy_initRegion(&map, 1 << 16, 4, 16);
+
+    size_t addr[500];
+    size_t sizes[500];
+    size_t num = 0;
+    size_t reserved = 0;
+
+    for(size_t i = 0; i < 2000; ++i) {
+        if (num > 0 && (rand() % 2 == 0 || num == 500)) {
+            const size_t index = rand() % num;
+            buddy_delete(&map, addr[index] + rand() % sizes[index]);
+            reserved -= sizes[index];
+            --num;
+            addr[index] = addr[num];
+            sizes[index] = sizes[num];
+        } else {
+            const size_t order = rand() % 8 + 4;
+            const size_t hint = (rand() % 2 == 0) ? (1 << 16) + rand() % (1 << 16) : 0;
+            const size_t ret = buddy_add(&map, hint, (size_t)1 << order);
+            if (ret != 0) {
+                if (((ret - (1 << 16)) % ((size_t)1 << order)) != 0) {
+                    printf("seed: %u\n", seed);
+                }
+                assert_int_equal( (ret - (1 << 16)) % ((size_t)1 << order), 0 );
+                addr[num] = ret;
+                sizes[num] = (size_t)1 << order;
+                reserved += sizes[num];
+                ++num;
+            }
+        }
+        if (buddy_isValid(&map) != BUDDY_INVALID_OK) {
+            printf("seed: %u\n", seed);
+        }
+        assert_int_equal( buddy_isValid(&map), BUDDY_INVALID_OK );
+        assert_int_equal( buddy_size(&map), num );
+        assert_int_equal( buddy_freeSize(&map), (1 << 16) - reserved );
+    }
+
+    buddy_release(&map);
+}
+
+
+/// ======================================================
+
+
+static void test_buddy_release_NULL(void **state) {
+    (void) state; /* unused */
+
+    assert_int_equal( buddy_release(NULL), false );
+}
+
+static void test_buddy_release_double(void **state) {
+    (void) state; /* unused */
+
+    BuddyMap map = create_small_map();
+    buddy_add(&map, 1024, 16);
+
+    assert_int_equal( buddy_release(&map), true );
+    assert_int_equal( buddy_release(&map), true );
+    assert_int_equal( buddy_size(&map), 0 );
+    assert_int_equal( buddy_add(&map, 1024, 16), 0 );
+}
+
+
+/// ======================================================
+
+
+int main(void) {
+
+    //TODO: add selective run
+
+    const struct UnitTest tests[] = {
+        unit_test(test_buddy_init_NULL),
+        unit_test(test_buddy_init_valid),
+
+        unit_test(test_buddy_add_NULL),
+        unit_test(test_buddy_add_rounding),
+        unit_test(test_buddy_add_aligned),
+        unit_test(test_buddy_add_full),
+
+        unit_test(test_buddy_delete_badaddr),
+        unit_test(test_buddy_delete_coalesce),
+        unit_test(test_buddy_mmap_munmap),
+        unit_test(test_buddy_random),
+
+        unit_test(test_buddy_release_NULL),
+        unit_test(test_buddy_release_double),
+    };
+
+    return run_group_tests(tests);
+}
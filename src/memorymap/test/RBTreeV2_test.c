@@ -26,6 +26,7 @@
 #include <time.h>
 #include <stdlib.h>
 #include <stdio.h>                              /// printf
+#include <string.h>                             /// memset
 
 /// for cmocka to mock system functions
 #define UNIT_TESTING 1
@@ -178,6 +179,1253 @@ static void test_tree2_mmap_segmented_toRight(void **state) {
     tree2_release(&tree);
 }
 
+static void test_tree2_mmap_fragmented(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+
+    /// blocks of size 10 with gaps: 2, 4, 6, ...
+    size_t addr = 100;
+    for(size_t i = 1; i <= 20; ++i) {
+        tree2_mmap(&tree, (void*)addr, 10);
+        addr += 10 + 2*i;
+    }
+    /// gap of size 12 is after 6th block
+    const void* ret = tree2_mmap(&tree, (void*)100, 11);
+    assert_int_equal( ret, 100 + 6*10 + 2+4+6+8+10 );
+
+    /// hint inside gap of size 20
+    const size_t gapStart = 100 + 10*10 + 2+4+6+8+10+12+14+16+18;
+    ret = tree2_mmap(&tree, (void*)(gapStart + 5), 15);
+    assert_int_equal( ret, gapStart + 5 );
+
+    /// no gap big enough -- goes after last block
+    ret = tree2_mmap(&tree, (void*)100, 100);
+    assert_int_equal( ret, tree2_endAddress(&tree) - 100 );
+
+    assert_int_equal( tree2_size(&tree), 23 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_mmapBestFit(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    assert_int_equal( tree2_useFreeIndex(&tree), true );
+
+    /// blocks of size 10 with gaps: 20, 4, 12, 6
+    tree2_mmap(&tree, (void*)100, 10);
+    tree2_mmap(&tree, (void*)130, 10);
+    tree2_mmap(&tree, (void*)144, 10);
+    tree2_mmap(&tree, (void*)166, 10);
+    tree2_mmap(&tree, (void*)182, 10);
+    assert_int_equal( tree2_freeExtents(&tree), 4 );
+
+    /// first fit takes gap of size 20, best fit takes gap of size 6
+    const void* ret = tree2_mmapBestFit(&tree, (void*)100, 5);
+    assert_int_equal( ret, 176 );
+    assert_int_equal( tree2_freeExtents(&tree), 4 );
+
+    /// exact fit removes extent
+    ret = tree2_mmapBestFit(&tree, (void*)100, 4);
+    assert_int_equal( ret, 140 );
+    assert_int_equal( tree2_freeExtents(&tree), 3 );
+
+    /// no extent big enough -- goes after last block
+    ret = tree2_mmapBestFit(&tree, (void*)100, 30);
+    assert_int_equal( ret, 192 );
+
+    assert_int_equal( tree2_size(&tree), 8 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    /// releasing block merges extents: 20 + 10 + 0
+    tree2_munmap(&tree, (void*)130);
+    assert_int_equal( tree2_freeExtents(&tree), 3 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    ret = tree2_mmapBestFit(&tree, (void*)0, 25);
+    assert_int_equal( ret, 110 );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_useFreeIndex(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+
+    tree2_add(&tree, 10, 10);
+    tree2_add(&tree, 30, 10);
+    tree2_add(&tree, 40, 10);
+    tree2_add(&tree, 55, 10);
+    assert_int_equal( tree2_freeExtents(&tree), 0 );
+
+    /// index built from existing areas
+    assert_int_equal( tree2_useFreeIndex(&tree), true );
+    assert_int_equal( tree2_freeExtents(&tree), 2 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    assert_int_equal( tree2_addBestFit(&tree, 0, 5), 50 );
+    assert_int_equal( tree2_freeExtents(&tree), 1 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_freeIndex_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    tree2_useFreeIndex(&tree);
+
+    for(size_t i = 0; i < 300; ++i) {
+        const size_t addr = rand() % 3000 + 1;
+        const size_t msize = rand() % 30 + 1;
+        if (rand() % 2 == 0) {
+            tree2_add(&tree, addr, msize);
+        } else {
+            tree2_addBestFit(&tree, addr, msize);
+        }
+        if (rand() % 3 == 0) {
+            tree2_delete(&tree, rand() % 3000 + 1);
+        }
+
+        const ARBTreeValidationError valid = tree2_isValid(&tree);
+        if (valid != ARBTREE_INVALID_OK) {
+            printf("seed: %u\n", seed);
+            printf("Iteration %zu\n", i);
+        }
+        assert_int_equal( valid, ARBTREE_INVALID_OK );
+    }
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_setPolicy(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+
+    assert_int_equal( tree2_setPolicy(NULL, TREE2_FIT_NEXT), false );
+    assert_int_equal( tree2_setPolicy(&tree, (RBTree2Policy)10), false );
+    assert_int_equal( tree.policy, TREE2_FIT_FIRST );
+
+    tree2_add(&tree, 100, 10);
+    tree2_add(&tree, 130, 10);
+    tree2_add(&tree, 145, 10);
+
+    /// best fit enables free index
+    assert_int_equal( tree2_setPolicy(&tree, TREE2_FIT_BEST), true );
+    assert_int_equal( tree.freeIndex, true );
+    assert_int_equal( tree2_add(&tree, 100, 5), 140 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_addFit_next(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+
+    /// blocks with gaps of size 10
+    tree2_add(&tree, 100, 10);
+    tree2_add(&tree, 120, 10);
+    tree2_add(&tree, 140, 10);
+    tree2_add(&tree, 160, 10);
+    tree2_delete(&tree, 120);
+    tree2_add(&tree, 125, 5);
+
+    tree2_setPolicy(&tree, TREE2_FIT_NEXT);
+
+    /// first fit would take gap after first block
+    assert_int_equal( tree2_add(&tree, 100, 5), 130 );
+    assert_int_equal( tree2_add(&tree, 100, 5), 135 );
+    assert_int_equal( tree2_add(&tree, 100, 5), 150 );
+    assert_int_equal( tree2_add(&tree, 100, 5), 155 );
+
+    /// no space after last reserved block -- wraps to hint
+    assert_int_equal( tree2_add(&tree, 100, 5), 110 );
+
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+    tree2_release(&tree);
+}
+
+static void test_tree2_addFit_topDown(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+
+    /// empty tree -- area ends at hint
+    assert_int_equal( tree2_addFit(&tree, 1000, 100, TREE2_FIT_TOP_DOWN), 900 );
+    assert_int_equal( tree2_addFit(&tree, 1000, 100, TREE2_FIT_TOP_DOWN), 800 );
+
+    /// gap of size 20 below 800
+    tree2_add(&tree, 700, 80);
+    assert_int_equal( tree2_addFit(&tree, 1000, 30, TREE2_FIT_TOP_DOWN), 670 );
+    assert_int_equal( tree2_addFit(&tree, 1000, 20, TREE2_FIT_TOP_DOWN), 780 );
+
+    /// hint inside reserved area
+    assert_int_equal( tree2_addFit(&tree, 750, 10, TREE2_FIT_TOP_DOWN), 660 );
+
+    /// no space below hint -- first fit
+    assert_int_equal( tree2_addFit(&tree, 5, 10, TREE2_FIT_TOP_DOWN), 5 );
+
+    assert_int_equal( tree2_size(&tree), 7 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+    tree2_release(&tree);
+}
+
+static void test_tree2_addFit_topDown_noHint(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    assert_int_equal( tree2_setTopAddress(NULL, 1000), false );
+    assert_int_equal( tree2_setTopAddress(&tree, 0), false );
+
+    /// no hint -- top of address space
+    assert_int_equal( tree2_addFit(&tree, 0, 0x1000, TREE2_FIT_TOP_DOWN), TREE2_DEFAULT_TOP_ADDRESS - 0x1000 );
+    assert_int_equal( tree2_addFit(&tree, 0, 0x1000, TREE2_FIT_TOP_DOWN), TREE2_DEFAULT_TOP_ADDRESS - 0x2000 );
+
+    /// no hint -- below top address, hint overrides it
+    assert_int_equal( tree2_setTopAddress(&tree, 1000), true );
+    assert_int_equal( tree2_addFit(&tree, 0, 100, TREE2_FIT_TOP_DOWN), 900 );
+    assert_int_equal( tree2_addFit(&tree, 0, 100, TREE2_FIT_TOP_DOWN), 800 );
+    assert_int_equal( tree2_addFit(&tree, 2000, 100, TREE2_FIT_TOP_DOWN), 1900 );
+
+    /// policy of tree
+    tree2_setPolicy(&tree, TREE2_FIT_TOP_DOWN);
+    assert_int_equal( tree2_add(&tree, 0, 100), 700 );
+
+    /// unknown policy
+    assert_int_equal( tree2_addFit(&tree, 0, 100, (RBTree2Policy)(TREE2_FIT_TOP_DOWN + 1)), 0 );
+
+    assert_int_equal( tree2_size(&tree), 6 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+    tree2_release(&tree);
+}
+
+/**
+ * Top-down placement compared with linear scan of free spaces.
+ */
+static void test_tree2_addFit_topDown_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    for(size_t i = 0; i < 200; ++i) {
+        tree2_add(&tree, rand() % 5000 + 1000, rand() % 30 + 1);
+    }
+
+    for(size_t i = 0; i < 100; ++i) {
+        const size_t limit = rand() % 6000 + 1000;
+        const size_t msize = rand() % 40 + 1;
+
+        /// expected: highest space below limit
+        size_t expected = 0;
+        size_t gapEnd = limit;
+        for(size_t n = tree2_size(&tree); n > 0; --n) {
+            const MemoryArea curr = tree2_valueByIndex(&tree, n - 1);
+            if (curr.start >= limit) {
+                continue ;
+            }
+            const size_t end = (gapEnd < limit) ? gapEnd : limit;
+            if (end > curr.end && end - curr.end >= msize) {
+                expected = end - msize;
+                break;
+            }
+            gapEnd = curr.start;
+        }
+        if (expected == 0 && gapEnd >= msize) {
+            expected = gapEnd - msize;
+        }
+
+        const size_t ret = tree2_addFit(&tree, limit, msize, TREE2_FIT_TOP_DOWN);
+        if (ret != expected) {
+            printf("seed: %u\n", seed);
+        }
+        assert_int_equal( ret, expected );
+    }
+
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+    tree2_release(&tree);
+}
+
+static void test_tree2_useRadixIndex(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    tree2_add(&tree, 0x100, 0x100);
+    tree2_add(&tree, 0x300, 0x100);
+
+    assert_true( tree2_useRadixIndex(&tree) );
+    assert_true( tree2_useRadixIndex(&tree) );
+
+    tree2_add(&tree, 0x500, 0x1000);
+    tree2_add(&tree, 0x2000, 0x10);
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    MemoryArea found = tree2_find(&tree, 0x350);
+    assert_int_equal( found.start, 0x300 );
+    assert_int_equal( found.end, 0x400 );
+    found = tree2_find(&tree, 0x1400);
+    assert_int_equal( found.start, 0x500 );
+    found = tree2_find(&tree, 0x1500);
+    assert_int_equal( found.end, 0 );
+    found = tree2_find(&tree, 0x3000);
+    assert_int_equal( found.end, 0 );
+
+    tree2_delete(&tree, 0x150);
+    tree2_delete(&tree, 0x1000);
+    assert_int_equal( tree2_size(&tree), 2 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    found = tree2_find(&tree, 0x100);
+    assert_int_equal( found.end, 0 );
+    found = tree2_find(&tree, 0x3FF);
+    assert_int_equal( found.start, 0x300 );
+    found = tree2_find(&tree, 0x2008);
+    assert_int_equal( found.start, 0x2000 );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_useRadixIndex_large(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    tree2_useRadixIndex(&tree);
+
+    /// covers whole tables on two levels
+    tree2_add(&tree, 0x3FFFF000, 0x40002000);
+    tree2_add(&tree, 0x80001000, 0x100);
+    tree2_add(&tree, 0x80001100, 0x100);
+    /// above indexed range
+    const size_t high = (size_t)1 << 50;
+    tree2_add(&tree, high, 0x1000);
+    assert_int_equal( tree2_size(&tree), 4 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    MemoryArea found = tree2_find(&tree, 0x60000000);
+    assert_int_equal( found.start, 0x3FFFF000 );
+    found = tree2_find(&tree, 0x80000FFF);
+    assert_int_equal( found.start, 0x3FFFF000 );
+    found = tree2_find(&tree, 0x80001180);
+    assert_int_equal( found.start, 0x80001100 );
+    found = tree2_find(&tree, high + 0x10);
+    assert_int_equal( found.start, high );
+
+    tree2_delete(&tree, 0x50000000);
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+    found = tree2_find(&tree, 0x60000000);
+    assert_int_equal( found.end, 0 );
+    found = tree2_find(&tree, 0x80001000);
+    assert_int_equal( found.start, 0x80001000 );
+
+    tree2_delete(&tree, high);
+    tree2_delete(&tree, 0x80001000);
+    assert_int_equal( tree2_size(&tree), 1 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_useRadixIndex_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    tree2_useRadixIndex(&tree);
+    RBTree2 plain;
+    tree2_init(&plain);
+
+    static const size_t sizes[] = { 0x10, 0x800, 0x3000, 0x300000 };
+
+    size_t addr[400];
+    for(size_t i = 0; i < 400; ++i) {
+        const size_t hint = rand() % 0x4000000;
+        const size_t size = sizes[rand() % 4];
+        addr[i] = tree2_add(&tree, hint, size);
+        assert_int_equal( tree2_add(&plain, hint, size), addr[i] );
+        if (rand() % 3 == 0) {
+            const size_t removed = addr[rand() % (i + 1)] + rand() % 0x10;
+            tree2_delete(&tree, removed);
+            tree2_delete(&plain, removed);
+        }
+        if (tree2_isValid(&tree) != ARBTREE_INVALID_OK) {
+            printf("seed: %u\n", seed);
+        }
+        assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+        const size_t address = rand() % 0x4400000;
+        const MemoryArea found = tree2_find(&tree, address);
+        const MemoryArea expected = tree2_find(&plain, address);
+        assert_int_equal( found.start, expected.start );
+        assert_int_equal( found.end, expected.end );
+    }
+    assert_int_equal( tree2_size(&tree), tree2_size(&plain) );
+
+    tree2_release(&plain);
+    tree2_release(&tree);
+}
+
+static void test_tree2_addBatch(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    tree2_add(&tree, 100, 50);
+    tree2_add(&tree, 300, 50);
+
+    MemoryArea areas[6];
+    areas[0] = memory_create(320, 20);              /// conflict -- moved after existing area
+    areas[1] = memory_create(10, 20);
+    areas[2] = memory_create(140, 100);             /// conflict -- moved after existing area
+    areas[3] = memory_create(10, 20);               /// conflict with batch request
+    areas[4] = memory_create(500, 0);               /// empty request
+    areas[5] = memory_create(200, 90);              /// conflict -- moved after batch request
+
+    const size_t reserved = tree2_addBatch(&tree, areas, 6);
+    assert_int_equal( reserved, 5 );
+    assert_int_equal( tree2_size(&tree), 7 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    assert_int_equal( areas[0].start, 350 );
+    assert_int_equal( areas[1].start, 10 );
+    assert_int_equal( areas[2].start, 150 );
+    assert_int_equal( areas[3].start, 30 );
+    assert_int_equal( areas[4].start, 0 );
+    assert_int_equal( areas[4].end, 0 );
+    assert_int_equal( areas[5].start, 370 );
+    assert_int_equal( areas[5].end, 460 );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_addBatch_perCall(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    for(size_t round = 0; round < 20; ++round) {
+        RBTree2 tree;
+        tree2_init(&tree);
+        RBTree2 plain;
+        tree2_init(&plain);
+        for(size_t i = 0; i < 50; ++i) {
+            const size_t address = rand() % 0x4000 + 1;
+            const size_t size = rand() % 0x100 + 1;
+            tree2_add(&tree, address, size);
+            tree2_add(&plain, address, size);
+        }
+
+        /// narrow window of hints -- many requests conflict
+        MemoryArea areas[100];
+        for(size_t i = 0; i < 100; ++i) {
+            areas[i] = memory_create(rand() % 0x2000 + 1, rand() % 0x80 + 1);
+        }
+        MemoryArea expected[100];
+        for(size_t i = 0; i < 100; ++i) {
+            expected[i] = memory_create(tree2_addFit(&plain, areas[i].start, memory_size(&areas[i]), TREE2_FIT_FIRST), memory_size(&areas[i]));
+        }
+
+        assert_int_equal( tree2_addBatch(&tree, areas, 100), 100 );
+        if (tree2_isValid(&tree) != ARBTREE_INVALID_OK) {
+            printf("seed: %u\n", seed);
+        }
+        assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+        for(size_t i = 0; i < 100; ++i) {
+            if (areas[i].start != expected[i].start) {
+                printf("seed: %u\n", seed);
+            }
+            assert_int_equal( areas[i].start, expected[i].start );
+            assert_int_equal( areas[i].end, expected[i].end );
+        }
+        assert_int_equal( tree2_size(&tree), tree2_size(&plain) );
+
+        tree2_release(&plain);
+        tree2_release(&tree);
+    }
+}
+
+static void test_tree2_addBatch_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    tree2_useFreeIndex(&tree);
+    tree2_useRadixIndex(&tree);
+
+    for(size_t i = 0; i < 200; ++i) {
+        tree2_add(&tree, rand() % 0x100000 + 1, rand() % 0x1000 + 1);
+    }
+
+    MemoryArea areas[300];
+    MemoryArea requests[300];
+    for(size_t i = 0; i < 300; ++i) {
+        requests[i] = memory_create(rand() % 0x100000 + 1, rand() % 0x1000 + 1);
+        areas[i] = requests[i];
+    }
+    const size_t reserved = tree2_addBatch(&tree, areas, 300);
+    assert_int_equal( reserved, 300 );
+    assert_int_equal( tree2_size(&tree), 500 );
+    if (tree2_isValid(&tree) != ARBTREE_INVALID_OK) {
+        printf("seed: %u\n", seed);
+    }
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    for(size_t i = 0; i < 300; ++i) {
+        assert_true( areas[i].start >= requests[i].start );
+        assert_int_equal( memory_size(&areas[i]), memory_size(&requests[i]) );
+        const MemoryArea found = tree2_find(&tree, areas[i].start);
+        assert_int_equal( found.start, areas[i].start );
+    }
+
+    /// tree stays usable
+    for(size_t i = 0; i < 300; ++i) {
+        tree2_delete(&tree, areas[i].start);
+        tree2_add(&tree, rand() % 0x100000 + 1, rand() % 0x1000 + 1);
+    }
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_buildFromSorted(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    tree2_useFreeIndex(&tree);
+    tree2_useRadixIndex(&tree);
+
+    MemoryArea areas[5];
+    areas[0] = memory_create(100, 10);
+    areas[1] = memory_create(110, 20);
+    areas[2] = memory_create(200, 10);
+    areas[3] = memory_create(150, 10);
+    areas[4] = memory_create(0x100000, 0x2000);
+
+    /// not sorted
+    assert_int_equal( tree2_buildFromSorted(&tree, areas, 5), false );
+    assert_int_equal( tree2_size(&tree), 0 );
+
+    areas[3] = memory_create(300, 10);
+    assert_true( tree2_buildFromSorted(&tree, areas, 5) );
+    assert_int_equal( tree2_size(&tree), 5 );
+    assert_int_equal( tree2_depth(&tree), 3 );
+    assert_int_equal( tree2_freeExtents(&tree), 3 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    /// tree has to be empty
+    assert_int_equal( tree2_buildFromSorted(&tree, areas, 5), false );
+
+    const MemoryArea found = tree2_find(&tree, 0x101000);
+    assert_int_equal( found.start, 0x100000 );
+    assert_int_equal( tree2_add(&tree, 100, 50), 130 );
+    tree2_delete(&tree, 205);
+    assert_int_equal( tree2_size(&tree), 5 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_buildFromSorted_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    MemoryArea areas[500];
+    size_t address = 1;
+    for(size_t i = 0; i < 500; ++i) {
+        address += rand() % 0x100;
+        areas[i] = memory_create(address, rand() % 0x1000 + 1);
+        address = areas[i].end;
+    }
+
+    for(size_t layout = 0; layout < 2; ++layout) {
+        RBTree2 tree;
+        tree2_initLayout(&tree, (RBTree2Layout)layout);
+        tree2_useFreeIndex(&tree);
+        tree2_useRadixIndex(&tree);
+        assert_true( tree2_buildFromSorted(&tree, areas, 500) );
+        if (tree2_isValid(&tree) != ARBTREE_INVALID_OK) {
+            printf("seed: %u\n", seed);
+        }
+        assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+        for(size_t i = 0; i < 500; ++i) {
+            const MemoryArea area = tree2_valueByIndex(&tree, i);
+            assert_int_equal( area.start, areas[i].start );
+            assert_int_equal( area.end, areas[i].end );
+        }
+        for(size_t i = 0; i < 200; ++i) {
+            tree2_delete(&tree, areas[rand() % 500].start);
+            tree2_add(&tree, rand() % address + 1, rand() % 0x100 + 1);
+        }
+        assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+        tree2_release(&tree);
+    }
+}
+
+static void test_tree2_deleteRange(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    tree2_useFreeIndex(&tree);
+    tree2_useRadixIndex(&tree);
+    const MemoryArea areas[4] = { memory_create(100, 100), memory_create(300, 100), memory_create(500, 100), memory_create(700, 100) };
+    assert_true( tree2_buildFromSorted(&tree, areas, 4) );
+
+    /// range in free space
+    assert_int_equal( tree2_deleteRange(&tree, 220, 280), 0 );
+    assert_int_equal( tree2_size(&tree), 4 );
+
+    /// trim areas crossing bounds
+    assert_int_equal( tree2_deleteRange(&tree, 150, 350), 0 );
+    assert_int_equal( tree2_size(&tree), 4 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+    assert_int_equal( tree2_valueByIndex(&tree, 0).end, 150 );
+    assert_int_equal( tree2_valueByIndex(&tree, 1).start, 350 );
+    assert_int_equal( tree2_find(&tree, 200).end, 0 );
+
+    /// split area containing range
+    assert_int_equal( tree2_deleteRange(&tree, 520, 580), 0 );
+    assert_int_equal( tree2_size(&tree), 5 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+    assert_int_equal( tree2_find(&tree, 510).end, 520 );
+    assert_int_equal( tree2_find(&tree, 590).start, 580 );
+
+    /// remove inner areas and trim edges
+    assert_int_equal( tree2_deleteRange(&tree, 120, 750), 3 );
+    assert_int_equal( tree2_size(&tree), 2 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+    assert_int_equal( tree2_valueByIndex(&tree, 0).end, 120 );
+    assert_int_equal( tree2_valueByIndex(&tree, 1).start, 750 );
+    assert_int_equal( tree2_freeExtents(&tree), 1 );
+
+    assert_int_equal( tree2_deleteRange(&tree, 0, 1000), 2 );
+    assert_int_equal( tree2_size(&tree), 0 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_deleteRange_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    const size_t range = 0x10000;
+    for(size_t layout = 0; layout < 2; ++layout) {
+        RBTree2 tree;
+        tree2_initLayout(&tree, (RBTree2Layout)layout);
+        tree2_usePool(&tree);
+        tree2_useFreeIndex(&tree);
+        tree2_useRadixIndex(&tree);
+
+        /// reserved addresses
+        bool* used = calloc(range, sizeof(bool));
+        for(size_t i = 0; i < 300; ++i) {
+            const size_t size = rand() % 0x80 + 1;
+            const size_t start = tree2_add(&tree, rand() % (range - 0x100) + 1, size);
+            if (start + size > range) {
+                tree2_deleteRange(&tree, start, start + size);
+                continue ;
+            }
+            for(size_t a = start; a < start + size; ++a) {
+                used[a] = true;
+            }
+        }
+
+        for(size_t i = 0; i < 100; ++i) {
+            const size_t start = rand() % range;
+            const size_t end = start + rand() % 0x800 + 1;
+            tree2_deleteRange(&tree, start, end);
+            for(size_t a = start; a < end && a < range; ++a) {
+                used[a] = false;
+            }
+            const ARBTreeValidationError valid = tree2_isValid(&tree);
+            if (valid != ARBTREE_INVALID_OK) {
+                printf("seed: %u\n", seed);
+            }
+            assert_int_equal( valid, ARBTREE_INVALID_OK );
+        }
+
+        size_t reserved = 0;
+        for(size_t i = 0; i < tree2_size(&tree); ++i) {
+            const MemoryArea area = tree2_valueByIndex(&tree, i);
+            for(size_t a = area.start; a < area.end; ++a) {
+                assert_true( used[a] );
+            }
+            reserved += memory_size(&area);
+        }
+        size_t expected = 0;
+        for(size_t a = 0; a < range; ++a) {
+            expected += used[a] ? 1 : 0;
+        }
+        assert_int_equal( reserved, expected );
+
+        free(used);
+        tree2_release(&tree);
+    }
+}
+
+static void test_tree2_cursor(void **state) {
+    (void) state; /* unused */
+
+    RBTree2Cursor cursor;
+    assert_int_equal( tree2_cursorFirst(NULL, &cursor), false );
+    assert_int_equal( tree2_cursorNext(NULL), false );
+    assert_int_equal( tree2_cursorGet(NULL).end, 0 );
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    assert_int_equal( tree2_cursorFirst(&tree, &cursor), false );
+    assert_int_equal( tree2_cursorGet(&cursor).end, 0 );
+
+    tree2_add(&tree, 100, 10);
+    tree2_add(&tree, 200, 10);
+    tree2_add(&tree, 300, 10);
+
+    assert_true( tree2_cursorFirst(&tree, &cursor) );
+    assert_int_equal( tree2_cursorGet(&cursor).start, 100 );
+    assert_true( tree2_cursorNext(&cursor) );
+    assert_int_equal( tree2_cursorGet(&cursor).start, 200 );
+    assert_true( tree2_cursorNext(&cursor) );
+    assert_int_equal( tree2_cursorGet(&cursor).start, 300 );
+    assert_int_equal( tree2_cursorNext(&cursor), false );
+    assert_int_equal( tree2_cursorPrev(&cursor), false );
+
+    assert_true( tree2_cursorLast(&tree, &cursor) );
+    assert_int_equal( tree2_cursorGet(&cursor).start, 300 );
+    assert_true( tree2_cursorPrev(&cursor) );
+    assert_int_equal( tree2_cursorGet(&cursor).start, 200 );
+
+    /// address inside area and in free space
+    assert_true( tree2_cursorSeek(&tree, 205, &cursor) );
+    assert_int_equal( tree2_cursorGet(&cursor).start, 200 );
+    assert_true( tree2_cursorSeek(&tree, 210, &cursor) );
+    assert_int_equal( tree2_cursorGet(&cursor).start, 300 );
+    assert_true( tree2_cursorSeek(&tree, 0, &cursor) );
+    assert_int_equal( tree2_cursorGet(&cursor).start, 100 );
+    assert_int_equal( tree2_cursorSeek(&tree, 310, &cursor), false );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_cursor_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    tree2_useRadixIndex(&tree);
+    for(size_t i = 0; i < 500; ++i) {
+        tree2_add(&tree, rand() % 0x100000 + 1, rand() % 0x1000 + 1);
+    }
+    const size_t size = tree2_size(&tree);
+
+    RBTree2Cursor cursor;
+    size_t index = 0;
+    for(bool valid = tree2_cursorFirst(&tree, &cursor); valid == true; valid = tree2_cursorNext(&cursor)) {
+        const MemoryArea area = tree2_cursorGet(&cursor);
+        const MemoryArea expected = tree2_valueByIndex(&tree, index);
+        assert_int_equal( area.start, expected.start );
+        assert_int_equal( area.end, expected.end );
+        ++index;
+    }
+    assert_int_equal( index, size );
+
+    for(size_t i = 0; i < 200; ++i) {
+        const size_t address = rand() % 0x110000;
+        const bool valid = tree2_cursorSeek(&tree, address, &cursor);
+        /// seek has to point to first area ending after address
+        size_t expected = 0;
+        while (expected < size && tree2_valueByIndex(&tree, expected).end <= address) {
+            ++expected;
+        }
+        if (expected == size) {
+            assert_int_equal( valid, false );
+            continue ;
+        }
+        assert_true( valid );
+        assert_int_equal( tree2_cursorGet(&cursor).start, tree2_valueByIndex(&tree, expected).start );
+    }
+
+    tree2_release(&tree);
+}
+
+/**
+ * Collects visited areas, stops after 'limit' areas.
+ */
+typedef struct {
+    MemoryArea areas[64];
+    size_t size;
+    size_t limit;
+} VisitedAreas;
+
+static bool collect_area(const MemoryArea* area, void* context) {
+    VisitedAreas* visited = (VisitedAreas*)context;
+    if (visited->size < 64) {
+        visited->areas[visited->size] = *area;
+    }
+    ++(visited->size);
+    return (visited->size < visited->limit);
+}
+
+static void test_tree2_forEachInRange(void **state) {
+    (void) state; /* unused */
+
+    VisitedAreas visited;
+    visited.size = 0;
+    visited.limit = 64;
+    assert_int_equal( tree2_forEachInRange(NULL, 0, 100, collect_area, &visited), 0 );
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    assert_int_equal( tree2_forEachInRange(&tree, 0, 100, collect_area, &visited), 0 );
+    tree2_add(&tree, 100, 10);
+    tree2_add(&tree, 200, 10);
+    tree2_add(&tree, 300, 10);
+    tree2_add(&tree, 400, 10);
+    assert_int_equal( tree2_forEachInRange(&tree, 100, 100, collect_area, &visited), 0 );
+    assert_int_equal( tree2_forEachInRange(&tree, 100, 200, NULL, &visited), 0 );
+
+    /// bounds of range cross areas
+    assert_int_equal( tree2_forEachInRange(&tree, 205, 301, collect_area, &visited), 2 );
+    assert_int_equal( visited.size, 2 );
+    assert_int_equal( visited.areas[0].start, 200 );
+    assert_int_equal( visited.areas[1].start, 300 );
+
+    /// areas touching range are not visited
+    visited.size = 0;
+    assert_int_equal( tree2_forEachInRange(&tree, 110, 200, collect_area, &visited), 0 );
+    assert_int_equal( tree2_forEachInRange(&tree, 0, 1000, collect_area, &visited), 4 );
+
+    /// stopped by visitor
+    visited.size = 0;
+    visited.limit = 1;
+    assert_int_equal( tree2_forEachInRange(&tree, 0, 1000, collect_area, &visited), 1 );
+    assert_int_equal( visited.areas[0].start, 100 );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_forEachInRange_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    for(size_t i = 0; i < 300; ++i) {
+        tree2_add(&tree, rand() % 0x100000 + 1, rand() % 0x1000 + 1);
+    }
+
+    for(size_t i = 0; i < 100; ++i) {
+        const size_t start = rand() % 0x100000;
+        const size_t end = start + rand() % 0x4000 + 1;
+        VisitedAreas visited;
+        visited.size = 0;
+        visited.limit = 64;
+        const size_t count = tree2_forEachInRange(&tree, start, end, collect_area, &visited);
+
+        size_t expected = 0;
+        for(size_t j = 0; j < tree2_size(&tree); ++j) {
+            const MemoryArea area = tree2_valueByIndex(&tree, j);
+            if (area.end <= start || area.start >= end) {
+                continue ;
+            }
+            if (expected < 64) {
+                assert_int_equal( visited.areas[expected].start, area.start );
+            }
+            ++expected;
+        }
+        if (count != expected) {
+            printf("seed: %u\n", seed);
+        }
+        assert_int_equal( count, expected );
+    }
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_forEachGap(void **state) {
+    (void) state; /* unused */
+
+    VisitedAreas visited;
+    visited.size = 0;
+    visited.limit = 64;
+    assert_int_equal( tree2_forEachGap(NULL, 0, collect_area, &visited), 0 );
+    assert_int_equal( tree2_largestGap(NULL).end, 0 );
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    assert_int_equal( tree2_forEachGap(&tree, 0, collect_area, &visited), 0 );
+    assert_int_equal( tree2_largestGap(&tree).end, 0 );
+
+    tree2_add(&tree, 100, 10);
+    tree2_add(&tree, 110, 10);
+    assert_int_equal( tree2_forEachGap(&tree, 0, collect_area, &visited), 0 );
+    assert_int_equal( tree2_largestGap(&tree).end, 0 );
+
+    tree2_add(&tree, 150, 10);
+    tree2_add(&tree, 200, 10);
+    tree2_add(&tree, 300, 10);
+    tree2_add(&tree, 400, 10);
+
+    /// gaps: (120, 150), (160, 200), (210, 300), (310, 400)
+    assert_int_equal( tree2_forEachGap(&tree, 0, collect_area, &visited), 4 );
+    assert_int_equal( visited.areas[0].start, 120 );
+    assert_int_equal( visited.areas[0].end, 150 );
+    assert_int_equal( visited.areas[1].start, 160 );
+    assert_int_equal( visited.areas[2].start, 210 );
+    assert_int_equal( visited.areas[3].start, 310 );
+    assert_int_equal( visited.areas[3].end, 400 );
+
+    visited.size = 0;
+    assert_int_equal( tree2_forEachGap(&tree, 50, collect_area, &visited), 2 );
+    assert_int_equal( visited.areas[0].start, 210 );
+    assert_int_equal( visited.areas[1].start, 310 );
+
+    /// stopped by visitor
+    visited.size = 0;
+    visited.limit = 1;
+    assert_int_equal( tree2_forEachGap(&tree, 0, collect_area, &visited), 1 );
+
+    /// lowest of largest gaps
+    MemoryArea gap = tree2_largestGap(&tree);
+    assert_int_equal( gap.start, 210 );
+    assert_int_equal( gap.end, 300 );
+
+    tree2_delete(&tree, 300);
+    gap = tree2_largestGap(&tree);
+    assert_int_equal( gap.start, 210 );
+    assert_int_equal( gap.end, 400 );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_largestGap_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    for(size_t i = 0; i < 300; ++i) {
+        tree2_add(&tree, rand() % 0x100000 + 1, rand() % 0x1000 + 1);
+        if (i % 3 == 0) {
+            tree2_delete(&tree, tree2_valueByIndex(&tree, rand() % tree2_size(&tree)).start);
+        }
+
+        /// brute force
+        MemoryArea expected = memory_create(0, 0);
+        size_t gaps = 0;
+        for(size_t j = 1; j < tree2_size(&tree); ++j) {
+            const size_t prevEnd = tree2_valueByIndex(&tree, j - 1).end;
+            const size_t nextStart = tree2_valueByIndex(&tree, j).start;
+            if (nextStart - prevEnd > memory_size(&expected)) {
+                expected = memory_create(prevEnd, nextStart - prevEnd);
+            }
+            if (nextStart - prevEnd >= 0x800) {
+                ++gaps;
+            }
+        }
+        const MemoryArea gap = tree2_largestGap(&tree);
+        if (gap.start != expected.start || gap.end != expected.end) {
+            printf("seed: %u\n", seed);
+        }
+        assert_int_equal( gap.start, expected.start );
+        assert_int_equal( gap.end, expected.end );
+
+        VisitedAreas visited;
+        visited.size = 0;
+        visited.limit = (size_t)-1;
+        assert_int_equal( tree2_forEachGap(&tree, 0x800, collect_area, &visited), gaps );
+    }
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_protect(void **state) {
+    (void) state; /* unused */
+
+    assert_int_equal( tree2_protect(NULL, 0, 100, READ), 0 );
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    tree2_useFreeIndex(&tree);
+    tree2_useRadixIndex(&tree);
+    const MemoryArea areas[4] = { memory_create(100, 100), memory_create(300, 100), memory_create(500, 100), memory_create(700, 100) };
+    assert_true( tree2_buildFromSorted(&tree, areas, 4) );
+
+    unsigned int any = 0;
+    unsigned int all = 0;
+    assert_true( tree2_rangeFlags(&tree, 0, 1000, &any, &all) );
+    assert_int_equal( any, 0 );
+    assert_int_equal( all, 0 );
+
+    /// split areas crossing bounds
+    assert_int_equal( tree2_protect(&tree, 150, 200, READ), 1 );
+    assert_int_equal( tree2_protect(&tree, 300, 350, READ), 1 );
+    assert_int_equal( tree2_size(&tree), 6 );
+    assert_int_equal( tree2_blocks(&tree), 4 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+    assert_int_equal( tree2_find(&tree, 120).end, 150 );
+    assert_int_equal( tree2_find(&tree, 320).end, 350 );
+    assert_true( tree2_rangeFlags(&tree, 150, 200, &any, &all) );
+    assert_int_equal( any, READ );
+    assert_int_equal( all, READ );
+    assert_true( tree2_rangeFlags(&tree, 100, 200, &any, &all) );
+    assert_int_equal( any, READ );
+    assert_int_equal( all, 0 );
+    assert_int_equal( tree2_rangeFlags(&tree, 210, 290, &any, &all), false );
+    assert_int_equal( any, 0 );
+    assert_int_equal( all, 0 );
+
+    /// join pieces of the same protection
+    assert_int_equal( tree2_protect(&tree, 100, 200, READ), 2 );
+    assert_int_equal( tree2_size(&tree), 5 );
+    assert_int_equal( tree2_protect(&tree, 300, 400, READ), 2 );
+    assert_int_equal( tree2_size(&tree), 4 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+    assert_int_equal( tree2_find(&tree, 120).end, 200 );
+    assert_int_equal( tree2_find(&tree, 320).start, 300 );
+
+    /// split area containing range and merge it back
+    assert_int_equal( tree2_protect(&tree, 550, 560, READ | WRITE), 1 );
+    assert_int_equal( tree2_size(&tree), 6 );
+    assert_true( tree2_rangeFlags(&tree, 500, 600, &any, &all) );
+    assert_int_equal( any, READ | WRITE );
+    assert_int_equal( all, 0 );
+    assert_int_equal( tree2_protect(&tree, 500, 600, 0), 3 );
+    assert_int_equal( tree2_size(&tree), 4 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    /// range not fully reserved -- nothing changes
+    assert_int_equal( tree2_protect(&tree, 420, 480, EXEC), -1 );
+    assert_int_equal( tree2_protect(&tree, 150, 350, EXEC), -1 );
+    assert_int_equal( tree2_protect(&tree, 0, 120, EXEC), -1 );
+    assert_int_equal( tree2_protect(&tree, 750, 850, EXEC), -1 );
+    assert_int_equal( tree2_size(&tree), 4 );
+    assert_int_equal( tree2_rangeFlags(&tree, 0, 1000, &any, &all), true );
+    assert_int_equal( any, READ );
+    assert_int_equal( all, 0 );
+    assert_int_equal( tree2_protect(&tree, 150, 150, EXEC), 0 );
+
+    /// separately reserved blocks are never merged
+    assert_int_equal( (size_t)tree2_mmapFlags(&tree, (void*)800, 100, TREE2_FIT_FIRST, READ), 800 );
+    assert_int_equal( tree2_protect(&tree, 700, 800, READ), 1 );
+    assert_int_equal( tree2_size(&tree), 5 );
+    assert_int_equal( tree2_blocks(&tree), 5 );
+    assert_int_equal( tree2_find(&tree, 750).end, 800 );
+    assert_int_equal( (size_t)tree2_mmapFlags(&tree, (void*)200, 100, TREE2_FIT_FIRST, READ), 200 );
+    assert_int_equal( tree2_size(&tree), 6 );
+    assert_int_equal( tree2_protect(&tree, 250, 260, READ), 0 );
+    assert_int_equal( tree2_protect(&tree, 200, 300, READ), 1 );
+    assert_int_equal( tree2_size(&tree), 6 );
+    assert_int_equal( tree2_blocks(&tree), 6 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+    assert_int_equal( tree2_find(&tree, 250).start, 200 );
+    assert_int_equal( tree2_find(&tree, 250).end, 300 );
+    assert_int_equal( tree2_freeExtents(&tree), 2 );
+
+    /// unmapping piece removes whole block
+    assert_int_equal( tree2_protect(&tree, 520, 540, EXEC), 1 );
+    assert_int_equal( tree2_size(&tree), 8 );
+    assert_int_equal( tree2_blocks(&tree), 6 );
+    tree2_munmap(&tree, (void*)530);
+    assert_int_equal( tree2_size(&tree), 5 );
+    assert_int_equal( tree2_blocks(&tree), 5 );
+    assert_int_equal( tree2_find(&tree, 510).start, 0 );
+    assert_int_equal( tree2_find(&tree, 510).end, 0 );
+    assert_int_equal( tree2_find(&tree, 580).end, 0 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_protect_adjacent(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    tree2_useFreeIndex(&tree);
+    tree2_useRadixIndex(&tree);
+
+    /// blocks A and B touch each other
+    assert_int_equal( (size_t)tree2_mmapFlags(&tree, (void*)1000, 100, TREE2_FIT_FIRST, READ), 1000 );
+    assert_int_equal( (size_t)tree2_mmapFlags(&tree, (void*)1100, 100, TREE2_FIT_FIRST, READ), 1100 );
+    assert_int_equal( tree2_protect(&tree, 1000, 1200, READ | WRITE), 2 );
+    assert_int_equal( tree2_size(&tree), 2 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    /// protect over boundary of blocks and restore it
+    assert_int_equal( tree2_protect(&tree, 1050, 1150, READ), 2 );
+    assert_int_equal( tree2_size(&tree), 4 );
+    assert_int_equal( tree2_blocks(&tree), 2 );
+    assert_int_equal( tree2_protect(&tree, 1000, 1200, READ | WRITE), 4 );
+    assert_int_equal( tree2_size(&tree), 2 );
+    assert_int_equal( tree2_blocks(&tree), 2 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    /// unmap B -- A stays mapped
+    tree2_munmap(&tree, (void*)1100);
+    assert_int_equal( tree2_size(&tree), 1 );
+    assert_int_equal( tree2_find(&tree, 1050).start, 1000 );
+    assert_int_equal( tree2_find(&tree, 1050).end, 1100 );
+    assert_int_equal( tree2_find(&tree, 1150).end, 0 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_protect_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    const size_t range = 0x4000;
+    const unsigned char unused = 0xFF;
+    for(size_t layout = 0; layout < 2; ++layout) {
+        RBTree2 tree;
+        tree2_initLayout(&tree, (RBTree2Layout)layout);
+        tree2_usePool(&tree);
+        tree2_useFreeIndex(&tree);
+        tree2_useRadixIndex(&tree);
+
+        /// protection of every address
+        unsigned char* flags = malloc(range);
+        memset(flags, unused, range);
+        size_t blocks = 0;
+        for(size_t i = 0; i < 100; ++i) {
+            const size_t size = rand() % 0x80 + 1;
+            const unsigned int areaFlags = rand() % (TREE2_FLAGS_MASK + 1);
+            const size_t start = (size_t)tree2_mmapFlags(&tree, (void*)(rand() % (range - 0x100) + 1), size, TREE2_FIT_FIRST, areaFlags);
+            if (start + size > range) {
+                tree2_deleteRange(&tree, start, start + size);
+                continue ;
+            }
+            memset(flags + start, areaFlags, size);
+            ++blocks;
+        }
+
+        for(size_t i = 0; i < 200; ++i) {
+            const size_t start = rand() % range;
+            const size_t end = start + rand() % ((i % 4 == 0) ? 0x40 : 0x400) + 1;
+            bool reserved = true;
+            for(size_t a = start; a < end; ++a) {
+                if (a >= range || flags[a] == unused) {
+                    reserved = false;
+                    break;
+                }
+            }
+            if (tree2_isReserved(&tree, start, end) != reserved) {
+                printf("seed: %u\n", seed);
+            }
+            assert_int_equal( tree2_isReserved(&tree, start, end), reserved );
+            if (i % 2 == 0) {
+                const unsigned int areaFlags = rand() % (TREE2_FLAGS_MASK + 1);
+                const int changed = tree2_protect(&tree, start, end, areaFlags);
+                if (reserved == false) {
+                    assert_int_equal( changed, -1 );
+                    continue ;
+                }
+                assert_true( changed >= 0 );
+                memset(flags + start, areaFlags, end - start);
+                const ARBTreeValidationError valid = tree2_isValid(&tree);
+                if (valid != ARBTREE_INVALID_OK) {
+                    printf("seed: %u\n", seed);
+                }
+                assert_int_equal( valid, ARBTREE_INVALID_OK );
+                assert_int_equal( tree2_blocks(&tree), blocks );
+                continue ;
+            }
+
+            /// brute force
+            unsigned int expectedAny = 0;
+            unsigned int expectedAll = TREE2_FLAGS_MASK;
+            bool found = false;
+            for(size_t a = start; a < end && a < range; ++a) {
+                if (flags[a] != unused) {
+                    expectedAny |= flags[a];
+                    expectedAll &= flags[a];
+                    found = true;
+                }
+            }
+            unsigned int any = 0;
+            unsigned int all = 0;
+            const bool result = tree2_rangeFlags(&tree, start, end, &any, &all);
+            if (result != found || any != (found ? expectedAny : 0) || all != (found ? expectedAll : 0)) {
+                printf("seed: %u\n", seed);
+            }
+            assert_int_equal( result, found );
+            if (found == true) {
+                assert_int_equal( any, expectedAny );
+                assert_int_equal( all, expectedAll );
+            }
+        }
+
+        /// areas match model
+        size_t reserved = 0;
+        for(size_t i = 0; i < tree2_size(&tree); ++i) {
+            const MemoryArea area = tree2_valueByIndex(&tree, i);
+            unsigned int any = 0;
+            unsigned int all = 0;
+            assert_true( tree2_rangeFlags(&tree, area.start, area.end, &any, &all) );
+            assert_int_equal( any, all );
+            for(size_t a = area.start; a < area.end; ++a) {
+                assert_int_equal( flags[a], any );
+            }
+            reserved += memory_size(&area);
+        }
+        size_t expected = 0;
+        for(size_t a = 0; a < range; ++a) {
+            expected += (flags[a] != unused) ? 1 : 0;
+        }
+        assert_int_equal( reserved, expected );
+
+        free(flags);
+        tree2_release(&tree);
+    }
+}
+
 static void test_tree2_munmap_NULL(void **state) {
     (void) state; /* unused */
 
@@ -387,6 +1635,60 @@ static void test_tree2_init_valid(void **state) {
     tree2_release(&tree);
 }
 
+static void test_tree2_initLayout_external(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    const bool ret = tree2_initLayout(&tree, TREE2_LAYOUT_EXTERNAL);
+    assert_int_equal( ret, true );
+
+    for(size_t i = 0; i < 16; ++i) {
+        tree2_add(&tree, 10, 5);
+    }
+    assert_int_equal( tree2_size(&tree), 16 );
+    assert_int_equal( tree2_endAddress(&tree), 90 );
+
+    tree2_delete(&tree, 42);
+    tree2_delete(&tree, 10);
+    assert_int_equal( tree2_size(&tree), 14 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    const MemoryArea area = tree2_valueByIndex(&tree, 0);
+    assert_int_equal( area.start, 15 );
+
+    tree2_release(&tree);
+}
+
+static void test_tree2_usePool(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_initLayout(&tree, TREE2_LAYOUT_EXTERNAL);
+    assert_int_equal( tree2_usePool(&tree), true );
+
+    for(size_t i = 0; i < 16; ++i) {
+        tree2_add(&tree, 10, 5);
+    }
+    tree2_delete(&tree, 42);
+    assert_int_equal( tree2_size(&tree), 15 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    /// not empty tree
+    assert_int_equal( tree2_usePool(&tree), false );
+    assert_int_equal( tree2_usePool(NULL), false );
+
+    tree2_release(&tree);
+    assert_int_equal( tree2_size(&tree), 0 );
+}
+
+static void test_tree2_initLayout_invalid(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    const bool ret = tree2_initLayout(&tree, (RBTree2Layout)-1);
+    assert_int_equal( ret, false );
+}
+
 
 /// ==================================================
 
@@ -681,6 +1983,40 @@ static void test_tree2_endAddress_valid(void **state) {
     }
 }
 
+static void test_tree2_bounds_delete(void **state) {
+    (void) state; /* unused */
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    for(size_t i = 0; i < 32; ++i) {
+        tree2_add(&tree, 10 + i * 20, 10);
+    }
+    assert_int_equal( tree2_startAddress(&tree), 10 );
+    assert_int_equal( tree2_endAddress(&tree), 640 );
+    assert_in_range( tree2_depth(&tree), tree2_blackHeight(&tree), 2 * tree2_blackHeight(&tree) );
+
+    /// remove from both ends
+    for(size_t i = 0; i < 15; ++i) {
+        tree2_delete(&tree, 10 + i * 20);
+        tree2_delete(&tree, 630 - i * 20);
+        assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+        assert_int_equal( tree2_startAddress(&tree), 30 + i * 20 );
+        assert_int_equal( tree2_endAddress(&tree), 620 - i * 20 );
+        assert_in_range( tree2_depth(&tree), tree2_blackHeight(&tree), 2 * tree2_blackHeight(&tree) );
+    }
+    assert_int_equal( tree2_size(&tree), 2 );
+
+    tree2_delete(&tree, 310);
+    tree2_delete(&tree, 330);
+    assert_int_equal( tree2_size(&tree), 0 );
+    assert_int_equal( tree2_blackHeight(&tree), 0 );
+    assert_int_equal( tree2_startAddress(&tree), 0 );
+    assert_int_equal( tree2_endAddress(&tree), 0 );
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    tree2_release(&tree);
+}
+
 static void test_tree2_area_NULL(void **state) {
     (void) state; /* unused */
 
@@ -757,6 +2093,37 @@ static void test_tree2_valueByIndex(void **state) {
     tree2_release(&tree);
 }
 
+static void test_tree2_valueByIndex_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    static const size_t nodes_num = 200;
+
+    RBTree2 tree = create_random_tree2_map(seed, nodes_num, 2000, 20);
+    const MemoryArea area = tree2_area(&tree);
+
+    for(size_t i = 0; i < nodes_num / 2; ++i) {
+        const size_t addr = rand() % memory_size(&area) + area.start;
+        tree2_delete(&tree, addr);
+    }
+    assert_int_equal( tree2_isValid(&tree), ARBTREE_INVALID_OK );
+
+    const size_t treeSize = tree2_size(&tree);
+    size_t prevEnd = 0;
+    for(size_t i = 0; i < treeSize; ++i) {
+        const MemoryArea curr = tree2_valueByIndex(&tree, i);
+        assert_int_not_equal( memory_size(&curr), 0 );
+        assert_true( prevEnd <= curr.start );
+        prevEnd = curr.end;
+    }
+    assert_int_equal( prevEnd, tree2_endAddress(&tree) );
+
+    const MemoryArea last = tree2_valueByIndex(&tree, treeSize);
+    assert_int_equal( memory_size(&last), 0 );
+
+    tree2_release(&tree);
+}
+
 static void test_tree2_isValid_NULL(void **state) {
     (void) state; /* unused */
 
@@ -1212,6 +2579,9 @@ int main(void) {
     const struct UnitTest tests[] = {
         unit_test(test_tree2_init_NULL),
         unit_test(test_tree2_init_valid),
+        unit_test(test_tree2_initLayout_external),
+        unit_test(test_tree2_initLayout_invalid),
+        unit_test(test_tree2_usePool),
 
         unit_test(test_tree2_add_NULL),
         unit_test(test_tree2_add_0),
@@ -1230,12 +2600,14 @@ int main(void) {
         unit_test(test_tree2_depth_0),
         unit_test(test_tree2_startAddress_valid),
         unit_test(test_tree2_endAddress_valid),
+        unit_test(test_tree2_bounds_delete),
         unit_test(test_tree2_area_NULL),
         unit_test(test_tree2_area_empty),
 
         unit_test(test_tree2_valueByIndex_NULL),
         unit_test(test_tree2_valueByIndex_empty),
         unit_test(test_tree2_valueByIndex),
+        unit_test(test_tree2_valueByIndex_random),
 
         unit_test(test_tree2_isValid_NULL),
         unit_test(test_tree2_isValid_valid),
@@ -1261,6 +2633,34 @@ int main(void) {
         unit_test(test_tree2_mmap_second),
         unit_test(test_tree2_mmap_segmented_toLeft),
         unit_test(test_tree2_mmap_segmented_toRight),
+        unit_test(test_tree2_mmap_fragmented),
+        unit_test(test_tree2_mmapBestFit),
+        unit_test(test_tree2_useFreeIndex),
+        unit_test(test_tree2_freeIndex_random),
+        unit_test(test_tree2_setPolicy),
+        unit_test(test_tree2_addFit_next),
+        unit_test(test_tree2_addFit_topDown),
+        unit_test(test_tree2_addFit_topDown_noHint),
+        unit_test(test_tree2_addFit_topDown_random),
+        unit_test(test_tree2_useRadixIndex),
+        unit_test(test_tree2_useRadixIndex_large),
+        unit_test(test_tree2_useRadixIndex_random),
+        unit_test(test_tree2_addBatch),
+        unit_test(test_tree2_addBatch_perCall),
+        unit_test(test_tree2_addBatch_random),
+        unit_test(test_tree2_buildFromSorted),
+        unit_test(test_tree2_buildFromSorted_random),
+        unit_test(test_tree2_deleteRange),
+        unit_test(test_tree2_deleteRange_random),
+        unit_test(test_tree2_cursor),
+        unit_test(test_tree2_cursor_random),
+        unit_test(test_tree2_forEachInRange),
+        unit_test(test_tree2_forEachInRange_random),
+        unit_test(test_tree2_forEachGap),
+        unit_test(test_tree2_largestGap_random),
+        unit_test(test_tree2_protect),
+        unit_test(test_tree2_protect_adjacent),
+        unit_test(test_tree2_protect_random),
 
         unit_test(test_tree2_munmap_NULL),
         unit_test(test_tree2_munmap_empty),
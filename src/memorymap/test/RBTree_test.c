@@ -386,6 +386,30 @@ static void test_tree_init_valid(void **state) {
     tree_release(&tree);
 }
 
+static void test_tree_usePool(void **state) {
+    (void) state; /* unused */
+
+    RBTree tree;
+    tree_init(&tree);
+    const int ret = tree_usePool(&tree);
+    assert_int_equal( ret, 0 );
+
+    for(size_t i = 0; i < 16; ++i) {
+        tree_add(&tree, 10, 5);
+    }
+    tree_delete(&tree, 42);
+    tree_delete(&tree, 10);
+    assert_int_equal( tree_size(&tree), 14 );
+    assert_int_equal( tree_isValid(&tree), RBTREE_INVALID_OK );
+
+    /// not empty tree
+    assert_int_equal( tree_usePool(&tree), -2 );
+
+    const int released = tree_release(&tree);
+    assert_int_equal( released, 14 );
+    assert_null( tree.pool );
+}
+
 
 /// ==================================================
 
@@ -652,6 +676,32 @@ static void test_tree_endAddress_valid(void **state) {
     }
 }
 
+static void test_tree_bounds_delete(void **state) {
+    (void) state; /* unused */
+
+    RBTree tree;
+    tree_init(&tree);
+    for(size_t i = 0; i < 32; ++i) {
+        tree_add(&tree, 10 + i * 20, 10);
+    }
+    assert_int_equal( tree_startAddress(&tree), 10 );
+    assert_int_equal( tree_endAddress(&tree), 640 );
+
+    /// remove from both ends
+    for(size_t i = 0; i < 16; ++i) {
+        tree_delete(&tree, 10 + i * 20);
+        tree_delete(&tree, 630 - i * 20);
+        assert_int_equal( tree_isValid(&tree), RBTREE_INVALID_OK );
+        assert_int_equal( tree_size(&tree), 30 - i * 2 );
+        assert_in_range( tree_depth(&tree), tree_blackHeight(&tree), 2 * tree_blackHeight(&tree) );
+    }
+    assert_int_equal( tree_blackHeight(&tree), 0 );
+    assert_int_equal( tree_startAddress(&tree), 0 );
+    assert_int_equal( tree_endAddress(&tree), 0 );
+
+    tree_release(&tree);
+}
+
 static void test_tree_area_NULL(void **state) {
     (void) state; /* unused */
 
@@ -1218,6 +1268,7 @@ int main(void) {
     const struct UnitTest tests[] = {
         unit_test(test_tree_init_NULL),
         unit_test(test_tree_init_valid),
+        unit_test(test_tree_usePool),
         
         unit_test(test_tree_add_NULL),
         unit_test(test_tree_add_0),
@@ -1235,6 +1286,7 @@ int main(void) {
         unit_test(test_tree_depth_0),
         unit_test(test_tree_startAddress_valid),
         unit_test(test_tree_endAddress_valid),
+        unit_test(test_tree_bounds_delete),
         unit_test(test_tree_area_NULL),
         unit_test(test_tree_area_empty),
 
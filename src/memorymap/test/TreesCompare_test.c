@@ -23,6 +23,7 @@
 
 #include "memorymap/RBTree.h"
 #include "memorymap/RBTreeV2.h"
+#include "memorymap/BTree.h"
 
 #include <time.h>
 #include <stdlib.h>
@@ -157,6 +158,97 @@ static void test_trees_comparison(void **state) {
 }
 
 
+static bool compare_btree(RBTree2* tree2, BTree* btree) {
+    const size_t size1 = tree2_size(tree2);
+    const size_t size2 = btree_size(btree);
+    if (size1 != size2 ) {
+        printf("bad size: %zu != %zu", size1, size2);
+        return false;
+    }
+    if ( btree_isValid(btree) != BTREE_INVALID_OK ) {
+        printf("First tree:\n");
+        tree2_print(tree2);
+        printf("Second tree:\n");
+        btree_print(btree);
+        printf("invalid B-tree");
+        return false;
+    }
+    for(size_t x = 0; x < size1; ++x) {
+        const MemoryArea area1 = tree2_valueByIndex(tree2, x);
+        const MemoryArea area2 = btree_valueByIndex(btree, x);
+        if (memory_isEqual( &area1, &area2 ) == false) {
+            printf("First tree:\n");
+            tree2_print(tree2);
+            printf("Second tree:\n");
+            btree_print(btree);
+            printf("bad elements in index %zu", x);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_trees_comparison_btree(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    /// enough nodes to have inner B-tree nodes
+    static const size_t nodes_num = 600;
+    static const size_t max_address = 20000;
+    static const size_t max_size = 50;
+
+    RBTree2 tree2;
+    tree2_init(&tree2);
+
+    BTree btree;
+    btree_init(&btree);
+
+
+    /// adding random elements
+
+    for(size_t i = 0; i < nodes_num; ++i) {
+        const size_t addr = rand() % max_address +1;
+        const size_t msize = rand() % max_size +1;
+
+        const size_t ret1 = tree2_add(&tree2, addr, msize);
+        const size_t ret2 = btree_add(&btree, addr, msize);
+        assert_int_equal( ret1, ret2 );
+    }
+    if (compare_btree(&tree2, &btree) == false) {
+        fail_msg("trees differ for seed %u", seed);
+    }
+
+    const MemoryArea area1 = tree2_area(&tree2);
+    const MemoryArea area2 = btree_area(&btree);
+    assert_int_equal( memory_isEqual( &area1, &area2 ), true );
+
+
+    /// mixed deleting and adding random elements
+
+    for(size_t i = 0; i < nodes_num * 2; ++i) {
+        const size_t addr = rand() % memory_size(&area1) + area1.start;
+        if (i % 3 == 0) {
+            const size_t msize = rand() % max_size +1;
+            const size_t ret1 = tree2_add(&tree2, addr, msize);
+            const size_t ret2 = btree_add(&btree, addr, msize);
+            assert_int_equal( ret1, ret2 );
+        } else {
+            tree2_delete(&tree2, addr);
+            btree_delete(&btree, addr);
+        }
+
+        if (compare_btree(&tree2, &btree) == false) {
+            fail_msg("trees differ for seed %u", seed);
+        }
+    }
+
+    tree2_release(&tree2);
+    btree_release(&btree);
+}
+
+
 /// ==================================================
 
 
@@ -165,7 +257,8 @@ int main(void) {
     //TODO: add selective run
 
     const struct UnitTest tests[] = {
-        unit_test(test_trees_comparison)
+        unit_test(test_trees_comparison),
+        unit_test(test_trees_comparison_btree)
     };
 
     return run_group_tests(tests);
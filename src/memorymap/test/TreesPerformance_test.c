@@ -23,6 +23,11 @@
 
 #include "memorymap/RBTree.h"
 #include "memorymap/RBTreeV2.h"
+#include "memorymap/BTree.h"
+#include "memorymap/Bitmap.h"
+#include "memorymap/Buddy.h"
+#include "rbtree/AbstractRBTree.h"
+#include "rbtree/NodePool.h"
 
 #include "benchmark/Timer.h"
 
@@ -30,6 +35,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <stdio.h>                              /// printf
+#include <string.h>                             /// memset
 
 
 
@@ -176,6 +182,886 @@ static void test_trees_exhaustive() {
 }
 
 
+static void test_trees_fragmented() {
+    #define fragmented_num 5000
+
+    RBTree tree;
+    tree_init(&tree);
+
+    RBTree2 tree2;
+    tree2_init(&tree2);
+
+    /// blocks of size 2 separated by 1 byte gaps
+    for(size_t i = 0; i < fragmented_num; ++i) {
+        const size_t addr = 3*i + 1;
+        tree_add(&tree, addr, 2);
+        tree2_add(&tree2, addr, 2);
+    }
+
+    /// every request does not fit into any gap
+    double timer1 = 0.0;
+    double timer2 = 0.0;
+
+    for(size_t i = 0; i < fragmented_num; ++i) {
+        timer_elapsed();
+        tree_add(&tree, 1, 2);
+        timer1 += timer_elapsed();
+        tree2_add(&tree2, 1, 2);
+        timer2 += timer_elapsed();
+    }
+
+    const double factor = timer2 / timer1 * 100.0;
+    printf("Fragmented timing: %f %f %f%%\n", timer1, timer2, factor);
+
+    tree_release(&tree);
+    tree2_release(&tree2);
+}
+
+
+static void test_trees_layout() {
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    #define layout_num 100000
+    static const size_t layout_address = layout_num*max_size / 2;
+
+    RBTree2 treeExt;
+    tree2_initLayout(&treeExt, TREE2_LAYOUT_EXTERNAL);
+
+    RBTree2 treeIn;
+    tree2_initLayout(&treeIn, TREE2_LAYOUT_INLINE);
+
+    double timer1 = 0.0;
+    double timer2 = 0.0;
+
+    for(size_t i = 0; i < layout_num; ++i) {
+        const size_t addr = rand() % layout_address +1;
+        const size_t msize = rand() % max_size +1;
+
+        timer_elapsed();
+        tree2_add(&treeExt, addr, msize);
+        timer1 += timer_elapsed();
+        tree2_add(&treeIn, addr, msize);
+        timer2 += timer_elapsed();
+    }
+
+    const MemoryArea area = tree2_area(&treeExt);
+
+    for(size_t i = 0; i < layout_num; ++i) {
+        const size_t addr = rand() % memory_size(&area) + area.start;
+
+        timer_elapsed();
+        tree2_delete(&treeExt, addr);
+        timer1 += timer_elapsed();
+        tree2_delete(&treeIn, addr);
+        timer2 += timer_elapsed();
+    }
+
+    const double factor = timer2 / timer1 * 100.0;
+    printf("Layout timing (external, inline): %f %f %f%%\n", timer1, timer2, factor);
+
+    tree2_release(&treeExt);
+    tree2_release(&treeIn);
+}
+
+
+static void test_trees_pool() {
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    #define pool_num 100000
+    static const size_t pool_address = pool_num*max_size / 2;
+
+    RBTree tree;
+    tree_init(&tree);
+
+    RBTree treePool;
+    tree_init(&treePool);
+    tree_usePool(&treePool);
+
+    RBTree2 tree2;
+    tree2_initLayout(&tree2, TREE2_LAYOUT_INLINE);
+
+    RBTree2 tree2Pool;
+    tree2_init(&tree2Pool);
+
+    double timer1 = 0.0;
+    double timer2 = 0.0;
+    double timer3 = 0.0;
+    double timer4 = 0.0;
+
+    /// churn: reserve and release blocks
+    for(size_t i = 0; i < pool_num; ++i) {
+        const size_t addr = rand() % pool_address +1;
+        const size_t msize = rand() % max_size +1;
+        const size_t delAddr = rand() % pool_address +1;
+
+        timer_elapsed();
+        tree_add(&tree, addr, msize);
+        tree_delete(&tree, delAddr);
+        timer1 += timer_elapsed();
+        tree_add(&treePool, addr, msize);
+        tree_delete(&treePool, delAddr);
+        timer2 += timer_elapsed();
+        tree2_add(&tree2, addr, msize);
+        tree2_delete(&tree2, delAddr);
+        timer3 += timer_elapsed();
+        tree2_add(&tree2Pool, addr, msize);
+        tree2_delete(&tree2Pool, delAddr);
+        timer4 += timer_elapsed();
+    }
+
+    timer_elapsed();
+    tree_release(&tree);
+    timer1 += timer_elapsed();
+    tree_release(&treePool);
+    timer2 += timer_elapsed();
+    tree2_release(&tree2);
+    timer3 += timer_elapsed();
+    tree2_release(&tree2Pool);
+    timer4 += timer_elapsed();
+
+    printf("Pool timing (malloc, pool): RBTree: %f %f %f%%, RBTree2: %f %f %f%%\n",
+           timer1, timer2, timer2 / timer1 * 100.0,
+           timer3, timer4, timer4 / timer3 * 100.0);
+}
+
+
+/**
+ * Memory used by tree per reserved block (node with inline value, slot size in pool).
+ */
+static void test_trees_footprint() {
+    RBTree tree;
+    tree_init(&tree);
+    tree_usePool(&tree);
+
+    RBTree2 tree2;
+    tree2_init(&tree2);
+
+    const NodePool* pool = tree.pool;
+    const NodePool* pool2 = (const NodePool*) tree2.tree.allocator;
+
+    printf("Footprint per block (node, pool slot): RBTree: %zu %zu, RBTree2: %zu %zu\n",
+           sizeof(RBTreeNode), pool->nodeSize,
+           sizeof(ARBTreeNode) + tree2.tree.valueSize, pool2->nodeSize);
+
+    tree_release(&tree);
+    tree2_release(&tree2);
+}
+
+/**
+ * Long run of reserving and releasing blocks -- compares placement policies
+ * (time, address space used at the end and its fragmentation).
+ */
+static void test_trees_policies() {
+    const unsigned int seed = get_next_seed();
+
+    #define fit_num 50000
+    #define fit_max_size 200
+    #define policies_num 4
+
+    static const char* policyNames[policies_num] = { "first", "next", "best", "top-down" };
+    static const size_t top_address = (size_t)fit_num * fit_max_size * 2;
+
+    size_t* addr = calloc(fit_num, sizeof(size_t));
+    size_t* sizes = calloc(fit_num, sizeof(size_t));
+
+    for(size_t p = 0; p < policies_num; ++p) {
+        /// same sequence of operations for every policy
+        srand( seed );
+
+        const RBTree2Policy policy = (RBTree2Policy)p;
+        const size_t hint = (policy == TREE2_FIT_TOP_DOWN) ? top_address : 1;
+
+        RBTree2 tree;
+        tree2_init(&tree);
+        tree2_setPolicy(&tree, policy);
+
+        size_t used = 0;
+        double timer = 0.0;
+
+        for(size_t i = 0; i < fit_num; ++i) {
+            const size_t msize = rand() % fit_max_size +1;
+            /// release random earlier block (every other iteration, so map grows)
+            const size_t delIndex = (i % 2 == 0) ? rand() % (i + 1) : fit_num;
+
+            timer_elapsed();
+            addr[i] = tree2_add(&tree, hint, msize);
+            if (delIndex < fit_num && sizes[delIndex] > 0) {
+                tree2_delete(&tree, addr[delIndex]);
+            }
+            timer += timer_elapsed();
+
+            sizes[i] = msize;
+            used += msize;
+            if (delIndex < fit_num && sizes[delIndex] > 0) {
+                used -= sizes[delIndex];
+                sizes[delIndex] = 0;
+            }
+        }
+
+        const MemoryArea space = tree2_area(&tree);
+        const size_t span = memory_size(&space);
+        printf("Policy %-8s: time: %f, address space: %zu, fragmentation: %f%%\n",
+               policyNames[p], timer, span, (1.0 - (double)used / (double)span) * 100.0);
+
+        memset(sizes, 0, fit_num * sizeof(size_t));
+        tree2_release(&tree);
+    }
+
+    free(addr);
+    free(sizes);
+}
+
+static void test_trees_finger() {
+    #define finger_num 100000
+
+    size_t* addr = calloc(finger_num, sizeof(size_t));
+    double timers[2] = { 0.0, 0.0 };
+
+    for(size_t t = 0; t < 2; ++t) {
+        srand( 1 );
+
+        RBTree2 tree;
+        tree2_init(&tree);
+        if (t == 1) {
+            tree2_useFinger(&tree);
+        }
+        /// random background blocks
+        for(size_t i = 0; i < finger_num; ++i) {
+            tree2_add(&tree, (rand() % finger_num) * 0x10000 + 1, rand() % 0x100 + 1);
+        }
+
+        timer_elapsed();
+        /// blocks reserved one after another and removed in neighbour order
+        size_t next = 0x80000000;
+        for(size_t i = 0; i < finger_num; ++i) {
+            addr[i] = tree2_add(&tree, next, 0x100);
+            next = addr[i] + 0x100;
+        }
+        for(size_t i = 0; i < finger_num; ++i) {
+            tree2_delete(&tree, addr[finger_num - 1 - i]);
+        }
+        timers[t] = timer_elapsed();
+
+        tree2_release(&tree);
+    }
+
+    printf("Finger timing (root, finger): %f %f %f%%\n", timers[0], timers[1], timers[1] / timers[0] * 100.0);
+
+    free(addr);
+}
+
+static void test_trees_radix() {
+    const unsigned int seed = get_next_seed();
+
+    #define radix_num 100000
+
+    size_t* addr = calloc(radix_num, sizeof(size_t));
+    double findTimers[2] = { 0.0, 0.0 };
+    double deleteTimers[2] = { 0.0, 0.0 };
+    size_t sums[2] = { 0, 0 };
+
+    for(size_t t = 0; t < 2; ++t) {
+        /// same sequence of operations for both trees
+        srand( seed );
+
+        RBTree2 tree;
+        tree2_init(&tree);
+        if (t == 1) {
+            tree2_useRadixIndex(&tree);
+        }
+        for(size_t i = 0; i < radix_num; ++i) {
+            addr[i] = tree2_add(&tree, (rand() % radix_num) * 0x1000, rand() % 0x4000 + 1);
+        }
+
+        timer_elapsed();
+        for(size_t i = 0; i < radix_num * 4; ++i) {
+            const MemoryArea area = tree2_find(&tree, addr[rand() % radix_num] + rand() % 0x10);
+            sums[t] += area.start;
+        }
+        findTimers[t] = timer_elapsed();
+
+        for(size_t i = 0; i < radix_num; ++i) {
+            const size_t index = rand() % radix_num;
+            timer_elapsed();
+            tree2_delete(&tree, addr[index]);
+            deleteTimers[t] += timer_elapsed();
+        }
+
+        tree2_release(&tree);
+    }
+
+    printf("Radix index timing (find: tree, radix; delete: tree, radix): %f %f %f%% %f %f %f%%, checksum: %d\n",
+           findTimers[0], findTimers[1], findTimers[1] / findTimers[0] * 100.0,
+           deleteTimers[0], deleteTimers[1], deleteTimers[1] / deleteTimers[0] * 100.0,
+           sums[0] == sums[1]);
+
+    free(addr);
+}
+
+static void test_trees_batch() {
+    #define batch_num 100000
+    #define batch_small 16
+
+    MemoryArea* areas = calloc(batch_num, sizeof(MemoryArea));
+    MemoryArea* requests = calloc(batch_num, sizeof(MemoryArea));
+    MemoryArea* placed = calloc(batch_num, sizeof(MemoryArea));
+
+    /// loader regions -- shuffled, rarely conflicting
+    srand( 1 );
+    for(size_t i = 0; i < batch_num; ++i) {
+        requests[i] = memory_create((i + 1) * 0x10000, rand() % 0x14000 + 1);
+    }
+    for(size_t i = batch_num - 1; i > 0; --i) {
+        const size_t j = rand() % (i + 1);
+        const MemoryArea tmp = requests[i];
+        requests[i] = requests[j];
+        requests[j] = tmp;
+    }
+
+    /// whole map reserved at once, then small batches added to large map
+    for(size_t scenario = 0; scenario < 2; ++scenario) {
+        const size_t batchSize = (scenario == 0) ? batch_num : batch_small;
+        double timers[2] = { 0.0, 0.0 };
+        size_t sizes[2] = { 0, 0 };
+        bool equal = true;
+        for(size_t t = 0; t < 2; ++t) {
+            /// configured as map of MyMap
+            RBTree2 tree;
+            tree2_init(&tree);
+            tree2_useFreeIndex(&tree);
+            tree2_useRadixIndex(&tree);
+            if (scenario == 1) {
+                memcpy(areas, requests, batch_num * sizeof(MemoryArea));
+                tree2_addBatch(&tree, areas, batch_num);
+            }
+
+            memcpy(areas, requests, batch_num * sizeof(MemoryArea));
+            timer_elapsed();
+            for(size_t offset = 0; offset < batch_num; offset += batchSize) {
+                MemoryArea* batch = areas + offset;
+                if (t == 0) {
+                    for(size_t i = 0; i < batchSize; ++i) {
+                        const size_t size = memory_size(&batch[i]);
+                        batch[i] = memory_create(tree2_add(&tree, batch[i].start, size), size);
+                    }
+                } else {
+                    tree2_addBatch(&tree, batch, batchSize);
+                }
+            }
+            timers[t] = timer_elapsed();
+
+            if (t == 0) {
+                memcpy(placed, areas, batch_num * sizeof(MemoryArea));
+            } else {
+                equal = (memcmp(placed, areas, batch_num * sizeof(MemoryArea)) == 0);
+            }
+            sizes[t] = tree2_size(&tree);
+            tree2_release(&tree);
+        }
+
+        printf("Batch timing of %zu blocks (per-call, batch): %f %f %f%%, blocks: %zu %zu, same placement: %d\n",
+               batchSize, timers[0], timers[1], timers[1] / timers[0] * 100.0, sizes[0], sizes[1], equal);
+    }
+
+    free(placed);
+    free(requests);
+    free(areas);
+}
+
+static void test_trees_build() {
+    #define build_num 200000
+
+    MemoryArea* areas = calloc(build_num, sizeof(MemoryArea));
+    srand( 1 );
+    size_t address = 1;
+    for(size_t i = 0; i < build_num; ++i) {
+        address += rand() % 0x1000;
+        areas[i] = memory_create(address, rand() % 0x1000 + 1);
+        address = areas[i].end;
+    }
+
+    double timers[2] = { 0.0, 0.0 };
+    size_t depths[2] = { 0, 0 };
+    for(size_t t = 0; t < 2; ++t) {
+        RBTree2 tree;
+        tree2_init(&tree);
+
+        timer_elapsed();
+        if (t == 0) {
+            for(size_t i = 0; i < build_num; ++i) {
+                tree2_add(&tree, areas[i].start, memory_size(&areas[i]));
+            }
+        } else {
+            tree2_buildFromSorted(&tree, areas, build_num);
+        }
+        timers[t] = timer_elapsed();
+
+        depths[t] = tree2_depth(&tree);
+        tree2_release(&tree);
+    }
+
+    printf("Build timing (add, build from sorted): %f %f %f%%, depth: %zu %zu\n",
+           timers[0], timers[1], timers[1] / timers[0] * 100.0, depths[0], depths[1]);
+
+    free(areas);
+}
+
+static void test_trees_range() {
+    #define range_num 200000
+    #define range_blocks 64
+
+    MemoryArea* areas = calloc(range_num, sizeof(MemoryArea));
+    srand( 1 );
+    size_t address = 1;
+    for(size_t i = 0; i < range_num; ++i) {
+        address += rand() % 0x1000;
+        areas[i] = memory_create(address, rand() % 0x1000 + 1);
+        address = areas[i].end;
+    }
+
+    /// release ranges of 'range_blocks' blocks
+    double timers[2] = { 0.0, 0.0 };
+    for(size_t t = 0; t < 2; ++t) {
+        RBTree2 tree;
+        tree2_init(&tree);
+        tree2_buildFromSorted(&tree, areas, range_num);
+
+        timer_elapsed();
+        for(size_t i = 0; i < range_num; i += range_blocks) {
+            const size_t last = (i + range_blocks < range_num) ? i + range_blocks : range_num;
+            if (t == 0) {
+                for(size_t j = i; j < last; ++j) {
+                    tree2_delete(&tree, areas[j].start);
+                }
+            } else {
+                tree2_deleteRange(&tree, areas[i].start, areas[last - 1].end);
+            }
+        }
+        timers[t] = timer_elapsed();
+
+        assert( tree2_size(&tree) == 0 );
+        tree2_release(&tree);
+    }
+
+    printf("Range release timing (delete, delete range): %f %f %f%%\n", timers[0], timers[1], timers[1] / timers[0] * 100.0);
+
+    free(areas);
+}
+
+static void test_trees_cursor() {
+    #define cursor_num 200000
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    srand( 1 );
+    size_t address = 1;
+    for(size_t i = 0; i < cursor_num; ++i) {
+        address += rand() % 0x1000;
+        address = tree2_add(&tree, address, rand() % 0x1000 + 1) + 1;
+    }
+
+    /// walk over all areas
+    size_t sums[2] = { 0, 0 };
+    double timers[2] = { 0.0, 0.0 };
+    timer_elapsed();
+    for(size_t i = 0; i < tree2_size(&tree); ++i) {
+        sums[0] += tree2_valueByIndex(&tree, i).start;
+    }
+    timers[0] = timer_elapsed();
+    RBTree2Cursor cursor;
+    for(bool valid = tree2_cursorFirst(&tree, &cursor); valid == true; valid = tree2_cursorNext(&cursor)) {
+        sums[1] += tree2_cursorGet(&cursor).start;
+    }
+    timers[1] = timer_elapsed();
+    assert( sums[0] == sums[1] );
+
+    printf("Walk timing (value by index, cursor): %f %f %f%%\n", timers[0], timers[1], timers[1] / timers[0] * 100.0);
+
+    tree2_release(&tree);
+}
+
+static bool count_visited(const MemoryArea* area, void* context) {
+    (void) area; /* unused */
+    size_t* counter = (size_t*)context;
+    ++(*counter);
+    return true;
+}
+
+static void test_trees_rangeVisit() {
+    #define visit_num 200000
+    #define visit_queries 100
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    srand( 1 );
+    size_t address = 1;
+    for(size_t i = 0; i < visit_num; ++i) {
+        address += rand() % 0x1000;
+        address = tree2_add(&tree, address, rand() % 0x1000 + 1) + 1;
+    }
+
+    /// areas overlapping windows: scan of all areas and range visit
+    size_t counters[2] = { 0, 0 };
+    double timers[2] = { 0.0, 0.0 };
+    for(size_t t = 0; t < 2; ++t) {
+        srand( 2 );
+        timer_elapsed();
+        for(size_t i = 0; i < visit_queries; ++i) {
+            const size_t start = rand() % address;
+            const size_t end = start + 0x10000;
+            if (t == 0) {
+                RBTree2Cursor cursor;
+                for(bool valid = tree2_cursorFirst(&tree, &cursor); valid == true; valid = tree2_cursorNext(&cursor)) {
+                    const MemoryArea area = tree2_cursorGet(&cursor);
+                    if (area.end > start && area.start < end) {
+                        ++counters[t];
+                    }
+                }
+            } else {
+                tree2_forEachInRange(&tree, start, end, count_visited, &counters[t]);
+            }
+        }
+        timers[t] = timer_elapsed();
+    }
+    assert( counters[0] == counters[1] );
+
+    printf("Range visit timing (scan, visit range): %f %f %f%%\n", timers[0], timers[1], timers[1] / timers[0] * 100.0);
+
+    tree2_release(&tree);
+}
+
+static void test_trees_largestGap() {
+    #define gap_num 200000
+    #define gap_queries 20
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    srand( 1 );
+    size_t address = 1;
+    for(size_t i = 0; i < gap_num; ++i) {
+        address += rand() % 0x1000;
+        address = tree2_add(&tree, address, rand() % 0x1000 + 1) + 1;
+    }
+
+    /// largest gap: scan of all areas and aggregate query
+    MemoryArea gaps[2] = { memory_create(0, 0), memory_create(0, 0) };
+    double timers[2] = { 0.0, 0.0 };
+    timer_elapsed();
+    for(size_t i = 0; i < gap_queries; ++i) {
+        RBTree2Cursor cursor;
+        size_t prevEnd = 0;
+        for(bool valid = tree2_cursorFirst(&tree, &cursor); valid == true; valid = tree2_cursorNext(&cursor)) {
+            const MemoryArea area = tree2_cursorGet(&cursor);
+            if (prevEnd > 0 && area.start - prevEnd > memory_size(&gaps[0])) {
+                gaps[0] = memory_create(prevEnd, area.start - prevEnd);
+            }
+            prevEnd = area.end;
+        }
+    }
+    timers[0] = timer_elapsed();
+    for(size_t i = 0; i < gap_queries; ++i) {
+        gaps[1] = tree2_largestGap(&tree);
+    }
+    timers[1] = timer_elapsed();
+    assert( gaps[0].start == gaps[1].start );
+
+    printf("Largest gap timing (scan, aggregate): %f %f %f%%\n", timers[0], timers[1], timers[1] / timers[0] * 100.0);
+
+    tree2_release(&tree);
+}
+
+typedef struct {
+    const RBTree2* tree;
+    unsigned int any;
+    unsigned int all;
+} RangeFlags;
+
+static bool collect_flags(const MemoryArea* area, void* context) {
+    RangeFlags* flags = (RangeFlags*)context;
+    unsigned int any = 0;
+    unsigned int all = 0;
+    tree2_rangeFlags(flags->tree, area->start, area->end, &any, &all);
+    flags->any |= any;
+    flags->all &= all;
+    return true;
+}
+
+static void test_trees_rangeFlags() {
+    #define flags_num 200000
+    #define flags_queries 100
+
+    RBTree2 tree;
+    tree2_init(&tree);
+    tree2_useRadixIndex(&tree);
+    srand( 1 );
+    size_t address = 1;
+    for(size_t i = 0; i < flags_num; ++i) {
+        address += rand() % 0x1000;
+        address = (size_t)tree2_mmapFlags(&tree, (void*)address, rand() % 0x1000 + 1, TREE2_FIT_FIRST, rand() % (TREE2_FLAGS_MASK + 1)) + 1;
+    }
+    const size_t window = tree2_endAddress(&tree) / 10;
+
+    /// protection of address window: walk over areas and aggregate query
+    unsigned int result[2] = { 0, 0 };
+    double timers[2] = { 0.0, 0.0 };
+    srand( 2 );
+    timer_elapsed();
+    for(size_t i = 0; i < flags_queries; ++i) {
+        const size_t start = rand() % address;
+        RangeFlags flags;
+        flags.tree = &tree;
+        flags.any = 0;
+        flags.all = TREE2_FLAGS_MASK;
+        if (tree2_forEachInRange(&tree, start, start + window, collect_flags, &flags) == 0) {
+            flags.all = 0;
+        }
+        result[0] += flags.any + flags.all;
+    }
+    timers[0] = timer_elapsed();
+    srand( 2 );
+    for(size_t i = 0; i < flags_queries; ++i) {
+        const size_t start = rand() % address;
+        unsigned int any = 0;
+        unsigned int all = 0;
+        tree2_rangeFlags(&tree, start, start + window, &any, &all);
+        result[1] += any + all;
+    }
+    timers[1] = timer_elapsed();
+    assert( result[0] == result[1] );
+
+    printf("Range protection timing (walk, aggregate): %f %f %f%%\n", timers[0], timers[1], timers[1] / timers[0] * 100.0);
+
+    tree2_release(&tree);
+}
+
+static void test_trees_index() {
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    #define index_num 500
+    static const size_t index_address = index_num*max_size / 2;
+
+    RBTree tree;
+    tree_init(&tree);
+
+    RBTree2 tree2;
+    tree2_init(&tree2);
+
+    for(size_t i = 0; i < index_num; ++i) {
+        const size_t addr = rand() % index_address +1;
+        const size_t msize = rand() % max_size +1;
+        tree_add(&tree, addr, msize);
+        tree2_add(&tree2, addr, msize);
+    }
+
+    /// iterate over all elements by index
+    double timer1 = 0.0;
+    double timer2 = 0.0;
+    size_t sum1 = 0;
+    size_t sum2 = 0;
+
+    timer_elapsed();
+    for(size_t i = 0; i < index_num; ++i) {
+        const MemoryArea area = tree_valueByIndex(&tree, i);
+        sum1 += area.start;
+    }
+    timer1 += timer_elapsed();
+    for(size_t i = 0; i < index_num; ++i) {
+        const MemoryArea area = tree2_valueByIndex(&tree2, i);
+        sum2 += area.start;
+    }
+    timer2 += timer_elapsed();
+
+    assert( sum1 == sum2 );
+
+    const double factor = timer2 / timer1 * 100.0;
+    printf("Index timing: %f %f %f%%\n", timer1, timer2, factor);
+
+    tree_release(&tree);
+    tree2_release(&tree2);
+}
+
+
+static void test_trees_btree() {
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    #define btree_num 20000
+    static const size_t btree_address = btree_num*max_size / 2;
+
+    RBTree tree;
+    tree_init(&tree);
+
+    RBTree2 tree2;
+    tree2_init(&tree2);
+
+    BTree btree;
+    btree_init(&btree);
+
+    double timer1 = 0.0;
+    double timer2 = 0.0;
+    double timer3 = 0.0;
+
+    for(size_t i = 0; i < btree_num; ++i) {
+        const size_t addr = rand() % btree_address +1;
+        const size_t msize = rand() % max_size +1;
+
+        timer_elapsed();
+        tree_add(&tree, addr, msize);
+        timer1 += timer_elapsed();
+        tree2_add(&tree2, addr, msize);
+        timer2 += timer_elapsed();
+        btree_add(&btree, addr, msize);
+        timer3 += timer_elapsed();
+    }
+
+    const MemoryArea area = tree2_area(&tree2);
+
+    for(size_t i = 0; i < btree_num; ++i) {
+        const size_t addr = rand() % memory_size(&area) + area.start;
+
+        timer_elapsed();
+        tree_delete(&tree, addr);
+        timer1 += timer_elapsed();
+        tree2_delete(&tree2, addr);
+        timer2 += timer_elapsed();
+        btree_delete(&btree, addr);
+        timer3 += timer_elapsed();
+    }
+
+    assert( tree2_size(&tree2) == btree_size(&btree) );
+
+    printf("BTree timing (RBTree, RBTree2, BTree): %f %f %f %f%% %f%%\n",
+           timer1, timer2, timer3, timer3 / timer1 * 100.0, timer3 / timer2 * 100.0);
+
+    tree_release(&tree);
+    tree2_release(&tree2);
+    btree_release(&btree);
+}
+
+
+/**
+ * Dense map of page-aligned blocks -- compares trees with bitmap.
+ */
+static void test_trees_bitmap() {
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    #define bitmap_num 20000
+    #define bitmap_page 4096
+    #define bitmap_max_pages 16
+    static const size_t bitmap_pages = bitmap_num * bitmap_max_pages / 2;
+
+    RBTree2 tree2;
+    tree2_init(&tree2);
+
+    BTree btree;
+    btree_init(&btree);
+
+    BitmapMap bitmap;
+    bitmap_init(&bitmap, bitmap_page);
+
+    double timer1 = 0.0;
+    double timer2 = 0.0;
+    double timer3 = 0.0;
+
+    for(size_t r = 0; r < 2; ++r) {
+        for(size_t i = 0; i < bitmap_num; ++i) {
+            const size_t addr = (rand() % bitmap_pages + 1) * bitmap_page;
+            const size_t msize = (rand() % bitmap_max_pages + 1) * bitmap_page;
+
+            timer_elapsed();
+            tree2_add(&tree2, addr, msize);
+            timer1 += timer_elapsed();
+            btree_add(&btree, addr, msize);
+            timer2 += timer_elapsed();
+            bitmap_add(&bitmap, addr, msize);
+            timer3 += timer_elapsed();
+        }
+
+        const MemoryArea area = tree2_area(&tree2);
+
+        for(size_t i = 0; i < bitmap_num; ++i) {
+            const size_t addr = rand() % memory_size(&area) + area.start;
+
+            timer_elapsed();
+            tree2_delete(&tree2, addr);
+            timer1 += timer_elapsed();
+            btree_delete(&btree, addr);
+            timer2 += timer_elapsed();
+            bitmap_delete(&bitmap, addr);
+            timer3 += timer_elapsed();
+        }
+    }
+
+    assert( tree2_size(&tree2) == bitmap_size(&bitmap) );
+    assert( tree2_endAddress(&tree2) == bitmap_endAddress(&bitmap) );
+
+    printf("Bitmap timing (RBTree2, BTree, Bitmap): %f %f %f %f%% %f%%\n",
+           timer1, timer2, timer3, timer3 / timer1 * 100.0, timer3 / timer2 * 100.0);
+
+    tree2_release(&tree2);
+    btree_release(&btree);
+    bitmap_release(&bitmap);
+}
+
+/**
+ * Throughput of reserving and releasing power-of-two blocks -- compares
+ * tree with buddy allocator.
+ */
+static void test_trees_buddy() {
+    const unsigned int seed = get_next_seed();
+
+    #define buddy_num 4000
+    #define buddy_ops 200000
+
+    size_t* addr = calloc(buddy_num, sizeof(size_t));
+    double timers[2] = { 0.0, 0.0 };
+
+    for(size_t t = 0; t < 2; ++t) {
+        /// same sequence of operations for both maps
+        srand( seed );
+
+        RBTree2 tree2;
+        tree2_init(&tree2);
+        BuddyMap buddy;
+        buddy_init(&buddy);
+
+        const size_t base = (size_t)1 << BUDDY_DEFAULT_MAX_ORDER;
+        for(size_t i = 0; i < buddy_num; ++i) {
+            const size_t msize = (size_t)1 << (rand() % 5 + 12);
+            addr[i] = (t == 0) ? tree2_add(&tree2, base, msize) : buddy_add(&buddy, base, msize);
+        }
+
+        for(size_t i = 0; i < buddy_ops; ++i) {
+            const size_t index = rand() % buddy_num;
+            const size_t msize = (size_t)1 << (rand() % 5 + 12);
+
+            timer_elapsed();
+            if (t == 0) {
+                tree2_delete(&tree2, addr[index]);
+                addr[index] = tree2_add(&tree2, base, msize);
+            } else {
+                buddy_delete(&buddy, addr[index]);
+                addr[index] = buddy_add(&buddy, base, msize);
+            }
+            timers[t] += timer_elapsed();
+        }
+
+        assert( t == 0 || buddy_size(&buddy) == buddy_num );
+
+        tree2_release(&tree2);
+        buddy_release(&buddy);
+    }
+
+    printf("Buddy throughput (RBTree2, Buddy) [ops/s]: %f %f %f%%\n",
+           buddy_ops / timers[0], buddy_ops / timers[1], timers[0] / timers[1] * 100.0);
+
+    free(addr);
+}
+
 /// ==================================================
 
 
@@ -185,5 +1071,41 @@ int main(void) {
 
     test_trees_exhaustive();
 
+    test_trees_fragmented();
+
+    test_trees_layout();
+
+    test_trees_pool();
+
+    test_trees_footprint();
+
+    test_trees_policies();
+
+
+    test_trees_radix();
+
+    test_trees_finger();
+
+    test_trees_batch();
+
+    test_trees_build();
+
+    test_trees_range();
+
+    test_trees_cursor();
+
+    test_trees_rangeVisit();
+
+    test_trees_largestGap();
+    test_trees_rangeFlags();
+
+    test_trees_index();
+
+    test_trees_btree();
+
+    test_trees_bitmap();
+
+    test_trees_buddy();
+
     return 0;
 }
@@ -32,19 +32,115 @@ typedef struct {
 } map_t;
 
 
+/**
+ * Placement policies of new blocks.
+ */
+typedef enum {
+    MYMAP_FIT_FIRST = 0,                    /// first free space at or after 'vaddr'
+    MYMAP_FIT_NEXT,                         /// first free space after previously reserved block
+    MYMAP_FIT_BEST,                         /// smallest free space between blocks able to hold block
+    MYMAP_FIT_TOP_DOWN                      /// highest free space ending at or below 'vaddr' (top address if NULL)
+} MyMapPolicy;
+
+
+/**
+ * Reservation flags of 'mymap_mmap'. Policy passed in flags overrides policy
+ * set by 'mymap_setPolicy' for single call (RBTreeV2 backend only).
+ */
+#define MYMAP_POLICY_SHIFT      8
+#define MYMAP_POLICY_MASK       (0x7 << MYMAP_POLICY_SHIFT)
+#define MYMAP_POLICY(policy)    (((policy) + 1) << MYMAP_POLICY_SHIFT)
+
+#define MYMAP_BEST_FIT          MYMAP_POLICY(MYMAP_FIT_BEST)
+#define MYMAP_TOP_DOWN          MYMAP_POLICY(MYMAP_FIT_TOP_DOWN)
+
+/**
+ * Protection of block passed in flags of 'mymap_mmap' and to 'mymap_mprotect'
+ * (RBTreeV2 backend only).
+ */
+#define MYMAP_PROT_NONE         0x0
+#define MYMAP_PROT_READ         0x1
+#define MYMAP_PROT_WRITE        0x2
+#define MYMAP_PROT_EXEC         0x4
+#define MYMAP_PROT_MASK         0x7
+
+
+/**
+ * Reservation request of 'mymap_mmap_batch'.
+ */
+typedef struct {
+    void *vaddr;                            /// desired address (hint)
+    unsigned int size;
+} map_request_t;
+
+
+/**
+ * Position of in-order walk over blocks. Cursor is valid until map is modified.
+ */
+typedef struct {
+    const void *position;                   /// backend specific, NULL if cursor points to no block
+} map_cursor_t;
+
+
 /// ====================================================================+
 
 
 /**
- * Reserve memory space.
+ * Reserve memory space. Block is placed according to map's policy (first fit
+ * by default) or according to policy passed in 'flags'. Protection of block
+ * is taken from 'MYMAP_PROT_*' bits of 'flags'. RBTreeV2 backend returns NULL
+ * for unknown policy code in 'flags'.
+ * Bitmap backend keeps pages of 4096 bytes ('BITMAP_DEFAULT_GRANULARITY'):
+ * 'vaddr' and 'size' are rounded up to whole pages, so returned address
+ * is page aligned and block takes whole pages. Region of the backend starts
+ * at first page (address 0 is never returned) and covers
+ * 'BITMAP_DEFAULT_PAGES' pages, NULL is returned for hint above region.
  */
 void *mymap_mmap(map_t *map, void *vaddr, unsigned int size, unsigned int flags, void *o);
 
+/**
+ * Reserve many memory blocks at once with first fit. Blocks are placed
+ * exactly as by 'mymap_mmap' calls in order of requests, then linked into
+ * map at once (RBTreeV2 backend), other backends reserve blocks one by one.
+ * Address of block of i-th request is stored in 'out[i]' (NULL on failure).
+ * Returns number of reserved blocks.
+ */
+size_t mymap_mmap_batch(map_t *map, const map_request_t *requests, const size_t n, void **out);
+
 /**
  * Release memory.
  */
 void mymap_munmap(map_t *map, void *vaddr);
 
+/**
+ * Release address range (vaddr, vaddr + len) like POSIX munmap: blocks inside
+ * range are released, blocks crossing bounds of range are trimmed and block
+ * containing whole range is split in two. Takes O(log n + k) for k released
+ * blocks (RBTreeV2 backend).
+ * Returns 0 on success, -3 if range release is not supported by backend.
+ */
+int mymap_munmap_range(map_t *map, void *vaddr, const size_t len);
+
+/**
+ * Set protection ('MYMAP_PROT_*' bits) of address range (vaddr, vaddr + len)
+ * like POSIX mprotect: blocks crossing bounds of range are split in pieces,
+ * touching pieces of the same block and of equal protection are joined back.
+ * Separate blocks are never merged, 'mymap_munmap' of piece releases whole
+ * block and 'mymap_size' counts block once. Lookups and walks visit pieces.
+ * Takes O(log n + k) for k pieces (RBTreeV2 backend).
+ * Returns 0 on success, -3 if protection is not supported by backend,
+ * -4 if range is not fully mapped (nothing is changed, like ENOMEM).
+ */
+int mymap_mprotect(map_t *map, void *vaddr, const size_t len, const unsigned int flags);
+
+/**
+ * Query protection of blocks intersecting range (vaddr, vaddr + len) in
+ * O(log n): 'any' gets bits set for any block, 'all' bits set for every block.
+ * Returns 1 if any block intersects range, 0 if range is free,
+ * -3 if protection is not supported by backend.
+ */
+int mymap_protection(const map_t *map, void *vaddr, const size_t len, unsigned int *any, unsigned int *all);
+
 /**
  * Memory initialization.
  */
@@ -52,6 +148,41 @@ int mymap_init(map_t *map);
 
 int mymap_release(map_t *map);
 
+/**
+ * Makes map thread safe: functions take reader-writer lock of map, queries
+ * ('mymap_size', 'mymap_startAddress', 'mymap_endAddress', lookups, walks,
+ * 'mymap_isValid', 'mymap_dump') take it shared, so they run concurrently,
+ * and modifications ('mymap_mmap', 'mymap_munmap', 'mymap_setPolicy',
+ * range functions) take it exclusive. Has to be called after 'mymap_init'
+ * and before map is shared between threads. Initialization and release of
+ * map are not synchronized. Cursor steps are not locked -- cursor is valid
+ * until map is modified, so caller has to prevent modifications during walk.
+ * Returns 0 on success.
+ */
+int mymap_useLocking(map_t *map);
+
+/**
+ * Enables radix index of blocks (RBTreeV2 backend only), so 'mymap_munmap'
+ * and lookups by address take fixed number of steps. Index costs up to few
+ * KiB per sparse block, so it is disabled by default.
+ * Returns 0 on success, -3 if index is not supported or cannot be allocated.
+ */
+int mymap_useRadixIndex(map_t *map);
+
+/**
+ * Set placement policy used by 'mymap_mmap'.
+ * Returns 0 on success, -3 if policy is not supported by backend.
+ */
+int mymap_setPolicy(map_t *map, const MyMapPolicy policy);
+
+/**
+ * Set address below which top-down policy places blocks reserved without
+ * hint ('vaddr' NULL), like mmap base of process. By default blocks are
+ * placed at top of address space.
+ * Returns 0 on success, -3 if not supported by backend or 'vaddr' is NULL.
+ */
+int mymap_setTopAddress(map_t *map, void *vaddr);
+
 /**
  * Print memory structure.
  */
@@ -69,4 +200,42 @@ void *mymap_endAddress(const map_t *map);
 
 int mymap_isValid(const map_t *map);
 
+
+/// ====================================================================+
+
+
+/**
+ * Walk over blocks in address order without allocations, step takes
+ * amortized O(1) (RBTreeV2 backend, other backends do not support walk).
+ * Functions return 1 if cursor points to block, 0 otherwise.
+ */
+int mymap_cursorFirst(const map_t *map, map_cursor_t *cursor);
+
+/**
+ * Moves cursor to block containing 'vaddr' or to first block after it.
+ */
+int mymap_cursorSeek(const map_t *map, void *vaddr, map_cursor_t *cursor);
+
+int mymap_cursorNext(map_cursor_t *cursor);
+
+int mymap_cursorPrev(map_cursor_t *cursor);
+
+/**
+ * Returns start address of block pointed by cursor (NULL if there is no such)
+ * and stores block size in 'size' (if not NULL).
+ */
+void *mymap_cursorGet(const map_cursor_t *cursor, size_t *size);
+
+/**
+ * Visitor of blocks, non-zero return value stops the walk.
+ */
+typedef int (* mymap_visitBlock)(void *vaddr, size_t size, void *context);
+
+/**
+ * Calls 'visitor' for every block intersecting range (vaddr, vaddr + len)
+ * in address order in O(log n + k) (RBTreeV2 backend).
+ * Returns number of visited blocks, -3 if walk is not supported by backend.
+ */
+int mymap_forEachInRange(const map_t *map, void *vaddr, const size_t len, mymap_visitBlock visitor, void *context);
+
 #endif /* MYMAP_H_ */
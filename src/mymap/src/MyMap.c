@@ -21,12 +21,396 @@
 /// SOFTWARE.
 ///
 
+/// reader-writer lock is part of POSIX.1-2001 (hidden in strict C99 mode)
+#define _POSIX_C_SOURCE 200112L
+
 #include "mymap/MyMap.h"
 
 
-#define USE_ARBTREE
+/// select implementation of memory map
+#define USE_ARBTREE
+/// #define USE_BTREE
+/// #define USE_BITMAP
+
+/// bytes per page of bitmap backend (addresses and sizes are rounded to pages)
+#define MYMAP_BITMAP_GRANULARITY    BITMAP_DEFAULT_GRANULARITY
+
+
+#include <stdbool.h>
+#include <pthread.h>
+
+
+/**
+ * Reader-writer lock of map. Lock is taken only if enabled by 'mymap_useLocking'.
+ */
+typedef struct {
+    pthread_rwlock_t rwlock;
+    bool enabled;
+} map_lock_t;
+
+
+static inline void mymap_lockShared(map_lock_t* lock) {
+    if (lock->enabled == true) {
+        pthread_rwlock_rdlock( &(lock->rwlock) );
+    }
+}
+
+static inline void mymap_lockExclusive(map_lock_t* lock) {
+    if (lock->enabled == true) {
+        pthread_rwlock_wrlock( &(lock->rwlock) );
+    }
+}
+
+static inline void mymap_unlock(map_lock_t* lock) {
+    if (lock->enabled == true) {
+        pthread_rwlock_unlock( &(lock->rwlock) );
+    }
+}
+
+static inline void mymap_releaseLock(map_lock_t* lock) {
+    if (lock->enabled == true) {
+        pthread_rwlock_destroy( &(lock->rwlock) );
+        lock->enabled = false;
+    }
+}
+
+
+#ifdef USE_BITMAP
+
+#include <stddef.h>                     /// NULL
+#include <stdio.h>                      /// printf
+#include <stdlib.h>                     /// free
+
+
+#include <memorymap/Bitmap.h>
+
+
+
+typedef struct map_root {
+    BitmapMap bitmap;
+    map_lock_t lock;
+} map_element;
+
+
+
+/**
+ * Reserve memory space.
+ * Fields 'flags' and 'o' not supported for now.
+ */
+void *mymap_mmap(map_t *map, void *vaddr, unsigned int size, unsigned int flags, void* o) {
+    (void) flags; /* unused */
+    (void) o; /* unused */
+
+    if (map == NULL) {
+        return NULL;
+    }
+    if (map->root == NULL) {
+        return NULL;
+    }
+    mymap_lockExclusive( &(map->root->lock) );
+    void *ret = bitmap_mmap( &(map->root->bitmap), vaddr, size );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
+
+/**
+ * Release memory.
+ */
+void mymap_munmap(map_t *map, void *vaddr) {
+    if (map == NULL) {
+        return ;
+    }
+    if (map->root == NULL) {
+        return ;
+    }
+    mymap_lockExclusive( &(map->root->lock) );
+    bitmap_munmap( &(map->root->bitmap), vaddr );
+    mymap_unlock( &(map->root->lock) );
+}
+
+/**
+ * Memory initialization.
+ */
+int mymap_init(map_t *map) {
+    if (map == NULL) {
+        return -1;
+    }
+    map->root = calloc(1, sizeof(map_element) );
+    /// region starts at first page, so NULL is never valid block
+    if (bitmap_initRegion( &(map->root->bitmap), MYMAP_BITMAP_GRANULARITY, MYMAP_BITMAP_GRANULARITY, BITMAP_DEFAULT_PAGES ) == false) {
+        return -2;
+    }
+    return 0;                   /// ok
+}
+
+int mymap_setPolicy(map_t *map, const MyMapPolicy policy) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    if (policy != MYMAP_FIT_FIRST) {
+        return -3;
+    }
+    return 0;                   /// ok
+}
+
+int mymap_release(map_t *map) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    const bool ret = bitmap_release( &(map->root->bitmap) );
+
+    mymap_releaseLock( &(map->root->lock) );
+    free(map->root);
+    map->root = NULL;
+
+    if (ret == false) {
+        return -3;
+    }
+    return 1;                   /// ok
+}
+
+/**
+ * Print memory structure.
+ */
+int mymap_dump(map_t *map) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->root == NULL) {
+        return 0;
+    }
+    mymap_lockShared( &(map->root->lock) );
+    bitmap_print( &(map->root->bitmap) );
+    mymap_unlock( &(map->root->lock) );
+    return 0;
+}
+
+size_t mymap_size(const map_t *map) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->root == NULL) {
+        return 0;
+    }
+    mymap_lockShared( &(map->root->lock) );
+    const size_t ret = bitmap_size( &(map->root->bitmap) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
+
+void *mymap_startAddress(const map_t *map) {
+    if (map == NULL) {
+        return NULL;
+    }
+    if (map->root == NULL) {
+        return NULL;
+    }
+    mymap_lockShared( &(map->root->lock) );
+    void *ret = (void *)bitmap_startAddress( &(map->root->bitmap) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
+
+void *mymap_endAddress(const map_t *map) {
+    if (map == NULL) {
+        return NULL;
+    }
+    if (map->root == NULL) {
+        return NULL;
+    }
+    mymap_lockShared( &(map->root->lock) );
+    void *ret = (void *)bitmap_endAddress( &(map->root->bitmap) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
+
+int mymap_isValid(const map_t *map) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->root == NULL) {
+        return -1;
+    }
+    mymap_lockShared( &(map->root->lock) );
+    const int ret = bitmap_isValid( &(map->root->bitmap) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
+
+#elif defined(USE_BTREE)
+
+#include <stddef.h>                     /// NULL
+#include <stdio.h>                      /// printf
+#include <stdlib.h>                     /// free
+
+
+#include <memorymap/BTree.h>
+
+
+
+typedef struct map_root {
+    BTree tree;
+    map_lock_t lock;
+} map_element;
+
+
+
+/**
+ * Reserve memory space.
+ * Fields 'flags' and 'o' not supported for now.
+ */
+void *mymap_mmap(map_t *map, void *vaddr, unsigned int size, unsigned int flags, void* o) {
+    (void) flags; /* unused */
+    (void) o; /* unused */
+
+    if (map == NULL) {
+        return NULL;
+    }
+    if (map->root == NULL) {
+        return NULL;
+    }
+    mymap_lockExclusive( &(map->root->lock) );
+    void *ret = btree_mmap( &(map->root->tree), vaddr, size );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
+
+/**
+ * Release memory.
+ */
+void mymap_munmap(map_t *map, void *vaddr) {
+    if (map == NULL) {
+        return ;
+    }
+    if (map->root == NULL) {
+        return ;
+    }
+    mymap_lockExclusive( &(map->root->lock) );
+    btree_munmap( &(map->root->tree), vaddr );
+    mymap_unlock( &(map->root->lock) );
+}
+
+/**
+ * Memory initialization.
+ */
+int mymap_init(map_t *map) {
+    if (map == NULL) {
+        return -1;
+    }
+    map->root = calloc(1, sizeof(map_element) );
+    if (btree_init( &(map->root->tree) ) == false) {
+        return -2;
+    }
+    return 0;                   /// ok
+}
+
+int mymap_setPolicy(map_t *map, const MyMapPolicy policy) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    if (policy != MYMAP_FIT_FIRST) {
+        return -3;
+    }
+    return 0;                   /// ok
+}
+
+int mymap_release(map_t *map) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    const bool ret = btree_release( &(map->root->tree) );
+
+    mymap_releaseLock( &(map->root->lock) );
+    free(map->root);
+    map->root = NULL;
+
+    if (ret == false) {
+        return -3;
+    }
+    return 1;                   /// ok
+}
+
+/**
+ * Print memory structure.
+ */
+int mymap_dump(map_t *map) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->root == NULL) {
+        return 0;
+    }
+    mymap_lockShared( &(map->root->lock) );
+    btree_print( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return 0;
+}
+
+size_t mymap_size(const map_t *map) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->root == NULL) {
+        return 0;
+    }
+    mymap_lockShared( &(map->root->lock) );
+    const size_t ret = btree_size( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
+
+void *mymap_startAddress(const map_t *map) {
+    if (map == NULL) {
+        return NULL;
+    }
+    if (map->root == NULL) {
+        return NULL;
+    }
+    mymap_lockShared( &(map->root->lock) );
+    void *ret = (void *)btree_startAddress( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
+
+void *mymap_endAddress(const map_t *map) {
+    if (map == NULL) {
+        return NULL;
+    }
+    if (map->root == NULL) {
+        return NULL;
+    }
+    mymap_lockShared( &(map->root->lock) );
+    void *ret = (void *)btree_endAddress( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
+
+int mymap_isValid(const map_t *map) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->root == NULL) {
+        return -1;
+    }
+    mymap_lockShared( &(map->root->lock) );
+    const int ret = btree_isValid( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
 
-#ifdef USE_ARBTREE
+#elif defined(USE_ARBTREE)
 
 #include <stddef.h>                     /// NULL
 #include <stdio.h>                      /// printf
@@ -39,16 +423,16 @@
 
 typedef struct map_root {
     RBTree2 tree;
+    map_lock_t lock;
 } map_element;
 
 
 
 /**
  * Reserve memory space.
- * Fields 'flags' and 'o' not supported for now.
+ * Field 'o' not supported for now.
  */
 void *mymap_mmap(map_t *map, void *vaddr, unsigned int size, unsigned int flags, void* o) {
-    (void) flags; /* unused */
     (void) o; /* unused */
 
     if (map == NULL) {
@@ -57,7 +441,44 @@ void *mymap_mmap(map_t *map, void *vaddr, unsigned int size, unsigned int flags,
     if (map->root == NULL) {
         return NULL;
     }
-    return tree2_mmap( &(map->root->tree), vaddr, size );
+    RBTree2* tree = &(map->root->tree);
+    const unsigned int policyFlag = (flags & MYMAP_POLICY_MASK) >> MYMAP_POLICY_SHIFT;
+    if (policyFlag > MYMAP_FIT_TOP_DOWN + 1) {
+        /// unknown policy code
+        return NULL;
+    }
+    mymap_lockExclusive( &(map->root->lock) );
+    const RBTree2Policy policy = (policyFlag != 0) ? (RBTree2Policy)(policyFlag - 1) : tree->policy;
+    void *ret = tree2_mmapFlags( tree, vaddr, size, policy, flags & MYMAP_PROT_MASK );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
+
+size_t mymap_mmap_batch(map_t *map, const map_request_t *requests, const size_t n, void **out) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->root == NULL) {
+        return 0;
+    }
+    if (requests == NULL || out == NULL || n == 0) {
+        return 0;
+    }
+    MemoryArea* areas = malloc( n * sizeof(MemoryArea) );
+    if (areas == NULL) {
+        return 0;
+    }
+    for(size_t i = 0; i < n; ++i) {
+        areas[i] = memory_create( (size_t)requests[i].vaddr, requests[i].size );
+    }
+    mymap_lockExclusive( &(map->root->lock) );
+    const size_t reserved = tree2_addBatch( &(map->root->tree), areas, n );
+    mymap_unlock( &(map->root->lock) );
+    for(size_t i = 0; i < n; ++i) {
+        out[i] = (memory_size(&areas[i]) > 0) ? (void*)areas[i].start : NULL;
+    }
+    free(areas);
+    return reserved;
 }
 
 /**
@@ -70,7 +491,58 @@ void mymap_munmap(map_t *map, void *vaddr) {
     if (map->root == NULL) {
         return ;
     }
+    mymap_lockExclusive( &(map->root->lock) );
     tree2_munmap( &(map->root->tree), vaddr );
+    mymap_unlock( &(map->root->lock) );
+}
+
+int mymap_munmap_range(map_t *map, void *vaddr, const size_t len) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    const size_t start = (size_t)vaddr;
+    const size_t end = (start + len < start) ? (size_t)-1 : start + len;
+    mymap_lockExclusive( &(map->root->lock) );
+    tree2_deleteRange( &(map->root->tree), start, end );
+    mymap_unlock( &(map->root->lock) );
+    return 0;                   /// ok
+}
+
+int mymap_mprotect(map_t *map, void *vaddr, const size_t len, const unsigned int flags) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    const size_t start = (size_t)vaddr;
+    const size_t end = (start + len < start) ? (size_t)-1 : start + len;
+    mymap_lockExclusive( &(map->root->lock) );
+    const int changed = tree2_protect( &(map->root->tree), start, end, flags & MYMAP_PROT_MASK );
+    mymap_unlock( &(map->root->lock) );
+    if (changed < 0) {
+        /// range not fully mapped
+        return -4;
+    }
+    return 0;                   /// ok
+}
+
+int mymap_protection(const map_t *map, void *vaddr, const size_t len, unsigned int *any, unsigned int *all) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    const size_t start = (size_t)vaddr;
+    const size_t end = (start + len < start) ? (size_t)-1 : start + len;
+    mymap_lockShared( &(map->root->lock) );
+    const bool found = tree2_rangeFlags( &(map->root->tree), start, end, any, all );
+    mymap_unlock( &(map->root->lock) );
+    return (found == true) ? 1 : 0;
 }
 
 /**
@@ -84,6 +556,57 @@ int mymap_init(map_t *map) {
     if (tree2_init( &(map->root->tree) ) == false) {
         return -2;
     }
+    if (tree2_useFreeIndex( &(map->root->tree) ) == false) {
+        return -2;
+    }
+    return 0;                   /// ok
+}
+
+int mymap_useRadixIndex(map_t *map) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    mymap_lockExclusive( &(map->root->lock) );
+    const bool ret = tree2_useRadixIndex( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    if (ret == false) {
+        return -3;
+    }
+    return 0;                   /// ok
+}
+
+int mymap_setPolicy(map_t *map, const MyMapPolicy policy) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    mymap_lockExclusive( &(map->root->lock) );
+    const bool ret = tree2_setPolicy( &(map->root->tree), (RBTree2Policy)policy );
+    mymap_unlock( &(map->root->lock) );
+    if (ret == false) {
+        return -3;
+    }
+    return 0;                   /// ok
+}
+
+int mymap_setTopAddress(map_t *map, void *vaddr) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    mymap_lockExclusive( &(map->root->lock) );
+    const bool ret = tree2_setTopAddress( &(map->root->tree), (size_t)vaddr );
+    mymap_unlock( &(map->root->lock) );
+    if (ret == false) {
+        return -3;
+    }
     return 0;                   /// ok
 }
 
@@ -96,6 +619,7 @@ int mymap_release(map_t *map) {
     }
     const bool ret = tree2_release( &(map->root->tree) );
 
+    mymap_releaseLock( &(map->root->lock) );
     free(map->root);
     map->root = NULL;
 
@@ -115,7 +639,9 @@ int mymap_dump(map_t *map) {
     if (map->root == NULL) {
         return 0;
     }
+    mymap_lockShared( &(map->root->lock) );
     tree2_print( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
     return 0;
 }
 
@@ -126,7 +652,10 @@ size_t mymap_size(const map_t *map) {
     if (map->root == NULL) {
         return 0;
     }
-    return tree2_size( &(map->root->tree) );
+    mymap_lockShared( &(map->root->lock) );
+    const size_t ret = tree2_blocks( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
 }
 
 void *mymap_startAddress(const map_t *map) {
@@ -136,7 +665,10 @@ void *mymap_startAddress(const map_t *map) {
     if (map->root == NULL) {
         return NULL;
     }
-    return (void *)tree2_startAddress( &(map->root->tree) );
+    mymap_lockShared( &(map->root->lock) );
+    void *ret = (void *)tree2_startAddress( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
 }
 
 void *mymap_endAddress(const map_t *map) {
@@ -146,7 +678,10 @@ void *mymap_endAddress(const map_t *map) {
     if (map->root == NULL) {
         return NULL;
     }
-    return (void *)tree2_endAddress( &(map->root->tree) );
+    mymap_lockShared( &(map->root->lock) );
+    void *ret = (void *)tree2_endAddress( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
 }
 
 int mymap_isValid(const map_t *map) {
@@ -156,7 +691,114 @@ int mymap_isValid(const map_t *map) {
     if (map->root == NULL) {
         return -1;
     }
-    return tree2_isValid( &(map->root->tree) );
+    mymap_lockShared( &(map->root->lock) );
+    const int ret = tree2_isValid( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
+
+int mymap_cursorFirst(const map_t *map, map_cursor_t *cursor) {
+    if (cursor == NULL) {
+        return 0;
+    }
+    cursor->position = NULL;
+    if (map == NULL || map->root == NULL) {
+        return 0;
+    }
+    RBTree2Cursor treeCursor;
+    mymap_lockShared( &(map->root->lock) );
+    tree2_cursorFirst( &(map->root->tree), &treeCursor );
+    mymap_unlock( &(map->root->lock) );
+    cursor->position = treeCursor.node;
+    return (cursor->position != NULL);
+}
+
+int mymap_cursorSeek(const map_t *map, void *vaddr, map_cursor_t *cursor) {
+    if (cursor == NULL) {
+        return 0;
+    }
+    cursor->position = NULL;
+    if (map == NULL || map->root == NULL) {
+        return 0;
+    }
+    RBTree2Cursor treeCursor;
+    mymap_lockShared( &(map->root->lock) );
+    tree2_cursorSeek( &(map->root->tree), (size_t)vaddr, &treeCursor );
+    mymap_unlock( &(map->root->lock) );
+    cursor->position = treeCursor.node;
+    return (cursor->position != NULL);
+}
+
+int mymap_cursorNext(map_cursor_t *cursor) {
+    if (cursor == NULL) {
+        return 0;
+    }
+    RBTree2Cursor treeCursor;
+    treeCursor.node = cursor->position;
+    tree2_cursorNext( &treeCursor );
+    cursor->position = treeCursor.node;
+    return (cursor->position != NULL);
+}
+
+int mymap_cursorPrev(map_cursor_t *cursor) {
+    if (cursor == NULL) {
+        return 0;
+    }
+    RBTree2Cursor treeCursor;
+    treeCursor.node = cursor->position;
+    tree2_cursorPrev( &treeCursor );
+    cursor->position = treeCursor.node;
+    return (cursor->position != NULL);
+}
+
+void *mymap_cursorGet(const map_cursor_t *cursor, size_t *size) {
+    if (cursor == NULL) {
+        return NULL;
+    }
+    RBTree2Cursor treeCursor;
+    treeCursor.node = cursor->position;
+    const MemoryArea area = tree2_cursorGet( &treeCursor );
+    if (size != NULL) {
+        *size = memory_size( &area );
+    }
+    if (cursor->position == NULL) {
+        return NULL;
+    }
+    return (void*)area.start;
+}
+
+/**
+ * Passes areas to block visitor.
+ */
+typedef struct {
+    mymap_visitBlock visitor;
+    void *context;
+} map_visit_t;
+
+static bool mymap_visitArea(const MemoryArea* area, void* context) {
+    const map_visit_t* visit = (const map_visit_t*)context;
+    return (visit->visitor( (void*)area->start, memory_size(area), visit->context ) == 0);
+}
+
+int mymap_forEachInRange(const map_t *map, void *vaddr, const size_t len, mymap_visitBlock visitor, void *context) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    if (visitor == NULL) {
+        return 0;
+    }
+    const size_t start = (size_t)vaddr;
+    const size_t end = (start + len < start) ? (size_t)-1 : start + len;
+    map_visit_t visit;
+    visit.visitor = visitor;
+    visit.context = context;
+    mymap_lockShared( &(map->root->lock) );
+    const size_t visited = tree2_forEachInRange( &(map->root->tree), start, end, mymap_visitArea, &visit );
+    mymap_unlock( &(map->root->lock) );
+    return (int) visited;
 }
 
 #else
@@ -174,6 +816,7 @@ int mymap_isValid(const map_t *map) {
 
 typedef struct map_root {
     RBTree tree;
+    map_lock_t lock;
 } map_element;
 
 
@@ -192,7 +835,10 @@ void *mymap_mmap(map_t *map, void *vaddr, unsigned int size, unsigned int flags,
     if (map->root == NULL) {
         return NULL;
     }
-    return tree_mmap( &(map->root->tree), vaddr, size );
+    mymap_lockExclusive( &(map->root->lock) );
+    void *ret = tree_mmap( &(map->root->tree), vaddr, size );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
 }
 
 /**
@@ -205,7 +851,9 @@ void mymap_munmap(map_t *map, void *vaddr) {
     if (map->root == NULL) {
         return ;
     }
+    mymap_lockExclusive( &(map->root->lock) );
     tree_munmap( &(map->root->tree), vaddr );
+    mymap_unlock( &(map->root->lock) );
 }
 
 /**
@@ -219,6 +867,19 @@ int mymap_init(map_t *map) {
     return tree_init( &(map->root->tree) );
 }
 
+int mymap_setPolicy(map_t *map, const MyMapPolicy policy) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    if (policy != MYMAP_FIT_FIRST) {
+        return -3;
+    }
+    return 0;                   /// ok
+}
+
 int mymap_release(map_t *map) {
     if (map == NULL) {
         return -1;
@@ -228,6 +889,7 @@ int mymap_release(map_t *map) {
     }
     const int ret = tree_release( &(map->root->tree) );
 
+    mymap_releaseLock( &(map->root->lock) );
     free(map->root);
     map->root = NULL;
 
@@ -244,7 +906,9 @@ int mymap_dump(map_t *map) {
     if (map->root == NULL) {
         return 0;
     }
+    mymap_lockShared( &(map->root->lock) );
     tree_print( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
     return 0;
 }
 
@@ -255,7 +919,10 @@ size_t mymap_size(const map_t *map) {
     if (map->root == NULL) {
         return 0;
     }
-    return tree_size( &(map->root->tree) );
+    mymap_lockShared( &(map->root->lock) );
+    const size_t ret = tree_size( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
 }
 
 void *mymap_startAddress(const map_t *map) {
@@ -265,7 +932,10 @@ void *mymap_startAddress(const map_t *map) {
     if (map->root == NULL) {
         return NULL;
     }
-    return (void *)tree_startAddress( &(map->root->tree) );
+    mymap_lockShared( &(map->root->lock) );
+    void *ret = (void *)tree_startAddress( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
 }
 
 void *mymap_endAddress(const map_t *map) {
@@ -275,7 +945,10 @@ void *mymap_endAddress(const map_t *map) {
     if (map->root == NULL) {
         return NULL;
     }
-    return (void *)tree_endAddress( &(map->root->tree) );
+    mymap_lockShared( &(map->root->lock) );
+    void *ret = (void *)tree_endAddress( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
 }
 
 int mymap_isValid(const map_t *map) {
@@ -285,7 +958,166 @@ int mymap_isValid(const map_t *map) {
     if (map->root == NULL) {
         return -1;
     }
-    return tree_isValid( &(map->root->tree) );
+    mymap_lockShared( &(map->root->lock) );
+    const int ret = tree_isValid( &(map->root->tree) );
+    mymap_unlock( &(map->root->lock) );
+    return ret;
+}
+
+#endif
+
+
+int mymap_useLocking(map_t *map) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    map_lock_t* lock = &(map->root->lock);
+    if (lock->enabled == true) {
+        return 0;               /// already enabled
+    }
+    if (pthread_rwlock_init( &(lock->rwlock), NULL ) != 0) {
+        return -3;
+    }
+    lock->enabled = true;
+    return 0;                   /// ok
+}
+
+
+#ifndef USE_ARBTREE
+
+int mymap_setTopAddress(map_t *map, void *vaddr) {
+    (void) vaddr; /* unused */
+
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    /// top-down policy is not supported by backend
+    return -3;
+}
+
+int mymap_useRadixIndex(map_t *map) {
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    /// index is not supported by backend
+    return -3;
+}
+
+size_t mymap_mmap_batch(map_t *map, const map_request_t *requests, const size_t n, void **out) {
+    if (requests == NULL || out == NULL) {
+        return 0;
+    }
+    size_t reserved = 0;
+    for(size_t i = 0; i < n; ++i) {
+        out[i] = mymap_mmap(map, requests[i].vaddr, requests[i].size, 0, NULL);
+        if (out[i] != NULL) {
+            ++reserved;
+        }
+    }
+    return reserved;
+}
+
+int mymap_cursorFirst(const map_t *map, map_cursor_t *cursor) {
+    (void) map; /* unused */
+
+    if (cursor != NULL) {
+        cursor->position = NULL;
+    }
+    /// walk is not supported by backend
+    return 0;
+}
+
+int mymap_cursorSeek(const map_t *map, void *vaddr, map_cursor_t *cursor) {
+    (void) vaddr; /* unused */
+    return mymap_cursorFirst(map, cursor);
+}
+
+int mymap_cursorNext(map_cursor_t *cursor) {
+    (void) cursor; /* unused */
+    return 0;
+}
+
+int mymap_cursorPrev(map_cursor_t *cursor) {
+    (void) cursor; /* unused */
+    return 0;
+}
+
+void *mymap_cursorGet(const map_cursor_t *cursor, size_t *size) {
+    (void) cursor; /* unused */
+    if (size != NULL) {
+        *size = 0;
+    }
+    return NULL;
+}
+
+int mymap_forEachInRange(const map_t *map, void *vaddr, const size_t len, mymap_visitBlock visitor, void *context) {
+    (void) vaddr; /* unused */
+    (void) len; /* unused */
+    (void) visitor; /* unused */
+    (void) context; /* unused */
+
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    /// walk is not supported by backend
+    return -3;
+}
+
+int mymap_munmap_range(map_t *map, void *vaddr, const size_t len) {
+    (void) vaddr; /* unused */
+    (void) len; /* unused */
+
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    /// trimming of blocks is not supported by backend
+    return -3;
+}
+
+int mymap_mprotect(map_t *map, void *vaddr, const size_t len, const unsigned int flags) {
+    (void) vaddr; /* unused */
+    (void) len; /* unused */
+    (void) flags; /* unused */
+
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    /// protection of blocks is not supported by backend
+    return -3;
+}
+
+int mymap_protection(const map_t *map, void *vaddr, const size_t len, unsigned int *any, unsigned int *all) {
+    (void) vaddr; /* unused */
+    (void) len; /* unused */
+    (void) any; /* unused */
+    (void) all; /* unused */
+
+    if (map == NULL) {
+        return -1;
+    }
+    if (map->root == NULL) {
+        return -2;
+    }
+    /// protection of blocks is not supported by backend
+    return -3;
 }
 
 #endif
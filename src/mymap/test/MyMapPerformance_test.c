@@ -0,0 +1,152 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#include "mymap/MyMap.h"
+
+#include "benchmark/Timer.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>                              /// printf
+
+
+
+#define PERF_BLOCKS         50000
+#define PERF_OPERATIONS     400000
+#define PERF_MAX_THREADS    8
+#define PERF_RANGE          ((size_t)PERF_BLOCKS * 0x200)
+
+
+typedef struct {
+    map_t *map;
+    pthread_mutex_t *mutex;                 /// global lock taken around every call or NULL
+    size_t operations;
+    unsigned int readPercent;
+    unsigned int seed;
+    size_t found;
+} MapWorker;
+
+static unsigned int next_random(unsigned int* seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return (*seed >> 16) & 0x7FFF;
+}
+
+/**
+ * Runs mix of lookups (shared access) and reservations and releases
+ * (exclusive access) on map.
+ */
+static void* run_worker(void *arg) {
+    MapWorker *worker = (MapWorker*)arg;
+    void *block = NULL;
+    for(size_t i = 0; i < worker->operations; ++i) {
+        const bool read = (next_random(&worker->seed) % 100 < worker->readPercent);
+        const size_t address = (size_t)next_random(&worker->seed) * next_random(&worker->seed) % PERF_RANGE + 1;
+        if (worker->mutex != NULL) {
+            pthread_mutex_lock(worker->mutex);
+        }
+        if (read == true) {
+            map_cursor_t cursor;
+            worker->found += mymap_cursorSeek(worker->map, (void*)address, &cursor);
+        } else if (block == NULL) {
+            block = mymap_mmap(worker->map, (void*)address, 0x100, 0, NULL);
+        } else {
+            /// range release -- 'mymap_munmap' validates whole map in debug build
+            mymap_munmap_range(worker->map, block, 0x100);
+            block = NULL;
+        }
+        if (worker->mutex != NULL) {
+            pthread_mutex_unlock(worker->mutex);
+        }
+    }
+    if (block != NULL) {
+        if (worker->mutex != NULL) {
+            pthread_mutex_lock(worker->mutex);
+        }
+        mymap_munmap_range(worker->map, block, 0x100);
+        if (worker->mutex != NULL) {
+            pthread_mutex_unlock(worker->mutex);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Returns throughput (operations per second) of 'threads' workers sharing map.
+ */
+static double run_workers(const size_t threads, const unsigned int readPercent, const bool globalMutex) {
+    map_t map;
+    mymap_init(&map);
+    for(size_t i = 0; i < PERF_BLOCKS; ++i) {
+        mymap_mmap(&map, (void*)(i * 0x200 + 1), 0x100, 0, NULL);
+    }
+    pthread_mutex_t mutex;
+    pthread_mutex_init(&mutex, NULL);
+    if (globalMutex == false) {
+        mymap_useLocking(&map);
+    }
+
+    pthread_t handles[PERF_MAX_THREADS];
+    MapWorker workers[PERF_MAX_THREADS];
+    timer_elapsed();
+    for(size_t i = 0; i < threads; ++i) {
+        workers[i].map = &map;
+        workers[i].mutex = (globalMutex == true) ? &mutex : NULL;
+        workers[i].operations = PERF_OPERATIONS / threads;
+        workers[i].readPercent = readPercent;
+        workers[i].seed = (unsigned int)i + 1;
+        workers[i].found = 0;
+        pthread_create(&handles[i], NULL, run_worker, &workers[i]);
+    }
+    for(size_t i = 0; i < threads; ++i) {
+        pthread_join(handles[i], NULL);
+    }
+    const double timer = timer_elapsed();
+
+    pthread_mutex_destroy(&mutex);
+    mymap_release(&map);
+    return PERF_OPERATIONS / timer;
+}
+
+/**
+ * Compares reader-writer lock of map with global mutex taken around
+ * every call for different ratios of lookups to modifications.
+ */
+static void test_mymap_locking() {
+    static const unsigned int readPercents[] = { 50, 90, 99 };
+    for(size_t r = 0; r < sizeof(readPercents) / sizeof(readPercents[0]); ++r) {
+        printf("Locking throughput (reads %u%%) [threads: mutex, rwlock ops/s]:", readPercents[r]);
+        for(size_t threads = 1; threads <= PERF_MAX_THREADS; threads *= 2) {
+            const double mutexOps = run_workers(threads, readPercents[r], true);
+            const double rwlockOps = run_workers(threads, readPercents[r], false);
+            printf(" %zu: %.0f %.0f", threads, mutexOps, rwlockOps);
+        }
+        printf("\n");
+    }
+}
+
+int main(void) {
+
+    test_mymap_locking();
+
+    return 0;
+}
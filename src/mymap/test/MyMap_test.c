@@ -23,6 +23,8 @@
 
 #include "mymap/MyMap.h"
 
+#include <pthread.h>
+
 #include <stdarg.h>
 #include <stddef.h>
 #include <setjmp.h>
@@ -118,6 +120,132 @@ static void test_mymap_mmap_segmented_toRight(void **state) {
     mymap_release(&memMap);
 }
 
+static void test_mymap_mmap_bestFit(void **state) {
+    (void) state; /* unused */
+
+    ContainerType memMap;
+    mymap_init(&memMap);
+
+    mymap_mmap(&memMap, (void*)100, 10, 0, NULL);
+    mymap_mmap(&memMap, (void*)130, 10, 0, NULL);
+    mymap_mmap(&memMap, (void*)150, 10, 0, NULL);
+    mymap_mmap(&memMap, (void*)165, 10, 0, NULL);
+
+    /// first fit: gap after first block
+    const void* ret = mymap_mmap(&memMap, (void*)100, 5, 0, NULL);
+    assert_int_equal( ret, 110 );
+
+    /// best fit: smallest gap
+    ret = mymap_mmap(&memMap, (void*)100, 5, MYMAP_BEST_FIT, NULL);
+    assert_int_equal( ret, 160 );
+
+    assert_int_equal( mymap_size(&memMap), 6 );
+    assert_int_equal( mymap_isValid(&memMap), 0 );
+
+    mymap_release(&memMap);
+}
+
+static void test_mymap_setPolicy(void **state) {
+    (void) state; /* unused */
+
+    ContainerType memMap;
+    memMap.root = NULL;
+    assert_int_equal( mymap_setPolicy(NULL, MYMAP_FIT_FIRST), -1 );
+    assert_int_equal( mymap_setPolicy(&memMap, MYMAP_FIT_FIRST), -2 );
+
+    mymap_init(&memMap);
+    mymap_mmap(&memMap, (void*)100, 10, 0, NULL);
+    mymap_mmap(&memMap, (void*)130, 10, 0, NULL);
+
+    /// top down: highest space ending at hint
+    assert_int_equal( mymap_setPolicy(&memMap, MYMAP_FIT_TOP_DOWN), 0 );
+    const void* ret = mymap_mmap(&memMap, (void*)200, 10, 0, NULL);
+    assert_int_equal( ret, 190 );
+    ret = mymap_mmap(&memMap, (void*)135, 10, 0, NULL);
+    assert_int_equal( ret, 120 );
+
+    /// policy passed in flags
+    ret = mymap_mmap(&memMap, (void*)100, 5, MYMAP_POLICY(MYMAP_FIT_FIRST), NULL);
+    assert_int_equal( ret, 110 );
+
+    /// unknown policy code
+    assert_int_equal( mymap_mmap(&memMap, (void*)100, 5, MYMAP_POLICY(MYMAP_FIT_TOP_DOWN + 1), NULL), NULL );
+    assert_int_equal( mymap_mmap(&memMap, (void*)100, 5, MYMAP_POLICY_MASK, NULL), NULL );
+
+    assert_int_equal( mymap_size(&memMap), 5 );
+    assert_int_equal( mymap_isValid(&memMap), 0 );
+
+    mymap_release(&memMap);
+}
+
+static void test_mymap_setTopAddress(void **state) {
+    (void) state; /* unused */
+
+    ContainerType memMap;
+    memMap.root = NULL;
+    assert_int_equal( mymap_setTopAddress(NULL, (void*)0x1000), -1 );
+    assert_int_equal( mymap_setTopAddress(&memMap, (void*)0x1000), -2 );
+
+    mymap_init(&memMap);
+    assert_int_equal( mymap_setTopAddress(&memMap, NULL), -3 );
+    assert_int_equal( mymap_setPolicy(&memMap, MYMAP_FIT_TOP_DOWN), 0 );
+    mymap_mmap(&memMap, (void*)100, 10, MYMAP_POLICY(MYMAP_FIT_FIRST), NULL);
+
+    /// no hint -- top of address space, below previous block
+    const size_t top = (size_t)mymap_mmap(&memMap, NULL, 0x1000, 0, NULL);
+    assert_true( top > 0x100000 );
+    assert_int_equal( (size_t)mymap_mmap(&memMap, NULL, 0x1000, 0, NULL), top - 0x1000 );
+
+    /// no hint -- below top address
+    assert_int_equal( mymap_setTopAddress(&memMap, (void*)0x10000), 0 );
+    assert_int_equal( (size_t)mymap_mmap(&memMap, NULL, 0x1000, 0, NULL), 0xF000 );
+    assert_int_equal( (size_t)mymap_mmap(&memMap, NULL, 0x1000, 0, NULL), 0xE000 );
+    /// hint overrides top address
+    assert_int_equal( (size_t)mymap_mmap(&memMap, (void*)0x20000, 0x1000, 0, NULL), 0x1F000 );
+
+    assert_int_equal( mymap_size(&memMap), 6 );
+    assert_int_equal( mymap_isValid(&memMap), 0 );
+
+    mymap_release(&memMap);
+}
+
+static void test_mymap_mmap_batch(void **state) {
+    (void) state; /* unused */
+
+    ContainerType memMap;
+    memMap.root = NULL;
+    void* out[4];
+    map_request_t requests[4];
+    requests[0].vaddr = (void*)300;
+    requests[0].size = 10;
+    requests[1].vaddr = (void*)100;
+    requests[1].size = 20;
+    requests[2].vaddr = (void*)105;
+    requests[2].size = 10;
+    requests[3].vaddr = (void*)400;
+    requests[3].size = 0;
+    assert_int_equal( mymap_mmap_batch(NULL, requests, 4, out), 0 );
+    assert_int_equal( mymap_mmap_batch(&memMap, requests, 4, out), 0 );
+
+    mymap_init(&memMap);
+    mymap_mmap(&memMap, (void*)120, 10, 0, NULL);
+
+    assert_int_equal( mymap_mmap_batch(&memMap, requests, 4, out), 3 );
+    assert_int_equal( out[0], 300 );
+    assert_int_equal( out[1], 100 );
+    assert_int_equal( out[2], 130 );
+    assert_null( out[3] );
+
+    assert_int_equal( mymap_size(&memMap), 4 );
+    assert_int_equal( mymap_isValid(&memMap), 0 );
+
+    mymap_munmap(&memMap, (void*)135);
+    assert_int_equal( mymap_size(&memMap), 3 );
+    assert_int_equal( mymap_isValid(&memMap), 0 );
+
+    mymap_release(&memMap);
+}
+
 static void test_mymap_munmap_NULL(void **state) {
     (void) state; /* unused */
 
@@ -311,6 +439,226 @@ static void test_mymap_munmap_subtree(void **state) {
     mymap_release(&memMap);
 }
 
+static void test_mymap_munmap_range(void **state) {
+    (void) state; /* unused */
+
+    ContainerType memMap;
+    memMap.root = NULL;
+    assert_int_equal( mymap_munmap_range(NULL, NULL, 10), -1 );
+    assert_int_equal( mymap_munmap_range(&memMap, NULL, 10), -2 );
+
+    mymap_init(&memMap);
+    mymap_mmap(&memMap, (void*)100, 100, 0, NULL);
+    mymap_mmap(&memMap, (void*)300, 100, 0, NULL);
+    mymap_mmap(&memMap, (void*)500, 100, 0, NULL);
+
+    /// trim edges and release middle block
+    assert_int_equal( mymap_munmap_range(&memMap, (void*)150, 400), 0 );
+    assert_int_equal( mymap_size(&memMap), 2 );
+    assert_int_equal( mymap_isValid(&memMap), 0 );
+    assert_int_equal( mymap_startAddress(&memMap), 100 );
+    assert_int_equal( mymap_endAddress(&memMap), 600 );
+
+    /// split block
+    assert_int_equal( mymap_munmap_range(&memMap, (void*)110, 10), 0 );
+    assert_int_equal( mymap_size(&memMap), 3 );
+    assert_int_equal( mymap_isValid(&memMap), 0 );
+
+    assert_int_equal( mymap_munmap_range(&memMap, (void*)0, (size_t)-1), 0 );
+    assert_int_equal( mymap_size(&memMap), 0 );
+
+    mymap_release(&memMap);
+}
+
+static void test_mymap_cursor(void **state) {
+    (void) state; /* unused */
+
+    ContainerType memMap;
+    memMap.root = NULL;
+    map_cursor_t cursor;
+    assert_int_equal( mymap_cursorFirst(NULL, &cursor), 0 );
+    assert_int_equal( mymap_cursorFirst(&memMap, &cursor), 0 );
+    assert_null( mymap_cursorGet(&cursor, NULL) );
+
+    mymap_init(&memMap);
+    mymap_mmap(&memMap, (void*)100, 10, 0, NULL);
+    mymap_mmap(&memMap, (void*)200, 20, 0, NULL);
+
+    size_t size = 0;
+    assert_int_equal( mymap_cursorFirst(&memMap, &cursor), 1 );
+    assert_int_equal( mymap_cursorGet(&cursor, &size), 100 );
+    assert_int_equal( size, 10 );
+    assert_int_equal( mymap_cursorNext(&cursor), 1 );
+    assert_int_equal( mymap_cursorGet(&cursor, &size), 200 );
+    assert_int_equal( size, 20 );
+    assert_int_equal( mymap_cursorNext(&cursor), 0 );
+    assert_null( mymap_cursorGet(&cursor, &size) );
+    assert_int_equal( size, 0 );
+
+    assert_int_equal( mymap_cursorSeek(&memMap, (void*)150, &cursor), 1 );
+    assert_int_equal( mymap_cursorGet(&cursor, NULL), 200 );
+    assert_int_equal( mymap_cursorPrev(&cursor), 1 );
+    assert_int_equal( mymap_cursorGet(&cursor, NULL), 100 );
+
+    mymap_release(&memMap);
+}
+
+static int count_block(void *vaddr, size_t size, void *context) {
+    (void) vaddr; /* unused */
+    size_t* sum = (size_t*)context;
+    *sum += size;
+    return 0;
+}
+
+static void test_mymap_forEachInRange(void **state) {
+    (void) state; /* unused */
+
+    ContainerType memMap;
+    memMap.root = NULL;
+    size_t sum = 0;
+    assert_int_equal( mymap_forEachInRange(NULL, NULL, 10, count_block, &sum), -1 );
+    assert_int_equal( mymap_forEachInRange(&memMap, NULL, 10, count_block, &sum), -2 );
+
+    mymap_init(&memMap);
+    mymap_mmap(&memMap, (void*)100, 10, 0, NULL);
+    mymap_mmap(&memMap, (void*)200, 20, 0, NULL);
+    mymap_mmap(&memMap, (void*)300, 30, 0, NULL);
+
+    assert_int_equal( mymap_forEachInRange(&memMap, (void*)105, 100, count_block, &sum), 2 );
+    assert_int_equal( sum, 30 );
+    assert_int_equal( mymap_forEachInRange(&memMap, (void*)0, (size_t)-1, count_block, &sum), 3 );
+    assert_int_equal( sum, 90 );
+
+    mymap_release(&memMap);
+}
+
+static void test_mymap_mprotect(void **state) {
+    (void) state; /* unused */
+
+    ContainerType memMap;
+    memMap.root = NULL;
+    unsigned int any = 0;
+    unsigned int all = 0;
+    assert_int_equal( mymap_mprotect(NULL, NULL, 10, MYMAP_PROT_READ), -1 );
+    assert_int_equal( mymap_mprotect(&memMap, NULL, 10, MYMAP_PROT_READ), -2 );
+    assert_int_equal( mymap_protection(NULL, NULL, 10, &any, &all), -1 );
+    assert_int_equal( mymap_protection(&memMap, NULL, 10, &any, &all), -2 );
+
+    mymap_init(&memMap);
+    mymap_mmap(&memMap, (void*)100, 100, MYMAP_PROT_READ | MYMAP_PROT_WRITE, NULL);
+    mymap_mmap(&memMap, (void*)200, 100, MYMAP_PROT_READ, NULL);
+    assert_int_equal( mymap_protection(&memMap, (void*)150, 100, &any, &all), 1 );
+    assert_int_equal( any, MYMAP_PROT_READ | MYMAP_PROT_WRITE );
+    assert_int_equal( all, MYMAP_PROT_READ );
+    assert_int_equal( mymap_protection(&memMap, (void*)400, 100, &any, &all), 0 );
+
+    /// split block
+    assert_int_equal( mymap_mprotect(&memMap, (void*)120, 10, MYMAP_PROT_EXEC), 0 );
+    assert_int_equal( mymap_size(&memMap), 2 );
+    assert_int_equal( mymap_isValid(&memMap), 0 );
+    assert_int_equal( mymap_protection(&memMap, (void*)125, 1, &any, &all), 1 );
+    assert_int_equal( any, MYMAP_PROT_EXEC );
+
+    /// join pieces of block, blocks of equal protection stay separate
+    assert_int_equal( mymap_mprotect(&memMap, (void*)100, 200, MYMAP_PROT_NONE), 0 );
+    assert_int_equal( mymap_size(&memMap), 2 );
+    assert_int_equal( mymap_isValid(&memMap), 0 );
+    assert_int_equal( mymap_protection(&memMap, (void*)100, 200, &any, &all), 1 );
+    assert_int_equal( any, MYMAP_PROT_NONE );
+
+    /// range not fully mapped
+    assert_int_equal( mymap_mprotect(&memMap, (void*)0, 1000, MYMAP_PROT_READ), -4 );
+    assert_int_equal( mymap_mprotect(&memMap, (void*)250, 100, MYMAP_PROT_READ), -4 );
+    assert_int_equal( mymap_size(&memMap), 2 );
+    assert_int_equal( mymap_protection(&memMap, (void*)100, 200, &any, &all), 1 );
+    assert_int_equal( any, MYMAP_PROT_NONE );
+
+    /// releasing second block keeps first block
+    mymap_munmap(&memMap, (void*)200);
+    assert_int_equal( mymap_size(&memMap), 1 );
+    assert_int_equal( mymap_protection(&memMap, (void*)100, 100, &any, &all), 1 );
+    assert_int_equal( mymap_protection(&memMap, (void*)200, 100, &any, &all), 0 );
+
+    /// releasing piece releases whole block
+    assert_int_equal( mymap_mprotect(&memMap, (void*)150, 10, MYMAP_PROT_READ), 0 );
+    mymap_munmap(&memMap, (void*)155);
+    assert_int_equal( mymap_size(&memMap), 0 );
+
+    mymap_release(&memMap);
+}
+
+typedef struct {
+    map_t *map;
+    size_t base;                            /// start of thread's address window
+} MapUser;
+
+/**
+ * Reserves and releases blocks in thread's address window
+ * and looks up blocks of whole map.
+ */
+static void* use_map(void *arg) {
+    const MapUser *user = (const MapUser*)arg;
+    map_t *map = user->map;
+    for(size_t i = 0; i < 1000; ++i) {
+        void *block = mymap_mmap(map, (void*)(user->base + i % 16 * 0x100), 0x80, 0, NULL);
+        map_cursor_t cursor;
+        mymap_cursorSeek(map, block, &cursor);
+        mymap_size(map);
+        mymap_munmap(map, block);
+    }
+    return NULL;
+}
+
+static void test_mymap_useRadixIndex(void **state) {
+    (void) state; /* unused */
+
+    ContainerType memMap;
+    memMap.root = NULL;
+    assert_int_equal( mymap_useRadixIndex(NULL), -1 );
+    assert_int_equal( mymap_useRadixIndex(&memMap), -2 );
+
+    mymap_init(&memMap);
+    void* block = mymap_mmap(&memMap, (void*)0x1000, 0x1000, 0, NULL);
+    assert_int_equal( mymap_useRadixIndex(&memMap), 0 );
+    assert_int_equal( mymap_useRadixIndex(&memMap), 0 );
+
+    void* next = mymap_mmap(&memMap, (void*)0x1000, 0x1000, 0, NULL);
+    assert_true( next == (void*)0x2000 );
+    mymap_munmap(&memMap, block);
+    assert_int_equal( mymap_size(&memMap), 1 );
+    assert_int_equal( mymap_isValid(&memMap), 0 );
+
+    mymap_release(&memMap);
+}
+
+static void test_mymap_useLocking(void **state) {
+    (void) state; /* unused */
+
+    ContainerType memMap;
+    memMap.root = NULL;
+    assert_int_equal( mymap_useLocking(NULL), -1 );
+    assert_int_equal( mymap_useLocking(&memMap), -2 );
+
+    mymap_init(&memMap);
+    assert_int_equal( mymap_useLocking(&memMap), 0 );
+    assert_int_equal( mymap_useLocking(&memMap), 0 );
+
+    pthread_t threads[4];
+    MapUser users[4];
+    for(size_t i = 0; i < 4; ++i) {
+        users[i].map = &memMap;
+        users[i].base = (i + 1) * 0x10000;
+        assert_int_equal( pthread_create(&threads[i], NULL, use_map, &users[i]), 0 );
+    }
+    for(size_t i = 0; i < 4; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    assert_int_equal( mymap_size(&memMap), 0 );
+    assert_int_equal( mymap_isValid(&memMap), 0 );
+
+    assert_int_equal( mymap_release(&memMap), 1 );
+}
+
 static void test_mymap_init_NULL(void **state) {
     (void) state; /* unused */
 
@@ -442,6 +790,10 @@ int main(void) {
         unit_test(test_mymap_mmap_NULL),
         unit_test(test_mymap_mmap_empty),
         unit_test(test_mymap_mmap_first),
+        unit_test(test_mymap_mmap_bestFit),
+        unit_test(test_mymap_setPolicy),
+        unit_test(test_mymap_setTopAddress),
+        unit_test(test_mymap_mmap_batch),
         unit_test(test_mymap_mmap_second),
         unit_test(test_mymap_mmap_segmented_toLeft),
         unit_test(test_mymap_mmap_segmented_toRight),
@@ -457,6 +809,12 @@ int main(void) {
         unit_test(test_mymap_munmap_left),
         unit_test(test_mymap_munmap_left2),
         unit_test(test_mymap_munmap_subtree),
+        unit_test(test_mymap_munmap_range),
+        unit_test(test_mymap_cursor),
+        unit_test(test_mymap_forEachInRange),
+        unit_test(test_mymap_mprotect),
+        unit_test(test_mymap_useRadixIndex),
+        unit_test(test_mymap_useLocking),
 
         unit_test(test_mymap_init_NULL),
         unit_test(test_mymap_init_valid),
@@ -27,20 +27,38 @@
 #include <stddef.h>                            /// NULL, size_t
 #include <stdio.h>                      	   /// printf
 #include <stdbool.h>
+#include <stdint.h>                             /// uintptr_t
 
 #include "rbtree/AbstractRBTreeDefs.h"
 
 
 
+/**
+ * Compact node: value (key data) is placed first, color is kept in lowest bit
+ * of parent pointer (nodes are at least pointer aligned, so the bit is always
+ * free). Use 'rbtree_parent()' and 'rbtree_color()' to read the fields.
+ */
 typedef struct ARBTreeElement {
-    struct ARBTreeElement* parent;
+    ARBTreeValue value;
     struct ARBTreeElement* left;
     struct ARBTreeElement* right;
-    ARBTreeValue value;
-    ARBTreeNodeColor color;                			/// black by default
+    uintptr_t parentColor;                          /// parent pointer and color (black by default)
+    size_t size;                                    /// number of nodes in subtree (including node)
 } ARBTreeNode;
 
 
+#define ARBTREE_COLOR_MASK      ((uintptr_t) 1)
+
+
+static inline ARBTreeNode* rbtree_parent(const ARBTreeNode* node) {
+    return (ARBTreeNode*) (node->parentColor & ~ARBTREE_COLOR_MASK);
+}
+
+static inline ARBTreeNodeColor rbtree_color(const ARBTreeNode* node) {
+    return (ARBTreeNodeColor) (node->parentColor & ARBTREE_COLOR_MASK);
+}
+
+
 /// ===========================================================================
 
 
@@ -50,10 +68,51 @@ typedef struct ARBTreeElement {
  */
 void rbtree_init(ARBTree* tree);
 
+/**
+ * Initializes tree storing values of 'valueSize' bytes inside nodes.
+ * Values passed to 'rbtree_add' are copied.
+ */
+void rbtree_initInline(ARBTree* tree, const size_t valueSize);
+
+/**
+ * Makes tree allocate nodes from slab pool (see 'NodePool.h').
+ * Have to be called on empty tree. Pool is released together with tree.
+ * If pool could not be created, then nodes are allocated by calloc.
+ */
+void rbtree_usePool(ARBTree* tree);
+
+/**
+ * Makes 'rbtree_findNode' and 'rbtree_add' start from last touched node
+ * (finger) instead of root. Operations close to previous one take O(log d),
+ * where d is distance (number of nodes) to finger, but unrelated operations
+ * visit up to two times more nodes, so finger suits workloads of strong locality.
+ */
+void rbtree_useFinger(ARBTree* tree);
+
 size_t rbtree_size(const ARBTree* tree);
 
+/**
+ * Returns exact depth. Requires traversal of whole tree,
+ * for constant time estimation use 'rbtree_blackHeight'.
+ */
 size_t rbtree_depth(const ARBTree* tree);
 
+/**
+ * Returns black height of tree (constant time).
+ * Depth of red-black tree is in range [blackHeight, 2*blackHeight].
+ */
+size_t rbtree_blackHeight(const ARBTree* tree);
+
+/**
+ * Returns smallest value or NULL if tree is empty (constant time).
+ */
+ARBTreeValue rbtree_firstValue(const ARBTree* tree);
+
+/**
+ * Returns greatest value or NULL if tree is empty (constant time).
+ */
+ARBTreeValue rbtree_lastValue(const ARBTree* tree);
+
 ARBTreeValue rbtree_valueByIndex(const ARBTree* tree, const size_t index);
 
 ARBTreeValidationError rbtree_isValid(const ARBTree* tree);
@@ -72,10 +131,105 @@ bool rbtree_release(ARBTree* tree);
 
 ARBTreeNode* rbtree_findNode(const ARBTree* tree, const ARBTreeValue value);
 
+/**
+ * Returns false if value could not be added (node allocation failed).
+ */
 bool rbtree_add(ARBTree* tree, const ARBTreeValue value);
 
+/**
+ * Inserts value as left or right leaf child of 'parent' (child has to be empty)
+ * and repairs colors. If 'parent' is NULL, then value becomes root of empty tree.
+ * Order is not checked. Used by insert loops generated by 'RBTREE_DEFINE'.
+ * Returns NULL if node could not be allocated (tree is not changed).
+ */
+ARBTreeNode* rbtree_insertLeaf(ARBTree* tree, ARBTreeNode* parent, const bool left, const ARBTreeValue value);
+
+/**
+ * Builds perfectly balanced tree of ascending 'values' in O(n): middle value
+ * becomes root, nodes of lowest level are red, other nodes are black.
+ * Tree has to be empty, otherwise returns false. Returns false also
+ * if allocation failed (tree stays empty).
+ */
+bool rbtree_buildFromSorted(ARBTree* tree, const ARBTreeValue* values, const size_t size);
+
+/**
+ * Inserts ascending 'values' into tree. Small batch is inserted value by value
+ * (descent from root and local repair of colors, O(k log n) for tree of
+ * n nodes and k values). If k log n exceeds n + k, then values are merged
+ * with nodes of tree in single in-order pass and all nodes are relinked into
+ * perfectly balanced tree at once in O(n + k). Existing nodes are reused
+ * in both cases. Values are not fitted ('fTryFit*' are not called).
+ * Pointers to new nodes are stored in 'nodes' if not NULL.
+ * Returns false if allocation failed (tree is not changed).
+ */
+bool rbtree_addSorted(ARBTree* tree, const ARBTreeValue* values, const size_t size, ARBTreeNode** nodes);
+
 bool rbtree_delete(ARBTree* tree, const ARBTreeValue value);
 
+/**
+ * Removes node found previously by 'rbtree_findNode'. Values of other
+ * nodes can be moved (inline values), so pointers to them are invalidated.
+ */
+bool rbtree_deleteNode(ARBTree* tree, ARBTreeNode* node);
+
+/**
+ * Recalculates augmented data after value of 'node' has been modified
+ * in place. Modification must not change order of values.
+ */
+void rbtree_refreshValue(ARBTree* tree, ARBTreeNode* node);
+
+/**
+ * Recalculates augmented data of all nodes in O(n) after many values
+ * have been modified in place. Modification must not change order of values.
+ */
+void rbtree_refreshTree(ARBTree* tree);
+
+
+/// =================================================================
+
+
+/**
+ * Splits 'tree' into 'left' (values less than 'key') and 'right' (other values)
+ * in O(log n). Both trees take configuration of 'tree', 'tree' becomes empty
+ * (it can be passed as 'left' or 'right'). Trees share allocator of 'tree':
+ * 'left' owns it (see 'fReleaseAllocator'), so 'right' has to be joined
+ * back or released before 'left'.
+ */
+void rbtree_split(ARBTree* tree, const ARBTreeValue key, ARBTree* left, ARBTree* right);
+
+/**
+ * Joins 'left', 'pivot' and 'right' into 'left' in O(log n). Values of 'left'
+ * have to be less than 'pivot' and values of 'right' greater than 'pivot',
+ * otherwise returns false. 'right' becomes empty. Trees have to share allocator.
+ * Returns false also if pivot node could not be allocated (trees are not changed).
+ */
+bool rbtree_join(ARBTree* left, const ARBTreeValue pivot, ARBTree* right);
+
+/**
+ * Joins 'left' and 'right' into 'left' in O(log n) (greatest node of 'left'
+ * is pivot). Values of 'left' have to be less than values of 'right',
+ * otherwise returns false. 'right' becomes empty.
+ */
+bool rbtree_concat(ARBTree* left, ARBTree* right);
+
+/**
+ * Set operations: result is stored in 'tree', 'other' becomes empty.
+ * Trees are treated as sets (no equal values inside tree) and have to
+ * share configuration and allocator. Subtrees are split by root of other
+ * tree and processed recursively, independent halves run on up to
+ * 'threads' threads (fork-join), then results are joined back. Removed
+ * nodes are released in calling thread, so allocator does not have to be
+ * thread safe.
+ */
+void rbtree_union(ARBTree* tree, ARBTree* other, const size_t threads);
+
+void rbtree_intersection(ARBTree* tree, ARBTree* other, const size_t threads);
+
+/**
+ * Removes values of 'other' from 'tree'.
+ */
+void rbtree_difference(ARBTree* tree, ARBTree* other, const size_t threads);
+
 
 /// =================================================================
 
@@ -91,13 +245,13 @@ bool rbtree_delete(ARBTree* tree, const ARBTreeValue value);
  */
 static inline const ARBTreeNode* rbtree_getRightAncestor(const ARBTreeNode* node) {
     const ARBTreeNode* child = node;
-    const ARBTreeNode* curr = node->parent;
+    const ARBTreeNode* curr = rbtree_parent(node);
     while( curr != NULL ) {
         if (curr->left == child) {
             return curr;
         }
         child = curr;
-        curr = curr->parent;
+        curr = rbtree_parent(curr);
     }
     /// root found
     return NULL;
@@ -114,19 +268,57 @@ static inline const ARBTreeNode* rbtree_getRightAncestor(const ARBTreeNode* node
  */
 static inline const ARBTreeNode* rbtree_getLeftAncestor(const ARBTreeNode* node) {
     const ARBTreeNode* child = node;
-    const ARBTreeNode* curr = node->parent;
+    const ARBTreeNode* curr = rbtree_parent(node);
     while( curr != NULL ) {
         if (curr->right == child) {
             return curr;
         }
         child = curr;
-        curr = curr->parent;
+        curr = rbtree_parent(curr);
     }
     /// root found
     return NULL;
 }
 
 
+/**
+ * Returns in-order successor of node or NULL.
+ */
+const ARBTreeNode* rbtree_nextNode(const ARBTreeNode* node);
+
+/**
+ * Returns in-order predecessor of node or NULL.
+ */
+const ARBTreeNode* rbtree_prevNode(const ARBTreeNode* node);
+
+
+/// =================================================================
+
+
+/**
+ * Cursor functions return true if cursor points to value. Stepping uses
+ * parent pointers, so walk over whole tree takes O(n) (amortized O(1)
+ * per step) without allocations.
+ */
+bool rbtree_cursorFirst(const ARBTree* tree, ARBTreeCursor* cursor);
+
+bool rbtree_cursorLast(const ARBTree* tree, ARBTreeCursor* cursor);
+
+/**
+ * Moves cursor to first value not less than 'value' in O(log n).
+ */
+bool rbtree_cursorSeek(const ARBTree* tree, const ARBTreeValue value, ARBTreeCursor* cursor);
+
+bool rbtree_cursorNext(ARBTreeCursor* cursor);
+
+bool rbtree_cursorPrev(ARBTreeCursor* cursor);
+
+/**
+ * Returns value pointed by cursor or NULL.
+ */
+ARBTreeValue rbtree_cursorGet(const ARBTreeCursor* cursor);
+
+
 /// =================================================================
 
 
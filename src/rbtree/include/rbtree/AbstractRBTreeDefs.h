@@ -24,6 +24,7 @@
 #ifndef SRC_RBTREE_INCLUDE_RBTREE_ABSTRACTRBTREEDEFS_H_
 #define SRC_RBTREE_INCLUDE_RBTREE_ABSTRACTRBTREEDEFS_H_
 
+#include <stddef.h>                            /// size_t
 #include <stdbool.h>
 
 
@@ -45,7 +46,11 @@ typedef enum {
     /// red-black tree properties
     ARBTREE_INVALID_RED_ROOT = 6,
     ARBTREE_INVALID_BLACK_CHILDREN = 7,            /// when node is red, then children have to be black
-    ARBTREE_INVALID_BLACK_PATH = 8                 /// invalid number of black nodes on paths
+    ARBTREE_INVALID_BLACK_PATH = 8,                /// invalid number of black nodes on paths
+
+    /// augmentation properties
+    ARBTREE_INVALID_AUGMENTED_DATA = 9,            /// data augmented to node does not match its subtree
+    ARBTREE_INVALID_TREE_DATA = 10                 /// cached tree data (bounds, black height) does not match nodes
 } ARBTreeValidationError;
 
 
@@ -64,25 +69,62 @@ typedef bool (* rbtree_isLessOrder)(const ARBTreeValue valueA, const ARBTreeValu
 
 typedef bool (* rbtree_tryFit)(const struct ARBTreeElement* node, ARBTreeValue value);
 
+/**
+ * Recalculates data augmented to node (e.g. subtree aggregates) based on node's children.
+ * Called bottom-up on every structural change of tree (insertion, deletion, rotation).
+ */
+typedef void (* rbtree_updateNode)(struct ARBTreeElement* node);
+
 typedef void (* rbtree_printValue)(const ARBTreeValue value);
 
 typedef void (* rbtree_deleteValue)(ARBTreeValue value);
 
+typedef void* (* rbtree_allocNode)(void* allocator, const size_t size);
+
+typedef void (* rbtree_freeNode)(void* allocator, void* node);
+
+/**
+ * Releases all nodes allocated by allocator and allocator itself.
+ */
+typedef void (* rbtree_releaseAllocator)(void* allocator);
+
 
 /// ==================================================================
 
 
 typedef struct {
     struct ARBTreeElement* root;
+    struct ARBTreeElement* leftmost;            /// smallest node, NULL if tree is empty
+    struct ARBTreeElement* rightmost;           /// greatest node, NULL if tree is empty
+    size_t blackHeight;                         /// number of black nodes on every path from root to leaf
+    struct ARBTreeElement* finger;              /// last inserted node or neighbour of last removed node, NULL if tree is empty
+    bool fingerSearch;                          /// start searches from 'finger' instead of root
+
+    size_t valueSize;                           /// size of value stored inside node, 0 means node keeps external pointer
 
     rbtree_isLessOrder fIsLessOrder;
 
     rbtree_tryFit fTryFitRight;                 /// optional, can be NULL
     rbtree_tryFit fTryFitLeft;                  /// optional, can be NULL
 
+    rbtree_updateNode fUpdateNode;              /// optional, can be NULL
+
     rbtree_printValue fPrintValue;
-    rbtree_deleteValue fDeleteValue;            /// destroy value (release memory etc)
+    rbtree_deleteValue fDeleteValue;            /// destroy value (release memory etc), optional for inline values
+
+    void* allocator;                            /// data passed to node allocation functions
+    rbtree_allocNode fAllocNode;                /// optional, can be NULL (calloc is used then)
+    rbtree_freeNode fFreeNode;                  /// optional, can be NULL (free is used then)
+    rbtree_releaseAllocator fReleaseAllocator;  /// optional, allows releasing tree without visiting every node
 } ARBTree;
 
 
+/**
+ * Position of in-order walk over tree. Cursor is valid until tree is modified.
+ */
+typedef struct {
+    const struct ARBTreeElement* node;          /// current node, NULL if cursor is past the end
+} ARBTreeCursor;
+
+
 #endif /* SRC_RBTREE_INCLUDE_RBTREE_ABSTRACTRBTREEDEFS_H_ */
@@ -0,0 +1,130 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#ifndef SRC_RBTREE_INCLUDE_RBTREE_ARENARBTREE_H_
+#define SRC_RBTREE_INCLUDE_RBTREE_ARENARBTREE_H_
+
+#include <stddef.h>                            /// NULL, size_t
+#include <stdint.h>                            /// uint32_t
+#include <stdbool.h>
+
+#include "rbtree/AbstractRBTreeDefs.h"
+
+
+#define ARTREE_NULL                 0               /// index of missing node
+#define ARTREE_INITIAL_CAPACITY     16              /// number of nodes allocated on first insertion
+#define ARTREE_MAX_NODES            0x7FFFFFFF      /// lowest bit of link keeps color, so indices are 31-bit
+
+
+typedef uint32_t ARTreeIndex;
+
+
+/**
+ * Links of node in arena. Color is kept in lowest bit of parent link.
+ */
+typedef struct {
+    ARTreeIndex left;
+    ARTreeIndex right;
+    ARTreeIndex parentColor;
+} ARTreeNode;
+
+
+/**
+ * Red-black tree keeping all nodes in one growable array. Nodes link to each
+ * other by 32-bit indices instead of pointers, so node is much smaller than
+ * ARBTreeNode and whole structure can be moved or copied with 'memcpy'.
+ *
+ * Node is laid out as value (copied, 'valueSize' bytes) followed by links.
+ * Index 0 is reserved and means no node. Released nodes are reused.
+ *
+ * Pointers returned by 'artree_value' are invalidated by 'artree_add'
+ * (array can be reallocated), indices stay valid until node is deleted.
+ */
+typedef struct {
+    char* nodes;                                /// array of nodes
+    size_t nodeSize;                            /// size of node with value (stride of array)
+    size_t valueSize;
+    size_t linksOffset;                         /// offset of links inside node
+    ARTreeIndex capacity;                       /// number of nodes in array
+    ARTreeIndex used;                           /// number of nodes taken from array (including reserved node)
+    ARTreeIndex freeList;                       /// released nodes linked by 'left'
+    ARTreeIndex root;
+    size_t size;                                /// number of nodes in tree
+
+    rbtree_isLessOrder fIsLessOrder;
+    rbtree_printValue fPrintValue;              /// optional, can be NULL
+} ArenaRBTree;
+
+
+/// ===========================================================================
+
+
+/**
+ * Initializes tree storing values of 'valueSize' bytes. Comparator
+ * 'fIsLessOrder' has to be set after initialization.
+ * If tree has be initialized previously, then have to be released
+ * before next initialization.
+ */
+void artree_init(ArenaRBTree* tree, const size_t valueSize);
+
+size_t artree_size(const ArenaRBTree* tree);
+
+size_t artree_depth(const ArenaRBTree* tree);
+
+/**
+ * Returns number of bytes allocated for nodes.
+ */
+size_t artree_memoryUsage(const ArenaRBTree* tree);
+
+/**
+ * Returns pointer to value stored in node 'index'.
+ */
+ARBTreeValue artree_value(const ArenaRBTree* tree, const ARTreeIndex index);
+
+ARBTreeValidationError artree_isValid(const ArenaRBTree* tree);
+
+void artree_print(const ArenaRBTree* tree);
+
+/**
+ * Releases all nodes at once. Tree can be reused afterwards.
+ */
+void artree_release(ArenaRBTree* tree);
+
+
+/// =================================================================
+
+
+/**
+ * Returns index of node holding value equal to given one or ARTREE_NULL.
+ */
+ARTreeIndex artree_findNode(const ArenaRBTree* tree, const ARBTreeValue value);
+
+/**
+ * Copies value into tree. Returns false if arena cannot grow.
+ */
+bool artree_add(ArenaRBTree* tree, const ARBTreeValue value);
+
+bool artree_delete(ArenaRBTree* tree, const ARBTreeValue value);
+
+
+#endif /* SRC_RBTREE_INCLUDE_RBTREE_ARENARBTREE_H_ */
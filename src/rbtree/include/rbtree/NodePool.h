@@ -0,0 +1,96 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+
+#ifndef SRC_RBTREE_INCLUDE_RBTREE_NODEPOOL_H_
+#define SRC_RBTREE_INCLUDE_RBTREE_NODEPOOL_H_
+
+#include <stddef.h>                            /// NULL, size_t
+
+
+#define NODEPOOL_CACHE_LINE         64              /// alignment of cache line
+#define NODEPOOL_NODE_ALIGNMENT     sizeof(void*)   /// default alignment of nodes -- nodes are packed densely
+#define NODEPOOL_CHUNK_NODES        1024            /// default number of nodes in chunk
+
+
+/**
+ * Slab allocator of fixed size nodes. Nodes are taken from large chunks
+ * and released nodes are reused. All nodes can be released at once.
+ */
+typedef struct {
+    struct NodePoolChunk* chunks;           /// list of allocated chunks
+    void* freeList;                         /// list of released nodes
+    char* next;                             /// next unused node in last chunk
+    char* end;                              /// end of last chunk
+    size_t nodeSize;                        /// size of node rounded up to alignment
+    size_t alignment;
+    size_t chunkNodes;                      /// number of nodes in chunk
+    size_t used;                            /// number of nodes in use
+} NodePool;
+
+
+/// ===========================================================================
+
+
+/**
+ * 'alignment' have to be power of two.
+ */
+void pool_init(NodePool* pool, const size_t nodeSize, const size_t alignment, const size_t chunkNodes);
+
+/**
+ * Returns zeroed node or NULL if new chunk could not be allocated.
+ */
+void* pool_alloc(NodePool* pool);
+
+void pool_free(NodePool* pool, void* node);
+
+/**
+ * Releases all chunks (all nodes) at once.
+ */
+void pool_release(NodePool* pool);
+
+size_t pool_chunks(const NodePool* pool);
+
+
+/// =================================================================
+
+
+/**
+ * Creates pool on heap. Used as allocator of tree nodes.
+ * Nodes are packed densely (aligned to pointer size), so compact
+ * nodes are not padded up to whole cache line.
+ * Returns NULL if allocation failed.
+ */
+NodePool* pool_create(const size_t nodeSize);
+
+/**
+ * Releases all nodes and pool created by 'pool_create'.
+ */
+void pool_destroy(void* allocator);
+
+void* pool_allocNode(void* allocator, const size_t size);
+
+void pool_freeNode(void* allocator, void* node);
+
+
+#endif /* SRC_RBTREE_INCLUDE_RBTREE_NODEPOOL_H_ */
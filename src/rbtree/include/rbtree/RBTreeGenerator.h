@@ -0,0 +1,336 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#ifndef RBTREEGENERATOR_H_
+#define RBTREEGENERATOR_H_
+
+#include <stddef.h>                            /// NULL, size_t
+#include <stdbool.h>
+
+#include "rbtree/AbstractRBTree.h"
+
+
+/**
+ * Generator of search and insert loops of ARBTree specialized for given value type.
+ *
+ * ARBTree calls comparator and fitting functions through pointers, so they
+ * cannot be inlined. Loops generated here call the functions by name, so
+ * compiler can inline them. Generated functions work on ordinary ARBTree
+ * (any layout of values), colors are repaired and augmented data is updated
+ * by AbstractRBTree, so generated tree keeps all features of ARBTree.
+ * ARBTree itself uses loops generated from the same macro with comparator
+ * and fitting functions taken from tree ('fIsLessOrder', 'fTryFit*').
+ *
+ * Usage (in source file, without trailing semicolon):
+ *      RBTREE_DEFINE(uirbtree, size_t, uirbtree_less, RBTREE_FIT_ANY, RBTREE_FIT_ANY)
+ *
+ * Parameters:
+ *      name        -- prefix of generated functions
+ *      value_type  -- type of value pointed by 'ARBTreeValue'
+ *      less        -- function or macro 'bool less(const value_type* a, const value_type* b)'
+ *      fit_left    -- function or macro 'bool fit(const ARBTreeNode* node, ARBTreeValue value)'
+ *                     deciding if value can be placed as left child of node (value can be adjusted)
+ *      fit_right   -- as above, for right child
+ *
+ * Generated functions (static, instantiated in every source file using them):
+ *      ARBTreeNode* name_findNode(const ARBTree* tree, const ARBTreeValue value)   -- as 'rbtree_findNode'
+ *      ARBTreeNode* name_addValue(ARBTree* tree, const ARBTreeValue value)         -- as 'rbtree_add', returns
+ *                                                                                     new node (NULL on failure)
+ *      bool name_deleteValue(ARBTree* tree, const ARBTreeValue value)              -- as 'rbtree_delete'
+ */
+
+
+/**
+ * Fitting function accepting every position.
+ */
+#define RBTREE_FIT_ANY(node, value)     true
+
+
+/**
+ * Defines loops for comparator and fitting functions of given value type.
+ */
+#define RBTREE_DEFINE(name, value_type, less, fit_left, fit_right)                                                  \
+    static inline bool name##_lessValue(const ARBTree* tree, const ARBTreeValue valueA, const ARBTreeValue valueB) { \
+        (void) tree; /* unused */                                                                                   \
+        return less((const value_type*)valueA, (const value_type*)valueB);                                          \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline bool name##_fitLeft(const ARBTree* tree, const ARBTreeNode* node, ARBTreeValue value) {           \
+        (void) tree; /* unused */                                                                                   \
+        (void) node; /* unused */                                                                                   \
+        (void) value; /* unused */                                                                                  \
+        return fit_left(node, value);                                                                               \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline bool name##_fitRight(const ARBTree* tree, const ARBTreeNode* node, ARBTreeValue value) {          \
+        (void) tree; /* unused */                                                                                   \
+        (void) node; /* unused */                                                                                   \
+        (void) value; /* unused */                                                                                  \
+        return fit_right(node, value);                                                                              \
+    }                                                                                                               \
+                                                                                                                    \
+    RBTREE_DEFINE_LOOPS(name, name##_lessValue, name##_fitLeft, name##_fitRight)
+
+
+/// ===========================================================================
+
+
+/**
+ * Defines loops calling 'less(tree, valueA, valueB)', 'fit_left(tree, node, value)'
+ * and 'fit_right(tree, node, value)'.
+ */
+#define RBTREE_DEFINE_LOOPS(name, less, fit_left, fit_right)                                                        \
+    RBTREE_DEFINE_FIND(name, less)                                                                                  \
+    RBTREE_DEFINE_ADD(name, less, fit_left, fit_right)                                                              \
+                                                                                                                    \
+    static inline bool name##_deleteValue(ARBTree* tree, const ARBTreeValue value) {                                \
+        ARBTreeNode* node = name##_findNode(tree, value);                                                           \
+        if (node == NULL) {                                                                                         \
+            /* node not found -- nothing to remove */                                                               \
+            return false;                                                                                           \
+        }                                                                                                           \
+        return rbtree_deleteNode(tree, node);                                                                       \
+    }
+
+
+/**
+ * Search of value: finger subtree (see 'rbtree_useFinger') and descent from root.
+ */
+#define RBTREE_DEFINE_FIND(name, less)                                                                              \
+    /* Finds smallest subtree containing finger and range of 'value' in O(log d), where d is distance */           \
+    /* between finger and value. Sets 'found' if ancestor equal to value is met. Returns NULL if 'value' */         \
+    /* is not placed inside any subtree below root. */                                                              \
+    static inline ARBTreeNode* name##_fingerSubtree(const ARBTree* tree, const ARBTreeValue value, bool* found) {   \
+        const ARBTreeNode* curr = tree->finger;                                                                     \
+        *found = false;                                                                                             \
+        if (curr == NULL) {                                                                                         \
+            return NULL;                                                                                            \
+        }                                                                                                           \
+        if ( less(tree, curr->value, value) == true ) {                                                             \
+            /* value > finger -- check upper bounds */                                                              \
+            while (curr != NULL) {                                                                                  \
+                const ARBTreeNode* bound = rbtree_getRightAncestor(curr);                                           \
+                if (bound == NULL) {                                                                                \
+                    return NULL;                                                                                    \
+                }                                                                                                   \
+                if ( less(tree, value, bound->value) == true ) {                                                    \
+                    return (ARBTreeNode*) curr;                                                                     \
+                }                                                                                                   \
+                if ( less(tree, bound->value, value) == false ) {                                                   \
+                    /* equal */                                                                                     \
+                    *found = true;                                                                                  \
+                    return (ARBTreeNode*) bound;                                                                     \
+                }                                                                                                   \
+                curr = bound;                                                                                       \
+            }                                                                                                       \
+            return NULL;                                                                                            \
+        }                                                                                                           \
+        if ( less(tree, value, curr->value) == true ) {                                                             \
+            /* value < finger -- check lower bounds */                                                              \
+            while (curr != NULL) {                                                                                  \
+                const ARBTreeNode* bound = rbtree_getLeftAncestor(curr);                                            \
+                if (bound == NULL) {                                                                                \
+                    return NULL;                                                                                    \
+                }                                                                                                   \
+                if ( less(tree, bound->value, value) == true ) {                                                    \
+                    return (ARBTreeNode*) curr;                                                                     \
+                }                                                                                                   \
+                if ( less(tree, value, bound->value) == false ) {                                                   \
+                    /* equal */                                                                                     \
+                    *found = true;                                                                                  \
+                    return (ARBTreeNode*) bound;                                                                     \
+                }                                                                                                   \
+                curr = bound;                                                                                       \
+            }                                                                                                       \
+            return NULL;                                                                                            \
+        }                                                                                                           \
+        /* equal */                                                                                                 \
+        *found = true;                                                                                              \
+        return (ARBTreeNode*) curr;                                                                                 \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline ARBTreeNode* name##_findNode(const ARBTree* tree, const ARBTreeValue value) {                     \
+        ARBTreeNode* curr = NULL;                                                                                   \
+        if (tree->fingerSearch == true) {                                                                           \
+            bool found = false;                                                                                     \
+            curr = name##_fingerSubtree(tree, value, &found);                                                       \
+            if (found == true) {                                                                                    \
+                return curr;                                                                                        \
+            }                                                                                                       \
+        }                                                                                                           \
+        if (curr == NULL) {                                                                                         \
+            curr = tree->root;                                                                                      \
+        }                                                                                                           \
+        while (curr != NULL) {                                                                                      \
+            if ( less(tree, value, curr->value) == true ) {                                                         \
+                curr = curr->left;                                                                                  \
+                continue ;                                                                                          \
+            }                                                                                                       \
+            if ( less(tree, curr->value, value) == true ) {                                                         \
+                curr = curr->right;                                                                                 \
+                continue ;                                                                                          \
+            }                                                                                                       \
+            /* equal */                                                                                             \
+            return curr;                                                                                            \
+        }                                                                                                           \
+        /* not found */                                                                                             \
+        return NULL;                                                                                                \
+    }
+
+
+/**
+ * Insertion of value: descent to smaller node, then walk over leaves
+ * to first position accepted by fitting functions.
+ */
+#define RBTREE_DEFINE_ADD(name, less, fit_left, fit_right)                                                          \
+    /* If no smaller node exists, then returns greater node. */                                                     \
+    static inline ARBTreeNode* name##_findSmallerNode(const ARBTree* tree, ARBTreeNode* currNode, ARBTreeValue value) { \
+        ARBTreeNode* tmpNode = currNode;                                                                            \
+        ARBTreeNode* bestNode = tmpNode;                                                                            \
+        bool valid = false;                                                                                         \
+        while (tmpNode != NULL) {                                                                                   \
+            if ( less(tree, tmpNode->value, value) ) {                                                              \
+                /* in order */                                                                                      \
+                bestNode = tmpNode;                                                                                 \
+                valid = true;                                                                                       \
+                if (tmpNode->right == NULL) {                                                                       \
+                    break;                                                                                          \
+                }                                                                                                   \
+                tmpNode = tmpNode->right;                                                                           \
+            } else {                                                                                                \
+                if (valid == false) {                                                                               \
+                    bestNode = tmpNode;                                                                             \
+                }                                                                                                   \
+                if (tmpNode->left == NULL) {                                                                        \
+                    /* no 'smaller' node exists */                                                                  \
+                    break;                                                                                          \
+                }                                                                                                   \
+                tmpNode = tmpNode->left;                                                                            \
+            }                                                                                                       \
+        }                                                                                                           \
+        return bestNode;                                                                                            \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Adds value as left child of node (left child has to be empty) if fits. */                                    \
+    /* Returns true if value fits, new node (NULL if not allocated) is stored in 'added'. */                        \
+    static inline bool name##_addToLeft(ARBTree* tree, ARBTreeNode* node, ARBTreeValue value, ARBTreeNode** added) {\
+        if ( fit_left(tree, node, value) == false ) {                                                               \
+            return false;                                                                                           \
+        }                                                                                                           \
+        *added = rbtree_insertLeaf(tree, node, true, value);                                                        \
+        return true;                                                                                                \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Adds value as right child of node if the child is empty and value fits. */                                   \
+    static inline bool name##_addToRight(ARBTree* tree, ARBTreeNode* node, ARBTreeValue value, ARBTreeNode** added) {\
+        if (node->right != NULL) {                                                                                  \
+            return false;                                                                                           \
+        }                                                                                                           \
+        if ( fit_right(tree, node, value) == false ) {                                                              \
+            return false;                                                                                           \
+        }                                                                                                           \
+        *added = rbtree_insertLeaf(tree, node, false, value);                                                       \
+        return true;                                                                                                \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Leftmost node of right subtree, NULL if there is no right subtree. */                                        \
+    static inline ARBTreeNode* name##_rightDescendant(const ARBTreeNode* node) {                                    \
+        ARBTreeNode* curr = node->right;                                                                            \
+        if (curr == NULL) {                                                                                         \
+            return NULL;                                                                                            \
+        }                                                                                                           \
+        while (curr->left != NULL) {                                                                                \
+            curr = curr->left;                                                                                      \
+        }                                                                                                           \
+        return curr;                                                                                                \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline ARBTreeNode* name##_addToNode(ARBTree* tree, ARBTreeNode* currNode, ARBTreeValue value) {         \
+        ARBTreeNode* added = NULL;                                                                                  \
+        ARBTreeNode* tmpNode = name##_findSmallerNode(tree, currNode, value);     /* never NULL */                  \
+        if (tmpNode->left == NULL && less(tree, value, tmpNode->value)) {                                           \
+            if (name##_addToLeft(tree, tmpNode, value, &added) == true) {                                           \
+                return added;                                                                                       \
+            }                                                                                                       \
+        }                                                                                                           \
+        if (name##_addToRight(tree, tmpNode, value, &added) == true) {                                              \
+            return added;                                                                                           \
+        }                                                                                                           \
+        /* walk over next leaves: right descendant of node, right descendant of right ancestor */                   \
+        /* or right ancestor itself (if it does not have right child) */                                            \
+        while (tmpNode != NULL) {                                                                                   \
+            ARBTreeNode* below = name##_rightDescendant(tmpNode);                                                   \
+            if (below != NULL) {                                                                                    \
+                /* left child is empty -- check both */                                                             \
+                tmpNode = below;                                                                                    \
+                if (name##_addToLeft(tree, tmpNode, value, &added) == true) {                                       \
+                    return added;                                                                                   \
+                }                                                                                                   \
+                if (name##_addToRight(tree, tmpNode, value, &added) == true) {                                      \
+                    return added;                                                                                   \
+                }                                                                                                   \
+                continue;                                                                                           \
+            }                                                                                                       \
+            ARBTreeNode* ancestor = (ARBTreeNode*) rbtree_getRightAncestor(tmpNode);                                \
+            if (ancestor == NULL) {                                                                                 \
+                return NULL;                                                                                        \
+            }                                                                                                       \
+            ARBTreeNode* right = name##_rightDescendant(ancestor);                                                  \
+            if (right != NULL) {                                                                                    \
+                /* left child is empty -- check both */                                                             \
+                tmpNode = right;                                                                                    \
+                if (name##_addToLeft(tree, tmpNode, value, &added) == true) {                                       \
+                    return added;                                                                                   \
+                }                                                                                                   \
+                if (name##_addToRight(tree, tmpNode, value, &added) == true) {                                      \
+                    return added;                                                                                   \
+                }                                                                                                   \
+            } else {                                                                                                \
+                /* left child is not empty -- check only right */                                                   \
+                tmpNode = ancestor;                                                                                 \
+                if (name##_addToRight(tree, tmpNode, value, &added) == true) {                                      \
+                    return added;                                                                                   \
+                }                                                                                                   \
+            }                                                                                                       \
+        }                                                                                                           \
+        return NULL;                                                                                                \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline ARBTreeNode* name##_addValue(ARBTree* tree, const ARBTreeValue value) {                           \
+        if (tree->root == NULL) {                                                                                   \
+            return rbtree_insertLeaf(tree, NULL, true, value);                                                      \
+        }                                                                                                           \
+        /* start from subtree near last touched node (root if not found) */                                         \
+        ARBTreeNode* start = tree->root;                                                                            \
+        if (tree->fingerSearch == true) {                                                                           \
+            bool found = false;                                                                                     \
+            ARBTreeNode* subtree = name##_fingerSubtree(tree, value, &found);                                       \
+            if (subtree != NULL && found == false) {                                                                \
+                start = subtree;                                                                                    \
+            }                                                                                                       \
+        }                                                                                                           \
+        return name##_addToNode(tree, start, value);                                                                \
+    }
+
+
+#endif /* RBTREEGENERATOR_H_ */
@@ -56,5 +56,16 @@ bool uirbtree_delete(UIntRBTree* tree, const UIntRBTreeValue value);
 
 bool uirbtree_release(UIntRBTree* tree);
 
+/**
+ * Set operations on trees of distinct values running on up to 'threads'
+ * threads (see 'rbtree_union'). Result is stored in 'tree', 'other'
+ * becomes empty.
+ */
+bool uirbtree_union(UIntRBTree* tree, UIntRBTree* other, const size_t threads);
+
+bool uirbtree_intersection(UIntRBTree* tree, UIntRBTree* other, const size_t threads);
+
+bool uirbtree_difference(UIntRBTree* tree, UIntRBTree* other, const size_t threads);
+
 
 #endif /* SRC_RBTREE_INCLUDE_RBTREE_UINTRBTREE_H_ */
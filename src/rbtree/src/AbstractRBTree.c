@@ -22,10 +22,13 @@
 ///
 
 #include "rbtree/AbstractRBTree.h"
+#include "rbtree/NodePool.h"
+#include "rbtree/RBTreeGenerator.h"
 
 #include <stdlib.h>                     /// free
 #include <assert.h>
 #include <string.h>
+#include <pthread.h>
 
 
 
@@ -33,14 +36,57 @@ void rbtree_init(ARBTree* tree) {
     assert( tree != NULL );
 
     tree->root = NULL;
+    tree->leftmost = NULL;
+    tree->rightmost = NULL;
+    tree->blackHeight = 0;
+    tree->finger = NULL;
+    tree->fingerSearch = false;
+
+    tree->valueSize = 0;
 
     tree->fIsLessOrder = NULL;
 
     tree->fTryFitRight = NULL;
     tree->fTryFitLeft = NULL;
 
+    tree->fUpdateNode = NULL;
+
     tree->fPrintValue = NULL;
     tree->fDeleteValue = NULL;
+
+    tree->allocator = NULL;
+    tree->fAllocNode = NULL;
+    tree->fFreeNode = NULL;
+    tree->fReleaseAllocator = NULL;
+}
+
+void rbtree_initInline(ARBTree* tree, const size_t valueSize) {
+    rbtree_init(tree);
+    tree->valueSize = valueSize;
+}
+
+void rbtree_useFinger(ARBTree* tree) {
+    assert( tree != NULL );
+    tree->fingerSearch = true;
+}
+
+void rbtree_usePool(ARBTree* tree) {
+    assert( tree != NULL );
+    assert( tree->root == NULL );
+    if (tree->fReleaseAllocator != NULL) {
+        tree->fReleaseAllocator(tree->allocator);
+    }
+    tree->allocator = pool_create( sizeof(ARBTreeNode) + tree->valueSize );
+    if (tree->allocator == NULL) {
+        /// nodes stay allocated by calloc
+        tree->fAllocNode = NULL;
+        tree->fFreeNode = NULL;
+        tree->fReleaseAllocator = NULL;
+        return ;
+    }
+    tree->fAllocNode = pool_allocNode;
+    tree->fFreeNode = pool_freeNode;
+    tree->fReleaseAllocator = pool_destroy;
 }
 
 static const ARBTreeNode* rbtree_getLeftmostNode(const ARBTreeNode* node) {
@@ -93,13 +139,11 @@ static const ARBTreeNode* rbtree_getLeftDescendant(const ARBTreeNode* node) {
 /// ===================================================
 
 
-static size_t rbtree_sizeSubtree(const ARBTreeNode* node) {
+static inline size_t rbtree_sizeSubtree(const ARBTreeNode* node) {
     if (node==NULL) {
         return 0;
     }
-    const size_t leftSize = rbtree_sizeSubtree(node->left);
-    const size_t rightSize = rbtree_sizeSubtree(node->right);
-    return leftSize + rightSize + 1;
+    return node->size;
 }
 
 size_t rbtree_size(const ARBTree* tree) {
@@ -125,37 +169,46 @@ size_t rbtree_depth(const ARBTree* tree) {
     return rbtree_depthSubtree(tree->root);
 }
 
-static const ARBTreeNode* rbtree_leftNode(const ARBTreeNode* node) {
-    const ARBTreeNode* desc = rbtree_getLeftDescendant(node);
-    if (desc != NULL) {
-        return desc;
-    }
-    return rbtree_getLeftAncestor(node);
+size_t rbtree_blackHeight(const ARBTree* tree) {
+    assert( tree != NULL );
+    return tree->blackHeight;
 }
 
-static const ARBTreeNode* rbtree_rightNode(const ARBTreeNode* node) {
-    const ARBTreeNode* desc = rbtree_getRightDescendant(node);
-    if (desc != NULL) {
-        return desc;
+ARBTreeValue rbtree_firstValue(const ARBTree* tree) {
+    assert( tree != NULL );
+    if (tree->leftmost == NULL) {
+        return NULL;
     }
-    return rbtree_getRightAncestor(node);
+    return tree->leftmost->value;
 }
 
-static const ARBTreeNode* rbtree_nodeByIndex(const ARBTreeNode* node, const size_t index) {
-    if (node==NULL) {
+ARBTreeValue rbtree_lastValue(const ARBTree* tree) {
+    assert( tree != NULL );
+    if (tree->rightmost == NULL) {
         return NULL;
     }
-    const size_t currIndex = rbtree_nodeIndex(node);
-    if (index < currIndex) {
-        const ARBTreeNode* left = rbtree_leftNode(node);
-        return rbtree_nodeByIndex(left, index);
-    }
-    if (index > currIndex) {
-        const ARBTreeNode* right = rbtree_rightNode(node);
-        return rbtree_nodeByIndex(right, index);
+    return tree->rightmost->value;
+}
+
+static const ARBTreeNode* rbtree_nodeByIndex(const ARBTreeNode* node, const size_t index) {
+    const ARBTreeNode* curr = node;
+    size_t currIndex = index;
+    while (curr != NULL) {
+        const size_t leftSize = rbtree_sizeSubtree(curr->left);
+        if (currIndex < leftSize) {
+            curr = curr->left;
+            continue ;
+        }
+        if (currIndex > leftSize) {
+            currIndex -= leftSize + 1;
+            curr = curr->right;
+            continue ;
+        }
+        /// index equals
+        return curr;
     }
-    /// index equals
-    return node;
+    /// index out of range
+    return NULL;
 }
 
 ARBTreeValue rbtree_valueByIndex(const ARBTree* tree, const size_t index) {
@@ -177,7 +230,7 @@ static ARBTreeValidationError rbtree_isValid_checkConnections(const ARBTreeNode*
     if (node == NULL) {
         return ARBTREE_INVALID_OK;
     }
-    if (node->parent != parent) {
+    if (rbtree_parent(node) != parent) {
         return ARBTREE_INVALID_NODE_PARENT;
     }
     if ((node->left == node->right) && (node->right != NULL)) {
@@ -197,6 +250,20 @@ static ARBTreeValidationError rbtree_isValid_checkConnections(const ARBTreeNode*
     return ARBTREE_INVALID_OK;
 }
 
+static ARBTreeValidationError rbtree_isValid_checkSize(const ARBTreeNode* node) {
+    if (node == NULL) {
+        return ARBTREE_INVALID_OK;
+    }
+    if (node->size != rbtree_sizeSubtree(node->left) + rbtree_sizeSubtree(node->right) + 1) {
+        return ARBTREE_INVALID_AUGMENTED_DATA;
+    }
+    const ARBTreeValidationError validLeft = rbtree_isValid_checkSize(node->left);
+    if (validLeft != ARBTREE_INVALID_OK) {
+        return validLeft;
+    }
+    return rbtree_isValid_checkSize(node->right);
+}
+
 static ARBTreeValidationError rbtree_isValid_checkSorted(const ARBTree* tree, const ARBTreeNode* node) {
     if (node == NULL) {
         return ARBTREE_INVALID_OK;
@@ -260,7 +327,7 @@ static ARBTreeValidationError rbtree_isValid_countBlackPaths(const ARBTreeNode*
         return ARBTREE_INVALID_BLACK_PATH;
     }
 
-    if (node->color == ARBTREE_COLOR_BLACK) {
+    if (rbtree_color(node) == ARBTREE_COLOR_BLACK) {
         *counter = leftCounter+1;
     } else {
         *counter = leftCounter;
@@ -295,16 +362,16 @@ static ARBTreeValidationError rbtree_isValid_checkColor(const ARBTreeNode* node)
 		}
 	}
 
-    if (node->color != ARBTREE_COLOR_RED) {
+    if (rbtree_color(node) != ARBTREE_COLOR_RED) {
     	return ARBTREE_INVALID_OK;
     }
 	if (node->left != NULL) {
-		if (node->left->color != ARBTREE_COLOR_BLACK) {
+		if (rbtree_color(node->left) != ARBTREE_COLOR_BLACK) {
 			return ARBTREE_INVALID_BLACK_CHILDREN;
 		}
 	}
 	if (node->right != NULL) {
-		if (node->right->color != ARBTREE_COLOR_BLACK) {
+		if (rbtree_color(node->right) != ARBTREE_COLOR_BLACK) {
 			return ARBTREE_INVALID_BLACK_CHILDREN;
 		}
 	}
@@ -312,18 +379,53 @@ static ARBTreeValidationError rbtree_isValid_checkColor(const ARBTreeNode* node)
 	return ARBTREE_INVALID_OK;
 }
 
+/**
+ * Checks data cached in tree structure: bounds and black height.
+ */
+static ARBTreeValidationError rbtree_isValid_checkTreeData(const ARBTree* tree) {
+    if (tree->leftmost != rbtree_getLeftmostNode(tree->root)) {
+        return ARBTREE_INVALID_TREE_DATA;
+    }
+    if (tree->rightmost != rbtree_getRightmostNode(tree->root)) {
+        return ARBTREE_INVALID_TREE_DATA;
+    }
+    size_t height = 0;
+    const ARBTreeNode* curr = tree->root;
+    while (curr != NULL) {
+        if (rbtree_color(curr) == ARBTREE_COLOR_BLACK) {
+            ++height;
+        }
+        curr = curr->left;
+    }
+    if (tree->blackHeight != height) {
+        return ARBTREE_INVALID_TREE_DATA;
+    }
+    /// finger has to be node of the tree
+    if (tree->finger == NULL) {
+        return (tree->root == NULL) ? ARBTREE_INVALID_OK : ARBTREE_INVALID_TREE_DATA;
+    }
+    curr = tree->finger;
+    while (rbtree_parent(curr) != NULL) {
+        curr = rbtree_parent(curr);
+    }
+    if (curr != tree->root) {
+        return ARBTREE_INVALID_TREE_DATA;
+    }
+    return ARBTREE_INVALID_OK;
+}
+
 ARBTreeValidationError rbtree_isValid(const ARBTree* tree) {
     assert( tree != NULL );
 
     if (tree->root == NULL)
-        return ARBTREE_INVALID_OK;
-    if (tree->root->parent != NULL)
+        return rbtree_isValid_checkTreeData(tree);
+    if (rbtree_parent(tree->root) != NULL)
         return ARBTREE_INVALID_ROOT_PARENT;
 
     const ARBTreeNode* rootNode = tree->root;
 
     /// check pointers
-    const ARBTreeValidationError validPointers = rbtree_isValid_checkConnections(rootNode, rootNode->parent);
+    const ARBTreeValidationError validPointers = rbtree_isValid_checkConnections(rootNode, rbtree_parent(rootNode));
     if (validPointers != ARBTREE_INVALID_OK) {
         return validPointers;
     }
@@ -335,9 +437,15 @@ ARBTreeValidationError rbtree_isValid(const ARBTree* tree) {
         return validOrder;
     }
 
+    /// check subtrees sizes
+    const ARBTreeValidationError validSize = rbtree_isValid_checkSize(rootNode);
+    if (validSize != ARBTREE_INVALID_OK) {
+        return validSize;
+    }
+
     /// checking red-black properties
     /// root is black
-    if (rootNode->color != ARBTREE_COLOR_BLACK)
+    if (rbtree_color(rootNode) != ARBTREE_COLOR_BLACK)
         return ARBTREE_INVALID_RED_ROOT;
 
     /// if a node is red, then both its children are black
@@ -351,81 +459,179 @@ ARBTreeValidationError rbtree_isValid(const ARBTree* tree) {
         return validPath;
     }
 
-    return ARBTREE_INVALID_OK;
+    /// black paths are valid, so black height can be counted on any path
+    return rbtree_isValid_checkTreeData(tree);
 }
 
 
 /// ==================================================================================
 
 
-ARBTreeNode* rbtree_findNode(const ARBTree* tree, const ARBTreeValue value) {
-    assert( tree != NULL );
+/// adaptors of tree callbacks for generated loops
 
-    ARBTreeNode* curr = tree->root;
-    while (curr != NULL) {
-        if ( tree->fIsLessOrder(value, curr->value) == true ) {
-            /// value < curr->value
-            curr = curr->left;
-            continue ;
-        }
-        if ( tree->fIsLessOrder(curr->value, value) == true ) {
-            /// value > curr->value
-            curr = curr->right;
-            continue ;
-        }
+static inline bool rbtree_lessValue(const ARBTree* tree, const ARBTreeValue valueA, const ARBTreeValue valueB) {
+    return tree->fIsLessOrder(valueA, valueB);
+}
 
-        /// equal
-        return curr;
+static inline bool rbtree_fitLeftValue(const ARBTree* tree, const ARBTreeNode* node, ARBTreeValue value) {
+    if ( tree->fTryFitLeft == NULL ) {
+        return true;
     }
-    /// not found
-    return NULL;
+    return tree->fTryFitLeft(node, value);
+}
+
+static inline bool rbtree_fitRightValue(const ARBTree* tree, const ARBTreeNode* node, ARBTreeValue value) {
+    if ( tree->fTryFitRight == NULL ) {
+        return true;
+    }
+    return tree->fTryFitRight(node, value);
+}
+
+/**
+ * Search and insert loops are shared with trees generated by 'RBTREE_DEFINE'.
+ * Finger search takes O(log d), where d is distance between finger and value.
+ */
+RBTREE_DEFINE_LOOPS(rbtree_generic, rbtree_lessValue, rbtree_fitLeftValue, rbtree_fitRightValue)
+
+ARBTreeNode* rbtree_findNode(const ARBTree* tree, const ARBTreeValue value) {
+    assert( tree != NULL );
+    return rbtree_generic_findNode(tree, value);
 }
 
 static const ARBTreeNode* rbtree_findRootFromNode(const ARBTreeNode* node) {
     /// find the new root to return
     const ARBTreeNode* curr = node;
-    while (curr->parent != NULL)
-        curr = curr->parent;
+    while (rbtree_parent(curr) != NULL)
+        curr = rbtree_parent(curr);
     return curr;
 }
 
 static void rbtree_findRoot(ARBTree* tree) {
+    if (tree->root == NULL) {
+        /// last node removed
+        return ;
+    }
     /// find the new root to return
     tree->root = (ARBTreeNode*) rbtree_findRootFromNode(tree->root);
 }
 
 
+const ARBTreeNode* rbtree_nextNode(const ARBTreeNode* node) {
+    if (node->right != NULL) {
+        return rbtree_getRightDescendant(node);
+    }
+    return rbtree_getRightAncestor(node);
+}
+
+const ARBTreeNode* rbtree_prevNode(const ARBTreeNode* node) {
+    if (node->left != NULL) {
+        return rbtree_getLeftDescendant(node);
+    }
+    return rbtree_getLeftAncestor(node);
+}
+
+
+/// ==================================================================================
+
+
+bool rbtree_cursorFirst(const ARBTree* tree, ARBTreeCursor* cursor) {
+    assert( tree != NULL );
+    assert( cursor != NULL );
+    cursor->node = tree->leftmost;
+    return (cursor->node != NULL);
+}
+
+bool rbtree_cursorLast(const ARBTree* tree, ARBTreeCursor* cursor) {
+    assert( tree != NULL );
+    assert( cursor != NULL );
+    cursor->node = tree->rightmost;
+    return (cursor->node != NULL);
+}
+
+bool rbtree_cursorSeek(const ARBTree* tree, const ARBTreeValue value, ARBTreeCursor* cursor) {
+    assert( tree != NULL );
+    assert( cursor != NULL );
+    const ARBTreeNode* found = NULL;
+    const ARBTreeNode* curr = tree->root;
+    while (curr != NULL) {
+        if ( tree->fIsLessOrder(curr->value, value) == true ) {
+            curr = curr->right;
+        } else {
+            /// candidate -- look for smaller one
+            found = curr;
+            curr = curr->left;
+        }
+    }
+    cursor->node = found;
+    return (cursor->node != NULL);
+}
+
+bool rbtree_cursorNext(ARBTreeCursor* cursor) {
+    assert( cursor != NULL );
+    if (cursor->node == NULL) {
+        return false;
+    }
+    cursor->node = rbtree_nextNode(cursor->node);
+    return (cursor->node != NULL);
+}
+
+bool rbtree_cursorPrev(ARBTreeCursor* cursor) {
+    assert( cursor != NULL );
+    if (cursor->node == NULL) {
+        return false;
+    }
+    cursor->node = rbtree_prevNode(cursor->node);
+    return (cursor->node != NULL);
+}
+
+ARBTreeValue rbtree_cursorGet(const ARBTreeCursor* cursor) {
+    assert( cursor != NULL );
+    if (cursor->node == NULL) {
+        return NULL;
+    }
+    return cursor->node->value;
+}
+
+
 /// ==================================================================================
 
 
 static ARBTreeNode* rbtree_grandparent(ARBTreeNode* node) {
-	assert( node->parent != NULL );
-	return node->parent->parent;
+	assert( rbtree_parent(node) != NULL );
+	return rbtree_parent(rbtree_parent(node));
 }
 
 static ARBTreeNode* rbtree_sibling(ARBTreeNode* node) {
-	assert( node->parent != NULL );
-	if (node->parent->left == node)
-		return node->parent->right;
+	assert( rbtree_parent(node) != NULL );
+	if (rbtree_parent(node)->left == node)
+		return rbtree_parent(node)->right;
 	else
-		return node->parent->left;
+		return rbtree_parent(node)->left;
 }
 
 static inline ARBTreeNode* rbtree_uncle(ARBTreeNode* node) {
-	return rbtree_sibling(node->parent);
+	return rbtree_sibling(rbtree_parent(node));
+}
+
+static inline void rbtree_setParent(ARBTreeNode* node, const ARBTreeNode* parent) {
+    node->parentColor = (uintptr_t) parent | (node->parentColor & ARBTREE_COLOR_MASK);
+}
+
+static inline void rbtree_setColor(ARBTreeNode* node, const ARBTreeNodeColor color) {
+    node->parentColor = (node->parentColor & ~ARBTREE_COLOR_MASK) | (uintptr_t) color;
 }
 
 static inline void rbtree_setLeftChild(ARBTreeNode* node, ARBTreeNode* child) {
     node->left = child;
     if (child != NULL) {
-        child->parent = node;
+        rbtree_setParent(child, node);
     }
 }
 
 static inline void rbtree_setRightChild(ARBTreeNode* node, ARBTreeNode* child) {
     node->right = child;
     if (child != NULL) {
-        child->parent = node;
+        rbtree_setParent(child, node);
     }
 }
 
@@ -437,14 +643,37 @@ static inline void rbtree_changeChild(ARBTreeNode* node, ARBTreeNode* from, ARBT
     }
 }
 
-static void rbtree_rotate_left(ARBTreeNode* node) {
-    ARBTreeNode* parent = node->parent;
+/**
+ * Recalculates augmented data of node based on its children.
+ */
+static inline void rbtree_refreshNode(const ARBTree* tree, ARBTreeNode* node) {
+    node->size = rbtree_sizeSubtree(node->left) + rbtree_sizeSubtree(node->right) + 1;
+    if (tree->fUpdateNode != NULL) {
+        tree->fUpdateNode(node);
+    }
+}
+
+/**
+ * Recalculates augmented data of node and all its ancestors.
+ */
+static void rbtree_refreshPath(const ARBTree* tree, ARBTreeNode* node) {
+    ARBTreeNode* curr = node;
+    while (curr != NULL) {
+        rbtree_refreshNode(tree, curr);
+        curr = rbtree_parent(curr);
+    }
+}
+
+static void rbtree_rotate_left(const ARBTree* tree, ARBTreeNode* node) {
+    ARBTreeNode* parent = rbtree_parent(node);
     ARBTreeNode* nnew = node->right;
     assert(nnew != NULL);                   /// since the leaves of a red-black tree are empty, they cannot become internal nodes
     rbtree_setRightChild(node, nnew->left);
     rbtree_setLeftChild(nnew, node);
+    rbtree_refreshNode(tree, node);
+    rbtree_refreshNode(tree, nnew);
     if (parent == NULL) {
-        nnew->parent = NULL;
+        rbtree_setParent(nnew, NULL);
         return;
     }
     if (parent->left == node) {
@@ -454,14 +683,16 @@ static void rbtree_rotate_left(ARBTreeNode* node) {
     }
 }
 
-static void rbtree_rotate_right(ARBTreeNode* node) {
-    ARBTreeNode* parent = node->parent;
+static void rbtree_rotate_right(const ARBTree* tree, ARBTreeNode* node) {
+    ARBTreeNode* parent = rbtree_parent(node);
     ARBTreeNode* nnew = node->left;
     assert(nnew != NULL);                   /// since the leaves of a red-black tree are empty, they cannot become internal nodes
     rbtree_setLeftChild(node, nnew->right);
     rbtree_setRightChild(nnew, node);
+    rbtree_refreshNode(tree, node);
+    rbtree_refreshNode(tree, nnew);
     if (parent == NULL) {
-        nnew->parent = NULL;
+        rbtree_setParent(nnew, NULL);
         return;
     }
     if (parent->left == node) {
@@ -471,24 +702,28 @@ static void rbtree_rotate_right(ARBTreeNode* node) {
     }
 }
 
-static void rbtree_repair_insert(ARBTreeNode* node) {
-	ARBTreeNode* nParent = node->parent;
+static void rbtree_repair_insert(ARBTree* tree, ARBTreeNode* node) {
+	ARBTreeNode* nParent = rbtree_parent(node);
 	if ( nParent == NULL) {
-		node->color = ARBTREE_COLOR_BLACK;
+	    if (rbtree_color(node) == ARBTREE_COLOR_RED) {
+	        /// red root blackened -- every path gets one more black node
+	        ++(tree->blackHeight);
+	    }
+		rbtree_setColor(node, ARBTREE_COLOR_BLACK);
 		return ;
 	}
-	if (nParent->color == ARBTREE_COLOR_BLACK) {
+	if (rbtree_color(nParent) == ARBTREE_COLOR_BLACK) {
 		/// do nothing
 		return ;
 	}
 	ARBTreeNode* uncle = rbtree_uncle(node);
 	if (uncle != NULL) {
-        if (uncle->color == ARBTREE_COLOR_RED) {
-            nParent->color = ARBTREE_COLOR_BLACK;
-            uncle->color = ARBTREE_COLOR_BLACK;
+        if (rbtree_color(uncle) == ARBTREE_COLOR_RED) {
+            rbtree_setColor(nParent, ARBTREE_COLOR_BLACK);
+            rbtree_setColor(uncle, ARBTREE_COLOR_BLACK);
             ARBTreeNode* grandpa = rbtree_grandparent(node);		/// never NULL here
-            grandpa->color = ARBTREE_COLOR_RED;
-            rbtree_repair_insert(grandpa);
+            rbtree_setColor(grandpa, ARBTREE_COLOR_RED);
+            rbtree_repair_insert(tree, grandpa);
             return ;
         }
 	}
@@ -497,215 +732,364 @@ static void rbtree_repair_insert(ARBTreeNode* node) {
 	{
         ARBTreeNode* grandpa = rbtree_grandparent(curr);		/// never NULL here
         if ((grandpa->left != NULL) && (curr == grandpa->left->right)) {
-            rbtree_rotate_left(curr->parent);
+            rbtree_rotate_left(tree, rbtree_parent(curr));
             curr = curr->left;
         } else if ((grandpa->right != NULL) && (curr == grandpa->right->left)) {
-            rbtree_rotate_right(curr->parent);
+            rbtree_rotate_right(tree, rbtree_parent(curr));
             curr = curr->right;
         }
 	}
 	{
 	    ARBTreeNode* grandpa = rbtree_grandparent(curr);       /// never NULL here
-        if (curr == curr->parent->left)
-            rbtree_rotate_right(grandpa);
+        if (curr == rbtree_parent(curr)->left)
+            rbtree_rotate_right(tree, grandpa);
         else
-            rbtree_rotate_left(grandpa);
-        curr->parent->color = ARBTREE_COLOR_BLACK;
-        grandpa->color = ARBTREE_COLOR_RED;
+            rbtree_rotate_left(tree, grandpa);
+        rbtree_setColor(rbtree_parent(curr), ARBTREE_COLOR_BLACK);
+        rbtree_setColor(grandpa, ARBTREE_COLOR_RED);
 	}
 }
 
-static ARBTreeNode* rbtree_insertLeftNode(ARBTreeNode* node) {
+static void rbtree_freeNodeMemory(ARBTree* tree, ARBTreeNode* node) {
+    if (tree->fFreeNode != NULL) {
+        tree->fFreeNode(tree->allocator, node);
+    } else {
+        free(node);
+    }
+}
+
+/**
+ * Frees nodes of subtree not linked into tree yet. Values are not deleted.
+ */
+static void rbtree_freeSubtreeMemory(ARBTree* tree, ARBTreeNode* node) {
+    if (node == NULL) {
+        return ;
+    }
+    rbtree_freeSubtreeMemory(tree, node->left);
+    rbtree_freeSubtreeMemory(tree, node->right);
+    rbtree_freeNodeMemory(tree, node);
+}
+
+/**
+ * Creates node holding given value. In case of inline values memory for value
+ * is allocated together with node and value is copied.
+ * Returns NULL if node could not be allocated.
+ */
+static ARBTreeNode* rbtree_makeValueNode(const ARBTree* tree, const ARBTreeNodeColor color, const ARBTreeValue value) {
+    const size_t nodeSize = sizeof(ARBTreeNode) + tree->valueSize;
+    ARBTreeNode* node = NULL;
+    if (tree->fAllocNode != NULL) {
+        node = tree->fAllocNode(tree->allocator, nodeSize);
+    } else {
+        node = calloc( 1, nodeSize );
+    }
+    if (node == NULL) {
+        return NULL;
+    }
+    rbtree_setColor(node, color);
+    if (tree->valueSize == 0) {
+        node->value = value;
+        return node;
+    }
+    node->value = (char*)node + sizeof(ARBTreeNode);
+    memcpy(node->value, value, tree->valueSize);
+    return node;
+}
+
+/**
+ * Updates cached bounds of tree after insertion of leaf 'node'.
+ * New leaf is leftmost only if it is left child of previous leftmost node
+ * (similar for rightmost), so no value comparison is needed.
+ */
+static void rbtree_updateBounds(ARBTree* tree, ARBTreeNode* node) {
+    if ( tree->leftmost->left == node ) {
+        tree->leftmost = node;
+    }
+    if ( tree->rightmost->right == node ) {
+        tree->rightmost = node;
+    }
+}
+
+static void rbtree_insertLeftNode(ARBTree* tree, ARBTreeNode* node, ARBTreeNode* newNode) {
     assert( node->left == NULL );
-	ARBTreeNode* newNode = rbtree_makeColoredNode(ARBTREE_COLOR_RED);         /// default color of new node
 	rbtree_setLeftChild(node, newNode);
-	rbtree_repair_insert(newNode);
-	return newNode;
+	rbtree_updateBounds(tree, newNode);
+	rbtree_refreshPath(tree, newNode);
+	rbtree_repair_insert(tree, newNode);
+	tree->finger = newNode;
 }
 
-static ARBTreeNode* rbtree_insertRightNode(ARBTreeNode* node) {
+static void rbtree_insertRightNode(ARBTree* tree, ARBTreeNode* node, ARBTreeNode* newNode) {
     assert( node->right == NULL );
-	ARBTreeNode* newNode = rbtree_makeColoredNode(ARBTREE_COLOR_RED);         /// default color of new node
 	rbtree_setRightChild(node, newNode);
-	rbtree_repair_insert(node->right);
-	return newNode;
+	rbtree_updateBounds(tree, newNode);
+	rbtree_refreshPath(tree, newNode);
+	rbtree_repair_insert(tree, node->right);
+	tree->finger = newNode;
+}
+
+/**
+ * Links new node as leaf child of 'parent' (root of empty tree if 'parent' is NULL)
+ * and repairs colors.
+ */
+static void rbtree_linkLeaf(ARBTree* tree, ARBTreeNode* parent, const bool left, ARBTreeNode* newNode) {
+    if (parent == NULL) {
+        assert( tree->root == NULL );
+        tree->root = newNode;
+        rbtree_setColor(newNode, ARBTREE_COLOR_BLACK);
+        rbtree_refreshNode(tree, tree->root);
+        rbtree_repair_insert(tree, tree->root);
+        tree->leftmost = tree->root;
+        tree->rightmost = tree->root;
+        tree->blackHeight = 1;
+        tree->finger = tree->root;
+        return ;
+    }
+
+    if (left == true) {
+        rbtree_insertLeftNode(tree, parent, newNode);
+    } else {
+        rbtree_insertRightNode(tree, parent, newNode);
+    }
+    rbtree_findRoot(tree);
 }
 
 
 /// ======================================================================================
 
 
+ARBTreeNode* rbtree_insertLeaf(ARBTree* tree, ARBTreeNode* parent, const bool left, const ARBTreeValue value) {
+    assert( tree != NULL );
+
+    ARBTreeNode* newNode = rbtree_makeValueNode(tree, ARBTREE_COLOR_RED, value);         /// default color of new node
+    if (newNode == NULL) {
+        return NULL;
+    }
+    rbtree_linkLeaf(tree, parent, left, newNode);
+    return newNode;
+}
+
+bool rbtree_add(ARBTree* tree, const ARBTreeValue value) {
+    assert( tree != NULL );
+    return (rbtree_generic_addValue(tree, value) != NULL);
+}
+
 /**
- * Adding to left side: value should be smaller than 'node->value'.
- * We assume 'node->left' is NULL.
- * Returns:
- *       false - if cannot fit: bad order or cannot fit
- *       true  - if added
+ * Builds perfectly balanced subtree of sorted values (middle value in root).
+ * Nodes on depth 'redDepth' are red, other nodes are black. Pointer to node
+ * of i-th value is stored in 'nodes[i]' if 'nodes' is not NULL.
+ * Returns NULL if allocation failed (nodes of subtree are freed then).
  */
-static bool rbtree_addToLeft(const ARBTree* tree, ARBTreeNode* node, ARBTreeValue value) {
-    assert( node->left == NULL );
+static ARBTreeNode* rbtree_buildSubtree(ARBTree* tree, const ARBTreeValue* values, const size_t size,
+                                        const size_t depth, const size_t redDepth, ARBTreeNode** nodes) {
+    if (size == 0) {
+        return NULL;
+    }
+    const size_t mid = size / 2;
+    const ARBTreeNodeColor color = (depth == redDepth) ? ARBTREE_COLOR_RED : ARBTREE_COLOR_BLACK;
+    ARBTreeNode* node = rbtree_makeValueNode(tree, color, values[mid]);
+    if (node == NULL) {
+        return NULL;
+    }
+    if (nodes != NULL) {
+        nodes[mid] = node;
+    }
+    ARBTreeNode* leftChild = rbtree_buildSubtree(tree, values, mid, depth + 1, redDepth, nodes);
+    ARBTreeNode* rightChild = NULL;
+    if (leftChild != NULL || mid == 0) {
+        rightChild = rbtree_buildSubtree(tree, values + mid + 1, size - mid - 1, depth + 1, redDepth,
+                                         (nodes != NULL) ? nodes + mid + 1 : NULL);
+    }
+    if ((leftChild == NULL && mid > 0) || (rightChild == NULL && size - mid - 1 > 0)) {
+        /// allocation failed
+        rbtree_freeSubtreeMemory(tree, leftChild);
+        rbtree_freeNodeMemory(tree, node);
+        return NULL;
+    }
+    rbtree_setLeftChild(node, leftChild);
+    rbtree_setRightChild(node, rightChild);
+    rbtree_refreshNode(tree, node);
+    return node;
+}
 
-    /// leaf case -- can add
-    if ( tree->fTryFitLeft != NULL ) {
-        if ( tree->fTryFitLeft(node, value) == false ) {
-            return false;       /// go to right
-        }
+/**
+ * Returns depth of lowest level of perfectly balanced tree of 'size' nodes.
+ */
+static inline size_t rbtree_balancedHeight(const size_t size) {
+    size_t height = 0;
+    while ( (size >> (height + 1)) > 0 ) {
+        ++height;
     }
-    ARBTreeNode* newNode = rbtree_insertLeftNode(node);
-    newNode->value = value;
-    return true;
+    return height;
+}
+
+/**
+ * Links sorted nodes into perfectly balanced subtree (middle node in root).
+ * Nodes on depth 'redDepth' are red, other nodes are black.
+ */
+static ARBTreeNode* rbtree_linkSubtree(const ARBTree* tree, ARBTreeNode** nodes, const size_t size,
+                                       const size_t depth, const size_t redDepth) {
+    if (size == 0) {
+        return NULL;
+    }
+    const size_t mid = size / 2;
+    ARBTreeNode* node = nodes[mid];
+    rbtree_setColor(node, (depth == redDepth) ? ARBTREE_COLOR_RED : ARBTREE_COLOR_BLACK);
+    rbtree_setLeftChild(node, rbtree_linkSubtree(tree, nodes, mid, depth + 1, redDepth));
+    rbtree_setRightChild(node, rbtree_linkSubtree(tree, nodes + mid + 1, size - mid - 1, depth + 1, redDepth));
+    rbtree_refreshNode(tree, node);
+    return node;
+}
+
+/**
+ * Sets root of tree and recalculates cached data.
+ */
+static void rbtree_setRoot(ARBTree* tree, ARBTreeNode* root, const size_t blackHeight) {
+    tree->root = root;
+    tree->leftmost = (ARBTreeNode*) rbtree_getLeftmostNode(root);
+    tree->rightmost = (ARBTreeNode*) rbtree_getRightmostNode(root);
+    tree->blackHeight = blackHeight;
+    tree->finger = root;
 }
 
 /**
- * Adding to right side: value should be greater than 'node->value'
- * Returns:
- *       false - if cannot add because of sub-node or cannot fir
- *       true - if added
+ * Builds tree of sorted values in place of empty tree.
+ * Returns false if allocation failed (tree stays empty).
  */
-static bool rbtree_addToRight(const ARBTree* tree, ARBTreeNode* node, ARBTreeValue value) {
-    if ( node->right != NULL ) {
-        /// leaf exists -- go to right
+static bool rbtree_build(ARBTree* tree, const ARBTreeValue* values, const size_t size, ARBTreeNode** nodes) {
+    assert( tree->root == NULL );
+    assert( size > 0 );
+    /// null links are placed on depth 'height' or below, so only nodes of lowest level can be red
+    const size_t height = rbtree_balancedHeight(size);
+    const size_t redDepth = (height > 0) ? height : (size_t)-1;
+    tree->root = rbtree_buildSubtree(tree, values, size, 0, redDepth, nodes);
+    if (tree->root == NULL) {
         return false;
     }
+    tree->leftmost = (ARBTreeNode*) rbtree_getLeftmostNode(tree->root);
+    tree->rightmost = (ARBTreeNode*) rbtree_getRightmostNode(tree->root);
+    tree->blackHeight = (height > 0) ? height : 1;
+    tree->finger = tree->root;
+    return true;
+}
 
-//    assert( node->right == NULL );
+bool rbtree_buildFromSorted(ARBTree* tree, const ARBTreeValue* values, const size_t size) {
+    assert( tree != NULL );
+    if (tree->root != NULL) {
+        return false;
+    }
+    if (values == NULL || size == 0) {
+        return true;
+    }
+    return rbtree_build(tree, values, size, NULL);
+}
 
-    /// leaf case -- can add
-    if ( tree->fTryFitRight != NULL ) {
-        if ( tree->fTryFitRight(node, value) == false ) {
-            return false;
+/**
+ * Merges sorted new nodes with nodes of tree and links all nodes into perfectly
+ * balanced tree in O(n + k). Existing nodes are reused, so pointers to them
+ * stay valid. Returns false if memory allocation failed (tree is not changed).
+ */
+static bool rbtree_mergeSorted(ARBTree* tree, ARBTreeNode** nodes, const size_t size) {
+    const size_t total = rbtree_size(tree) + size;
+    ARBTreeNode** all = malloc( total * sizeof(ARBTreeNode*) );
+    if (all == NULL) {
+        return false;
+    }
+    ARBTreeNode* next = tree->leftmost;
+    size_t count = 0;
+    for(size_t i = 0; i < size; ++i) {
+        while (next != NULL && tree->fIsLessOrder(nodes[i]->value, next->value) == false) {
+            all[count++] = next;
+            next = (ARBTreeNode*) rbtree_nextNode(next);
         }
+        all[count++] = nodes[i];
     }
-    ARBTreeNode* newNode = rbtree_insertRightNode(node);
-    newNode->value = value;
+    while (next != NULL) {
+        all[count++] = next;
+        next = (ARBTreeNode*) rbtree_nextNode(next);
+    }
+    assert( count == total );
+
+    const size_t height = rbtree_balancedHeight(total);
+    const size_t redDepth = (height > 0) ? height : (size_t)-1;
+    ARBTreeNode* root = rbtree_linkSubtree(tree, all, total, 0, redDepth);
+    rbtree_setParent(root, NULL);
+    rbtree_setRoot(tree, root, (height > 0) ? height : 1);
+    free(all);
     return true;
 }
 
 /**
- * If no smaller node exists, then returns greater node.
+ * Inserts new node as leaf found by descent from root and repairs colors.
  */
-static ARBTreeNode* rbtree_findSmallerNode(const ARBTree* tree, ARBTreeNode* currNode, ARBTreeValue value) {
-    ARBTreeNode* tmpNode = currNode;
-    ARBTreeNode* bestNode = tmpNode;
-    bool valid = false;
-    while(tmpNode!=NULL) {
-        if ( tree->fIsLessOrder(tmpNode->value, value)) {
-            /// in order
-            bestNode = tmpNode;
-            valid = true;
-            if (tmpNode->right == NULL) {
+static void rbtree_insertSorted(ARBTree* tree, ARBTreeNode* newNode) {
+    const ARBTreeValue value = newNode->value;
+    ARBTreeNode* node = tree->root;
+    while (true) {
+        if ( tree->fIsLessOrder(value, node->value) ) {
+            if (node->left == NULL) {
                 break;
             }
-            /// check for more accurate results
-            tmpNode = tmpNode->right;
+            node = node->left;
         } else {
-            /// 'value' is equal or less than node -- check right subtree
-            if (valid == false) {
-                bestNode = tmpNode;
-            }
-            if (tmpNode->left == NULL) {
-                /// no 'smaller' node exists
+            if (node->right == NULL) {
                 break;
             }
-            tmpNode = tmpNode->left;
+            node = node->right;
         }
     }
-    return bestNode;
+    rbtree_linkLeaf(tree, node, tree->fIsLessOrder(value, node->value), newNode);
 }
 
-static bool rbtree_addToNode(const ARBTree* tree, ARBTreeNode* currNode, ARBTreeValue value) {
-    ARBTreeNode* tmpNode = rbtree_findSmallerNode(tree, currNode, value);       /// never NULL
-    if ( tmpNode->left == NULL ) {
-        if ( tree->fIsLessOrder(value, tmpNode->value) ) {
-            const bool leftAdded = rbtree_addToLeft(tree, tmpNode, value);
-            if (leftAdded) {
-                return true;
-            }
-        }
-    }
-    const bool rightAdded = rbtree_addToRight(tree, tmpNode, value);
-    if (rightAdded) {
+bool rbtree_addSorted(ARBTree* tree, const ARBTreeValue* values, const size_t size, ARBTreeNode** nodes) {
+    assert( tree != NULL );
+    if (values == NULL || size == 0) {
         return true;
     }
-
-    while(tmpNode!=NULL) {
-
-        /**
-         * Consider three cases:
-         *      1. right descendant of current node -- not having left node
-         *      2. right descendant of ancestor -- not having left node
-         *      3. ancestor if does not have right node -- not having right node
-         */
-
-        const ARBTreeNode* below = rbtree_getRightDescendant(tmpNode);        /// NULL when no right node
-        if (below!=NULL) {
-            /// left node is NULL -- check both
-            tmpNode = (ARBTreeNode*)below;
-
-            const bool leftAdded = rbtree_addToLeft(tree, tmpNode, value);
-            if (leftAdded) {
-                return true;
-            }
-
-            const bool rightAdded = rbtree_addToRight(tree, tmpNode, value);
-            if (rightAdded) {
-                return true;
-            }
-
-            continue;
+    if (tree->root == NULL) {
+        return rbtree_build(tree, values, size, nodes);
+    }
+    ARBTreeNode** added = nodes;
+    if (added == NULL) {
+        added = malloc( size * sizeof(ARBTreeNode*) );
+        if (added == NULL) {
+            return false;
         }
-
-        const ARBTreeNode* ancestor = rbtree_getRightAncestor(tmpNode);        /// NULL when no parent
-        assert(ancestor);                                                      /// should always be valid
-
-        const ARBTreeNode* right = rbtree_getRightDescendant(ancestor);     /// NULL when no right node
-        if (right!=NULL) {
-            /// left node is NULL -- check both
-            tmpNode = (ARBTreeNode*)right;
-
-            const bool leftAdded = rbtree_addToLeft(tree, tmpNode, value);
-            if (leftAdded) {
-                return true;
-            }
-
-            const bool rightAdded = rbtree_addToRight(tree, tmpNode, value);
-            if (rightAdded) {
-                return true;
+    }
+    /// all nodes are allocated before tree is changed
+    for(size_t i = 0; i < size; ++i) {
+        added[i] = rbtree_makeValueNode(tree, ARBTREE_COLOR_RED, values[i]);
+        if (added[i] == NULL) {
+            for(size_t j = 0; j < i; ++j) {
+                rbtree_freeNodeMemory(tree, added[j]);
             }
-        } else {
-            /// left node is NOT NULL -- check only right
-            tmpNode = (ARBTreeNode*)ancestor;
-
-            const bool rightAdded = rbtree_addToRight(tree, tmpNode, value);
-            if (rightAdded) {
-                return true;
+            if (nodes == NULL) {
+                free(added);
             }
+            return false;
         }
     }
 
-    return false;
-}
-
-bool rbtree_add(ARBTree* tree, const ARBTreeValue value) {
-    assert( tree != NULL );
-
-    if (tree->root == NULL) {
-        tree->root = rbtree_makeDefaultNode();
-        ///tree->root->parent = NULL;
-        ///tree->root->color = RBTREE_BLACK;
-        tree->root->value = value;
-        rbtree_repair_insert(tree->root);
-        return true;
+    /// large batch -- single rebalance of whole tree is cheaper than k insertions
+    const size_t treeSize = rbtree_size(tree);
+    const size_t height = rbtree_balancedHeight(treeSize) + 1;
+    bool merged = false;
+    if (size * height >= treeSize + size) {
+        merged = rbtree_mergeSorted(tree, added, size);
     }
+    if (merged == false) {
+        for(size_t i = 0; i < size; ++i) {
+            rbtree_insertSorted(tree, added[i]);
+        }
+    }
+    tree->finger = added[size - 1];
 
-    if (rbtree_addToNode(tree, tree->root, value) == false) {
-        return false;
+    if (nodes == NULL) {
+        free(added);
     }
-    rbtree_findRoot(tree);
     return true;
 }
 
-
 /// ==============================================================================================
 
 
@@ -730,7 +1114,7 @@ static void rbtree_printLevel(const ARBTree* tree, const ARBTreeNode* node, cons
     }
 
     char color = 'X';
-    switch(node->color) {
+    switch(rbtree_color(node)) {
     case ARBTREE_COLOR_BLACK: {
         color = 'B';
         break;
@@ -771,8 +1155,10 @@ void rbtree_print(const ARBTree* tree) {
 
 
 static void rbtree_releaseNode(ARBTree* tree, ARBTreeNode* node) {
-    tree->fDeleteValue(node->value);
-    free(node);
+    if (tree->fDeleteValue != NULL) {
+        tree->fDeleteValue(node->value);
+    }
+    rbtree_freeNodeMemory(tree, node);
 }
 
 static int rbtree_releaseSubtree(ARBTree* tree, ARBTreeNode* node) {
@@ -791,14 +1177,44 @@ static int rbtree_releaseSubtree(ARBTree* tree, ARBTreeNode* node) {
     return leftReleased+rightReleased+1;
 }
 
+static void rbtree_deleteSubtreeValues(ARBTree* tree, ARBTreeNode* node) {
+    if (node == NULL) {
+        return ;
+    }
+    rbtree_deleteSubtreeValues(tree, node->left);
+    rbtree_deleteSubtreeValues(tree, node->right);
+    tree->fDeleteValue(node->value);
+}
+
 bool rbtree_release(ARBTree* tree) {
     assert( tree != NULL );
+    if (tree->fReleaseAllocator != NULL) {
+        /// nodes are released together with allocator
+        if (tree->fDeleteValue != NULL) {
+            rbtree_deleteSubtreeValues(tree, tree->root);
+        }
+        tree->fReleaseAllocator(tree->allocator);
+        tree->allocator = NULL;
+        tree->fAllocNode = NULL;
+        tree->fFreeNode = NULL;
+        tree->fReleaseAllocator = NULL;
+        tree->root = NULL;
+        tree->leftmost = NULL;
+        tree->rightmost = NULL;
+        tree->blackHeight = 0;
+        tree->finger = NULL;
+        return true;
+    }
     if (tree->root==NULL) {
         /// empty is valid, so releasing is successful
         return true;
     }
     rbtree_releaseSubtree(tree, tree->root);
     tree->root = NULL;
+    tree->leftmost = NULL;
+    tree->rightmost = NULL;
+    tree->blackHeight = 0;
+    tree->finger = NULL;
     return true;
 }
 
@@ -818,7 +1234,7 @@ static ARBTreeNode* rbtree_repair_sibling(ARBTreeNode* parent, ARBTreeNode* node
 
 static int rbtree_repair_isChildrenColors(const ARBTreeNode* parent, const ARBTreeNodeColor leftChild, const ARBTreeNodeColor rightChild) {
     if ( parent->left != NULL ) {
-        if ( parent->left->color != leftChild ) {
+        if ( rbtree_color(parent->left) != leftChild ) {
             return 1;
         }
     } else {
@@ -827,7 +1243,7 @@ static int rbtree_repair_isChildrenColors(const ARBTreeNode* parent, const ARBTr
         }
     }
     if ( parent->right != NULL ) {
-        if ( parent->right->color != rightChild ) {
+        if ( rbtree_color(parent->right) != rightChild ) {
             return 1;
         }
     } else {
@@ -838,28 +1254,28 @@ static int rbtree_repair_isChildrenColors(const ARBTreeNode* parent, const ARBTr
     return 0;
 }
 
-static void rbtree_repair_case1(ARBTreeNode* parent, ARBTreeNode* node);
+static void rbtree_repair_case1(ARBTree* tree, ARBTreeNode* parent, ARBTreeNode* node);
 
-static void rbtree_repair_case6(ARBTreeNode* parent, ARBTreeNode* node) {
+static void rbtree_repair_case6(ARBTree* tree, ARBTreeNode* parent, ARBTreeNode* node) {
     ARBTreeNode* sibling = rbtree_repair_sibling(parent, node);
-    sibling->color = parent->color;
-    parent->color = ARBTREE_COLOR_BLACK;
+    rbtree_setColor(sibling, rbtree_color(parent));
+    rbtree_setColor(parent, ARBTREE_COLOR_BLACK);
 
     if (parent->left == node) {
         if (sibling->right!=NULL)
-            sibling->right->color = ARBTREE_COLOR_BLACK;
-        rbtree_rotate_left( parent );
+            rbtree_setColor(sibling->right, ARBTREE_COLOR_BLACK);
+        rbtree_rotate_left(tree, parent);
     } else {
         if (sibling->left!=NULL)
-            sibling->left->color = ARBTREE_COLOR_BLACK;
-        rbtree_rotate_right( parent );
+            rbtree_setColor(sibling->left, ARBTREE_COLOR_BLACK);
+        rbtree_rotate_right(tree, parent);
     }
 }
 
-static void rbtree_repair_case5(ARBTreeNode* parent, ARBTreeNode* node) {
+static void rbtree_repair_case5(ARBTree* tree, ARBTreeNode* parent, ARBTreeNode* node) {
     ARBTreeNode* sibling = rbtree_repair_sibling(parent, node);
-    if (sibling->color != ARBTREE_COLOR_BLACK) {
-        rbtree_repair_case6(parent, node);
+    if (rbtree_color(sibling) != ARBTREE_COLOR_BLACK) {
+        rbtree_repair_case6(tree, parent, node);
         return ;
     }
 //    if (node == NULL) {
@@ -870,155 +1286,159 @@ static void rbtree_repair_case5(ARBTreeNode* parent, ARBTreeNode* node) {
     if (parent->left == node) {
         /// is left child
         if (rbtree_repair_isChildrenColors(sibling, ARBTREE_COLOR_RED, ARBTREE_COLOR_BLACK) == 0) {
-            sibling->color = ARBTREE_COLOR_RED;
+            rbtree_setColor(sibling, ARBTREE_COLOR_RED);
             if (sibling->left != NULL)
-                sibling->left->color = ARBTREE_COLOR_BLACK;
-            rbtree_rotate_right( sibling );
-            rbtree_repair_case6(parent, node);
+                rbtree_setColor(sibling->left, ARBTREE_COLOR_BLACK);
+            rbtree_rotate_right(tree, sibling);
+            rbtree_repair_case6(tree, parent, node);
             return ;
         }
-        rbtree_repair_case6(parent, node);
+        rbtree_repair_case6(tree, parent, node);
         return ;
     }
 
     if (parent->right == node) {
         /// is right child
         if (rbtree_repair_isChildrenColors(sibling, ARBTREE_COLOR_BLACK, ARBTREE_COLOR_RED) == 0) {
-            sibling->color = ARBTREE_COLOR_RED;
+            rbtree_setColor(sibling, ARBTREE_COLOR_RED);
             if (sibling->right != NULL)
-                sibling->right->color = ARBTREE_COLOR_BLACK;
-            rbtree_rotate_left( sibling );
-            rbtree_repair_case6(parent, node);
+                rbtree_setColor(sibling->right, ARBTREE_COLOR_BLACK);
+            rbtree_rotate_left(tree, sibling);
+            rbtree_repair_case6(tree, parent, node);
             return ;
         }
-        rbtree_repair_case6(parent, node);
+        rbtree_repair_case6(tree, parent, node);
         return ;
     }
 }
 
-static void rbtree_repair_case4(ARBTreeNode* parent, ARBTreeNode* node) {
-    if (parent->color != ARBTREE_COLOR_RED) {
-        rbtree_repair_case5(parent, node);
+static void rbtree_repair_case4(ARBTree* tree, ARBTreeNode* parent, ARBTreeNode* node) {
+    if (rbtree_color(parent) != ARBTREE_COLOR_RED) {
+        rbtree_repair_case5(tree, parent, node);
         return ;
     }
     ARBTreeNode* sibling = rbtree_repair_sibling(parent, node);
-    if (sibling->color != ARBTREE_COLOR_BLACK) {
-        rbtree_repair_case5(parent, node);
+    if (rbtree_color(sibling) != ARBTREE_COLOR_BLACK) {
+        rbtree_repair_case5(tree, parent, node);
         return ;
     }
     if (rbtree_repair_isChildrenColors(sibling, ARBTREE_COLOR_BLACK, ARBTREE_COLOR_BLACK) != 0) {
-        rbtree_repair_case5(parent, node);
+        rbtree_repair_case5(tree, parent, node);
         return ;
     }
-    sibling->color = ARBTREE_COLOR_RED;
-    parent->color = ARBTREE_COLOR_BLACK;
+    rbtree_setColor(sibling, ARBTREE_COLOR_RED);
+    rbtree_setColor(parent, ARBTREE_COLOR_BLACK);
 }
 
-static void rbtree_repair_case3(ARBTreeNode* parent, ARBTreeNode* node) {
-    if (parent->color != ARBTREE_COLOR_BLACK) {
-        rbtree_repair_case4(parent, node);
+static void rbtree_repair_case3(ARBTree* tree, ARBTreeNode* parent, ARBTreeNode* node) {
+    if (rbtree_color(parent) != ARBTREE_COLOR_BLACK) {
+        rbtree_repair_case4(tree, parent, node);
         return ;
     }
     ARBTreeNode* sibling = rbtree_repair_sibling(parent, node);
-    if (sibling->color != ARBTREE_COLOR_BLACK) {
-        rbtree_repair_case4(parent, node);
+    if (rbtree_color(sibling) != ARBTREE_COLOR_BLACK) {
+        rbtree_repair_case4(tree, parent, node);
         return ;
     }
 
     if (rbtree_repair_isChildrenColors(sibling, ARBTREE_COLOR_BLACK, ARBTREE_COLOR_BLACK) != 0) {
-        rbtree_repair_case4(parent, node);
+        rbtree_repair_case4(tree, parent, node);
         return ;
     }
 
-    sibling->color = ARBTREE_COLOR_RED;
-    rbtree_repair_case1(parent->parent, parent);
+    rbtree_setColor(sibling, ARBTREE_COLOR_RED);
+    rbtree_repair_case1(tree, rbtree_parent(parent), parent);
 }
 
-static void rbtree_repair_case2(ARBTreeNode* parent, ARBTreeNode* node) {
+static void rbtree_repair_case2(ARBTree* tree, ARBTreeNode* parent, ARBTreeNode* node) {
     ARBTreeNode* sibling = rbtree_repair_sibling(parent, node);
     if (sibling == NULL) {
         /// case of root
         return ;
     }
-    if (sibling->color == ARBTREE_COLOR_RED) {
-        parent->color = ARBTREE_COLOR_RED;
-        sibling->color = ARBTREE_COLOR_BLACK;
+    if (rbtree_color(sibling) == ARBTREE_COLOR_RED) {
+        rbtree_setColor(parent, ARBTREE_COLOR_RED);
+        rbtree_setColor(sibling, ARBTREE_COLOR_BLACK);
         if (parent->left == node)
-            rbtree_rotate_left( parent );
+            rbtree_rotate_left(tree, parent);
         else
-            rbtree_rotate_right( parent );
+            rbtree_rotate_right(tree, parent);
     }
-    rbtree_repair_case3(parent, node);
+    rbtree_repair_case3(tree, parent, node);
 }
 
-static void rbtree_repair_case1(ARBTreeNode* parent, ARBTreeNode* node) {
+static void rbtree_repair_case1(ARBTree* tree, ARBTreeNode* parent, ARBTreeNode* node) {
     if (parent == NULL) {
+        /// missing black node reached root -- every path lost one black node
+        --(tree->blackHeight);
         return ;
     }
-    rbtree_repair_case2(parent, node);
+    rbtree_repair_case2(tree, parent, node);
 }
 
-static void rbtree_repair_delete(ARBTreeNode* parent, ARBTreeNode* node) {
+static void rbtree_repair_delete(ARBTree* tree, ARBTreeNode* parent, ARBTreeNode* node) {
     if (node != NULL) {
-        if (node->color == ARBTREE_COLOR_RED) {
-            node->color = ARBTREE_COLOR_BLACK;
+        if (rbtree_color(node) == ARBTREE_COLOR_RED) {
+            rbtree_setColor(node, ARBTREE_COLOR_BLACK);
             return ;
         }
     }
 
     /// restore -- cases
-    rbtree_repair_case1(parent, node);
+    rbtree_repair_case1(tree, parent, node);
 }
 
 bool rbtree_delete(ARBTree* tree, const ARBTreeValue value) {
-    ARBTreeNode* node = rbtree_findNode( tree, value );
-    if (node == NULL) {
-        /// node not found -- nothing to remove
-        return false;
-    }
+    assert( tree != NULL );
+    return rbtree_generic_deleteValue(tree, value);
+}
 
-    if (node->right == NULL) {
-        /// simple case -- just remove
-        if ( node->parent != NULL ) {
-            /// non-root case
-            rbtree_changeChild(node->parent, node, node->left);
-        } else {
-            /// removing root
-            tree->root = node->left;
-            if (node->left != NULL) {
-                node->left->parent = NULL;
-            }
-        }
+/**
+ * Unlinks node having at most one child and repairs tree. Node is not released.
+ */
+static void rbtree_unlinkNode(ARBTree* tree, ARBTreeNode* node) {
+    assert( node->left == NULL || node->right == NULL );
+
+    /// update bounds before unlinking
+    if (node == tree->leftmost) {
+        tree->leftmost = (ARBTreeNode*) rbtree_nextNode(node);
+    }
+    if (node == tree->rightmost) {
+        tree->rightmost = (ARBTreeNode*) rbtree_prevNode(node);
+    }
 
-        if (node->color == ARBTREE_COLOR_BLACK) {
-            rbtree_repair_delete(node->parent, node->left);
-            /// can happpen than root changes due to rotations
-            rbtree_findRoot(tree);
+    ARBTreeNode* parent = rbtree_parent(node);
+    ARBTreeNode* child = (node->right == NULL) ? node->left : node->right;
+    if ( parent != NULL ) {
+        /// non-root case
+        rbtree_changeChild(parent, node, child);
+        rbtree_refreshPath(tree, parent);
+    } else {
+        /// removing root
+        tree->root = child;
+        if (child != NULL) {
+            rbtree_setParent(child, NULL);
         }
+    }
 
-        rbtree_releaseNode(tree, node);
-        return true;
+    if (rbtree_color(node) == ARBTREE_COLOR_BLACK) {
+        rbtree_repair_delete(tree, parent, child);
+        /// can happpen than root changes due to rotations
+        rbtree_findRoot(tree);
     }
 
-    if (node->left == NULL) {
-        /// simple case -- just reconnect
-        if ( node->parent != NULL ) {
-            /// non-root case
-            rbtree_changeChild(node->parent, node, node->right);
-        } else {
-            /// removing root
-            tree->root = node->right;
-            if (node->right != NULL) {
-                node->right->parent = NULL;
-            }
-        }
+    /// parent or child replacing removed node stays near it
+    tree->finger = (parent != NULL) ? parent : tree->root;
+}
 
-        if (node->color == ARBTREE_COLOR_BLACK) {
-            rbtree_repair_delete(node->parent, node->right);
-            /// can happpen than root changes due to rotations
-            rbtree_findRoot(tree);
-        }
+bool rbtree_deleteNode(ARBTree* tree, ARBTreeNode* node) {
+    if (node == NULL) {
+        return false;
+    }
 
+    if (node->left == NULL || node->right == NULL) {
+        /// simple case -- just reconnect
+        rbtree_unlinkNode(tree, node);
         rbtree_releaseNode(tree, node);
         return true;
     }
@@ -1027,23 +1447,508 @@ bool rbtree_delete(ARBTree* tree, const ARBTreeValue value) {
     /// there is right subtree
 
     ARBTreeNode* nextNode = (ARBTreeNode*) rbtree_getRightDescendant(node);      /// never NULL
+    if (nextNode == tree->rightmost) {
+        /// greatest value moves to 'node'
+        tree->rightmost = node;
+    }
 
-    /// swap pointer values (it's important -- it causes to release proper pointer)
-    ARBTreeValue tmpVal = node->value;
-    node->value = nextNode->value;
-    nextNode->value = tmpVal;
+    if (tree->valueSize == 0) {
+        /// swap pointer values (it's important -- it causes to release proper pointer)
+        ARBTreeValue tmpVal = node->value;
+        node->value = nextNode->value;
+        nextNode->value = tmpVal;
+    } else {
+        /// inline values -- destroy removed value and move next value in its place
+        if (tree->fDeleteValue != NULL) {
+            tree->fDeleteValue(node->value);
+        }
+        memcpy(node->value, nextNode->value, tree->valueSize);
+    }
 
-    rbtree_changeChild(nextNode->parent, nextNode, nextNode->right);
-    if (nextNode->color == ARBTREE_COLOR_BLACK) {
-        rbtree_repair_delete(nextNode->parent, nextNode->right);
+    rbtree_changeChild(rbtree_parent(nextNode), nextNode, nextNode->right);
+    rbtree_refreshPath(tree, rbtree_parent(nextNode));
+    if (rbtree_color(nextNode) == ARBTREE_COLOR_BLACK) {
+        rbtree_repair_delete(tree, rbtree_parent(nextNode), nextNode->right);
         /// can happpen than root changes due to rotations
         rbtree_findRoot(tree);
     }
 
-    rbtree_releaseNode(tree, nextNode);
+    tree->finger = node;
+    if (tree->valueSize == 0) {
+        rbtree_releaseNode(tree, nextNode);
+    } else {
+        /// value already moved
+        rbtree_freeNodeMemory(tree, nextNode);
+    }
     return true;
 }
 
+void rbtree_refreshValue(ARBTree* tree, ARBTreeNode* node) {
+    assert( tree != NULL );
+    assert( node != NULL );
+    rbtree_refreshPath(tree, node);
+}
+
+static void rbtree_refreshSubtree(const ARBTree* tree, ARBTreeNode* node) {
+    if (node == NULL) {
+        return ;
+    }
+    rbtree_refreshSubtree(tree, node->left);
+    rbtree_refreshSubtree(tree, node->right);
+    rbtree_refreshNode(tree, node);
+}
+
+void rbtree_refreshTree(ARBTree* tree) {
+    assert( tree != NULL );
+    rbtree_refreshSubtree(tree, tree->root);
+}
+
+
+/// =========================================================
+
+
+/**
+ * Detaches root of subtree and makes it black.
+ * Returns black height of subtree after recoloring ('height' is black height before).
+ */
+static size_t rbtree_detachSubtree(ARBTreeNode* root, const size_t height) {
+    if (root == NULL) {
+        return 0;
+    }
+    rbtree_setParent(root, NULL);
+    if (rbtree_color(root) == ARBTREE_COLOR_RED) {
+        rbtree_setColor(root, ARBTREE_COLOR_BLACK);
+        return height + 1;
+    }
+    return height;
+}
+
+/**
+ * Joins subtrees of black roots through 'node': values of 'left' are less
+ * than node's value, values of 'right' are greater. Node is linked to spine
+ * of higher subtree on level of lower subtree, then colors are repaired,
+ * so join takes O(|leftHeight - rightHeight| + 1).
+ * Returns root of joined subtree, its black height is stored in 'height'.
+ */
+static ARBTreeNode* rbtree_joinSubtrees(const ARBTree* tree, ARBTreeNode* left, const size_t leftHeight,
+                                        ARBTreeNode* node, ARBTreeNode* right, const size_t rightHeight, size_t* height) {
+    node->left = NULL;
+    node->right = NULL;
+    node->parentColor = (uintptr_t) ARBTREE_COLOR_BLACK;
+    if (leftHeight == rightHeight) {
+        rbtree_setLeftChild(node, left);
+        rbtree_setRightChild(node, right);
+        rbtree_refreshNode(tree, node);
+        *height = leftHeight + 1;
+        return node;
+    }
+
+    /// higher subtree is repaired as separate tree
+    ARBTree part = *tree;
+    rbtree_setColor(node, ARBTREE_COLOR_RED);
+    if (leftHeight > rightHeight) {
+        /// find black node of 'rightHeight' on right spine of left subtree
+        ARBTreeNode* parent = NULL;
+        ARBTreeNode* curr = left;
+        size_t currHeight = leftHeight;
+        while (curr != NULL && (rbtree_color(curr) == ARBTREE_COLOR_RED || currHeight > rightHeight)) {
+            if (rbtree_color(curr) == ARBTREE_COLOR_BLACK) {
+                --currHeight;
+            }
+            parent = curr;
+            curr = curr->right;
+        }
+        rbtree_setLeftChild(node, curr);
+        rbtree_setRightChild(node, right);
+        rbtree_setRightChild(parent, node);
+        part.root = left;
+        part.blackHeight = leftHeight;
+    } else {
+        /// find black node of 'leftHeight' on left spine of right subtree
+        ARBTreeNode* parent = NULL;
+        ARBTreeNode* curr = right;
+        size_t currHeight = rightHeight;
+        while (curr != NULL && (rbtree_color(curr) == ARBTREE_COLOR_RED || currHeight > leftHeight)) {
+            if (rbtree_color(curr) == ARBTREE_COLOR_BLACK) {
+                --currHeight;
+            }
+            parent = curr;
+            curr = curr->left;
+        }
+        rbtree_setRightChild(node, curr);
+        rbtree_setLeftChild(node, left);
+        rbtree_setLeftChild(parent, node);
+        part.root = right;
+        part.blackHeight = rightHeight;
+    }
+    rbtree_refreshPath(&part, node);
+    rbtree_repair_insert(&part, node);
+    *height = part.blackHeight;
+    return (ARBTreeNode*) rbtree_findRootFromNode(node);
+}
+
+/**
+ * Splits subtree of black height 'height' into subtree of values less than
+ * 'key' and subtree of other values. Nodes on search path are joined back
+ * as pivots, heights of joined parts telescope, so split takes O(log n).
+ * If 'found' is not NULL, then node equal to 'key' is cut out of both
+ * subtrees and stored in 'found' (NULL if there is no such node).
+ */
+static void rbtree_splitSubtree(const ARBTree* tree, ARBTreeNode* node, const size_t height, const ARBTreeValue key,
+                                ARBTreeNode** left, size_t* leftHeight, ARBTreeNode** right, size_t* rightHeight,
+                                ARBTreeNode** found) {
+    if (node == NULL) {
+        *left = NULL;
+        *leftHeight = 0;
+        *right = NULL;
+        *rightHeight = 0;
+        return ;
+    }
+    const size_t childHeight = (rbtree_color(node) == ARBTREE_COLOR_BLACK) ? height - 1 : height;
+    ARBTreeNode* nodeLeft = node->left;
+    ARBTreeNode* nodeRight = node->right;
+    if ( tree->fIsLessOrder(node->value, key) == true ) {
+        /// node and its left subtree are less than key
+        ARBTreeNode* subtree = NULL;
+        size_t subtreeHeight = 0;
+        rbtree_splitSubtree(tree, nodeRight, childHeight, key, &subtree, &subtreeHeight, right, rightHeight, found);
+        const size_t nodeLeftHeight = rbtree_detachSubtree(nodeLeft, childHeight);
+        *left = rbtree_joinSubtrees(tree, nodeLeft, nodeLeftHeight, node, subtree, subtreeHeight, leftHeight);
+    } else if ( found != NULL && tree->fIsLessOrder(key, node->value) == false ) {
+        /// node equal to key
+        *leftHeight = rbtree_detachSubtree(nodeLeft, childHeight);
+        *left = nodeLeft;
+        *rightHeight = rbtree_detachSubtree(nodeRight, childHeight);
+        *right = nodeRight;
+        node->left = NULL;
+        node->right = NULL;
+        rbtree_setParent(node, NULL);
+        *found = node;
+    } else {
+        /// node and its right subtree are not less than key
+        ARBTreeNode* subtree = NULL;
+        size_t subtreeHeight = 0;
+        rbtree_splitSubtree(tree, nodeLeft, childHeight, key, left, leftHeight, &subtree, &subtreeHeight, found);
+        const size_t nodeRightHeight = rbtree_detachSubtree(nodeRight, childHeight);
+        *right = rbtree_joinSubtrees(tree, subtree, subtreeHeight, node, nodeRight, nodeRightHeight, rightHeight);
+    }
+}
+
+/**
+ * Joins trees through 'node' into 'left', 'right' becomes empty.
+ */
+static void rbtree_joinTrees(ARBTree* left, ARBTreeNode* node, ARBTree* right) {
+    size_t height = 0;
+    ARBTreeNode* root = rbtree_joinSubtrees(left, left->root, left->blackHeight, node, right->root, right->blackHeight, &height);
+    rbtree_setRoot(left, root, height);
+    rbtree_setRoot(right, NULL, 0);
+    if (right->fReleaseAllocator != NULL) {
+        /// take ownership of allocator
+        left->fReleaseAllocator = right->fReleaseAllocator;
+        right->fReleaseAllocator = NULL;
+    }
+}
+
+void rbtree_split(ARBTree* tree, const ARBTreeValue key, ARBTree* left, ARBTree* right) {
+    assert( tree != NULL );
+    assert( left != NULL );
+    assert( right != NULL );
+    assert( left != right );
+
+    const ARBTree config = *tree;
+    ARBTreeNode* leftRoot = NULL;
+    size_t leftHeight = 0;
+    ARBTreeNode* rightRoot = NULL;
+    size_t rightHeight = 0;
+    rbtree_splitSubtree(&config, tree->root, tree->blackHeight, key, &leftRoot, &leftHeight, &rightRoot, &rightHeight, NULL);
+
+    if (tree != left && tree != right) {
+        rbtree_setRoot(tree, NULL, 0);
+        tree->fReleaseAllocator = NULL;
+    }
+    *left = config;
+    *right = config;
+    /// 'right' shares allocator owned by 'left'
+    right->fReleaseAllocator = NULL;
+    rbtree_setRoot(left, leftRoot, leftHeight);
+    rbtree_setRoot(right, rightRoot, rightHeight);
+}
+
+bool rbtree_join(ARBTree* left, const ARBTreeValue pivot, ARBTree* right) {
+    assert( left != NULL );
+    assert( right != NULL );
+    assert( left->allocator == right->allocator );
+    if (left->rightmost != NULL && left->fIsLessOrder(left->rightmost->value, pivot) == false) {
+        return false;
+    }
+    if (right->leftmost != NULL && left->fIsLessOrder(pivot, right->leftmost->value) == false) {
+        return false;
+    }
+    ARBTreeNode* node = rbtree_makeValueNode(left, ARBTREE_COLOR_BLACK, pivot);
+    if (node == NULL) {
+        return false;
+    }
+    rbtree_joinTrees(left, node, right);
+    return true;
+}
+
+bool rbtree_concat(ARBTree* left, ARBTree* right) {
+    assert( left != NULL );
+    assert( right != NULL );
+    assert( left->allocator == right->allocator );
+    if (right->root == NULL) {
+        return true;
+    }
+    if (left->root == NULL) {
+        rbtree_setRoot(left, right->root, right->blackHeight);
+        rbtree_setRoot(right, NULL, 0);
+        if (right->fReleaseAllocator != NULL) {
+            left->fReleaseAllocator = right->fReleaseAllocator;
+            right->fReleaseAllocator = NULL;
+        }
+        return true;
+    }
+    if (left->fIsLessOrder(left->rightmost->value, right->leftmost->value) == false) {
+        return false;
+    }
+    /// greatest node of left tree becomes pivot
+    ARBTreeNode* node = left->rightmost;
+    rbtree_unlinkNode(left, node);
+    rbtree_joinTrees(left, node, right);
+    return true;
+}
+
+/// =========================================================
+
+
+/**
+ * Minimal number of nodes of both subtrees of set operation task
+ * to run its subtasks in parallel.
+ */
+#define ARBTREE_PARALLEL_GRAIN      4096
+
+
+typedef enum {
+    ARBTREE_SET_UNION,
+    ARBTREE_SET_INTERSECTION,
+    ARBTREE_SET_DIFFERENCE
+} ARBTreeSetOperation;
+
+/**
+ * Set operation on subtrees of black roots. Nodes removed by operation
+ * are not released (allocator does not have to be thread safe), but
+ * collected on list of garbage subtrees linked by parent pointer of roots.
+ */
+typedef struct {
+    const ARBTree* tree;                        /// configuration of trees (shared by threads)
+    ARBTreeSetOperation operation;
+    size_t threads;                             /// number of threads available for task
+    ARBTreeNode* rootA;
+    size_t heightA;
+    ARBTreeNode* rootB;
+    size_t heightB;
+    ARBTreeNode* result;
+    size_t height;
+    ARBTreeNode* garbage;                       /// first garbage subtree
+    ARBTreeNode* garbageLast;                   /// last garbage subtree
+} ARBTreeSetTask;
+
+
+/**
+ * Joins subtrees of black roots without pivot: greatest node of 'left'
+ * is taken as pivot.
+ */
+static ARBTreeNode* rbtree_concatSubtrees(const ARBTree* tree, ARBTreeNode* left, const size_t leftHeight,
+                                          ARBTreeNode* right, const size_t rightHeight, size_t* height) {
+    if (left == NULL) {
+        *height = rightHeight;
+        return right;
+    }
+    if (right == NULL) {
+        *height = leftHeight;
+        return left;
+    }
+    ARBTree part = *tree;
+    rbtree_setRoot(&part, left, leftHeight);
+    ARBTreeNode* node = part.rightmost;
+    rbtree_unlinkNode(&part, node);
+    const size_t partHeight = rbtree_detachSubtree(part.root, part.blackHeight);
+    return rbtree_joinSubtrees(tree, part.root, partHeight, node, right, rightHeight, height);
+}
+
+static void rbtree_discardSubtree(ARBTreeSetTask* task, ARBTreeNode* root) {
+    if (root == NULL) {
+        return ;
+    }
+    rbtree_setParent(root, task->garbage);
+    task->garbage = root;
+    if (task->garbageLast == NULL) {
+        task->garbageLast = root;
+    }
+}
+
+static void rbtree_discardList(ARBTreeSetTask* task, const ARBTreeSetTask* subtask) {
+    if (subtask->garbage == NULL) {
+        return ;
+    }
+    rbtree_setParent(subtask->garbageLast, task->garbage);
+    task->garbage = subtask->garbage;
+    if (task->garbageLast == NULL) {
+        task->garbageLast = subtask->garbageLast;
+    }
+}
+
+static void rbtree_runSetTask(ARBTreeSetTask* task);
+
+static void* rbtree_runSetThread(void* data) {
+    rbtree_runSetTask((ARBTreeSetTask*)data);
+    return NULL;
+}
+
+/**
+ * Divide and conquer on root of subtree B: subtree A is split by root's value,
+ * both halves are processed (in parallel if threads are available) and
+ * results are joined back, so work is O(m log(n/m + 1)) for m <= n.
+ */
+static void rbtree_runSetTask(ARBTreeSetTask* task) {
+    const ARBTree* tree = task->tree;
+    if (task->rootA == NULL || task->rootB == NULL) {
+        ARBTreeNode* rest = (task->rootA != NULL) ? task->rootA : task->rootB;
+        const size_t restHeight = (task->rootA != NULL) ? task->heightA : task->heightB;
+        const bool keep = (task->operation == ARBTREE_SET_UNION) || (task->operation == ARBTREE_SET_DIFFERENCE && rest == task->rootA);
+        if (keep == true) {
+            task->result = rest;
+            task->height = restHeight;
+        } else {
+            task->result = NULL;
+            task->height = 0;
+            rbtree_discardSubtree(task, rest);
+        }
+        return ;
+    }
+
+    ARBTreeNode* pivot = task->rootB;
+    const size_t childHeight = (rbtree_color(pivot) == ARBTREE_COLOR_BLACK) ? task->heightB - 1 : task->heightB;
+    ARBTreeNode* pivotLeft = pivot->left;
+    ARBTreeNode* pivotRight = pivot->right;
+    const size_t pivotLeftHeight = rbtree_detachSubtree(pivotLeft, childHeight);
+    const size_t pivotRightHeight = rbtree_detachSubtree(pivotRight, childHeight);
+    pivot->left = NULL;
+    pivot->right = NULL;
+
+    const size_t size = rbtree_sizeSubtree(task->rootA) + rbtree_sizeSubtree(task->rootB);
+    ARBTreeSetTask leftTask = *task;
+    ARBTreeSetTask rightTask = *task;
+    ARBTreeNode* found = NULL;
+    rbtree_splitSubtree(tree, task->rootA, task->heightA, pivot->value,
+                        &(leftTask.rootA), &(leftTask.heightA), &(rightTask.rootA), &(rightTask.heightA), &found);
+    leftTask.rootB = pivotLeft;
+    leftTask.heightB = pivotLeftHeight;
+    leftTask.threads = task->threads / 2;
+    leftTask.garbage = NULL;
+    leftTask.garbageLast = NULL;
+    rightTask.rootB = pivotRight;
+    rightTask.heightB = pivotRightHeight;
+    rightTask.threads = task->threads - leftTask.threads;
+    rightTask.garbage = NULL;
+    rightTask.garbageLast = NULL;
+
+    pthread_t thread;
+    bool forked = false;
+    if (leftTask.threads > 0 && size >= ARBTREE_PARALLEL_GRAIN) {
+        forked = (pthread_create(&thread, NULL, rbtree_runSetThread, &leftTask) == 0);
+    }
+    if (forked == false) {
+        rbtree_runSetTask(&leftTask);
+    }
+    rbtree_runSetTask(&rightTask);
+    if (forked == true) {
+        pthread_join(thread, NULL);
+    }
+
+    task->garbage = NULL;
+    task->garbageLast = NULL;
+    rbtree_discardList(task, &leftTask);
+    rbtree_discardList(task, &rightTask);
+
+    /// pivot is kept if it belongs to result, equal node of A is redundant
+    bool keepPivot = false;
+    switch(task->operation) {
+    case ARBTREE_SET_UNION: {
+        keepPivot = true;
+        break;
+    }
+    case ARBTREE_SET_INTERSECTION: {
+        keepPivot = (found != NULL);
+        break;
+    }
+    case ARBTREE_SET_DIFFERENCE: {
+        keepPivot = false;
+        break;
+    }
+    }
+    rbtree_discardSubtree(task, found);
+    if (keepPivot == true) {
+        task->result = rbtree_joinSubtrees(tree, leftTask.result, leftTask.height, pivot, rightTask.result, rightTask.height, &(task->height));
+    } else {
+        rbtree_setParent(pivot, NULL);
+        rbtree_discardSubtree(task, pivot);
+        task->result = rbtree_concatSubtrees(tree, leftTask.result, leftTask.height, rightTask.result, rightTask.height, &(task->height));
+    }
+}
+
+/**
+ * Stores result of set operation in 'tree', 'other' becomes empty.
+ */
+static void rbtree_setOperation(ARBTree* tree, ARBTree* other, const size_t threads, const ARBTreeSetOperation operation) {
+    assert( tree != NULL );
+    assert( other != NULL );
+    assert( tree != other );
+    assert( tree->allocator == other->allocator );
+
+    ARBTreeSetTask task;
+    task.tree = tree;
+    task.operation = operation;
+    task.threads = (threads > 0) ? threads : 1;
+    task.rootA = tree->root;
+    task.heightA = tree->blackHeight;
+    task.rootB = other->root;
+    task.heightB = other->blackHeight;
+    task.result = NULL;
+    task.height = 0;
+    task.garbage = NULL;
+    task.garbageLast = NULL;
+    rbtree_runSetTask(&task);
+
+    rbtree_setRoot(tree, task.result, task.height);
+    rbtree_setRoot(other, NULL, 0);
+    if (other->fReleaseAllocator != NULL) {
+        tree->fReleaseAllocator = other->fReleaseAllocator;
+        other->fReleaseAllocator = NULL;
+    }
+
+    /// release removed nodes in calling thread
+    ARBTreeNode* garbage = task.garbage;
+    while (garbage != NULL) {
+        ARBTreeNode* next = rbtree_parent(garbage);
+        rbtree_releaseSubtree(tree, garbage);
+        garbage = next;
+    }
+}
+
+void rbtree_union(ARBTree* tree, ARBTree* other, const size_t threads) {
+    rbtree_setOperation(tree, other, threads, ARBTREE_SET_UNION);
+}
+
+void rbtree_intersection(ARBTree* tree, ARBTree* other, const size_t threads) {
+    rbtree_setOperation(tree, other, threads, ARBTREE_SET_INTERSECTION);
+}
+
+void rbtree_difference(ARBTree* tree, ARBTree* other, const size_t threads) {
+    rbtree_setOperation(tree, other, threads, ARBTREE_SET_DIFFERENCE);
+}
+
+
 
 /// =========================================================
 
@@ -1054,7 +1959,7 @@ ARBTreeNode* rbtree_makeDefaultNode() {
 
 ARBTreeNode* rbtree_makeColoredNode(const ARBTreeNodeColor color) {
     ARBTreeNode* node = rbtree_makeDefaultNode();
-    node->color = color;
+    rbtree_setColor(node, color);
     return node;
 }
 
@@ -1063,11 +1968,17 @@ size_t rbtree_nodeIndex(const ARBTreeNode* node) {
         return -1;
     }
 
-    const size_t subIndex = rbtree_sizeSubtree(node->left);
-    const ARBTreeNode* leftNode = rbtree_getLeftAncestor(node);
-    if (leftNode == NULL) {
-        return subIndex;
+    size_t index = rbtree_sizeSubtree(node->left);
+    const ARBTreeNode* child = node;
+    const ARBTreeNode* curr = rbtree_parent(node);
+    while( curr != NULL ) {
+        if (curr->right == child) {
+            /// all nodes of left subtree and parent are before node
+            index += rbtree_sizeSubtree(curr->left) + 1;
+        }
+        child = curr;
+        curr = rbtree_parent(curr);
     }
-    return rbtree_nodeIndex(leftNode) + 1 + subIndex;
+    return index;
 }
 
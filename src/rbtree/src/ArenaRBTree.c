@@ -0,0 +1,547 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#include "rbtree/ArenaRBTree.h"
+
+#include <stdlib.h>                     /// malloc, free
+#include <stdio.h>                      /// printf
+#include <assert.h>
+#include <string.h>
+
+
+#define ARTREE_COLOR_MASK       ((ARTreeIndex) 1)
+
+
+static inline size_t artree_alignUp(const size_t value, const size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static inline ARTreeNode* artree_node(const ArenaRBTree* tree, const ARTreeIndex index) {
+    return (ARTreeNode*) (tree->nodes + (size_t)index * tree->nodeSize + tree->linksOffset);
+}
+
+static inline ARTreeIndex artree_parent(const ArenaRBTree* tree, const ARTreeIndex index) {
+    return artree_node(tree, index)->parentColor >> 1;
+}
+
+static inline ARBTreeNodeColor artree_color(const ArenaRBTree* tree, const ARTreeIndex index) {
+    return (ARBTreeNodeColor) (artree_node(tree, index)->parentColor & ARTREE_COLOR_MASK);
+}
+
+static inline bool artree_isBlack(const ArenaRBTree* tree, const ARTreeIndex index) {
+    return (index == ARTREE_NULL) || (artree_color(tree, index) == ARBTREE_COLOR_BLACK);
+}
+
+static inline void artree_setParent(ArenaRBTree* tree, const ARTreeIndex index, const ARTreeIndex parent) {
+    ARTreeNode* node = artree_node(tree, index);
+    node->parentColor = (parent << 1) | (node->parentColor & ARTREE_COLOR_MASK);
+}
+
+static inline void artree_setColor(ArenaRBTree* tree, const ARTreeIndex index, const ARBTreeNodeColor color) {
+    ARTreeNode* node = artree_node(tree, index);
+    node->parentColor = (node->parentColor & ~ARTREE_COLOR_MASK) | (ARTreeIndex) color;
+}
+
+
+/// ========================================================================================
+
+
+void artree_init(ArenaRBTree* tree, const size_t valueSize) {
+    assert( tree != NULL );
+
+    tree->nodes = NULL;
+    tree->valueSize = valueSize;
+    tree->linksOffset = artree_alignUp(valueSize, sizeof(ARTreeIndex));
+    /// keep values aligned for any pointer-sized type
+    tree->nodeSize = artree_alignUp(tree->linksOffset + sizeof(ARTreeNode), sizeof(void*));
+    tree->capacity = 0;
+    tree->used = 0;
+    tree->freeList = ARTREE_NULL;
+    tree->root = ARTREE_NULL;
+    tree->size = 0;
+
+    tree->fIsLessOrder = NULL;
+    tree->fPrintValue = NULL;
+}
+
+size_t artree_size(const ArenaRBTree* tree) {
+    assert( tree != NULL );
+    return tree->size;
+}
+
+static size_t artree_depthSubtree(const ArenaRBTree* tree, const ARTreeIndex index) {
+    if (index == ARTREE_NULL) {
+        return 0;
+    }
+    const ARTreeNode* node = artree_node(tree, index);
+    const size_t dLeft = artree_depthSubtree(tree, node->left);
+    const size_t dRight = artree_depthSubtree(tree, node->right);
+    return (dLeft > dRight) ? dLeft + 1 : dRight + 1;
+}
+
+size_t artree_depth(const ArenaRBTree* tree) {
+    assert( tree != NULL );
+    return artree_depthSubtree(tree, tree->root);
+}
+
+size_t artree_memoryUsage(const ArenaRBTree* tree) {
+    assert( tree != NULL );
+    return (size_t)tree->capacity * tree->nodeSize;
+}
+
+ARBTreeValue artree_value(const ArenaRBTree* tree, const ARTreeIndex index) {
+    assert( tree != NULL );
+    return tree->nodes + (size_t)index * tree->nodeSize;
+}
+
+
+/// ==================================================================================
+
+
+/**
+ * Checks links, order (value in range of ancestors 'lower' and 'upper'),
+ * colors and black paths of subtree. Counts nodes and black height.
+ */
+static ARBTreeValidationError artree_isValid_checkSubtree(const ArenaRBTree* tree, const ARTreeIndex index, const ARTreeIndex parent,
+                                                          const ARTreeIndex lower, const ARTreeIndex upper,
+                                                          size_t* blackHeight, size_t* nodesCounter) {
+    if (index == ARTREE_NULL) {
+        *blackHeight = 0;
+        return ARBTREE_INVALID_OK;
+    }
+    const ARTreeNode* node = artree_node(tree, index);
+    if (artree_parent(tree, index) != parent) {
+        return ARBTREE_INVALID_NODE_PARENT;
+    }
+    if ((node->left == node->right) && (node->left != ARTREE_NULL)) {
+        return ARBTREE_INVALID_SAME_CHILD;
+    }
+
+    const ARBTreeValue value = artree_value(tree, index);
+    if (lower != ARTREE_NULL && tree->fIsLessOrder(value, artree_value(tree, lower))) {
+        return ARBTREE_INVALID_NOT_SORTED;
+    }
+    if (upper != ARTREE_NULL && tree->fIsLessOrder(artree_value(tree, upper), value)) {
+        return ARBTREE_INVALID_NOT_SORTED;
+    }
+
+    if (artree_color(tree, index) == ARBTREE_COLOR_RED) {
+        if (artree_isBlack(tree, node->left) == false || artree_isBlack(tree, node->right) == false) {
+            return ARBTREE_INVALID_BLACK_CHILDREN;
+        }
+    }
+
+    size_t leftHeight = 0;
+    const ARBTreeValidationError validLeft = artree_isValid_checkSubtree(tree, node->left, index, lower, index, &leftHeight, nodesCounter);
+    if (validLeft != ARBTREE_INVALID_OK) {
+        return validLeft;
+    }
+    size_t rightHeight = 0;
+    const ARBTreeValidationError validRight = artree_isValid_checkSubtree(tree, node->right, index, index, upper, &rightHeight, nodesCounter);
+    if (validRight != ARBTREE_INVALID_OK) {
+        return validRight;
+    }
+    if (leftHeight != rightHeight) {
+        return ARBTREE_INVALID_BLACK_PATH;
+    }
+
+    *blackHeight = (artree_color(tree, index) == ARBTREE_COLOR_BLACK) ? leftHeight + 1 : leftHeight;
+    ++(*nodesCounter);
+    return ARBTREE_INVALID_OK;
+}
+
+ARBTreeValidationError artree_isValid(const ArenaRBTree* tree) {
+    assert( tree != NULL );
+
+    if (tree->root == ARTREE_NULL) {
+        return (tree->size == 0) ? ARBTREE_INVALID_OK : ARBTREE_INVALID_TREE_DATA;
+    }
+    if (artree_parent(tree, tree->root) != ARTREE_NULL) {
+        return ARBTREE_INVALID_ROOT_PARENT;
+    }
+    if (artree_color(tree, tree->root) != ARBTREE_COLOR_BLACK) {
+        return ARBTREE_INVALID_RED_ROOT;
+    }
+
+    size_t blackHeight = 0;
+    size_t nodesCounter = 0;
+    const ARBTreeValidationError valid = artree_isValid_checkSubtree(tree, tree->root, ARTREE_NULL, ARTREE_NULL, ARTREE_NULL,
+                                                                     &blackHeight, &nodesCounter);
+    if (valid != ARBTREE_INVALID_OK) {
+        return valid;
+    }
+    if (nodesCounter != tree->size) {
+        return ARBTREE_INVALID_TREE_DATA;
+    }
+    return ARBTREE_INVALID_OK;
+}
+
+
+/// ==================================================================================
+
+
+ARTreeIndex artree_findNode(const ArenaRBTree* tree, const ARBTreeValue value) {
+    assert( tree != NULL );
+
+    ARTreeIndex curr = tree->root;
+    while (curr != ARTREE_NULL) {
+        const ARBTreeValue currValue = artree_value(tree, curr);
+        if ( tree->fIsLessOrder(value, currValue) == true ) {
+            /// value < curr->value
+            curr = artree_node(tree, curr)->left;
+            continue ;
+        }
+        if ( tree->fIsLessOrder(currValue, value) == true ) {
+            /// value > curr->value
+            curr = artree_node(tree, curr)->right;
+            continue ;
+        }
+
+        /// equal
+        return curr;
+    }
+    /// not found
+    return ARTREE_NULL;
+}
+
+
+/// ==================================================================================
+
+
+/**
+ * Takes node from free list or from end of array (growing array if needed).
+ * Returns ARTREE_NULL if memory cannot be allocated.
+ */
+static ARTreeIndex artree_allocNode(ArenaRBTree* tree) {
+    if (tree->freeList != ARTREE_NULL) {
+        const ARTreeIndex index = tree->freeList;
+        tree->freeList = artree_node(tree, index)->left;
+        return index;
+    }
+
+    if (tree->used == tree->capacity) {
+        if (tree->capacity == ARTREE_MAX_NODES) {
+            return ARTREE_NULL;
+        }
+        ARTreeIndex newCapacity = ARTREE_INITIAL_CAPACITY;
+        if (tree->capacity > 0) {
+            newCapacity = (tree->capacity < ARTREE_MAX_NODES / 2) ? tree->capacity * 2 : ARTREE_MAX_NODES;
+        }
+        char* nodes = realloc( tree->nodes, (size_t)newCapacity * tree->nodeSize );
+        if (nodes == NULL) {
+            return ARTREE_NULL;
+        }
+        tree->nodes = nodes;
+        tree->capacity = newCapacity;
+        if (tree->used == 0) {
+            /// reserve node meaning NULL
+            memset(tree->nodes, 0, tree->nodeSize);
+            tree->used = 1;
+        }
+    }
+
+    const ARTreeIndex index = tree->used;
+    ++(tree->used);
+    return index;
+}
+
+static inline void artree_freeNode(ArenaRBTree* tree, const ARTreeIndex index) {
+    artree_node(tree, index)->left = tree->freeList;
+    tree->freeList = index;
+}
+
+/**
+ * Replaces child 'from' of 'parent' with 'to'. If 'parent' is NULL, then 'to' becomes root.
+ */
+static inline void artree_replaceChild(ArenaRBTree* tree, const ARTreeIndex parent, const ARTreeIndex from, const ARTreeIndex to) {
+    if (to != ARTREE_NULL) {
+        artree_setParent(tree, to, parent);
+    }
+    if (parent == ARTREE_NULL) {
+        tree->root = to;
+        return ;
+    }
+    ARTreeNode* parentNode = artree_node(tree, parent);
+    if (parentNode->left == from) {
+        parentNode->left = to;
+    } else {
+        parentNode->right = to;
+    }
+}
+
+static void artree_rotate_left(ArenaRBTree* tree, const ARTreeIndex index) {
+    ARTreeNode* node = artree_node(tree, index);
+    const ARTreeIndex parent = artree_parent(tree, index);
+    const ARTreeIndex nnew = node->right;
+    assert( nnew != ARTREE_NULL );
+    ARTreeNode* nnewNode = artree_node(tree, nnew);
+
+    node->right = nnewNode->left;
+    if (node->right != ARTREE_NULL) {
+        artree_setParent(tree, node->right, index);
+    }
+    nnewNode->left = index;
+    artree_setParent(tree, index, nnew);
+    artree_replaceChild(tree, parent, index, nnew);
+}
+
+static void artree_rotate_right(ArenaRBTree* tree, const ARTreeIndex index) {
+    ARTreeNode* node = artree_node(tree, index);
+    const ARTreeIndex parent = artree_parent(tree, index);
+    const ARTreeIndex nnew = node->left;
+    assert( nnew != ARTREE_NULL );
+    ARTreeNode* nnewNode = artree_node(tree, nnew);
+
+    node->left = nnewNode->right;
+    if (node->left != ARTREE_NULL) {
+        artree_setParent(tree, node->left, index);
+    }
+    nnewNode->right = index;
+    artree_setParent(tree, index, nnew);
+    artree_replaceChild(tree, parent, index, nnew);
+}
+
+static void artree_repair_insert(ArenaRBTree* tree, const ARTreeIndex index) {
+    ARTreeIndex curr = index;
+    while (true) {
+        ARTreeIndex parent = artree_parent(tree, curr);
+        if (parent == ARTREE_NULL) {
+            artree_setColor(tree, curr, ARBTREE_COLOR_BLACK);
+            return ;
+        }
+        if (artree_color(tree, parent) == ARBTREE_COLOR_BLACK) {
+            return ;
+        }
+
+        /// parent is red, so it is not root
+        const ARTreeIndex grandpa = artree_parent(tree, parent);
+        const ARTreeNode* grandpaNode = artree_node(tree, grandpa);
+        const ARTreeIndex uncle = (grandpaNode->left == parent) ? grandpaNode->right : grandpaNode->left;
+        if (artree_isBlack(tree, uncle) == false) {
+            artree_setColor(tree, parent, ARBTREE_COLOR_BLACK);
+            artree_setColor(tree, uncle, ARBTREE_COLOR_BLACK);
+            artree_setColor(tree, grandpa, ARBTREE_COLOR_RED);
+            curr = grandpa;
+            continue ;
+        }
+
+        if (grandpaNode->left == parent) {
+            if (artree_node(tree, parent)->right == curr) {
+                artree_rotate_left(tree, parent);
+                parent = curr;
+            }
+            artree_rotate_right(tree, grandpa);
+        } else {
+            if (artree_node(tree, parent)->left == curr) {
+                artree_rotate_right(tree, parent);
+                parent = curr;
+            }
+            artree_rotate_left(tree, grandpa);
+        }
+        artree_setColor(tree, parent, ARBTREE_COLOR_BLACK);
+        artree_setColor(tree, grandpa, ARBTREE_COLOR_RED);
+        return ;
+    }
+}
+
+bool artree_add(ArenaRBTree* tree, const ARBTreeValue value) {
+    assert( tree != NULL );
+
+    const ARTreeIndex index = artree_allocNode(tree);          /// can move array
+    if (index == ARTREE_NULL) {
+        return false;
+    }
+    memcpy(artree_value(tree, index), value, tree->valueSize);
+
+    /// equal values are placed on right side
+    ARTreeIndex parent = ARTREE_NULL;
+    ARTreeIndex curr = tree->root;
+    bool toLeft = false;
+    while (curr != ARTREE_NULL) {
+        parent = curr;
+        toLeft = tree->fIsLessOrder(value, artree_value(tree, curr));
+        const ARTreeNode* currNode = artree_node(tree, curr);
+        curr = toLeft ? currNode->left : currNode->right;
+    }
+
+    ARTreeNode* node = artree_node(tree, index);
+    node->left = ARTREE_NULL;
+    node->right = ARTREE_NULL;
+    node->parentColor = (parent << 1) | ARBTREE_COLOR_RED;         /// default color of new node
+    if (parent == ARTREE_NULL) {
+        tree->root = index;
+    } else if (toLeft) {
+        artree_node(tree, parent)->left = index;
+    } else {
+        artree_node(tree, parent)->right = index;
+    }
+    ++(tree->size);
+
+    artree_repair_insert(tree, index);
+    return true;
+}
+
+
+/// ==================================================================================
+
+
+/**
+ * Restores black paths after removing black node. 'node' (can be NULL)
+ * took place of removed node under 'parent'.
+ */
+static void artree_repair_delete(ArenaRBTree* tree, const ARTreeIndex parentIndex, const ARTreeIndex index) {
+    ARTreeIndex parent = parentIndex;
+    ARTreeIndex curr = index;
+    while (parent != ARTREE_NULL && artree_isBlack(tree, curr)) {
+        const ARTreeNode* parentNode = artree_node(tree, parent);
+        const bool isLeft = (parentNode->left == curr);
+        ARTreeIndex sibling = isLeft ? parentNode->right : parentNode->left;       /// never NULL in valid tree
+
+        if (artree_color(tree, sibling) == ARBTREE_COLOR_RED) {
+            artree_setColor(tree, sibling, ARBTREE_COLOR_BLACK);
+            artree_setColor(tree, parent, ARBTREE_COLOR_RED);
+            if (isLeft) {
+                artree_rotate_left(tree, parent);
+            } else {
+                artree_rotate_right(tree, parent);
+            }
+            sibling = isLeft ? artree_node(tree, parent)->right : artree_node(tree, parent)->left;
+        }
+
+        const ARTreeNode* siblingNode = artree_node(tree, sibling);
+        if (artree_isBlack(tree, siblingNode->left) && artree_isBlack(tree, siblingNode->right)) {
+            artree_setColor(tree, sibling, ARBTREE_COLOR_RED);
+            curr = parent;
+            parent = artree_parent(tree, parent);
+            continue ;
+        }
+
+        if (isLeft) {
+            if (artree_isBlack(tree, siblingNode->right)) {
+                artree_setColor(tree, siblingNode->left, ARBTREE_COLOR_BLACK);
+                artree_setColor(tree, sibling, ARBTREE_COLOR_RED);
+                artree_rotate_right(tree, sibling);
+                sibling = artree_node(tree, parent)->right;
+            }
+            artree_setColor(tree, sibling, artree_color(tree, parent));
+            artree_setColor(tree, parent, ARBTREE_COLOR_BLACK);
+            artree_setColor(tree, artree_node(tree, sibling)->right, ARBTREE_COLOR_BLACK);
+            artree_rotate_left(tree, parent);
+        } else {
+            if (artree_isBlack(tree, siblingNode->left)) {
+                artree_setColor(tree, siblingNode->right, ARBTREE_COLOR_BLACK);
+                artree_setColor(tree, sibling, ARBTREE_COLOR_RED);
+                artree_rotate_left(tree, sibling);
+                sibling = artree_node(tree, parent)->left;
+            }
+            artree_setColor(tree, sibling, artree_color(tree, parent));
+            artree_setColor(tree, parent, ARBTREE_COLOR_BLACK);
+            artree_setColor(tree, artree_node(tree, sibling)->left, ARBTREE_COLOR_BLACK);
+            artree_rotate_right(tree, parent);
+        }
+        curr = tree->root;
+        break;
+    }
+    if (curr != ARTREE_NULL) {
+        artree_setColor(tree, curr, ARBTREE_COLOR_BLACK);
+    }
+}
+
+bool artree_delete(ArenaRBTree* tree, const ARBTreeValue value) {
+    assert( tree != NULL );
+
+    ARTreeIndex index = artree_findNode(tree, value);
+    if (index == ARTREE_NULL) {
+        /// node not found -- nothing to remove
+        return false;
+    }
+
+    const ARTreeNode* node = artree_node(tree, index);
+    if (node->left != ARTREE_NULL && node->right != ARTREE_NULL) {
+        /// have both children -- move next value to node and remove next node
+        ARTreeIndex next = node->right;
+        while (artree_node(tree, next)->left != ARTREE_NULL) {
+            next = artree_node(tree, next)->left;
+        }
+        memcpy(artree_value(tree, index), artree_value(tree, next), tree->valueSize);
+        index = next;
+        node = artree_node(tree, index);
+    }
+
+    /// node has at most one child
+    const ARTreeIndex child = (node->left != ARTREE_NULL) ? node->left : node->right;
+    const ARTreeIndex parent = artree_parent(tree, index);
+    artree_replaceChild(tree, parent, index, child);
+    if (artree_color(tree, index) == ARBTREE_COLOR_BLACK) {
+        artree_repair_delete(tree, parent, child);
+    }
+
+    artree_freeNode(tree, index);
+    --(tree->size);
+    return true;
+}
+
+
+/// ==================================================================================
+
+
+static void artree_printSubtree(const ArenaRBTree* tree, const ARTreeIndex index, const size_t level) {
+    if (index == ARTREE_NULL) {
+        return ;
+    }
+    const ARTreeNode* node = artree_node(tree, index);
+    artree_printSubtree(tree, node->left, level + 1);
+    for(size_t l = 0; l < level; ++l) {
+        printf("  ");
+    }
+    printf("%u%s: ", index, (artree_color(tree, index) == ARBTREE_COLOR_RED) ? "R" : "B");
+    if (tree->fPrintValue != NULL) {
+        tree->fPrintValue( artree_value(tree, index) );
+    }
+    printf("%s", "\n");
+    artree_printSubtree(tree, node->right, level + 1);
+}
+
+void artree_print(const ArenaRBTree* tree) {
+    if (tree == NULL) {
+        printf("%s", "[NULL]");
+        return ;
+    }
+    if (tree->root == ARTREE_NULL) {
+        printf("%s", "(NULL)");
+        return ;
+    }
+    artree_printSubtree(tree, tree->root, 0);
+}
+
+void artree_release(ArenaRBTree* tree) {
+    assert( tree != NULL );
+
+    free(tree->nodes);
+    tree->nodes = NULL;
+    tree->capacity = 0;
+    tree->used = 0;
+    tree->freeList = ARTREE_NULL;
+    tree->root = ARTREE_NULL;
+    tree->size = 0;
+}
@@ -0,0 +1,168 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+
+#include "rbtree/NodePool.h"
+
+#include <stdlib.h>                     /// malloc, free
+#include <string.h>                     /// memset
+#include <stdint.h>                     /// uintptr_t
+#include <stdbool.h>
+#include <assert.h>
+
+
+typedef struct NodePoolChunk {
+    struct NodePoolChunk* next;
+} NodePoolChunk;
+
+
+static inline size_t pool_alignUp(const size_t value, const size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static bool pool_addChunk(NodePool* pool) {
+    /// extra space for chunk header and alignment
+    const size_t chunkSize = sizeof(NodePoolChunk) + pool->alignment + pool->nodeSize * pool->chunkNodes;
+    NodePoolChunk* chunk = malloc( chunkSize );
+    if (chunk == NULL) {
+        return false;
+    }
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+
+    const uintptr_t data = (uintptr_t)(chunk + 1);
+    pool->next = (char*)pool_alignUp(data, pool->alignment);
+    pool->end = pool->next + pool->nodeSize * pool->chunkNodes;
+    return true;
+}
+
+
+/// ===========================================================================
+
+
+void pool_init(NodePool* pool, const size_t nodeSize, const size_t alignment, const size_t chunkNodes) {
+    assert( pool != NULL );
+    assert( (alignment & (alignment - 1)) == 0 );
+
+    pool->chunks = NULL;
+    pool->freeList = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+    pool->alignment = (alignment < sizeof(void*)) ? sizeof(void*) : alignment;
+    pool->nodeSize = pool_alignUp(nodeSize, pool->alignment);
+    pool->chunkNodes = (chunkNodes > 0) ? chunkNodes : NODEPOOL_CHUNK_NODES;
+    pool->used = 0;
+}
+
+void* pool_alloc(NodePool* pool) {
+    assert( pool != NULL );
+
+    void* node = pool->freeList;
+    if (node != NULL) {
+        /// reuse released node
+        pool->freeList = *(void**)node;
+    } else {
+        if (pool->next == pool->end) {
+            if (pool_addChunk(pool) == false) {
+                return NULL;
+            }
+        }
+        node = pool->next;
+        pool->next += pool->nodeSize;
+    }
+
+    ++(pool->used);
+    memset(node, 0, pool->nodeSize);
+    return node;
+}
+
+void pool_free(NodePool* pool, void* node) {
+    assert( pool != NULL );
+    if (node == NULL) {
+        return ;
+    }
+    *(void**)node = pool->freeList;
+    pool->freeList = node;
+    --(pool->used);
+}
+
+void pool_release(NodePool* pool) {
+    assert( pool != NULL );
+    NodePoolChunk* curr = pool->chunks;
+    while (curr != NULL) {
+        NodePoolChunk* next = curr->next;
+        free(curr);
+        curr = next;
+    }
+    pool->chunks = NULL;
+    pool->freeList = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+    pool->used = 0;
+}
+
+size_t pool_chunks(const NodePool* pool) {
+    if (pool == NULL) {
+        return 0;
+    }
+    size_t counter = 0;
+    const NodePoolChunk* curr = pool->chunks;
+    while (curr != NULL) {
+        ++counter;
+        curr = curr->next;
+    }
+    return counter;
+}
+
+
+/// ===========================================================================
+
+
+NodePool* pool_create(const size_t nodeSize) {
+    NodePool* pool = malloc( sizeof(NodePool) );
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool_init(pool, nodeSize, NODEPOOL_NODE_ALIGNMENT, NODEPOOL_CHUNK_NODES);
+    return pool;
+}
+
+void pool_destroy(void* allocator) {
+    NodePool* pool = (NodePool*)allocator;
+    if (pool == NULL) {
+        return ;
+    }
+    pool_release(pool);
+    free(pool);
+}
+
+void* pool_allocNode(void* allocator, const size_t size) {
+    NodePool* pool = (NodePool*)allocator;
+    assert( size <= pool->nodeSize );
+    (void) size; /* unused in release */
+    return pool_alloc(pool);
+}
+
+void pool_freeNode(void* allocator, void* node) {
+    pool_free((NodePool*)allocator, node);
+}
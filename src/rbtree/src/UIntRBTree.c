@@ -27,6 +27,7 @@
 #include <assert.h>
 
 #include "rbtree/AbstractRBTree.h"
+#include "rbtree/RBTreeGenerator.h"
 
 
 
@@ -36,6 +37,13 @@ static inline bool uirbtree_checkOrder(const ARBTreeValue valueA, const ARBTreeV
     return (vA < vB);
 }
 
+static inline bool uirbtree_less(const UIntRBTreeValue* valueA, const UIntRBTreeValue* valueB) {
+    return (*valueA < *valueB);
+}
+
+/// loops with inlined comparator, tree keeps 'fIsLessOrder' for other operations
+RBTREE_DEFINE(uirbtree_typed, UIntRBTreeValue, uirbtree_less, RBTREE_FIT_ANY, RBTREE_FIT_ANY)
+
 static inline void uirbtree_printValue(const ARBTreeValue value) {
     const UIntRBTreeValue v = *((UIntRBTreeValue*)value);
     printf("%zu", v);
@@ -104,11 +112,16 @@ bool uirbtree_add(UIntRBTree* tree, const UIntRBTreeValue value) {
     ARBTree* baseTree = &(tree->tree);
 
     UIntRBTreeValue* ptr = malloc( sizeof(UIntRBTreeValue) );
+    if (ptr == NULL) {
+        return false;
+    }
     *ptr = value;
 
-    const bool added = rbtree_add(baseTree, ptr);
-    assert( added );
-    return added;
+    if (uirbtree_typed_addValue(baseTree, ptr) == NULL) {
+        free(ptr);
+        return false;
+    }
+    return true;
 }
 
 bool uirbtree_delete(UIntRBTree* tree, const UIntRBTreeValue value) {
@@ -118,7 +131,7 @@ bool uirbtree_delete(UIntRBTree* tree, const UIntRBTreeValue value) {
     ARBTree* baseTree = &(tree->tree);
 
     const ARBTreeValue v = (ARBTreeValue)&value;
-    return rbtree_delete(baseTree, v);
+    return uirbtree_typed_deleteValue(baseTree, v);
 }
 
 bool uirbtree_release(UIntRBTree* tree) {
@@ -129,3 +142,27 @@ bool uirbtree_release(UIntRBTree* tree) {
     return rbtree_release(baseTree);
 }
 
+bool uirbtree_union(UIntRBTree* tree, UIntRBTree* other, const size_t threads) {
+    if (tree == NULL || other == NULL || tree == other) {
+        return false;
+    }
+    rbtree_union(&(tree->tree), &(other->tree), threads);
+    return true;
+}
+
+bool uirbtree_intersection(UIntRBTree* tree, UIntRBTree* other, const size_t threads) {
+    if (tree == NULL || other == NULL || tree == other) {
+        return false;
+    }
+    rbtree_intersection(&(tree->tree), &(other->tree), threads);
+    return true;
+}
+
+bool uirbtree_difference(UIntRBTree* tree, UIntRBTree* other, const size_t threads) {
+    if (tree == NULL || other == NULL || tree == other) {
+        return false;
+    }
+    rbtree_difference(&(tree->tree), &(other->tree), threads);
+    return true;
+}
+
@@ -0,0 +1,284 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#include "rbtree/ArenaRBTree.h"
+#include "rbtree/UIntRBTree.h"
+
+#include <time.h>
+#include <stdlib.h>
+#include <stdio.h>                              /// printf
+#include <string.h>                             /// memcpy
+
+/// for cmocka to mock system functions
+#define UNIT_TESTING 1
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+
+
+static unsigned int current_seed = 0;
+
+static unsigned int get_next_seed() {
+    if (current_seed == 0) {
+        srand( time(NULL) );
+        current_seed = rand();
+    }
+    return (++current_seed);
+}
+
+static bool artree_checkOrder(const ARBTreeValue valueA, const ARBTreeValue valueB) {
+    const size_t vA = *((size_t*)valueA);
+    const size_t vB = *((size_t*)valueB);
+    return (vA < vB);
+}
+
+static ArenaRBTree create_tree() {
+    ArenaRBTree tree;
+    artree_init(&tree, sizeof(size_t));
+    tree.fIsLessOrder = artree_checkOrder;
+    return tree;
+}
+
+static bool add_value(ArenaRBTree* tree, size_t value) {
+    return artree_add(tree, &value);
+}
+
+static bool delete_value(ArenaRBTree* tree, size_t value) {
+    return artree_delete(tree, &value);
+}
+
+static ARTreeIndex find_value(ArenaRBTree* tree, size_t value) {
+    return artree_findNode(tree, &value);
+}
+
+
+/// ======================================================
+
+
+static void test_artree_init(void **state) {
+    (void) state; /* unused */
+
+    ArenaRBTree tree = create_tree();
+
+    assert_int_equal( artree_size(&tree), 0 );
+    assert_int_equal( artree_depth(&tree), 0 );
+    assert_int_equal( artree_memoryUsage(&tree), 0 );
+    assert_int_equal( artree_isValid(&tree), ARBTREE_INVALID_OK );
+    assert_int_equal( find_value(&tree, 3), ARTREE_NULL );
+
+    /// value followed by three 32-bit links
+    assert_int_equal( tree.nodeSize, 24 );
+
+    artree_release(&tree);
+}
+
+static void test_artree_add_same(void **state) {
+    (void) state; /* unused */
+
+    ArenaRBTree tree = create_tree();
+
+    assert_int_equal( add_value(&tree, 10), true );
+    assert_int_equal( add_value(&tree, 10), true );
+
+    assert_int_equal( artree_size(&tree), 2 );
+    assert_int_equal( artree_depth(&tree), 2 );
+    assert_int_equal( artree_isValid(&tree), ARBTREE_INVALID_OK );
+
+    artree_release(&tree);
+}
+
+static void test_artree_add_subtree(void **state) {
+    (void) state; /* unused */
+
+    ArenaRBTree tree = create_tree();
+
+    add_value(&tree, 13);
+    add_value(&tree, 8);
+    add_value(&tree, 1);
+    add_value(&tree, 6);
+    add_value(&tree, 11);
+    add_value(&tree, 17);
+    add_value(&tree, 15);
+    add_value(&tree, 25);
+    add_value(&tree, 22);
+    add_value(&tree, 27);
+
+    assert_int_equal( artree_size(&tree), 10 );
+    assert_int_equal( artree_depth(&tree), 4 );
+    assert_int_equal( artree_isValid(&tree), ARBTREE_INVALID_OK );
+
+    const ARTreeIndex index = find_value(&tree, 22);
+    assert_int_not_equal( index, ARTREE_NULL );
+    assert_int_equal( *(size_t*)artree_value(&tree, index), 22 );
+    assert_int_equal( find_value(&tree, 23), ARTREE_NULL );
+
+    artree_release(&tree);
+}
+
+static void test_artree_delete(void **state) {
+    (void) state; /* unused */
+
+    ArenaRBTree tree = create_tree();
+    for(size_t i = 0; i < 16; ++i) {
+        add_value(&tree, i+1);
+    }
+
+    assert_int_equal( delete_value(&tree, 10), true );
+    assert_int_equal( delete_value(&tree, 10), false );
+
+    assert_int_equal( artree_size(&tree), 15 );
+    assert_int_equal( artree_isValid(&tree), ARBTREE_INVALID_OK );
+    assert_int_equal( find_value(&tree, 10), ARTREE_NULL );
+
+    for(size_t i = 0; i < 16; ++i) {
+        delete_value(&tree, i+1);
+        assert_int_equal( artree_isValid(&tree), ARBTREE_INVALID_OK );
+    }
+    assert_int_equal( artree_size(&tree), 0 );
+
+    artree_release(&tree);
+}
+
+static void test_artree_reuse(void **state) {
+    (void) state; /* unused */
+
+    ArenaRBTree tree = create_tree();
+    for(size_t i = 0; i < ARTREE_INITIAL_CAPACITY - 1; ++i) {
+        add_value(&tree, i+1);
+    }
+    const size_t memory = artree_memoryUsage(&tree);
+    assert_int_equal( memory, ARTREE_INITIAL_CAPACITY * tree.nodeSize );
+
+    /// released nodes are reused -- arena does not grow
+    for(size_t i = 0; i < 100; ++i) {
+        delete_value(&tree, i % 15 + 1);
+        add_value(&tree, i % 15 + 1);
+    }
+    assert_int_equal( artree_memoryUsage(&tree), memory );
+
+    /// next node grows arena
+    add_value(&tree, 100);
+    assert_int_equal( artree_memoryUsage(&tree), 2 * memory );
+    assert_int_equal( artree_isValid(&tree), ARBTREE_INVALID_OK );
+
+    artree_release(&tree);
+    assert_int_equal( artree_memoryUsage(&tree), 0 );
+
+    /// tree usable after release
+    add_value(&tree, 5);
+    assert_int_equal( artree_size(&tree), 1 );
+    artree_release(&tree);
+}
+
+static void test_artree_relocate(void **state) {
+    (void) state; /* unused */
+
+    ArenaRBTree tree = create_tree();
+    for(size_t i = 0; i < 50; ++i) {
+        add_value(&tree, i * 3);
+    }
+
+    /// indices instead of pointers -- copy of arena is valid tree
+    ArenaRBTree copy = tree;
+    copy.nodes = malloc( artree_memoryUsage(&tree) );
+    memcpy(copy.nodes, tree.nodes, artree_memoryUsage(&tree));
+    artree_release(&tree);
+
+    assert_int_equal( artree_isValid(&copy), ARBTREE_INVALID_OK );
+    assert_int_not_equal( find_value(&copy, 12), ARTREE_NULL );
+    assert_int_equal( delete_value(&copy, 12), true );
+    assert_int_equal( artree_size(&copy), 49 );
+
+    artree_release(&copy);
+}
+
+static void test_artree_compare(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    static const size_t nodes_num = 400;
+    static const size_t max_val = 300;
+
+    UIntRBTree reference;
+    uirbtree_init(&reference);
+
+    ArenaRBTree tree = create_tree();
+
+    for(size_t i = 0; i < nodes_num; ++i) {
+        const size_t val = rand() % max_val + 1;
+        uirbtree_add(&reference, val);
+        add_value(&tree, val);
+    }
+    assert_int_equal( artree_isValid(&tree), ARBTREE_INVALID_OK );
+
+    for(size_t i = 0; i < nodes_num; ++i) {
+        const size_t val = rand() % max_val + 1;
+        const bool deleted = uirbtree_delete(&reference, val);
+        const bool arenaDeleted = delete_value(&tree, val);
+        if (deleted != arenaDeleted) {
+            printf("seed: %u\n", seed);
+        }
+        assert_int_equal( deleted, arenaDeleted );
+
+        const ARBTreeValidationError valid = artree_isValid(&tree);
+        if (valid != ARBTREE_INVALID_OK) {
+            printf("seed: %u\n", seed);
+            printf("Iteration %zu: removing %zu\n", i, val);
+        }
+        assert_int_equal( valid, ARBTREE_INVALID_OK );
+        assert_int_equal( artree_size(&tree), uirbtree_size(&reference) );
+
+        if (i % 2 == 0) {
+            const size_t addVal = rand() % max_val + 1;
+            uirbtree_add(&reference, addVal);
+            add_value(&tree, addVal);
+        }
+    }
+
+    uirbtree_release(&reference);
+    artree_release(&tree);
+}
+
+
+/// ==================================================
+
+
+int main(void) {
+
+    const struct UnitTest tests[] = {
+        unit_test(test_artree_init),
+        unit_test(test_artree_add_same),
+        unit_test(test_artree_add_subtree),
+        unit_test(test_artree_delete),
+        unit_test(test_artree_reuse),
+        unit_test(test_artree_relocate),
+        unit_test(test_artree_compare)
+    };
+
+    return run_group_tests(tests);
+}
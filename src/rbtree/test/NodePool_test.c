@@ -0,0 +1,134 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+
+#include "rbtree/NodePool.h"
+
+#include <stdint.h>                             /// uintptr_t
+
+/// for cmocka to mock system functions
+#define UNIT_TESTING 1
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+
+
+static void test_pool_init(void **state) {
+    (void) state; /* unused */
+
+    NodePool pool;
+    pool_init(&pool, 40, NODEPOOL_CACHE_LINE, 0);
+
+    assert_int_equal( pool.nodeSize, 64 );
+    assert_int_equal( pool.chunkNodes, NODEPOOL_CHUNK_NODES );
+    assert_int_equal( pool.used, 0 );
+    assert_int_equal( pool_chunks(&pool), 0 );
+
+    pool_release(&pool);
+}
+
+static void test_pool_alloc_aligned(void **state) {
+    (void) state; /* unused */
+
+    NodePool pool;
+    pool_init(&pool, 40, NODEPOOL_CACHE_LINE, 4);
+
+    for(size_t i = 0; i < 10; ++i) {
+        const char* node = pool_alloc(&pool);
+        assert_non_null( node );
+        assert_int_equal( ((uintptr_t)node) % NODEPOOL_CACHE_LINE, 0 );
+        for(size_t x = 0; x < pool.nodeSize; ++x) {
+            assert_int_equal( node[x], 0 );
+        }
+    }
+
+    assert_int_equal( pool.used, 10 );
+    assert_int_equal( pool_chunks(&pool), 3 );
+
+    pool_release(&pool);
+    assert_int_equal( pool_chunks(&pool), 0 );
+    assert_int_equal( pool.used, 0 );
+}
+
+static void test_pool_free_reuse(void **state) {
+    (void) state; /* unused */
+
+    NodePool pool;
+    pool_init(&pool, 16, 16, 2);
+
+    char* node1 = pool_alloc(&pool);
+    char* node2 = pool_alloc(&pool);
+    node1[3] = 7;
+
+    pool_free(&pool, node1);
+    assert_int_equal( pool.used, 1 );
+
+    char* node3 = pool_alloc(&pool);
+    assert_true( node3 == node1 );
+    assert_int_equal( node3[3], 0 );
+    assert_int_equal( pool_chunks(&pool), 1 );
+
+    pool_free(&pool, NULL);
+    pool_free(&pool, node2);
+    pool_free(&pool, node3);
+    assert_int_equal( pool.used, 0 );
+
+    pool_release(&pool);
+}
+
+static void test_pool_create(void **state) {
+    (void) state; /* unused */
+
+    NodePool* pool = pool_create(100);
+    /// nodes packed densely
+    assert_int_equal( pool->nodeSize, (100 + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*) );
+
+    void* node = pool_allocNode(pool, 100);
+    assert_non_null( node );
+    pool_freeNode(pool, node);
+
+    pool_allocNode(pool, 100);
+    pool_destroy(pool);
+    pool_destroy(NULL);
+}
+
+
+/// ==================================================
+
+
+int main(void) {
+
+    //TODO: add selective run
+
+    const struct UnitTest tests[] = {
+        unit_test(test_pool_init),
+        unit_test(test_pool_alloc_aligned),
+        unit_test(test_pool_free_reuse),
+        unit_test(test_pool_create),
+    };
+
+    return run_group_tests(tests);
+}
@@ -0,0 +1,225 @@
+/// MIT License
+///
+/// Copyright (c) 2017 Arkadiusz Netczuk <dev.arnet@gmail.com>
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+
+#include "rbtree/UIntRBTree.h"
+#include "rbtree/ArenaRBTree.h"
+#include "rbtree/AbstractRBTree.h"
+#include "rbtree/RBTreeGenerator.h"
+
+#include "benchmark/Timer.h"
+
+#include <time.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdio.h>                              /// printf
+
+
+
+static unsigned int current_seed = 0;
+
+static unsigned int get_next_seed() {
+    if (current_seed == 0) {
+        srand( time(NULL) );
+        current_seed = rand();
+    }
+    return (++current_seed);
+}
+
+static bool typed_checkOrder(const ARBTreeValue valueA, const ARBTreeValue valueB) {
+    return *((size_t*)valueA) < *((size_t*)valueB);
+}
+
+static inline bool typed_less(const size_t* valueA, const size_t* valueB) {
+    return (*valueA < *valueB);
+}
+
+RBTREE_DEFINE(typed, size_t, typed_less, RBTREE_FIT_ANY, RBTREE_FIT_ANY)
+
+/**
+ * Compares generic loops of ARBTree (comparator by pointer) with loops
+ * generated by RBTREE_DEFINE (inlined comparator) on the same tree layout.
+ */
+static void test_typed_tree() {
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    static const size_t nodes_num = 200000;
+    static const size_t max_val = 1000000;
+
+    ARBTree tree;
+    rbtree_initInline(&tree, sizeof(size_t));
+    tree.fIsLessOrder = typed_checkOrder;
+
+    ARBTree typedTree;
+    rbtree_initInline(&typedTree, sizeof(size_t));
+    typedTree.fIsLessOrder = typed_checkOrder;
+
+    double timer1 = 0.0;
+    double timer2 = 0.0;
+
+    for(size_t i = 0; i < nodes_num; ++i) {
+        size_t val = rand() % max_val + 1;
+
+        timer_elapsed();
+        rbtree_add(&tree, &val);
+        timer1 += timer_elapsed();
+        typed_addValue(&typedTree, &val);
+        timer2 += timer_elapsed();
+    }
+
+    for(size_t i = 0; i < nodes_num; ++i) {
+        size_t val = rand() % max_val + 1;
+
+        timer_elapsed();
+        rbtree_delete(&tree, &val);
+        timer1 += timer_elapsed();
+        typed_deleteValue(&typedTree, &val);
+        timer2 += timer_elapsed();
+    }
+
+    assert( rbtree_size(&tree) == rbtree_size(&typedTree) );
+
+    timer_elapsed();
+    rbtree_release(&tree);
+    timer1 += timer_elapsed();
+    rbtree_release(&typedTree);
+    timer2 += timer_elapsed();
+
+    printf("Typed tree timing: generic: %f, generated: %f, %f%%\n", timer1, timer2, timer2 / timer1 * 100.0);
+}
+
+/**
+ * Compares pointer-linked tree with tree of 32-bit indexed nodes in arena.
+ */
+static void test_arena_tree() {
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    static const size_t nodes_num = 200000;
+    static const size_t max_val = 1000000;
+
+    UIntRBTree tree;
+    uirbtree_init(&tree);
+
+    ArenaRBTree arenaTree;
+    artree_init(&arenaTree, sizeof(size_t));
+    arenaTree.fIsLessOrder = typed_checkOrder;
+
+    double timer1 = 0.0;
+    double timer2 = 0.0;
+
+    for(size_t i = 0; i < nodes_num; ++i) {
+        size_t val = rand() % max_val + 1;
+
+        timer_elapsed();
+        uirbtree_add(&tree, val);
+        timer1 += timer_elapsed();
+        artree_add(&arenaTree, &val);
+        timer2 += timer_elapsed();
+    }
+
+    for(size_t i = 0; i < nodes_num; ++i) {
+        size_t val = rand() % max_val + 1;
+
+        timer_elapsed();
+        uirbtree_delete(&tree, val);
+        timer1 += timer_elapsed();
+        artree_delete(&arenaTree, &val);
+        timer2 += timer_elapsed();
+    }
+
+    assert( uirbtree_size(&tree) == artree_size(&arenaTree) );
+
+    /// node with separately allocated value vs node in arena (with unused capacity)
+    const size_t pointerFootprint = sizeof(ARBTreeNode) + sizeof(UIntRBTreeValue);
+    const double arenaFootprint = (double)artree_memoryUsage(&arenaTree) / artree_size(&arenaTree);
+
+    timer_elapsed();
+    uirbtree_release(&tree);
+    timer1 += timer_elapsed();
+    artree_release(&arenaTree);
+    timer2 += timer_elapsed();
+
+    printf("Arena tree timing: UIntRBTree: %f, arena: %f, %f%%\n", timer1, timer2, timer2 / timer1 * 100.0);
+    printf("Footprint per value: UIntRBTree: %zu, inline: %zu, arena: %zu (%.1f with spare capacity)\n",
+           pointerFootprint, sizeof(ARBTreeNode) + sizeof(size_t), arenaTree.nodeSize, arenaFootprint);
+}
+
+
+/**
+ * Measures scaling of parallel set operations with number of threads.
+ */
+static void test_set_operations() {
+    static const size_t range = 400000;
+    static const size_t max_threads = 8;
+
+    const unsigned int seed = get_next_seed();
+    for(size_t operation = 0; operation < 3; ++operation) {
+        double timer1 = 0.0;
+        printf("Set operation %zu timing [threads: time, speedup]:", operation);
+        for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+            srand( seed );
+            UIntRBTree tree;
+            UIntRBTree other;
+            uirbtree_init(&tree);
+            uirbtree_init(&other);
+            for(size_t i = 0; i < range; ++i) {
+                if (rand() % 2 == 0) {
+                    uirbtree_add(&tree, i);
+                }
+                if (rand() % 2 == 0) {
+                    uirbtree_add(&other, i);
+                }
+            }
+
+            timer_elapsed();
+            if (operation == 0) {
+                uirbtree_union(&tree, &other, threads);
+            } else if (operation == 1) {
+                uirbtree_intersection(&tree, &other, threads);
+            } else {
+                uirbtree_difference(&tree, &other, threads);
+            }
+            const double timer = timer_elapsed();
+            if (threads == 1) {
+                timer1 = timer;
+            }
+            printf(" %zu: %f %.2f", threads, timer, timer1 / timer);
+
+            uirbtree_release(&tree);
+            uirbtree_release(&other);
+        }
+        printf("\n");
+    }
+}
+
+int main(void) {
+
+    test_typed_tree();
+
+    test_arena_tree();
+
+    test_set_operations();
+
+    return 0;
+}
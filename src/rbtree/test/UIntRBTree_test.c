@@ -22,6 +22,7 @@
 ///
 
 #include "rbtree/UIntRBTree.h"
+#include "rbtree/AbstractRBTree.h"
 
 #include <time.h>
 #include <stdlib.h>
@@ -82,6 +83,337 @@ static UIntRBTree create_random_uirbtree_map(const unsigned int seed, const size
 }
 
 
+static void test_uirbtree_split(void **state) {
+    (void) state; /* unused */
+
+    UIntRBTree tree;
+    uirbtree_init(&tree);
+    for(size_t i = 1; i <= 100; ++i) {
+        uirbtree_add(&tree, i);
+    }
+
+    UIntRBTree left;
+    UIntRBTree right;
+    size_t key = 40;
+    rbtree_split(&(tree.tree), &key, &(left.tree), &(right.tree));
+    assert_int_equal( uirbtree_size(&tree), 0 );
+    assert_int_equal( uirbtree_size(&left), 39 );
+    assert_int_equal( uirbtree_size(&right), 61 );
+    assert_int_equal( uirbtree_isValid(&left), ARBTREE_INVALID_OK );
+    assert_int_equal( uirbtree_isValid(&right), ARBTREE_INVALID_OK );
+    assert_int_equal( *(const size_t*)rbtree_lastValue(&(left.tree)), 39 );
+    assert_int_equal( *(const size_t*)rbtree_valueByIndex(&(right.tree), 0), 40 );
+
+    /// wrong order
+    assert_int_equal( rbtree_concat(&(right.tree), &(left.tree)), false );
+
+    assert_true( rbtree_concat(&(left.tree), &(right.tree)) );
+    assert_int_equal( uirbtree_size(&left), 100 );
+    assert_int_equal( uirbtree_size(&right), 0 );
+    assert_int_equal( uirbtree_isValid(&left), ARBTREE_INVALID_OK );
+
+    /// split in place on bounds
+    key = 0;
+    rbtree_split(&(left.tree), &key, &(left.tree), &(right.tree));
+    assert_int_equal( uirbtree_size(&left), 0 );
+    assert_int_equal( uirbtree_size(&right), 100 );
+    assert_true( rbtree_concat(&(left.tree), &(right.tree)) );
+    key = 1000;
+    rbtree_split(&(left.tree), &key, &(left.tree), &(right.tree));
+    assert_int_equal( uirbtree_size(&left), 100 );
+    assert_int_equal( uirbtree_size(&right), 0 );
+    assert_int_equal( uirbtree_isValid(&left), ARBTREE_INVALID_OK );
+
+    uirbtree_release(&right);
+    uirbtree_release(&left);
+    uirbtree_release(&tree);
+}
+
+static void test_uirbtree_join(void **state) {
+    (void) state; /* unused */
+
+    UIntRBTree tree;
+    uirbtree_init(&tree);
+    rbtree_usePool(&(tree.tree));       /// allocator ownership is passed between trees
+    for(size_t i = 1; i <= 100; ++i) {
+        uirbtree_add(&tree, i);
+    }
+
+    /// cut out 50
+    UIntRBTree middle;
+    UIntRBTree right;
+    size_t key = 50;
+    rbtree_split(&(tree.tree), &key, &(tree.tree), &(right.tree));
+    key = 51;
+    rbtree_split(&(right.tree), &key, &(middle.tree), &(right.tree));
+    assert_int_equal( uirbtree_size(&tree), 49 );
+    assert_int_equal( uirbtree_size(&middle), 1 );
+    assert_int_equal( uirbtree_size(&right), 50 );
+
+    size_t* pivot = malloc( sizeof(size_t) );
+    *pivot = 10;
+    assert_int_equal( rbtree_join(&(tree.tree), pivot, &(right.tree)), false );
+    *pivot = 50;
+    assert_true( rbtree_join(&(tree.tree), pivot, &(right.tree)) );
+    assert_int_equal( uirbtree_size(&tree), 100 );
+    assert_int_equal( uirbtree_size(&right), 0 );
+    assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+    for(size_t i = 0; i < 100; ++i) {
+        assert_int_equal( *(const size_t*)rbtree_valueByIndex(&(tree.tree), i), i + 1 );
+    }
+
+    /// join with empty trees
+    pivot = malloc( sizeof(size_t) );
+    *pivot = 200;
+    assert_true( rbtree_join(&(tree.tree), pivot, &(right.tree)) );
+    pivot = malloc( sizeof(size_t) );
+    *pivot = 0;
+    assert_true( rbtree_join(&(right.tree), pivot, &(tree.tree)) );
+    assert_int_equal( uirbtree_size(&right), 102 );
+    assert_int_equal( uirbtree_isValid(&right), ARBTREE_INVALID_OK );
+
+    uirbtree_release(&middle);
+    uirbtree_release(&tree);
+    uirbtree_release(&right);
+}
+
+static void test_uirbtree_split_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    UIntRBTree tree = create_random_uirbtree_map(seed, 300, 1000);
+
+    for(size_t i = 0; i < 50; ++i) {
+        size_t key = rand() % 1100;
+        UIntRBTree left;
+        UIntRBTree right;
+        rbtree_split(&(tree.tree), &key, &(left.tree), &(right.tree));
+        const ARBTreeValidationError leftValid = uirbtree_isValid(&left);
+        const ARBTreeValidationError rightValid = uirbtree_isValid(&right);
+        if (leftValid != ARBTREE_INVALID_OK || rightValid != ARBTREE_INVALID_OK) {
+            printf("seed: %u\n", seed);
+        }
+        assert_int_equal( leftValid, ARBTREE_INVALID_OK );
+        assert_int_equal( rightValid, ARBTREE_INVALID_OK );
+        assert_int_equal( uirbtree_size(&left) + uirbtree_size(&right), 300 );
+        if (uirbtree_size(&left) > 0) {
+            assert_true( *(const size_t*)rbtree_lastValue(&(left.tree)) < key );
+        }
+        if (uirbtree_size(&right) > 0) {
+            assert_true( *(const size_t*)rbtree_valueByIndex(&(right.tree), 0) >= key );
+        }
+
+        if (rand() % 2 == 0 || uirbtree_size(&right) == 0) {
+            assert_true( rbtree_concat(&(left.tree), &(right.tree)) );
+            tree = left;
+        } else {
+            /// pass greatest value of left tree as pivot
+            size_t* pivot = malloc( sizeof(size_t) );
+            *pivot = key;
+            if (uirbtree_size(&right) > 0 && *(const size_t*)rbtree_valueByIndex(&(right.tree), 0) == key) {
+                *pivot = key - 1;
+            }
+            if (uirbtree_size(&left) > 0 && *(const size_t*)rbtree_lastValue(&(left.tree)) >= *pivot) {
+                free(pivot);
+                assert_true( rbtree_concat(&(left.tree), &(right.tree)) );
+            } else {
+                assert_true( rbtree_join(&(left.tree), pivot, &(right.tree)) );
+                uirbtree_delete(&left, *pivot);
+            }
+            tree = left;
+        }
+        assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+        assert_int_equal( uirbtree_size(&tree), 300 );
+    }
+
+    uirbtree_release(&tree);
+}
+
+
+static void test_uirbtree_setOperations_NULL(void **state) {
+    (void) state; /* unused */
+
+    UIntRBTree tree;
+    uirbtree_init(&tree);
+    assert_int_equal( uirbtree_union(NULL, &tree, 1), false );
+    assert_int_equal( uirbtree_intersection(&tree, NULL, 1), false );
+    assert_int_equal( uirbtree_difference(&tree, &tree, 1), false );
+    uirbtree_release(&tree);
+}
+
+/**
+ * Creates trees of even values and of multiples of 3 in range [0, 300).
+ */
+static void create_set_trees(UIntRBTree* evens, UIntRBTree* triples) {
+    uirbtree_init(evens);
+    uirbtree_init(triples);
+    for(size_t i = 0; i < 300; ++i) {
+        if (i % 2 == 0) {
+            uirbtree_add(evens, i);
+        }
+        if (i % 3 == 0) {
+            uirbtree_add(triples, i);
+        }
+    }
+}
+
+static void test_uirbtree_setOperations(void **state) {
+    (void) state; /* unused */
+
+    UIntRBTree tree;
+    UIntRBTree other;
+
+    create_set_trees(&tree, &other);
+    assert_true( uirbtree_union(&tree, &other, 1) );
+    assert_int_equal( uirbtree_size(&tree), 200 );
+    assert_int_equal( uirbtree_size(&other), 0 );
+    assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+    assert_int_equal( *(const size_t*)rbtree_valueByIndex(&(tree.tree), 1), 2 );
+    assert_int_equal( *(const size_t*)rbtree_valueByIndex(&(tree.tree), 2), 3 );
+    uirbtree_release(&tree);
+    uirbtree_release(&other);
+
+    create_set_trees(&tree, &other);
+    assert_true( uirbtree_intersection(&tree, &other, 2) );
+    assert_int_equal( uirbtree_size(&tree), 50 );
+    assert_int_equal( uirbtree_size(&other), 0 );
+    assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+    for(size_t i = 0; i < 50; ++i) {
+        assert_int_equal( *(const size_t*)rbtree_valueByIndex(&(tree.tree), i), i * 6 );
+    }
+    uirbtree_release(&tree);
+    uirbtree_release(&other);
+
+    create_set_trees(&tree, &other);
+    assert_true( uirbtree_difference(&tree, &other, 4) );
+    assert_int_equal( uirbtree_size(&tree), 100 );
+    assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+    assert_int_equal( *(const size_t*)rbtree_valueByIndex(&(tree.tree), 0), 2 );
+    assert_int_equal( *(const size_t*)rbtree_valueByIndex(&(tree.tree), 1), 4 );
+    assert_int_equal( *(const size_t*)rbtree_valueByIndex(&(tree.tree), 2), 8 );
+
+    /// empty trees
+    assert_true( uirbtree_difference(&tree, &other, 4) );
+    assert_int_equal( uirbtree_size(&tree), 100 );
+    assert_true( uirbtree_intersection(&other, &tree, 4) );
+    assert_int_equal( uirbtree_size(&other), 0 );
+    assert_int_equal( uirbtree_size(&tree), 0 );
+    uirbtree_release(&tree);
+    uirbtree_release(&other);
+}
+
+static void test_uirbtree_setOperations_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    /// large enough to run in parallel
+    const size_t range = 40000;
+    bool* inA = calloc(range, sizeof(bool));
+    bool* inB = calloc(range, sizeof(bool));
+    for(size_t operation = 0; operation < 3; ++operation) {
+        UIntRBTree tree;
+        UIntRBTree other;
+        uirbtree_init(&tree);
+        uirbtree_init(&other);
+        for(size_t i = 0; i < range; ++i) {
+            inA[i] = (rand() % 2 == 0);
+            inB[i] = (rand() % 3 == 0);
+            if (inA[i] == true) {
+                uirbtree_add(&tree, i);
+            }
+            if (inB[i] == true) {
+                uirbtree_add(&other, i);
+            }
+        }
+
+        const size_t threads = operation + 2;
+        if (operation == 0) {
+            uirbtree_union(&tree, &other, threads);
+        } else if (operation == 1) {
+            uirbtree_intersection(&tree, &other, threads);
+        } else {
+            uirbtree_difference(&tree, &other, threads);
+        }
+        const ARBTreeValidationError valid = uirbtree_isValid(&tree);
+        if (valid != ARBTREE_INVALID_OK) {
+            printf("seed: %u\n", seed);
+        }
+        assert_int_equal( valid, ARBTREE_INVALID_OK );
+        assert_int_equal( uirbtree_size(&other), 0 );
+
+        size_t index = 0;
+        for(size_t i = 0; i < range; ++i) {
+            bool expected = false;
+            if (operation == 0) {
+                expected = inA[i] || inB[i];
+            } else if (operation == 1) {
+                expected = inA[i] && inB[i];
+            } else {
+                expected = inA[i] && !inB[i];
+            }
+            if (expected == false) {
+                continue ;
+            }
+            assert_int_equal( *(const size_t*)rbtree_valueByIndex(&(tree.tree), index), i );
+            ++index;
+        }
+        assert_int_equal( uirbtree_size(&tree), index );
+
+        uirbtree_release(&tree);
+        uirbtree_release(&other);
+    }
+    free(inA);
+    free(inB);
+}
+
+
+static void test_uirbtree_cursor(void **state) {
+    (void) state; /* unused */
+
+    UIntRBTree tree;
+    uirbtree_init(&tree);
+    ARBTreeCursor cursor;
+    assert_int_equal( rbtree_cursorFirst(&(tree.tree), &cursor), false );
+    assert_null( rbtree_cursorGet(&cursor) );
+    assert_int_equal( rbtree_cursorNext(&cursor), false );
+
+    for(size_t i = 1; i <= 50; ++i) {
+        uirbtree_add(&tree, i * 2);
+    }
+
+    /// forward walk
+    size_t expected = 2;
+    for(bool valid = rbtree_cursorFirst(&(tree.tree), &cursor); valid == true; valid = rbtree_cursorNext(&cursor)) {
+        assert_int_equal( *(const size_t*)rbtree_cursorGet(&cursor), expected );
+        expected += 2;
+    }
+    assert_int_equal( expected, 102 );
+    assert_null( rbtree_cursorGet(&cursor) );
+
+    /// backward walk
+    for(bool valid = rbtree_cursorLast(&(tree.tree), &cursor); valid == true; valid = rbtree_cursorPrev(&cursor)) {
+        expected -= 2;
+        assert_int_equal( *(const size_t*)rbtree_cursorGet(&cursor), expected );
+    }
+    assert_int_equal( expected, 2 );
+
+    size_t key = 31;
+    assert_true( rbtree_cursorSeek(&(tree.tree), &key, &cursor) );
+    assert_int_equal( *(const size_t*)rbtree_cursorGet(&cursor), 32 );
+    key = 32;
+    assert_true( rbtree_cursorSeek(&(tree.tree), &key, &cursor) );
+    assert_int_equal( *(const size_t*)rbtree_cursorGet(&cursor), 32 );
+    assert_true( rbtree_cursorPrev(&cursor) );
+    assert_int_equal( *(const size_t*)rbtree_cursorGet(&cursor), 30 );
+    key = 101;
+    assert_int_equal( rbtree_cursorSeek(&(tree.tree), &key, &cursor), false );
+
+    uirbtree_release(&tree);
+}
+
+
 /// ======================================================
 
 
@@ -534,6 +866,275 @@ static void test_uirbtree_randomTest1(void **state) {
     }
 }
 
+static void test_uirbtree_finger(void **state) {
+    (void) state; /* unused */
+
+    const size_t treeSize = 16;
+    UIntRBTree tree = create_default_tree(treeSize);
+    rbtree_useFinger(&(tree.tree));
+
+    /// finger points to last added node
+    const ARBTree* baseTree = &(tree.tree);
+    assert_non_null( baseTree->finger );
+    assert_int_equal( *(const size_t*)baseTree->finger->value, 16 );
+
+    size_t value = 15;
+    const ARBTreeNode* node = rbtree_findNode(baseTree, &value);
+    assert_non_null( node );
+    assert_int_equal( *(const size_t*)node->value, 15 );
+    value = 1;
+    node = rbtree_findNode(baseTree, &value);
+    assert_non_null( node );
+    assert_int_equal( *(const size_t*)node->value, 1 );
+    value = 17;
+    assert_null( rbtree_findNode(baseTree, &value) );
+
+    assert_true( uirbtree_delete(&tree, 16) );
+    assert_true( uirbtree_delete(&tree, 8) );
+    assert_non_null( baseTree->finger );
+    assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+
+    assert_true( uirbtree_add(&tree, 8) );
+    assert_int_equal( *(const size_t*)baseTree->finger->value, 8 );
+    assert_int_equal( uirbtree_size(&tree), 15 );
+    assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+
+    for(size_t i = 1; i < 16; ++i) {
+        assert_true( uirbtree_delete(&tree, i) );
+    }
+    assert_null( baseTree->finger );
+    assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+
+    uirbtree_release(&tree);
+}
+
+static void test_uirbtree_finger_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    srand( seed );
+
+    #define finger_max_val 200
+    size_t counts[finger_max_val] = { 0 };
+
+    UIntRBTree tree;
+    uirbtree_init(&tree);
+    rbtree_useFinger(&(tree.tree));
+
+    size_t last = finger_max_val / 2;
+    for(size_t i = 0; i < 2000; ++i) {
+        /// mostly operations close to previous one
+        const size_t near = (last + finger_max_val + rand() % 7 - 3) % finger_max_val;
+        const size_t value = (rand() % 4 == 0) ? (size_t)(rand() % finger_max_val) : near;
+        if (rand() % 2 == 0) {
+            assert_true( uirbtree_add(&tree, value) );
+            ++counts[value];
+        } else {
+            const bool deleted = uirbtree_delete(&tree, value);
+            assert_int_equal( deleted, counts[value] > 0 );
+            if (deleted) {
+                --counts[value];
+            }
+        }
+        last = value;
+
+        const ARBTreeValidationError valid = uirbtree_isValid(&tree);
+        if (valid != ARBTREE_INVALID_OK) {
+            printf("seed: %u\n", seed);
+        }
+        assert_int_equal( valid, ARBTREE_INVALID_OK );
+
+        size_t searched = rand() % finger_max_val;
+        const ARBTreeNode* node = rbtree_findNode(&(tree.tree), &searched);
+        assert_int_equal( node != NULL, counts[searched] > 0 );
+    }
+
+    uirbtree_release(&tree);
+}
+
+static void test_uirbtree_addSorted(void **state) {
+    (void) state; /* unused */
+
+    UIntRBTree tree;
+    uirbtree_init(&tree);
+    ARBTree* baseTree = &(tree.tree);
+
+    /// values are owned by tree
+    ARBTreeValue values[64];
+    ARBTreeNode* nodes[64];
+    for(size_t i = 0; i < 32; ++i) {
+        values[i] = malloc( sizeof(size_t) );
+        *(size_t*)values[i] = i * 2 + 1;
+    }
+    assert_true( rbtree_addSorted(baseTree, values, 32, nodes) );
+    assert_int_equal( uirbtree_size(&tree), 32 );
+    assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+    assert_int_equal( *(const size_t*)nodes[31]->value, 63 );
+
+    /// interleave with existing values
+    for(size_t i = 0; i < 64; ++i) {
+        values[i] = malloc( sizeof(size_t) );
+        *(size_t*)values[i] = i;
+    }
+    assert_true( rbtree_addSorted(baseTree, values, 64, NULL) );
+    assert_int_equal( uirbtree_size(&tree), 96 );
+    assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+
+    /// in-order sequence
+    size_t prev = 0;
+    for(size_t i = 0; i < 96; ++i) {
+        const size_t value = *(const size_t*)rbtree_valueByIndex(baseTree, i);
+        assert_true( value >= prev );
+        prev = value;
+    }
+    assert_int_equal( *(const size_t*)rbtree_lastValue(baseTree), 63 );
+
+    /// nodes are relinked, not recreated
+    bool linked = false;
+    for(const ARBTreeNode* node = baseTree->leftmost; node != NULL; node = rbtree_nextNode(node)) {
+        linked |= (node == nodes[31]);
+    }
+    assert_true( linked );
+    assert_int_equal( *(const size_t*)nodes[31]->value, 63 );
+
+    /// small batch is inserted value by value
+    for(size_t i = 0; i < 3; ++i) {
+        values[i] = malloc( sizeof(size_t) );
+        *(size_t*)values[i] = i * 40 + 5;
+    }
+    assert_true( rbtree_addSorted(baseTree, values, 3, nodes) );
+    assert_int_equal( uirbtree_size(&tree), 99 );
+    assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+    assert_int_equal( *(const size_t*)nodes[2]->value, 85 );
+    assert_int_equal( *(const size_t*)rbtree_lastValue(baseTree), 85 );
+
+    uirbtree_release(&tree);
+}
+
+static void test_uirbtree_addSorted_random(void **state) {
+    (void) state; /* unused */
+
+    const unsigned int seed = get_next_seed();
+    UIntRBTree tree = create_random_uirbtree_map(seed, 100, 1000);
+
+    ARBTreeValue values[200];
+    size_t value = 0;
+    for(size_t i = 0; i < 200; ++i) {
+        value += rand() % 10;
+        values[i] = malloc( sizeof(size_t) );
+        *(size_t*)values[i] = value;
+    }
+    assert_true( rbtree_addSorted(&(tree.tree), values, 200, NULL) );
+    const ARBTreeValidationError valid = uirbtree_isValid(&tree);
+    if (valid != ARBTREE_INVALID_OK) {
+        printf("seed: %u\n", seed);
+    }
+    assert_int_equal( valid, ARBTREE_INVALID_OK );
+    assert_int_equal( uirbtree_size(&tree), 300 );
+
+    uirbtree_release(&tree);
+}
+
+static void test_uirbtree_buildFromSorted(void **state) {
+    (void) state; /* unused */
+
+    for(size_t n = 0; n < 70; ++n) {
+        UIntRBTree tree;
+        uirbtree_init(&tree);
+
+        /// values are owned by tree
+        ARBTreeValue values[70];
+        for(size_t i = 0; i < n; ++i) {
+            values[i] = malloc( sizeof(size_t) );
+            *(size_t*)values[i] = i * 3;
+        }
+        assert_true( rbtree_buildFromSorted(&(tree.tree), values, n) );
+        assert_int_equal( uirbtree_size(&tree), n );
+        assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+
+        /// perfectly balanced
+        size_t height = 0;
+        while ( ((size_t)1 << height) <= n ) {
+            ++height;
+        }
+        assert_int_equal( uirbtree_depth(&tree), height );
+
+        if (n > 0) {
+            assert_int_equal( *(const size_t*)rbtree_valueByIndex(&(tree.tree), n / 3), (n / 3) * 3 );
+            /// tree has to be empty
+            assert_int_equal( rbtree_buildFromSorted(&(tree.tree), values, n), false );
+        }
+
+        assert_true( uirbtree_add(&tree, 7) );
+        assert_true( uirbtree_delete(&tree, 0) || n == 0 );
+        assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+
+        uirbtree_release(&tree);
+    }
+}
+
+/// number of nodes test allocator can still allocate
+static size_t alloc_budget = 0;
+
+static void* test_allocLimited(void* allocator, const size_t size) {
+    (void) allocator; /* unused */
+    if (alloc_budget == 0) {
+        return NULL;
+    }
+    --alloc_budget;
+    return calloc(1, size);
+}
+
+static void test_uirbtree_allocFailure(void **state) {
+    (void) state; /* unused */
+
+    UIntRBTree tree;
+    uirbtree_init(&tree);
+    ARBTree* baseTree = &(tree.tree);
+    baseTree->fAllocNode = test_allocLimited;
+
+    alloc_budget = 3;
+    assert_true( uirbtree_add(&tree, 10) );
+    assert_true( uirbtree_add(&tree, 20) );
+    assert_true( uirbtree_add(&tree, 30) );
+    assert_int_equal( uirbtree_add(&tree, 40), false );
+    assert_int_equal( uirbtree_size(&tree), 3 );
+    assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+
+    /// failed batch does not change tree, values stay owned by caller
+    ARBTreeValue values[16];
+    for(size_t i = 0; i < 16; ++i) {
+        values[i] = malloc( sizeof(size_t) );
+        *(size_t*)values[i] = i * 3;
+    }
+    alloc_budget = 2;
+    assert_int_equal( rbtree_addSorted(baseTree, values, 3, NULL), false );
+    alloc_budget = 10;
+    assert_int_equal( rbtree_addSorted(baseTree, values, 16, NULL), false );
+    assert_int_equal( uirbtree_size(&tree), 3 );
+    assert_int_equal( uirbtree_isValid(&tree), ARBTREE_INVALID_OK );
+
+    /// failed build leaves tree empty
+    UIntRBTree empty;
+    uirbtree_init(&empty);
+    empty.tree.fAllocNode = test_allocLimited;
+    alloc_budget = 9;
+    assert_int_equal( rbtree_buildFromSorted(&(empty.tree), values, 16), false );
+    assert_int_equal( uirbtree_size(&empty), 0 );
+
+    /// pivot of join not allocated
+    size_t pivot = 5;
+    alloc_budget = 0;
+    assert_int_equal( rbtree_join(&(empty.tree), &pivot, baseTree), false );
+    assert_int_equal( uirbtree_size(&tree), 3 );
+    uirbtree_release(&empty);
+
+    for(size_t i = 0; i < 16; ++i) {
+        free(values[i]);
+    }
+    uirbtree_release(&tree);
+}
+
 
 /// ==================================================
 
@@ -576,7 +1177,26 @@ int main(void) {
         unit_test(test_uirbtree_release_2),
 
         unit_test(test_uirbtree_randomT1),
-        unit_test(test_uirbtree_randomTest1)
+        unit_test(test_uirbtree_randomTest1),
+
+        unit_test(test_uirbtree_finger),
+        unit_test(test_uirbtree_finger_random),
+
+        unit_test(test_uirbtree_addSorted),
+        unit_test(test_uirbtree_addSorted_random),
+
+        unit_test(test_uirbtree_buildFromSorted),
+        unit_test(test_uirbtree_allocFailure),
+
+        unit_test(test_uirbtree_split),
+        unit_test(test_uirbtree_join),
+        unit_test(test_uirbtree_split_random),
+
+        unit_test(test_uirbtree_setOperations_NULL),
+        unit_test(test_uirbtree_setOperations),
+        unit_test(test_uirbtree_setOperations_random),
+
+        unit_test(test_uirbtree_cursor)
     };
 
     return run_group_tests(tests);